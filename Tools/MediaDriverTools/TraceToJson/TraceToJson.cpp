@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////
+/*
+ * Copyright (c) 2018, Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+///////////////////////////////////////////////////////////////////////////////
+
+// Converts the binary trace written by the media driver when
+// "Trace Event Output File" is set into the Chrome trace event JSON format,
+// which chrome://tracing and the Perfetto UI both open.
+//
+// Usage: TraceToJson <trace file> [<json file>]
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+static const uint32_t TRACE_FILE_MAGIC      = 0x42544D49;   // "IMTB"
+static const uint32_t TRACE_FILE_VERSION    = 1;
+
+// Must match MOS_TRACE_FILE_HEADER and MOS_TRACE_RECORD in mos_utilities_specific.h
+struct TraceFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t processId;
+    uint32_t reserved;
+    uint64_t droppedEvents;
+};
+
+struct TraceRecord
+{
+    uint16_t id;
+    uint8_t  type;
+    uint8_t  reserved0;
+    uint32_t size;
+    uint32_t threadId;
+    uint32_t reserved1;
+    uint64_t timestamp;
+};
+
+struct TraceEvent
+{
+    TraceRecord          record;
+    std::vector<uint8_t> payload;
+};
+
+// Must match MEDIA_EVENT in mos_os_trace_event.h
+static const char *EVENT_NAMES[] =
+{
+    "UNDEFINED_EVENT",
+    "EVENT_RESOURCE_ALLOCATE",
+    "EVENT_RESOURCE_FREE",
+    "EVENT_RESOURCE_REGISTER",
+    "EVENT_RESOURCE_PATCH",
+    "EVENT_PPED_HUC",
+    "EVENT_PPED_FW",
+    "EVENT_PPED_AUDIO",
+    "EVENT_BLT_ENC",
+    "EVENT_BLT_DEC",
+    "EVENT_PPED_HW_CAPS",
+    "EVENT_MOS_MESSAGE",
+    "EVENT_CODEC_NV12ToP010",
+    "EVENT_CODEC_DECRYPT",
+    "EVENT_CODEC_DECODE_DDI",
+    "EVENT_CODEC_DECODE",
+    "EVENT_CODEC_ENCODE_DDI",
+    "EVENT_ENCODER_CREATE",
+    "EVENT_ENCODER_DESTROY",
+    "EVENT_CODECHAL_CREATE",
+    "EVENT_CODECHAL_EXECUTE",
+    "EVENT_CODECHAL_DESTROY",
+    "EVENT_MHW_PROLOG",
+    "EVENT_MHW_EPILOG",
+    "EVENT_KEYEXCHANGE_WV",
+};
+
+static std::string EventName(uint16_t id)
+{
+    if (id < sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]))
+    {
+        return EVENT_NAMES[id];
+    }
+    return "EVENT_" + std::to_string(id);
+}
+
+static const char *EventPhase(uint8_t type)
+{
+    switch (type)
+    {
+    case 1:  return "B";    // EVENT_TYPE_START
+    case 2:  return "E";    // EVENT_TYPE_END
+    default: return "i";    // EVENT_TYPE_INFO
+    }
+}
+
+static bool ReadTrace(std::istream &in, TraceFileHeader &header, std::vector<TraceEvent> &events)
+{
+    if (!in.read((char *)&header, sizeof(header)) ||
+        header.magic != TRACE_FILE_MAGIC ||
+        header.version != TRACE_FILE_VERSION)
+    {
+        std::cerr << "not a media driver trace file, or unsupported version" << std::endl;
+        return false;
+    }
+
+    TraceEvent event;
+    while (in.read((char *)&event.record, sizeof(event.record)))
+    {
+        uint32_t padded = (event.record.size + 7) & ~7u;
+        event.payload.resize(padded);
+        if (padded && !in.read((char *)event.payload.data(), padded))
+        {
+            std::cerr << "truncated record at the end of the trace, ignored" << std::endl;
+            break;
+        }
+        event.payload.resize(event.record.size);
+        events.push_back(event);
+    }
+
+    // records of different threads are drained in chunks, restore the global order
+    std::stable_sort(events.begin(), events.end(),
+        [](const TraceEvent &a, const TraceEvent &b) { return a.record.timestamp < b.record.timestamp; });
+    return true;
+}
+
+static void WriteJson(std::ostream &out, const TraceFileHeader &header, const std::vector<TraceEvent> &events)
+{
+    uint64_t base = events.empty() ? 0 : events.front().record.timestamp;
+
+    out << "{\"traceEvents\":[" << std::endl;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const TraceRecord &record = events[i].record;
+        std::ostringstream data;
+        for (uint8_t byte : events[i].payload)
+        {
+            data << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (uint32_t)byte;
+        }
+
+        out << "{\"name\":\"" << EventName(record.id) << "\""
+            << ",\"cat\":\"media\""
+            << ",\"ph\":\"" << EventPhase(record.type) << "\""
+            << ",\"ts\":" << (record.timestamp - base) / 1000 << "." << std::setw(3) << std::setfill('0') << (record.timestamp - base) % 1000
+            << ",\"pid\":" << header.processId
+            << ",\"tid\":" << record.threadId;
+        if (record.type != 1 && record.type != 2)
+        {
+            out << ",\"s\":\"t\"";
+        }
+        out << ",\"args\":{\"id\":" << record.id << ",\"data\":\"" << data.str() << "\"}}"
+            << (i + 1 < events.size() ? "," : "") << std::endl;
+    }
+    out << "],\"otherData\":{\"droppedEvents\":" << header.droppedEvents << "}}" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <trace file> [<json file>]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    TraceFileHeader         header;
+    std::vector<TraceEvent> events;
+    if (!ReadTrace(in, header, events))
+    {
+        return 1;
+    }
+
+    if (argc > 2)
+    {
+        std::ofstream out(argv[2]);
+        if (!out)
+        {
+            std::cerr << "cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+        WriteJson(out, header, events);
+    }
+    else
+    {
+        WriteJson(std::cout, header, events);
+    }
+
+    if (header.droppedEvents)
+    {
+        std::cerr << header.droppedEvents << " events were dropped because a trace ring was full" << std::endl;
+    }
+    return 0;
+}
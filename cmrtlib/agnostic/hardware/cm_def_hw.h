@@ -335,7 +335,9 @@ struct CM_DEVICE_CREATE_BUFFER_ALIAS_PARAM
 #endif
 
 #if MDF_PROFILER_ENABLED
-#define INSERT_PROFILER_RECORD()     CmTimer Time(__FUNCTION__ )
+// The function id is looked up once per call site and cached in a local static
+#define INSERT_PROFILER_RECORD()     static const uint32_t cmProfilerFunctionId = CmTimer::RegisterFunction(__FUNCTION__); \
+                                     CmTimer Time(cmProfilerFunctionId)
 #else
 #define INSERT_PROFILER_RECORD()
 #endif
@@ -22,13 +22,18 @@
 #include "cm_perf_statistics.h"
 #include "cm_mem.h"
 #include "cm_sdk_provider.h"
+#include <algorithm>
 
 #if MDF_PROFILER_ENABLED
 
+// Only one CmPerfStatistics exists (gCmPerfStatistics), so the thread's data can be cached here
+static thread_local ApiPerfThreadData *s_threadData = nullptr;
+
 CmPerfStatistics::CmPerfStatistics()
 {
+    m_functionCount       = 0;
+    memset(m_functionNames, 0, sizeof(m_functionNames));
 
-    m_apiCallRecordCount  = 0;
     m_apiCallFile         = nullptr;
 
     m_perfStatisticFile   = nullptr;
@@ -51,7 +56,19 @@ CmPerfStatistics::~CmPerfStatistics()
 {
     DumpApiCallRecords();
 
+    MergePerfStatistics();
+
     DumpPerfStatisticRecords();
+
+    for (ApiPerfThreadData *threadData : m_threadData)
+    {
+        for (uint32_t i = 0; i < CM_PERF_MAX_FUNCTION_NUM; i++)
+        {
+            delete threadData->counters[i].load(std::memory_order_relaxed);
+        }
+        delete threadData;
+    }
+    m_threadData.clear();
 }
 
 void CmPerfStatistics::GetProfilerLevel()
@@ -61,71 +78,201 @@ void CmPerfStatistics::GetProfilerLevel()
     return;
 }
 
-//! Insert API Call Records Into m_apiCallRecords Array and Update Perf Statistic Array accordingly
-void CmPerfStatistics::InsertApiCallRecord(char *functionName, float time, LARGE_INTEGER start, LARGE_INTEGER end)
+uint32_t CmPerfStatistics::RegisterFunction(const char *functionName)
 {
-    CLock locker(m_criticalSectionOnApiCallRecords);
+    CLock locker(m_criticalSectionOnFunctions);
 
-    ApiCallRecord *pRecords = new ApiCallRecord ;
+    for (uint32_t i = 0; i < m_functionCount; i++)
+    {
+        if (!strcmp(functionName, m_functionNames[i]))
+        {
+            return i;
+        }
+    }
 
-    pRecords->startTime = start;
-    pRecords->endTime   = end;
-    pRecords->duration   = time;
+    if (m_functionCount == CM_PERF_MAX_FUNCTION_NUM)
+    {
+        return CM_PERF_INVALID_FUNCTION_ID;
+    }
 
-    CM_STRCPY(pRecords->functionName, MSG_STRING_SIZE, functionName);
+    m_functionNames[m_functionCount] = functionName;
+    return m_functionCount++;
+}
 
-    m_apiCallRecords.push_back(pRecords);
-    m_apiCallRecordCount++; 
+ApiPerfThreadData *CmPerfStatistics::GetThreadData()
+{
+    if (s_threadData == nullptr)
+    {
+        ApiPerfThreadData *threadData = new (std::nothrow) ApiPerfThreadData();
+        if (threadData == nullptr)
+        {
+            return nullptr;
+        }
 
-    InsertPerfStatistic(pRecords);
+        CLock locker(m_criticalSectionOnThreadData);
+        m_threadData.push_back(threadData);
+        s_threadData = threadData;
+    }
+    return s_threadData;
+}
+
+uint32_t CmPerfStatistics::GetHistogramBucket(uint64_t timeNs)
+{
+    const uint32_t subBuckets = 1 << CM_PERF_HISTOGRAM_SUB_BITS;
 
+    if (timeNs < subBuckets)
+    {
+        return (uint32_t)timeNs;
+    }
+
+    // log2 selects the power of two, the next bits below the leading one the sub-bucket
+    uint32_t log2 = 63 - __builtin_clzll(timeNs);
+    uint32_t bucket = ((log2 - CM_PERF_HISTOGRAM_SUB_BITS + 1) << CM_PERF_HISTOGRAM_SUB_BITS) +
+                      (uint32_t)((timeNs >> (log2 - CM_PERF_HISTOGRAM_SUB_BITS)) & (subBuckets - 1));
+
+    return (std::min)(bucket, (uint32_t)CM_PERF_HISTOGRAM_BUCKET_NUM - 1);
 }
 
-//Update Perf Statistic Array 
-void CmPerfStatistics::InsertPerfStatistic(ApiCallRecord *record)
+float CmPerfStatistics::GetHistogramBucketTime(uint32_t bucket)
 {
-    uint32_t index = 0;
-    
-    for( index = 0 ; index < m_perfStatisticCount ; index ++)
+    const uint32_t subBuckets = 1 << CM_PERF_HISTOGRAM_SUB_BITS;
+
+    if (bucket < subBuckets)
     {
-        ApiPerfStatistic *pPerfStatisticRecords = m_perfStatisticRecords[index];
-        if(pPerfStatisticRecords != nullptr)
-        {
-            if(!strcmp(record->functionName, pPerfStatisticRecords->functionName))
-            { // existing
-               pPerfStatisticRecords->callTimes ++ ;
-               pPerfStatisticRecords->time += record->duration;
+        return (float)bucket / 1000000.0f;
+    }
 
-               //Update statistic records
-               m_perfStatisticRecords[index] = pPerfStatisticRecords;
+    uint32_t shift = (bucket >> CM_PERF_HISTOGRAM_SUB_BITS) - 1;
+    uint64_t lower = (uint64_t)(subBuckets + (bucket & (subBuckets - 1))) << shift;
+    uint64_t width = (uint64_t)1 << shift;
 
-               break;
-            }
+    return (float)(lower + width / 2) / 1000000.0f;
+}
+
+float CmPerfStatistics::GetPercentile(ApiPerfStatistic *statistic, uint32_t percent)
+{
+    uint64_t target = ((uint64_t)statistic->callTimes * percent + 99) / 100;
+    uint64_t count  = 0;
+
+    for (uint32_t i = 0; i < CM_PERF_HISTOGRAM_BUCKET_NUM; i++)
+    {
+        count += statistic->histogram[i];
+        if (count >= target && count > 0)
+        {
+            return GetHistogramBucketTime(i);
         }
     }
+    return 0.0f;
+}
 
-    if(index == m_perfStatisticCount)
-    { // record does not exist, create new entry
-        ApiPerfStatistic *pPerfStatisticRecords = new ApiPerfStatistic;
-        CM_STRCPY(pPerfStatisticRecords->functionName, MSG_STRING_SIZE, record->functionName);
+//! Update the calling thread's counters, no lock is taken after the thread's first call
+void CmPerfStatistics::InsertApiCallRecord(uint32_t functionId, float time, LARGE_INTEGER start, LARGE_INTEGER end)
+{
+    if (functionId >= CM_PERF_MAX_FUNCTION_NUM)
+    {
+        return;
+    }
 
-        pPerfStatisticRecords->callTimes = 1;
-        pPerfStatisticRecords->time       = record->duration;
+    ApiPerfThreadData *threadData = GetThreadData();
+    if (threadData == nullptr)
+    {
+        return;
+    }
 
-        m_perfStatisticRecords.push_back(pPerfStatisticRecords);
-        m_perfStatisticCount ++;
+    ApiPerfCounter *counter = threadData->counters[functionId].load(std::memory_order_relaxed);
+    if (counter == nullptr)
+    {
+        counter = new (std::nothrow) ApiPerfCounter();
+        if (counter == nullptr)
+        {
+            return;
+        }
+        threadData->counters[functionId].store(counter, std::memory_order_release);
     }
 
-    return ;
+    // Only this thread writes the counters, so load + store is enough
+    uint64_t timeNs = (uint64_t)(time * 1000000.0f);
+    uint32_t bucket = GetHistogramBucket(timeNs);
+    counter->callTimes.store(counter->callTimes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    counter->timeNs.store(counter->timeNs.load(std::memory_order_relaxed) + timeNs, std::memory_order_relaxed);
+    counter->histogram[bucket].store(counter->histogram[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (m_profilerLevel >= CM_RT_PERF_LOG_LEVEL_RECORDS)
+    {
+        ApiCallRecord record;
+        record.functionId = functionId;
+        record.startTime  = start;
+        record.endTime    = end;
+        record.duration   = time;
+        threadData->apiCallRecords.push_back(record);
+    }
 }
 
-//Dump APICall Records and Release m_apiCallRecords Array
+//Merge the per-thread counters into m_perfStatisticRecords Array
+void CmPerfStatistics::MergePerfStatistics()
+{
+    CLock locker(m_criticalSectionOnThreadData);
+
+    for (uint32_t id = 0; id < m_functionCount; id++)
+    {
+        ApiPerfStatistic *pPerfStatisticRecords = nullptr;
+
+        for (ApiPerfThreadData *threadData : m_threadData)
+        {
+            ApiPerfCounter *counter = threadData->counters[id].load(std::memory_order_acquire);
+            if (counter == nullptr)
+            {
+                continue;
+            }
+
+            if (pPerfStatisticRecords == nullptr)
+            {
+                pPerfStatisticRecords = new (std::nothrow) ApiPerfStatistic();
+                if (pPerfStatisticRecords == nullptr)
+                {
+                    return;
+                }
+                pPerfStatisticRecords->functionName = m_functionNames[id];
+            }
+
+            pPerfStatisticRecords->callTimes += counter->callTimes.load(std::memory_order_relaxed);
+            pPerfStatisticRecords->time      += (float)counter->timeNs.load(std::memory_order_relaxed) / 1000000.0f;
+            for (uint32_t i = 0; i < CM_PERF_HISTOGRAM_BUCKET_NUM; i++)
+            {
+                pPerfStatisticRecords->histogram[i] += counter->histogram[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        if (pPerfStatisticRecords != nullptr)
+        {
+            m_perfStatisticRecords.push_back(pPerfStatisticRecords);
+            m_perfStatisticCount ++;
+        }
+    }
+}
+
+//Dump APICall Records and Release the per-thread records
 void CmPerfStatistics::DumpApiCallRecords()
 {
     if(!m_profilerOn)
     {
         return ;
     }
+
+    // Records are kept per thread, merge them back into call order
+    std::vector<ApiCallRecord> apiCallRecords;
+    {
+        CLock locker(m_criticalSectionOnThreadData);
+        for (ApiPerfThreadData *threadData : m_threadData)
+        {
+            apiCallRecords.insert(apiCallRecords.end(),
+                                  threadData->apiCallRecords.begin(),
+                                  threadData->apiCallRecords.end());
+            std::vector<ApiCallRecord>().swap(threadData->apiCallRecords);
+        }
+    }
+    std::stable_sort(apiCallRecords.begin(), apiCallRecords.end(),
+        [](const ApiCallRecord &a, const ApiCallRecord &b) { return a.startTime.QuadPart < b.startTime.QuadPart; });
     
     CM_FOPEN(m_apiCallFile, "CmPerfLog.csv", "wb");
     if(! m_apiCallFile )
@@ -135,17 +282,11 @@ void CmPerfStatistics::DumpApiCallRecords()
     }
     fprintf(m_apiCallFile,  "%-40s %s \t %s \t %s \n", "FunctionName", "StartTime", "EndTime", "Duration");
 
-    for(uint32_t i=0 ; i< m_apiCallRecordCount ; i++)
+    for (const ApiCallRecord &record : apiCallRecords)
     {
-        ApiCallRecord *pRecords = m_apiCallRecords[i];
-
-        fprintf(m_apiCallFile,  "%-40s  %lld \t %lld \t %fms \n", pRecords->functionName, 
-           pRecords->startTime.QuadPart, pRecords->endTime.QuadPart, pRecords->duration);
-
-        CmSafeRelease(pRecords);
+        fprintf(m_apiCallFile,  "%-40s  %lld \t %lld \t %fms \n", m_functionNames[record.functionId], 
+           record.startTime.QuadPart, record.endTime.QuadPart, record.duration);
     }
-    
-    m_apiCallRecords.clear();
 
     fclose(m_apiCallFile);
     
@@ -165,14 +306,17 @@ void CmPerfStatistics::DumpPerfStatisticRecords()
         fprintf(stdout, "Fail to create file CmPerfStatistics.txt \n ");
         return ;
     }
-    fprintf(m_perfStatisticFile,  "%-40s %s \t %s \n", "FunctionName", "Total Time(ms)", "Called Times");
+    fprintf(m_perfStatisticFile,  "%-40s %s \t %s \t %s \t %s \t %s \n", "FunctionName", "Total Time(ms)", "Called Times",
+        "Average(ms)", "P50(ms)", "P99(ms)");
 
     for(uint32_t i=0 ; i< m_perfStatisticCount; i++)
     {
         ApiPerfStatistic *pPerfStatisticRecords = m_perfStatisticRecords[i];
 
-        fprintf(m_perfStatisticFile,  "%-40s %fms \t %d \n", pPerfStatisticRecords->functionName, 
-           pPerfStatisticRecords->time, pPerfStatisticRecords->callTimes);
+        fprintf(m_perfStatisticFile,  "%-40s %fms \t %d \t %fms \t %fms \t %fms \n", pPerfStatisticRecords->functionName, 
+           pPerfStatisticRecords->time, pPerfStatisticRecords->callTimes,
+           pPerfStatisticRecords->time / pPerfStatisticRecords->callTimes,
+           GetPercentile(pPerfStatisticRecords, 50), GetPercentile(pPerfStatisticRecords, 99));
 
         CmSafeRelease(pPerfStatisticRecords);
     }
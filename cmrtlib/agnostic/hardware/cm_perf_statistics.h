@@ -23,6 +23,7 @@
 #define CMRTLIB_AGNOSTIC_HARDWARE_CM_PERF_STATISTICS_H_
 
 #include <vector>
+#include <atomic>
 #include <cstdio>
 #include "cm_def_hw.h"
 #include "cm_include.h"
@@ -33,21 +34,48 @@
 #define MSG_STRING_SIZE 256
 #define INIT_ARRAY_ZIE  256
 
+#define CM_PERF_MAX_FUNCTION_NUM        256         // max number of distinct profiled functions
+#define CM_PERF_INVALID_FUNCTION_ID     0xFFFFFFFF
+#define CM_PERF_HISTOGRAM_SUB_BITS      2           // 4 sub-buckets per power of two, i.e. <= 25% error
+#define CM_PERF_HISTOGRAM_BUCKET_NUM    128         // covers durations up to 2^33 ns, longer ones go to the last bucket
+
 struct ApiPerfStatistic
 {
-    char  functionName[MSG_STRING_SIZE];       // function name
+    const char *functionName;                   // function name
     float time;                                 // accumulative api duration
     uint32_t callTimes;                           // called times
+    uint64_t histogram[CM_PERF_HISTOGRAM_BUCKET_NUM]; // call count per log-scale duration bucket
 };
 
 struct ApiCallRecord
 {
-    char  functionName[MSG_STRING_SIZE];       // function name
+    uint32_t       functionId;                  // function id returned by RegisterFunction()
     LARGE_INTEGER  startTime;                  // start time
     LARGE_INTEGER  endTime;                    // end time
     float          duration;                    // duration
 };
 
+//!
+//! Counters of one function in one thread. Only the owning thread writes them,
+//! so the updates are plain relaxed stores; the atomics only make the reads at
+//! dump time well defined.
+//!
+struct ApiPerfCounter
+{
+    std::atomic<uint32_t> callTimes;
+    std::atomic<uint64_t> timeNs;
+    std::atomic<uint32_t> histogram[CM_PERF_HISTOGRAM_BUCKET_NUM];
+};
+
+//!
+//! Per-thread profiling data, owned by CmPerfStatistics so that it outlives the thread.
+//!
+struct ApiPerfThreadData
+{
+    std::atomic<ApiPerfCounter*> counters[CM_PERF_MAX_FUNCTION_NUM];
+    std::vector<ApiCallRecord>   apiCallRecords;
+};
+
 enum PerfLogLevel
 {
     CM_RT_PERF_LOG_LEVEL_DEFAULT = 0 , // default level: only dump the statistics results when destorying cm device
@@ -62,10 +90,22 @@ public:
     ~CmPerfStatistics();
 
     //!
-    //! \brief    Insert API call record 
-    //! \details  Insert API call record which contains function name, start time, end and duration.
+    //! \brief    Register a profiled function
+    //! \details  Map a function name to the id used by InsertApiCallRecord().
+    //!           Called once per call site, the id is cached in a function local
+    //!           static by INSERT_PROFILER_RECORD(). Overloads share the same id.
     //! \param    [in] functionName
-    //!           pointer to function name's string
+    //!           pointer to function name's string, must have static storage
+    //! \retval   function id, or CM_PERF_INVALID_FUNCTION_ID if the table is full
+    //!
+    uint32_t RegisterFunction(const char *functionName);
+
+    //!
+    //! \brief    Insert API call record 
+    //! \details  Update the calling thread's counters and histogram of the function,
+    //!           and keep the call record if records are enabled. Takes no lock.
+    //! \param    [in] functionId
+    //!           function id returned by RegisterFunction()
     //! \param    [in] time
     //!           function's duration
     //! \param    [in] start
@@ -73,15 +113,7 @@ public:
     //! \param    [in] end
     //!           function's end time
     //!
-    void InsertApiCallRecord(char *functionName, float time, LARGE_INTEGER start, LARGE_INTEGER end);
-
-    //!
-    //! \brief    Insert API call record into performace statistic record
-    //! \details  Insert API call record into performace statistic record.
-    //! \param    [in] pRecords
-    //!           pointer to API call record
-    //!
-    void InsertPerfStatistic(ApiCallRecord *records);
+    void InsertApiCallRecord(uint32_t functionId, float time, LARGE_INTEGER start, LARGE_INTEGER end);
 
     //!
     //! \brief    Check if this profiler on or not
@@ -99,6 +131,45 @@ private:
     //!
     void GetProfilerLevel(); 
 
+    //!
+    //! \brief    Get the calling thread's profiling data
+    //! \details  Allocated and registered on the first call of each thread.
+    //! \retval   pointer to the thread's data, nullptr if out of memory
+    //!
+    ApiPerfThreadData *GetThreadData();
+
+    //!
+    //! \brief    Get the histogram bucket of a duration
+    //! \param    [in] timeNs
+    //!           duration in nanoseconds
+    //! \retval   bucket index
+    //!
+    static uint32_t GetHistogramBucket(uint64_t timeNs);
+
+    //!
+    //! \brief    Get the duration represented by a histogram bucket
+    //! \param    [in] bucket
+    //!           bucket index
+    //! \retval   middle of the bucket's range in milliseconds
+    //!
+    static float GetHistogramBucketTime(uint32_t bucket);
+
+    //!
+    //! \brief    Get a percentile from a histogram
+    //! \param    [in] statistic
+    //!           merged statistic of a function
+    //! \param    [in] percent
+    //!           percentile to get, 0 to 100
+    //! \retval   percentile in milliseconds
+    //!
+    static float GetPercentile(ApiPerfStatistic *statistic, uint32_t percent);
+
+    //!
+    //! \brief    Merge the per-thread counters into perf statistic records
+    //! \details  Sum the counters and histograms of all threads per function.
+    //!
+    void MergePerfStatistics();
+
     //!
     //! \brief    Dump API call records into file
     //! \details  Dump API call records into file, 
@@ -113,15 +184,18 @@ private:
     //!
     void DumpPerfStatisticRecords();
 
-    CSync           m_criticalSectionOnApiCallRecords;
-    uint32_t        m_apiCallRecordCount;
+    CSync           m_criticalSectionOnFunctions;
+    const char     *m_functionNames[CM_PERF_MAX_FUNCTION_NUM];
+    uint32_t        m_functionCount;
+
+    CSync           m_criticalSectionOnThreadData;
+    std::vector<ApiPerfThreadData*>  m_threadData;     // data of every thread that made a call
+
     FILE           *m_apiCallFile;
 
-    CSync           m_criticalSectionOnPerfStatisticRecords;
     FILE           *m_perfStatisticFile;
     uint32_t        m_perfStatisticCount;
 
-    std::vector<ApiCallRecord*>      m_apiCallRecords;  // array to store api call records 
     std::vector<ApiPerfStatistic*>   m_perfStatisticRecords; // array to store perf statistic information
 
     PerfLogLevel m_profilerLevel; // profiler level
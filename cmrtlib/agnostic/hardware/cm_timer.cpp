@@ -27,9 +27,9 @@
 #if MDF_PROFILER_ENABLED
 extern CmPerfStatistics gCmPerfStatistics;
 
-CmTimer::CmTimer(const char *functionName):
+CmTimer::CmTimer(uint32_t functionId):
     m_cycles(0),
-    m_funcName(const_cast<char*>(functionName))
+    m_functionId(functionId)
 {
     //Get frequency
     QueryPerformanceFrequency(&m_freq);
@@ -47,10 +47,15 @@ CmTimer::CmTimer(const char *functionName):
 CmTimer::~CmTimer()
 {
     Stop();
-    gCmPerfStatistics.InsertApiCallRecord(m_funcName, GetTimeinMs(), m_start,
+    gCmPerfStatistics.InsertApiCallRecord(m_functionId, GetTimeinMs(), m_start,
                                           m_end);
 }
 
+uint32_t CmTimer::RegisterFunction(const char *functionName)
+{
+    return gCmPerfStatistics.RegisterFunction(functionName);
+}
+
 void CmTimer::Start()
 {
     QueryPerformanceCounter(&m_start);  // recode API start time
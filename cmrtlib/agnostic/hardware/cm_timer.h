@@ -32,10 +32,20 @@
 class CmTimer
 {
 public:
-    CmTimer(const char *functionName);
+    CmTimer(uint32_t functionId);
 
     ~CmTimer();
 
+    //!
+    //! \brief    Register a profiled function
+    //! \details  Called once per call site by INSERT_PROFILER_RECORD(),
+    //!           the returned id is passed to every CmTimer of the site.
+    //! \param    [in] functionName
+    //!           function name, must have static storage
+    //! \retval   function id
+    //!
+    static uint32_t RegisterFunction(const char *functionName);
+
 private:
     void Start();
 
@@ -55,7 +65,7 @@ private:
 
     LARGE_INTEGER m_freq;
 
-    char *m_funcName;
+    uint32_t m_functionId;
 };
 
 #endif  // #if MDF_PROFILER_ENABLED
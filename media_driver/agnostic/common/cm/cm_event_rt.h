@@ -84,6 +84,8 @@ public:
 
     int32_t SetTaskOsData(void *data);
 
+    int32_t ReferenceTaskOsData(void *&data);
+
     int32_t SetSurfaceDetails(CM_HAL_SURFACE_ENTRY_INFO_ARRAYS SurfaceInfo);
 
     int32_t Acquire(void);
@@ -41,6 +41,8 @@ enum CPU_INSTRUCTION_LEVEL
     CPU_INSTRUCTION_LEVEL_SSE3,
     CPU_INSTRUCTION_LEVEL_SSE4,
     CPU_INSTRUCTION_LEVEL_SSE4_1,
+    CPU_INSTRUCTION_LEVEL_AVX2,
+    CPU_INSTRUCTION_LEVEL_AVX512,
     NUM_CPU_INSTRUCTION_LEVELS
 };
 
@@ -49,6 +51,9 @@ typedef uint32_t            PREFETCH[8];    //             32-bytes
 typedef uint32_t            CACHELINE[8];   //             32-bytes
 typedef uint16_t            DHWORD[32];     // 512-bits,   64-bytes
 
+// Copies at least this large bypass the cache with streaming stores,
+// smaller ones are likely to be read back soon
+#define CM_STREAMING_STORE_THRESHOLD    (256 * 1024)
 
 
 #define CmSafeDeleteArray(_ptr) {if(_ptr != nullptr) {delete[] (_ptr); (_ptr)=nullptr;}}
@@ -229,17 +234,18 @@ inline int CmSafeMemCompare( const void* dst, const void* src, const size_t byte
 
 /*****************************************************************************\
 Inline Function:
-    GetCpuInstructionLevel
+    DetectCpuInstructionLevel
 
 Description:
-    Returns the highest level of IA32 intruction extensions supported by the CPU
-    ( i.e. SSE, SSE2, SSE4, etc )
+    Queries the CPU for the highest level of IA32 intruction extensions supported
+    ( i.e. SSE, SSE2, SSE4, AVX2, etc ). AVX levels also require the OS to save
+    the corresponding register state.
 
 Output:
     CPU_INSTRUCTION_LEVEL - highest level of IA32 instruction extension(s) supported
     by CPU
 \*****************************************************************************/
-inline CPU_INSTRUCTION_LEVEL GetCpuInstructionLevel( void )
+inline CPU_INSTRUCTION_LEVEL DetectCpuInstructionLevel( void )
 {
     int CpuInfo[4];
     memset( CpuInfo, 0, 4*sizeof(int) );
@@ -250,6 +256,26 @@ inline CPU_INSTRUCTION_LEVEL GetCpuInstructionLevel( void )
     if( (CpuInfo[2] & BIT(19)) && TestSSE4_1() )
     {
         CpuInstructionLevel = CPU_INSTRUCTION_LEVEL_SSE4_1;
+
+        // OSXSAVE: XCR0 tells which register states the OS preserves
+        if( CpuInfo[2] & BIT(27) )
+        {
+            int      ExtCpuInfo[4];
+            uint64_t xcr0 = GetXCR0();
+            memset( ExtCpuInfo, 0, 4*sizeof(int) );
+
+            GetCPUIDEx(ExtCpuInfo, 7, 0);
+
+            // XMM | YMM state, plus opmask | ZMM_Hi256 | Hi16_ZMM for AVX-512
+            if( (ExtCpuInfo[1] & BIT(16)) && ( (xcr0 & 0xE6) == 0xE6 ) )
+            {
+                CpuInstructionLevel = CPU_INSTRUCTION_LEVEL_AVX512;
+            }
+            else if( (ExtCpuInfo[1] & BIT(5)) && ( (xcr0 & 0x6) == 0x6 ) )
+            {
+                CpuInstructionLevel = CPU_INSTRUCTION_LEVEL_AVX2;
+            }
+        }
     }
     else if( CpuInfo[2] & BIT(1) )
     {
@@ -271,6 +297,24 @@ inline CPU_INSTRUCTION_LEVEL GetCpuInstructionLevel( void )
     return CpuInstructionLevel;
 }
 
+/*****************************************************************************\
+Inline Function:
+    GetCpuInstructionLevel
+
+Description:
+    Returns the highest level of IA32 intruction extensions supported by the CPU.
+    CPUID is serializing, so the CPU is only queried on the first call.
+
+Output:
+    CPU_INSTRUCTION_LEVEL - highest level of IA32 instruction extension(s) supported
+    by CPU
+\*****************************************************************************/
+inline CPU_INSTRUCTION_LEVEL GetCpuInstructionLevel( void )
+{
+    static const CPU_INSTRUCTION_LEVEL CpuInstructionLevel = DetectCpuInstructionLevel();
+    return CpuInstructionLevel;
+}
+
 /*****************************************************************************\
 Inline Function:
     Round
@@ -636,6 +680,22 @@ Input:
 \*****************************************************************************/
 inline void CmFastMemCopy( void* dst, const   void* src, const size_t bytes )
 {
+    if( bytes >= sizeof(DHWORD) )
+    {
+        const CPU_INSTRUCTION_LEVEL cpuInstructionLevel = GetCpuInstructionLevel();
+        const bool streaming = ( bytes >= CM_STREAMING_STORE_THRESHOLD );
+
+        if( cpuInstructionLevel >= CPU_INSTRUCTION_LEVEL_AVX512 )
+        {
+            FastMemCopy_AVX512( dst, src, bytes, streaming );
+            return;
+        }
+        else if( cpuInstructionLevel >= CPU_INSTRUCTION_LEVEL_AVX2 )
+        {
+            FastMemCopy_AVX2( dst, src, bytes, streaming );
+            return;
+        }
+    }
 
     // Cache pointers to memory
     uint8_t *p_dst = (uint8_t*)dst;
@@ -678,6 +738,23 @@ bytes - number of bytes to copy
 \*****************************************************************************/
 inline void CmFastMemCopyWC( void* dst,   const void* src, const size_t bytes )
 {
+  if( bytes >= sizeof(DHWORD) )
+  {
+    const CPU_INSTRUCTION_LEVEL cpuInstructionLevel = GetCpuInstructionLevel();
+
+    // Write-combined memory is always written with streaming stores
+    if( cpuInstructionLevel >= CPU_INSTRUCTION_LEVEL_AVX512 )
+    {
+      FastMemCopy_AVX512( dst, src, bytes, true );
+      return;
+    }
+    else if( cpuInstructionLevel >= CPU_INSTRUCTION_LEVEL_AVX2 )
+    {
+      FastMemCopy_AVX2( dst, src, bytes, true );
+      return;
+    }
+  }
+
   // Cache pointers to memory
   uint8_t *p_dst = (uint8_t*)dst;
   uint8_t *p_src = (uint8_t*)src;
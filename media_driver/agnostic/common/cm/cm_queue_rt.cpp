@@ -113,7 +113,9 @@ CmQueueRT::CmQueueRT(CmDeviceRT *pDevice,
     m_pHalMaxValues(nullptr),
     m_CopyKrnParamArray(CM_INIT_GPUCOPY_KERNL_COUNT),
     m_CopyKrnParamArrayCount(0),
-    m_queueOption(QueueCreateOption)
+    m_queueOption(QueueCreateOption),
+    m_completionThreadActive(false),
+    m_completionThreadExit(false)
 {
 
 }
@@ -126,6 +128,8 @@ CmQueueRT::~CmQueueRT()
 {
     uint32_t EventReleaseTimes = 0;
 
+    StopCompletionThread();
+
     uint32_t EventArrayUsedSize = m_EventArray.GetMaxSize();
     for( uint32_t i = 0; i < EventArrayUsedSize; i ++ )
     {
@@ -201,6 +205,18 @@ int32_t CmQueueRT::Initialize()
         }
     }
 
+    // Retire flushed tasks on a background thread if requested
+    MOS_USER_FEATURE_VALUE_DATA UserFeatureData;
+    MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_MDF_COMPLETION_THREAD_ENABLE_ID,
+        &UserFeatureData);
+    if (UserFeatureData.u32Data)
+    {
+        hr = (CM_RETURN_CODE)StartCompletionThread();
+    }
+
 finish:
     return hr;
 }
@@ -2205,6 +2221,13 @@ int32_t CmQueueRT::CleanQueue( )
     {
         QueryFlushedTasks();
 
+        if( !m_FlushedTasks.IsEmpty() &&
+            WaitForOldestFlushedTask( CM_FLUSH_WAIT_MAX_MS ) == CM_FAILURE )
+        {
+            // Nothing to sleep on, avoid burning the CPU while the status catches up
+            MOS_Sleep( CM_FLUSH_WAIT_MIN_MS );
+        }
+
         LARGE_INTEGER current;
         MOS_QueryPerformanceCounter((uint64_t*)&current.QuadPart);
         if( current.QuadPart > timeout )
@@ -2782,6 +2805,130 @@ finish:
     return hr;
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Block until the flushed queue has room for one more task.
+//|             Sleeps on the oldest task's bo, or on the completion thread if
+//|             it is running. Waits are bounded and back off exponentially so
+//|             that a lost wake-up or a task without bo only costs a re-check.
+//| Returns:    None.
+//*-----------------------------------------------------------------------------
+void CmQueueRT::WaitForFlushedTaskSlot()
+{
+    const uint32_t maxTasks = m_pHalMaxValues->iMaxTasks;
+    uint32_t       waitMs   = CM_FLUSH_WAIT_MIN_MS;
+
+    QueryFlushedTasks();
+    while( (uint32_t)m_FlushedTasks.GetCount() >= maxTasks )
+    {
+        if( m_completionThreadActive )
+        {
+            std::unique_lock<std::mutex> lock( m_completionMutex );
+            m_completionDone.wait_for( lock, std::chrono::milliseconds( waitMs ),
+                [&] { return (uint32_t)m_FlushedTasks.GetCount() < maxTasks; } );
+        }
+        else
+        {
+            uint32_t countBefore = m_FlushedTasks.GetCount();
+            int32_t  result      = WaitForOldestFlushedTask( waitMs );
+
+            QueryFlushedTasks();
+            if( (uint32_t)m_FlushedTasks.GetCount() < countBefore )
+            {
+                break;
+            }
+
+            if( result != CM_EXCEED_MAX_TIMEOUT )
+            {
+                // No bo to block on, or the bo went idle before the task status did
+                MOS_Sleep( waitMs );
+            }
+        }
+
+        waitMs = MOS_MIN( waitMs * 2, CM_FLUSH_WAIT_MAX_MS );
+    }
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Start the thread retiring flushed tasks in the background
+//| Returns:    Result of the operation.
+//*-----------------------------------------------------------------------------
+int32_t CmQueueRT::StartCompletionThread()
+{
+    if( m_completionThreadActive )
+    {
+        return CM_SUCCESS;
+    }
+
+    m_completionThreadExit = false;
+    m_completionThread = std::thread( &CmQueueRT::CompletionThreadProc, this );
+    m_completionThreadActive = true;
+
+    return CM_SUCCESS;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Stop the completion thread and wait for it to exit
+//| Returns:    None.
+//*-----------------------------------------------------------------------------
+void CmQueueRT::StopCompletionThread()
+{
+    if( !m_completionThreadActive )
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_completionMutex );
+        m_completionThreadExit = true;
+        m_completionWork.notify_one();
+    }
+    m_completionThread.join();
+
+    m_completionThreadActive = false;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Completion thread body. Sleeps until tasks are flushed, then
+//|             blocks on the oldest one and retires it. Retiring completes the
+//|             task events, which fires their callbacks, and wakes producers
+//|             waiting for room in the flushed queue.
+//| Returns:    None.
+//*-----------------------------------------------------------------------------
+void CmQueueRT::CompletionThreadProc()
+{
+    uint32_t waitMs = CM_FLUSH_WAIT_MIN_MS;
+
+    std::unique_lock<std::mutex> lock( m_completionMutex );
+    while( !m_completionThreadExit )
+    {
+        if( m_FlushedTasks.IsEmpty() )
+        {
+            m_completionWork.wait( lock );
+            continue;
+        }
+
+        lock.unlock();
+
+        uint32_t countBefore = m_FlushedTasks.GetCount();
+        int32_t  result      = WaitForOldestFlushedTask( CM_FLUSH_WAIT_MAX_MS );
+        QueryFlushedTasks();
+        bool     retired     = ( (uint32_t)m_FlushedTasks.GetCount() < countBefore );
+
+        lock.lock();
+        if( retired )
+        {
+            waitMs = CM_FLUSH_WAIT_MIN_MS;
+            m_completionDone.notify_all();
+        }
+        else if( result != CM_EXCEED_MAX_TIMEOUT )
+        {
+            // No bo to block on, back off instead of spinning
+            m_completionWork.wait_for( lock, std::chrono::milliseconds( waitMs ) );
+            waitMs = MOS_MIN( waitMs * 2, CM_FLUSH_WAIT_MAX_MS );
+        }
+    }
+}
+
 //*-----------------------------------------------------------------------------
 //! Flush the queue, i.e. submit all tasks in the queue to execute according
 //! to their order in the the queue. The queue will be empty after flush,
@@ -2808,12 +2955,11 @@ int32_t CmQueueRT::FlushTaskWithoutSync( bool bIfFlushBlock )
         uint32_t flushedTaskCount = m_FlushedTasks.GetCount();
         if ( bIfFlushBlock )
         {
-            while( flushedTaskCount >= m_pHalMaxValues->iMaxTasks )
+            if( flushedTaskCount >= m_pHalMaxValues->iMaxTasks )
             {
                 // If the task count in flushed queue is no less than hw restrictiion,
-                // query the staus of flushed task queue. Remove any finished tasks from the queue
-                QueryFlushedTasks();
-                flushedTaskCount = m_FlushedTasks.GetCount();
+                // sleep until the GPU retires one of the flushed tasks
+                WaitForFlushedTaskSlot();
             }
         }
         else
@@ -2865,6 +3011,12 @@ int32_t CmQueueRT::FlushTaskWithoutSync( bool bIfFlushBlock )
         {
             m_FlushedTasks.Push( pTask );
             pTask->VtuneSetFlushTime(); // Record Flush Time
+
+            if( m_completionThreadActive )
+            {
+                std::lock_guard<std::mutex> lock( m_completionMutex );
+                m_completionWork.notify_one();
+            }
         }
         else
         {
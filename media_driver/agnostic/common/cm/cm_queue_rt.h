@@ -30,8 +30,15 @@
 #include "cm_queue.h"
 
 #include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "cm_array.h"
 
+// Bounds of the exponential backoff used while waiting for flushed tasks
+#define CM_FLUSH_WAIT_MIN_MS    1
+#define CM_FLUSH_WAIT_MAX_MS    64
+
 namespace CMRT_UMD
 {
 class CmDeviceRT;
@@ -83,6 +90,7 @@ public:
     CmTaskInternal *Top()
     {
         CmTaskInternal *element = nullptr;
+        mCriticalSection.Acquire();
         if (mQueue.empty())
         {
             CM_ASSERT(0);
@@ -91,12 +99,25 @@ public:
         {
             element = mQueue.front();
         }
+        mCriticalSection.Release();
         return element;
     }
 
-    bool IsEmpty() { return mQueue.empty(); }
+    bool IsEmpty()
+    {
+        mCriticalSection.Acquire();
+        bool empty = mQueue.empty();
+        mCriticalSection.Release();
+        return empty;
+    }
 
-    int GetCount() { return mQueue.size(); }
+    int GetCount()
+    {
+        mCriticalSection.Acquire();
+        int count = mQueue.size();
+        mCriticalSection.Release();
+        return count;
+    }
 
  private:
     std::queue<CmTaskInternal*> mQueue;
@@ -259,6 +280,16 @@ protected:
 
     int32_t QueryFlushedTasks();
 
+    int32_t WaitForOldestFlushedTask(uint32_t dwTimeOutMs);
+
+    void WaitForFlushedTaskSlot();
+
+    int32_t StartCompletionThread();
+
+    void StopCompletionThread();
+
+    void CompletionThreadProc();
+
     //New sub functions for different task flush
     int32_t FlushGeneralTask(CmTaskInternal *pTask);
 
@@ -320,6 +351,14 @@ protected:
 
     CM_HAL_MAX_VALUES *m_pHalMaxValues;
     CM_QUEUE_CREATE_OPTION m_queueOption;
+
+    // Optional background retirement of flushed tasks
+    std::thread m_completionThread;
+    std::mutex m_completionMutex;
+    std::condition_variable m_completionWork;   // Signaled when a task is flushed
+    std::condition_variable m_completionDone;   // Signaled when flushed tasks are retired
+    bool m_completionThreadActive;
+    bool m_completionThreadExit;
 };
 };  //namespace
 
@@ -97,6 +97,7 @@ int32_t CmSurfaceManager:: UpdateStateForReuseDestroy(SURFACE_DESTROY_KIND destr
                   !m_surfaceCached[index])
             {
                 m_surfaceCached[index] = true;
+                AddSurfaceToReuseIndex(index);
             }
             return CM_SURFACE_CACHED;
 
@@ -118,11 +119,18 @@ int32_t CmSurfaceManager:: UpdateStateForReuseDestroy(SURFACE_DESTROY_KIND destr
 
 int32_t CmSurfaceManager::UpdateStateForRealDestroy(uint32_t index, CM_ENUM_CLASS_TYPE surfaceType)
 {
+    RemoveSurfaceFromReuseIndex(index);
+
     m_surfaceReleased[index] = false;
     m_surfaceCached[index] = false;
     m_surfaceArray[index] = nullptr;
     m_surfaceDestroyId[index] ++;
     m_surfaceSizes[index] = 0;
+
+    if (m_freeSurfaceIndexCount < m_surfaceArraySize)
+    {
+        m_freeSurfaceIndices[m_freeSurfaceIndexCount++] = index;
+    }
     
     switch (surfaceType)
     {
@@ -152,12 +160,78 @@ int32_t CmSurfaceManager::UpdateStateForRealDestroy(uint32_t index, CM_ENUM_CLAS
 
 int32_t CmSurfaceManager::UpdateStateForSurfaceReuse(uint32_t index)
 {
+    RemoveSurfaceFromReuseIndex(index);
+
     m_surfaceCached[index] = false;
     m_surfaceReleased[index] = false;
 
     return CM_SUCCESS;
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Add a cached surface to the reuse index
+//| Arguments :
+//|               index         [in]       Index of the surface in surface array
+//|
+//| Returns:    None
+//*-----------------------------------------------------------------------------
+void CmSurfaceManager::AddSurfaceToReuseIndex(uint32_t index)
+{
+    CM_SURFACE_REUSE_KEY &key = m_surfaceReuseKeys[index];
+    CmSurface *pSurface = m_surfaceArray[index];
+
+    if (!pSurface || key.index)
+    {
+        return;
+    }
+
+    key.type = pSurface->Type();
+    key.depth = 0;
+    key.sizePerPixel = 0;
+
+    // Sizes follow the best-fit metric of GetReuseSurfaceIndex
+    switch (key.type)
+    {
+    case CM_ENUM_CLASS_TYPE_CMSURFACE3D:
+        static_cast< CmSurface3DRT* >( pSurface )->GetProperties(key.width, key.height, key.depth, key.format);
+        key.size = key.width * key.height * key.depth;
+        break;
+    case CM_ENUM_CLASS_TYPE_CMSURFACE2D:
+        static_cast< CmSurface2DRT* >( pSurface )->GetSurfaceDesc(key.width, key.height, key.format, key.sizePerPixel);
+        key.size = key.width * key.height * key.sizePerPixel;
+        break;
+    case CM_ENUM_CLASS_TYPE_CMBUFFER_RT:
+        static_cast< CmBuffer_RT* >( pSurface )->GetSize(key.width);
+        key.height = 0;
+        key.format = CM_SURFACE_FORMAT_INVALID;
+        key.size = key.width;
+        break;
+    default:
+        return;
+    }
+
+    key.index = index;
+    m_surfaceReuseIndex.insert(key);
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Remove a surface from the reuse index if it is there
+//| Arguments :
+//|               index         [in]       Index of the surface in surface array
+//|
+//| Returns:    None
+//*-----------------------------------------------------------------------------
+void CmSurfaceManager::RemoveSurfaceFromReuseIndex(uint32_t index)
+{
+    CM_SURFACE_REUSE_KEY &key = m_surfaceReuseKeys[index];
+
+    if (key.index)
+    {
+        m_surfaceReuseIndex.erase(key);
+        key.index = 0;
+    }
+}
+
 int32_t CmSurfaceManager::UpdateProfileFor2DSurface(uint32_t index, uint32_t width, uint32_t height, CM_SURFACE_FORMAT format, bool reuse)
 {
     uint32_t size = 0;
@@ -298,6 +372,9 @@ CmSurfaceManager::CmSurfaceManager( CmDeviceRT* device):
     m_surfaceReleased(nullptr),
     m_surfaceDestroyId(nullptr),
     m_surfaceSizes(nullptr),
+    m_surfaceReuseKeys(nullptr),
+    m_freeSurfaceIndices(nullptr),
+    m_freeSurfaceIndexCount(0),
     m_maxBufferCount(0),
     m_bufferCount(0),
     m_max2DSurfaceCount(0),
@@ -360,6 +437,8 @@ CmSurfaceManager::~CmSurfaceManager()
     MosSafeDeleteArray(m_surfaceReleased);
     MosSafeDeleteArray(m_surfaceDestroyId);
     MosSafeDeleteArray(m_surfaceSizes);
+    MosSafeDeleteArray(m_surfaceReuseKeys);
+    MosSafeDeleteArray(m_freeSurfaceIndices);
     MosSafeDeleteArray(m_surfaceArray);
 }
 
@@ -495,19 +574,25 @@ int32_t CmSurfaceManager::Initialize( CM_HAL_MAX_VALUES halMaxValues, CM_HAL_MAX
     m_surfaceReleased   = MOS_NewArray(bool, m_surfaceArraySize);
     m_surfaceDestroyId  = MOS_NewArray(int32_t, m_surfaceArraySize);
     m_surfaceSizes      = MOS_NewArray(int32_t, m_surfaceArraySize);
+    m_surfaceReuseKeys  = MOS_NewArray(CM_SURFACE_REUSE_KEY, m_surfaceArraySize);
+    m_freeSurfaceIndices = MOS_NewArray(uint32_t, m_surfaceArraySize);
 
     if( m_surfaceArray == nullptr ||
         m_surfaceStates == nullptr ||
         m_surfaceCached == nullptr ||
         m_surfaceReleased == nullptr ||
         m_surfaceDestroyId == nullptr ||
-        m_surfaceSizes == nullptr)
+        m_surfaceSizes == nullptr ||
+        m_surfaceReuseKeys == nullptr ||
+        m_freeSurfaceIndices == nullptr)
     {
         MosSafeDeleteArray(m_surfaceStates);
         MosSafeDeleteArray(m_surfaceCached);
         MosSafeDeleteArray(m_surfaceReleased);
         MosSafeDeleteArray(m_surfaceDestroyId);
         MosSafeDeleteArray(m_surfaceSizes);
+        MosSafeDeleteArray(m_surfaceReuseKeys);
+        MosSafeDeleteArray(m_freeSurfaceIndices);
         MosSafeDeleteArray(m_surfaceArray);
 
         CM_ASSERTMESSAGE("Error: Out of system memory.");
@@ -520,6 +605,8 @@ int32_t CmSurfaceManager::Initialize( CM_HAL_MAX_VALUES halMaxValues, CM_HAL_MAX
     CmSafeMemSet( m_surfaceReleased, 0, m_surfaceArraySize * sizeof( bool ) );
     CmSafeMemSet( m_surfaceDestroyId, 0, m_surfaceArraySize * sizeof( int32_t ) );
     CmSafeMemSet( m_surfaceSizes, 0, m_surfaceArraySize * sizeof( int32_t ) );
+    CmSafeMemSet( m_surfaceReuseKeys, 0, m_surfaceArraySize * sizeof( CM_SURFACE_REUSE_KEY ) );
+    m_freeSurfaceIndexCount = 0; // filled from the surface array on first use
     return CM_SUCCESS;
 }
 
@@ -643,20 +730,35 @@ int32_t CmSurfaceManager::TouchSurfaceInPoolForDestroy()
 
 int32_t CmSurfaceManager::GetFreeSurfaceIndexFromPool(uint32_t &freeIndex)
 {
-    uint32_t index = ValidSurfaceIndexStart();
+    // Elements freed by real destroy are pushed onto the free stack. An element
+    // handed out but never filled drops out of it, so the stack is rebuilt
+    // from the surface array once it runs dry.
+    while( m_freeSurfaceIndexCount > 0 )
+    {
+        uint32_t index = m_freeSurfaceIndices[ --m_freeSurfaceIndexCount ];
+        if( !m_surfaceArray[ index ] )
+        {
+            freeIndex = index;
+            return CM_SUCCESS;
+        }
+    }
 
-    while( ( index < m_surfaceArraySize ) && m_surfaceArray[ index ] )
+    // Push in descending order so the lowest free index is handed out first
+    for( uint32_t index = m_surfaceArraySize; index > ValidSurfaceIndexStart(); index -- )
     {
-        index ++;
+        if( !m_surfaceArray[ index - 1 ] )
+        {
+            m_freeSurfaceIndices[ m_freeSurfaceIndexCount++ ] = index - 1;
+        }
     }
 
-    if( index >= m_surfaceArraySize )
+    if( m_freeSurfaceIndexCount == 0 )
     {
         CM_ASSERTMESSAGE("Error: Invalid surface index.");
         return CM_FAILURE;
     }
 
-    freeIndex = index;
+    freeIndex = m_freeSurfaceIndices[ --m_freeSurfaceIndexCount ];
 
     return CM_SUCCESS;
 }
@@ -793,127 +895,56 @@ inline int32_t CmSurfaceManager::GetMemorySizeOfSurfaces()
 #define REUSE_SIZE_FACTOR 1.5
 int32_t CmSurfaceManager:: GetReuseSurfaceIndex(uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT format)
 {
-    uint32_t index = ValidSurfaceIndexStart();
-    uint32_t s_width = 0;
-    uint32_t s_height = 0;
-    uint32_t s_depth = 0;
-    CM_SURFACE_FORMAT s_format;
-    uint32_t minSize = 0;
-    uint32_t t_index = 0;
-    uint32_t s_sizeperpixel = 0;
+    CM_SURFACE_REUSE_KEY key;
+    CmSafeMemSet( &key, 0, sizeof( key ) );
 
-    while( index < m_surfaceArraySize )
+    if (depth)
     {
-        if (!m_surfaceArray[index])
-        {
-            index ++;
-            continue;
-        }
-    
-        if (m_surfaceCached[index])
-        {
-            CmSurface* pSurface  = m_surfaceArray[index];
-            if (depth) 
-            {
-                CmSurface3DRT* pSurf3D = nullptr;
-                if (pSurface && ( pSurface->Type() == CM_ENUM_CLASS_TYPE_CMSURFACE3D ))
-                {
-                    pSurf3D = static_cast< CmSurface3DRT* >( pSurface );
-                }
-
-                if (!pSurf3D)
-                {
-                    index++;
-                    continue;
-                }
-                pSurf3D->GetProperties(s_width, s_height, s_depth, s_format);
-                if (width <= s_width &&
-                      height <= s_height &&
-                      depth <= s_depth &&
-                      s_format == format)
-                {
-                    uint32_t t_size;
-                    t_size = s_width * s_height * s_depth;
-                    if (!minSize || minSize > t_size) //To find out the smallest one
-                    {
-                        minSize = t_size;
-                        t_index = index;
-                    }
-                }
-            }
-            else if (width && height)
-            {
-                CmSurface2DRT* pSurf2D = nullptr;
-                if (pSurface && ( pSurface->Type() == CM_ENUM_CLASS_TYPE_CMSURFACE2D ))
-                {
-                    pSurf2D = static_cast< CmSurface2DRT* >( pSurface );
-                }
-
-                if (!pSurf2D)
-                {
-                    index++;
-                    continue;
-                }
-                pSurf2D->GetSurfaceDesc(s_width, s_height, s_format, s_sizeperpixel);
-                if (width <= s_width &&
-                     height <= s_height &&
-                     s_format == format &&
-                     (width * s_sizeperpixel % 4 == 0))
-                {
-                     uint32_t t_size;
-                     t_size = s_width * s_height * s_sizeperpixel;
-                     if (!minSize || minSize > t_size)
-                     {
-                         minSize = t_size;
-                         t_index = index;
-                     }
-                }
-            }
-            else if (width && !height)
-            {
-                CmBuffer_RT* pBuffer = nullptr;
-                if (pSurface && ( pSurface->Type() == CM_ENUM_CLASS_TYPE_CMBUFFER_RT ))
-                {
-                    pBuffer = static_cast< CmBuffer_RT* >( pSurface );
-                }
-
-                if (!pBuffer)
-                {
-                    index++;
-                    continue;
-                }
-                pBuffer->GetSize(s_width);
-                if (width <= s_width)
-                {
-                    if (!minSize || minSize > s_width) //To find out the smallest one
-                    {
-                        minSize = s_width;
-                        t_index = index;
-                    }
-                }
-            }
-        }
-
-        index++;
+        key.type = CM_ENUM_CLASS_TYPE_CMSURFACE3D;
+        key.format = format;
+        key.size = width * height * depth;
+    }
+    else if (width && height)
+    {
+        // Size per pixel is at least 1, so this bounds every fitting surface
+        key.type = CM_ENUM_CLASS_TYPE_CMSURFACE2D;
+        key.format = format;
+        key.size = width * height;
+    }
+    else if (width)
+    {
+        key.type = CM_ENUM_CLASS_TYPE_CMBUFFER_RT;
+        key.format = CM_SURFACE_FORMAT_INVALID;
+        key.size = width;
+    }
+    else
+    {
+        return 0;
     }
 
-    if (t_index) //Reuse existing
+    // Candidates are visited in ascending size, so the first one that fits is
+    // the smallest. Once sizes reach the reuse limit nothing further qualifies.
+    double sizeLimit = width * (height == 0 ? 1: height) * (depth == 0 ? 1 : depth) * REUSE_SIZE_FACTOR;
+
+    for (std::set<CM_SURFACE_REUSE_KEY>::const_iterator it = m_surfaceReuseIndex.lower_bound(key);
+         it != m_surfaceReuseIndex.end() && it->type == key.type && it->format == key.format;
+         ++it)
     {
-        if (minSize >= width * (height == 0 ? 1: height) * (depth == 0 ? 1 : depth) * REUSE_SIZE_FACTOR)
+        if (it->size >= sizeLimit)
         {
-            index = 0;
+            break;
         }
-        else
+
+        if (width <= it->width &&
+            height <= it->height &&
+            depth <= it->depth &&
+            (key.type != CM_ENUM_CLASS_TYPE_CMSURFACE2D || (width * it->sizePerPixel % 4 == 0)))
         {
-            index = t_index;
+            return it->index;
         }
     }
-    else
-    {
-        index = 0;
-    }
 
-    return index;
+    return 0;
 }
 
 int32_t CmSurfaceManager:: GetSurface2DInPool(uint32_t width, uint32_t height, CM_SURFACE_FORMAT format, CmSurface2DRT* &surface2d)
@@ -34,6 +34,202 @@
 #include <sstream>
 #include <iomanip>
 
+CodechalDebugDumpWriter::CodechalDebugDumpWriter(Mode mode, uint32_t stagingSize) :
+    m_mode(mode),
+    m_stagingSize(stagingSize)
+{
+    m_worker = std::thread(&CodechalDebugDumpWriter::WorkerThread, this);
+}
+
+CodechalDebugDumpWriter::~CodechalDebugDumpWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+    }
+    m_jobQueued.notify_one();
+
+    // Worker drains the queue before exiting
+    if (m_worker.joinable())
+    {
+        m_worker.join();
+    }
+
+    if (m_droppedCount)
+    {
+        CODECHAL_DEBUG_NORMALMESSAGE("%d dumps were dropped because the staging memory was full", m_droppedCount);
+    }
+}
+
+MOS_STATUS CodechalDebugDumpWriter::Write(
+    const std::string &fileName,
+    Format             format,
+    const uint8_t *    data,
+    uint32_t           width,
+    uint32_t           height,
+    uint32_t           pitch,
+    bool               append)
+{
+    CODECHAL_DEBUG_CHK_NULL(data);
+
+    uint32_t size = width * height;
+    if (size == 0)
+    {
+        return MOS_STATUS_UNKNOWN;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Parts appended to a dropped dump are dropped as well
+    if (append && fileName == m_droppedFile)
+    {
+        m_droppedCount++;
+        return MOS_STATUS_SUCCESS;
+    }
+
+    // A dump larger than the staging memory is only accepted when nothing else is queued
+    if (m_pendingSize && m_pendingSize + size > m_stagingSize)
+    {
+        // Never drop the remaining parts of a dump already queued, the file would be incomplete
+        if (m_mode == modeAsyncDrop && !append)
+        {
+            m_droppedFile = fileName;
+            m_droppedCount++;
+            return MOS_STATUS_SUCCESS;
+        }
+        m_jobDone.wait(lock, [&] { return m_pendingSize == 0 || m_pendingSize + size <= m_stagingSize; });
+    }
+    if (!append)
+    {
+        m_droppedFile.clear();
+    }
+
+    DumpJob job;
+    job.fileName = fileName;
+    job.format   = format;
+    job.append   = append;
+    job.size     = size;
+    if (!m_freeBuffers.empty())
+    {
+        job.data.swap(m_freeBuffers.back());
+        m_freeBuffers.pop_back();
+    }
+    m_pendingSize += size;
+    lock.unlock();
+
+    // Copy rows tightly packed, padded to a whole dword for the hex formatter
+    job.data.resize(MOS_ALIGN_CEIL(size, sizeof(uint32_t)));
+    uint8_t *dst = job.data.data();
+    for (uint32_t h = 0; h < height; h++)
+    {
+        MOS_SecureMemcpy(dst, width, data, width);
+        dst  += width;
+        data += pitch;
+    }
+    memset(dst, 0, job.data.size() - size);
+
+    lock.lock();
+    m_jobs.push_back(std::move(job));
+    lock.unlock();
+    m_jobQueued.notify_one();
+
+    return MOS_STATUS_SUCCESS;
+}
+
+void CodechalDebugDumpWriter::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_jobQueued.wait(lock, [&] { return m_exit || !m_jobs.empty(); });
+        if (m_jobs.empty())
+        {
+            break;
+        }
+
+        DumpJob job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        lock.unlock();
+
+        std::ios_base::openmode openMode = std::ios_base::out;
+        if (job.format == formatBinary)
+        {
+            openMode |= std::ios_base::binary;
+        }
+        if (job.append)
+        {
+            openMode |= std::ios_base::app;
+        }
+
+        std::ofstream ofs(job.fileName, openMode);
+        if (ofs.fail())
+        {
+            CODECHAL_DEBUG_ASSERTMESSAGE("Failed to open dump file %s", job.fileName.c_str());
+        }
+        else if (job.format == formatBinary)
+        {
+            WriteBinary(ofs, job.data.data(), job.size, 1, job.size);
+        }
+        else
+        {
+            WriteHexDwords(ofs, job.data.data(), job.size);
+        }
+        ofs.close();
+
+        lock.lock();
+        m_pendingSize -= job.size;
+        if (m_freeBuffers.size() < 4)
+        {
+            m_freeBuffers.push_back(std::move(job.data));
+        }
+        m_jobDone.notify_all();
+    }
+}
+
+MOS_STATUS CodechalDebugDumpWriter::WriteBinary(
+    std::ostream &  ofs,
+    const uint8_t * data,
+    uint32_t        width,
+    uint32_t        height,
+    uint32_t        pitch)
+{
+    for (uint32_t h = 0; h < height; h++)
+    {
+        ofs.write((const char *)data, width);
+        data += pitch;
+    }
+
+    return MOS_STATUS_SUCCESS;
+}
+
+MOS_STATUS CodechalDebugDumpWriter::WriteHexDwords(
+    std::ostream &  ofs,
+    const uint8_t * data,
+    uint32_t        size)
+{
+    uint32_t dwordSize  = size / sizeof(uint32_t);
+    uint32_t remainSize = size % sizeof(uint32_t);
+
+    const uint32_t *dwordData = (const uint32_t *)data;
+    uint32_t        i;
+    for (i = 0; i < dwordSize; i++)
+    {
+        ofs << std::hex << std::setw(8) << std::setfill('0') << +dwordData[i] << " ";
+        if (i % 4 == 3)
+        {
+            ofs << std::endl;
+        }
+    }
+
+    if (remainSize > 0)
+    {
+        uint32_t lastWord = dwordData[i] & (0xFFFFFFFF << ((8 - remainSize * 2) * 4));
+        ofs << std::hex << std::setw(8) << std::setfill('0') << +lastWord << std::endl;
+    }
+
+    return MOS_STATUS_SUCCESS;
+}
+
 CodechalDebugInterface::CodechalDebugInterface()
 {
     memset(&CurrPic, 0, sizeof(CODEC_PICTURE));
@@ -43,6 +239,11 @@ CodechalDebugInterface::CodechalDebugInterface()
 }
 CodechalDebugInterface::~CodechalDebugInterface()
 {
+    if (nullptr != m_dumpWriter)
+    {
+        MOS_Delete(m_dumpWriter);
+    }
+
     if (nullptr != m_configMgr)
     {
         MOS_Delete(m_configMgr);
@@ -89,6 +290,28 @@ MOS_STATUS CodechalDebugInterface::Initialize(
     {
         m_outputFilePath = MOS_DEBUG_DEFAULT_OUTPUT_LOCATION;
     }
+
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_CODECHAL_DEBUG_ASYNC_DUMP_ID,
+        &userFeatureData);
+    uint32_t asyncMode = userFeatureData.u32Data;
+
+    if (asyncMode == CodechalDebugDumpWriter::modeAsyncWait ||
+        asyncMode == CodechalDebugDumpWriter::modeAsyncDrop)
+    {
+        MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+        MOS_UserFeature_ReadValue_ID(
+            nullptr,
+            __MEDIA_USER_FEATURE_VALUE_CODECHAL_DEBUG_ASYNC_DUMP_STAGING_SIZE_ID,
+            &userFeatureData);
+        uint32_t stagingSize = MOS_MIN(MOS_MAX(userFeatureData.u32Data, 1), 2048) << 20;
+
+        m_dumpWriter = MOS_New(CodechalDebugDumpWriter, (CodechalDebugDumpWriter::Mode)asyncMode, stagingSize);
+        CODECHAL_DEBUG_CHK_NULL(m_dumpWriter);
+    }
+
     CodecFunction = codecFunction;
     m_configMgr = MOS_New(CodechalDebugConfigMgr, this, codecFunction, m_outputFilePath);
     CODECHAL_DEBUG_CHK_NULL(m_configMgr);
@@ -456,17 +679,23 @@ MOS_STATUS CodechalDebugInterface::DumpYUVSurface(
 
     const char *filePath = CreateFileName(funcName, bufName.c_str(), CodechalDbgExtType::yuv);
 
-    std::ofstream ofs(filePath, std::ios_base::out | std::ios_base::binary);
-    if (ofs.fail())
+    std::ofstream ofs;
+    if (m_dumpWriter)
     {
-        return MOS_STATUS_UNKNOWN;
+        // write luma data to staging memory, the file is written by the dump writer thread
+        m_dumpWriter->Write(filePath, CodechalDebugDumpWriter::formatBinary, data, width, height, pitch);
     }
-
-    // write luma data to file
-    for (uint32_t h = 0; h < height; h++)
+    else
     {
-        ofs.write((char* )data, width);
-        data += pitch;
+        ofs.open(filePath, std::ios_base::out | std::ios_base::binary);
+        if (ofs.fail())
+        {
+            pOsInterface->pfnUnlockResource(pOsInterface, &surface->OsResource);
+            return MOS_STATUS_UNKNOWN;
+        }
+
+        // write luma data to file
+        CodechalDebugDumpWriter::WriteBinary(ofs, data, width, height, pitch);
     }
 
     switch (surface->Format)
@@ -496,13 +725,18 @@ MOS_STATUS CodechalDebugInterface::DumpYUVSurface(
     data = surfBaseAddr + surface->UPlaneOffset.iLockSurfaceOffset;
 
     // write chroma data to file
-    for (uint32_t h = 0; h < height; h++)
+    if (m_dumpWriter)
     {
-        ofs.write((char*)data, width);
-        data += pitch;
+        if (height > 0)
+        {
+            m_dumpWriter->Write(filePath, CodechalDebugDumpWriter::formatBinary, data, width, height, pitch, true);
+        }
+    }
+    else
+    {
+        CodechalDebugDumpWriter::WriteBinary(ofs, data, width, height, pitch);
+        ofs.close();
     }
-
-    ofs.close();
 
     if (surfBaseAddr)
     {
@@ -1070,6 +1304,11 @@ MOS_STATUS CodechalDebugInterface::DumpBufferInBinary(uint8_t *data, uint32_t si
         return MOS_STATUS_UNKNOWN;
     }
 
+    if (m_dumpWriter)
+    {
+        return m_dumpWriter->Write(filePath, CodechalDebugDumpWriter::formatBinary, data, size, 1, size);
+    }
+
     std::ofstream ofs(filePath, std::ios_base::out | std::ios_base::binary);
     if (ofs.fail())
     {
@@ -1096,17 +1335,18 @@ MOS_STATUS CodechalDebugInterface::Dump2DBufferInBinary(
         return MOS_STATUS_UNKNOWN;
     }
 
+    if (m_dumpWriter)
+    {
+        return m_dumpWriter->Write(filePath, CodechalDebugDumpWriter::formatBinary, data, width, height, pitch);
+    }
+
     std::ofstream ofs(filePath, std::ios_base::out | std::ios_base::binary);
     if (ofs.fail())
     {
         return MOS_STATUS_UNKNOWN;
     }
 
-    for (uint32_t h = 0; h < height; h++)
-    {
-        ofs.write((char*)data, width);
-        data += pitch;
-    }
+    CodechalDebugDumpWriter::WriteBinary(ofs, data, width, height, pitch);
 
     ofs.close();
     return MOS_STATUS_SUCCESS;
@@ -1123,32 +1363,19 @@ MOS_STATUS CodechalDebugInterface::DumpBufferInHexDwords(uint8_t *data, uint32_t
         return MOS_STATUS_UNKNOWN;
     }
 
-    std::ofstream ofs(filePath);
-
-    if (ofs.fail())
+    if (m_dumpWriter)
     {
-        return MOS_STATUS_UNKNOWN;
+        return m_dumpWriter->Write(filePath, CodechalDebugDumpWriter::formatHexDwords, data, size, 1, size);
     }
 
-    uint32_t dwordSize  = size / sizeof(uint32_t);
-    uint32_t remainSize = size % sizeof(uint32_t);
+    std::ofstream ofs(filePath);
 
-    uint32_t *dwordData = (uint32_t *)data;
-    uint32_t  i;
-    for (i = 0; i < dwordSize; i++)
+    if (ofs.fail())
     {
-        ofs << std::hex << std::setw(8) << std::setfill('0') << +dwordData[i] << " ";
-        if (i % 4 == 3)
-        {
-            ofs << std::endl;
-        }
+        return MOS_STATUS_UNKNOWN;
     }
 
-    if (remainSize > 0)
-    {
-        uint32_t lastWord = dwordData[i] & (0xFFFFFFFF << ((8 - remainSize * 2) * 4));
-        ofs << std::hex << std::setw(8) << std::setfill('0') << +lastWord << std::endl;
-    }
+    CodechalDebugDumpWriter::WriteHexDwords(ofs, data, size);
 
     ofs.close();
 
@@ -47,6 +47,11 @@
 #include "codechal_debug_config_manager.h"
 #include <sstream>
 #include <fstream>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #define CODECHAL_DEBUG_TOOL(expr)   expr;
 
@@ -166,6 +171,84 @@ typedef struct _CODECHAL_ME_OUTPUT_PARAMS
     bool                            bVdencStreamInInUse;
 } CODECHAL_ME_OUTPUT_PARAMS, *PCODECHAL_ME_OUTPUT_PARAMS;
 
+//!
+//! \brief    Asynchronous dump writer
+//! \details  Dump data is copied into bounded staging memory on the calling thread, formatting
+//!           and file I/O are done by a worker thread in submission order. When the staging
+//!           memory is exhausted the caller either waits for the worker or the dump is dropped.
+//!
+class CodechalDebugDumpWriter
+{
+public:
+    enum Mode
+    {
+        modeSync      = 0,  //!< Dumps are written by the calling thread
+        modeAsyncWait = 1,  //!< Asynchronous, caller waits for staging memory when full
+        modeAsyncDrop = 2   //!< Asynchronous, dump is dropped when staging memory is full
+    };
+
+    enum Format
+    {
+        formatBinary,
+        formatHexDwords
+    };
+
+    CodechalDebugDumpWriter(Mode mode, uint32_t stagingSize);
+    ~CodechalDebugDumpWriter();
+
+    //!
+    //! \brief    Queues a dump of height rows of width bytes, pitch bytes apart
+    //! \param    [in] append
+    //!           Append to the file instead of creating it (dumps written in several parts)
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if the dump was queued or dropped
+    //!
+    MOS_STATUS Write(
+        const std::string &fileName,
+        Format             format,
+        const uint8_t *    data,
+        uint32_t           width,
+        uint32_t           height,
+        uint32_t           pitch,
+        bool               append = false);
+
+    static MOS_STATUS WriteBinary(
+        std::ostream &  ofs,
+        const uint8_t * data,
+        uint32_t        width,
+        uint32_t        height,
+        uint32_t        pitch);
+
+    static MOS_STATUS WriteHexDwords(
+        std::ostream &  ofs,
+        const uint8_t * data,
+        uint32_t        size);
+
+protected:
+    struct DumpJob
+    {
+        std::string          fileName;
+        Format               format;
+        bool                 append;
+        uint32_t             size;
+        std::vector<uint8_t> data;
+    };
+
+    void WorkerThread();
+
+    Mode                    m_mode;
+    uint32_t                m_stagingSize;
+    uint32_t                m_pendingSize = 0;      //!< Staging memory held by queued dumps
+    uint32_t                m_droppedCount = 0;
+    std::string             m_droppedFile;          //!< Last dump dropped, its appended parts are dropped too
+    bool                    m_exit = false;
+    std::deque<DumpJob>     m_jobs;
+    std::vector<std::vector<uint8_t>> m_freeBuffers; //!< Staging buffers for reuse
+    std::mutex              m_mutex;
+    std::condition_variable m_jobQueued;
+    std::condition_variable m_jobDone;
+    std::thread             m_worker;
+};
 
 class CodechalDebugInterface
 {
@@ -302,7 +385,8 @@ protected:
         uint32_t    height,
         uint32_t    pitch);
 
-    CodechalDebugConfigMgr *m_configMgr = nullptr;
+    CodechalDebugConfigMgr  *m_configMgr = nullptr;
+    CodechalDebugDumpWriter *m_dumpWriter = nullptr;   //!< Asynchronous dump writer, nullptr for synchronous dumps
     std::string             m_outputFilePath;
 };
 #else
@@ -128,9 +128,9 @@ MOS_STATUS CodechalDecodeVc1::GetBits(uint32_t bitsRead, uint32_t &value)
     return MOS_STATUS_SUCCESS;
 }
 
-MOS_STATUS CodechalDecodeVc1::GetVLC(const uint32_t* table, uint32_t &value)
+MOS_STATUS CodechalDecodeVc1::GetVLC(const CODECHAL_DECODE_VC1_VLC_LUT &lut, uint32_t &value)
 {
-    value = GetVLC(table);
+    value = GetVLC(lut);
     if (CODECHAL_DECODE_VC1_EOS == value)
     {
         return MOS_STATUS_UNKNOWN;
@@ -140,9 +140,10 @@ MOS_STATUS CodechalDecodeVc1::GetVLC(const uint32_t* table, uint32_t &value)
 
 MOS_STATUS CodechalDecodeVc1::SkipWords(uint32_t dwordNumber, uint32_t &value)
 {
-    for (uint32_t i = 0; i < dwordNumber; i++)
+    // two words per call, the bit reader takes up to 32 bits
+    for (uint32_t i = 0; i < dwordNumber; i += 2)
     {
-        value = SkipBits(16);
+        value = SkipBits((dwordNumber - i >= 2) ? 32 : 16);
         if (CODECHAL_DECODE_VC1_EOS == value)
         {
             return MOS_STATUS_UNKNOWN;
@@ -165,12 +166,6 @@ MOS_STATUS CodechalDecodeVc1::SkipBits(uint32_t bits, uint32_t &value)
     return MOS_STATUS_SUCCESS;
 }
 
-typedef union _CODECHAL_DECODE_VC1_BITSTREAM_BUFFER_VALUE
-{
-    uint32_t u32Value;
-    uint8_t  u8Value[sizeof(uint32_t)];
-} CODECHAL_DECODE_VC1_BITSTREAM_VALUE, *PCODECHAL_DECODE_VC1_BITSTREAM_VALUE;
-
 typedef enum _CODECHAL_DECODE_VC1_MVMODE
 {
     CODECHAL_VC1_MVMODE_1MV_HALFPEL_BILINEAR,
@@ -390,6 +385,82 @@ static const uint32_t CODECHAL_DECODE_VC1_VldRefDistTable[] =
     (uint32_t)-1
 };
 
+// NORM2/DIFF2 code length indexed by the next 3 bits: 0 (1 bit), 100 and 101 (3 bits), 11 (2 bits)
+static const uint8_t CODECHAL_DECODE_VC1_Norm2CodeLength[8] =
+{
+    1, 1, 1, 1, 3, 3, 2, 2
+};
+
+// Expand a VLC code table above into a lookup table indexed by the next maxBits bits.
+// Codes up to CODECHAL_DECODE_VC1_VLC_PRIMARY_BITS long are resolved by the primary
+// table, longer ones escape to a secondary table indexed by the remaining bits.
+static CODECHAL_DECODE_VC1_VLC_LUT BuildVlcLut(const uint32_t *table)
+{
+    CODECHAL_DECODE_VC1_VLC_LUT lut;
+    MOS_ZeroMemory(&lut, sizeof(lut));
+
+    uint32_t maxBits       = table[0];
+    uint32_t primaryBits   = MOS_MIN(maxBits, CODECHAL_DECODE_VC1_VLC_PRIMARY_BITS);
+    uint32_t secondaryBits = maxBits - primaryBits;
+    uint32_t secondaryEnd  = 1 << primaryBits;
+
+    lut.u32MaxBits     = maxBits;
+    lut.u32PrimaryBits = primaryBits;
+
+    uint32_t index = 1;
+    for (uint32_t codeLength = 1; codeLength <= maxBits; codeLength++)
+    {
+        uint32_t codeNum = table[index++];
+        while (codeNum--)
+        {
+            uint32_t code  = table[index++] << (maxBits - codeLength);
+            uint32_t value = table[index++];
+
+            uint32_t start, count;
+            if (codeLength <= primaryBits)
+            {
+                start = code >> secondaryBits;
+                count = 1 << (primaryBits - codeLength);
+            }
+            else
+            {
+                CODECHAL_DECODE_VC1_VLC_ENTRY *escape = &lut.Entries[code >> secondaryBits];
+                if (escape->u8Length != CODECHAL_DECODE_VC1_VLC_ESCAPE)
+                {
+                    if (escape->u8Length != 0 ||
+                        secondaryEnd + (1 << secondaryBits) > CODECHAL_DECODE_VC1_VLC_LUT_SIZE)
+                    {
+                        continue;
+                    }
+                    escape->u8Length = CODECHAL_DECODE_VC1_VLC_ESCAPE;
+                    escape->u16Value = (uint16_t)secondaryEnd;
+                    secondaryEnd += 1 << secondaryBits;
+                }
+                start = escape->u16Value + (code & ((1 << secondaryBits) - 1));
+                count = 1 << (maxBits - codeLength);
+            }
+
+            // shorter codes take precedence, as when the code table is searched in order
+            for (uint32_t i = start; i < start + count; i++)
+            {
+                if (lut.Entries[i].u8Length == 0)
+                {
+                    lut.Entries[i].u16Value = (uint16_t)value;
+                    lut.Entries[i].u8Length = (uint8_t)codeLength;
+                }
+            }
+        }
+    }
+
+    return lut;
+}
+
+static const CODECHAL_DECODE_VC1_VLC_LUT CODECHAL_DECODE_VC1_VldBitplaneModeLut       = BuildVlcLut(CODECHAL_DECODE_VC1_VldBitplaneModeTable);
+static const CODECHAL_DECODE_VC1_VLC_LUT CODECHAL_DECODE_VC1_VldCode3x2Or2x3TilesLut  = BuildVlcLut(CODECHAL_DECODE_VC1_VldCode3x2Or2x3TilesTable);
+static const CODECHAL_DECODE_VC1_VLC_LUT CODECHAL_DECODE_VC1_VldPictureTypeLut        = BuildVlcLut(CODECHAL_DECODE_VC1_VldPictureTypeTable);
+static const CODECHAL_DECODE_VC1_VLC_LUT CODECHAL_DECODE_VC1_VldBFractionLut          = BuildVlcLut(CODECHAL_DECODE_VC1_VldBFractionTable);
+static const CODECHAL_DECODE_VC1_VLC_LUT CODECHAL_DECODE_VC1_VldRefDistLut            = BuildVlcLut(CODECHAL_DECODE_VC1_VldRefDistTable);
+
 // lookup tables for MVMODE
 static const uint32_t CODECHAL_DECODE_VC1_LowRateMvModeTable[] =
 {
@@ -1440,74 +1511,58 @@ MOS_STATUS CodechalDecodeVc1::HandleSkipFrame()
 
 uint32_t CodechalDecodeVc1::PeekBits(uint32_t bitsRead)
 {
-    uint32_t value = 0;
-
     CODECHAL_DECODE_ASSERT((bitsRead) > 0 && (bitsRead) <= 32);
 
-    uint32_t* cache = Bitstream.pu32Cache;
-    int32_t shiftOffset = Bitstream.iBitOffset - (bitsRead);
-
-    if (shiftOffset >= 0)
+    if (Bitstream.iCachedBits < (int32_t)bitsRead)
     {
-        value = (*cache) >> (shiftOffset);
-    }
-    else
-    {
-        shiftOffset += 32;
-        value = (cache[0] << (32 - shiftOffset)) + (cache[1] >> shiftOffset);
+        if (UpdateBitstreamBuffer() == CODECHAL_DECODE_VC1_EOS)
+        {
+            return CODECHAL_DECODE_VC1_EOS;
+        }
     }
 
-    return (value & ((1 << bitsRead) - 1));
+    // bits beyond the end of the bitstream read as zero
+    return (uint32_t)(Bitstream.u64Cache >> (64 - bitsRead));
 }
 
 uint32_t CodechalDecodeVc1::UpdateBitstreamBuffer()
 {
-    uint32_t* cache = (uint32_t*)Bitstream.CacheBuffer;
-    uint32_t* cacheEnd = Bitstream.pu32CacheEnd;
-    uint32_t* cacheDataEnd = Bitstream.pu32CacheDataEnd;
+    uint64_t  cache = Bitstream.u64Cache;
+    int32_t   cachedBits = Bitstream.iCachedBits;
     uint32_t  zeroNum = Bitstream.u32ZeroNum;
     uint8_t*  originalBitBuffer = Bitstream.pOriginalBitBuffer;
     uint8_t*  originalBufferEnd = Bitstream.pOriginalBufferEnd;
 
-    if (cacheDataEnd == cacheEnd)
+    while (cachedBits <= 56 && originalBitBuffer < originalBufferEnd)
     {
-        *cache++ = *cacheEnd;
-    }
-
-    while (cache <= cacheEnd)
-    {
-        uint32_t leftByte;
-        CODECHAL_DECODE_VC1_BITSTREAM_VALUE value;
-        if (Bitstream.bIsEBDU)
+        if (originalBufferEnd - originalBitBuffer >= 8)
         {
-            // for EBDU, set dwLeftByte to 4 to remove emulation prevention bytes in the later while loop
-            leftByte = 4;
-            value.u32Value = 0;
-        }
-        else
-        {
-            leftByte = 0;
-            value.u8Value[3] = *originalBitBuffer++;
-            value.u8Value[2] = *originalBitBuffer++;
-            value.u8Value[1] = *originalBitBuffer++;
-            value.u8Value[0] = *originalBitBuffer++;
-        }
+            uint64_t bytes = 0;
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                bytes = (bytes << 8) | originalBitBuffer[i];
+            }
 
-        while (leftByte)
-        {
-            if (originalBitBuffer >= originalBufferEnd) // End of the bitstream;
+            // as many bytes as the cache takes, in one step if none of them is zero, since
+            // an emulation prevention byte or a start code can only follow two zero bytes
+            uint32_t byteNum = (64 - cachedBits) >> 3;
+            uint64_t byteMask = ~0ULL << (64 - (byteNum << 3));
+            uint64_t zeroBytes = (bytes - 0x0101010101010101ULL) & ~bytes & 0x8080808080808080ULL;
+
+            if (!Bitstream.bIsEBDU || (zeroNum < 2 && (zeroBytes & byteMask) == 0))
             {
-                *cache = value.u32Value;
-                Bitstream.pu32Cache = (uint32_t*)Bitstream.CacheBuffer;
-                Bitstream.u32ZeroNum = zeroNum;
-                Bitstream.pOriginalBitBuffer = originalBitBuffer;
-                Bitstream.pu32CacheDataEnd = cache;
-                Bitstream.iBitOffsetEnd = leftByte * 8;
-                return 0;
+                cache |= (bytes & byteMask) >> cachedBits;
+                cachedBits += byteNum << 3;
+                originalBitBuffer += byteNum;
+                zeroNum = 0;
+                continue;
             }
+        }
 
-            uint8_t data = *originalBitBuffer++;
+        uint8_t data = *originalBitBuffer++;
 
+        if (Bitstream.bIsEBDU)
+        {
             if (zeroNum < 2)
             {
                 zeroNum = data ? 0 : zeroNum + 1;
@@ -1559,62 +1614,38 @@ uint32_t CodechalDecodeVc1::UpdateBitstreamBuffer()
                     return(CODECHAL_DECODE_VC1_EOS);
                 }
             }
-
-            leftByte--;
-            value.u8Value[leftByte] = data;
         }
 
-        *cache = value.u32Value;
-        cache++;
+        cache |= (uint64_t)data << (56 - cachedBits);
+        cachedBits += 8;
     }
 
-    Bitstream.pu32Cache = (uint32_t*)Bitstream.CacheBuffer;
+    Bitstream.u64Cache = cache;
+    Bitstream.iCachedBits = cachedBits;
     Bitstream.u32ZeroNum = zeroNum;
     Bitstream.pOriginalBitBuffer = originalBitBuffer;
-    Bitstream.iBitOffsetEnd = 0;
-    Bitstream.pu32CacheDataEnd = Bitstream.pu32CacheEnd;
 
     return 0;
 }
 
 uint32_t CodechalDecodeVc1::GetBits(uint32_t bitsRead)
 {
-    uint32_t        value = 0;
-
     CODECHAL_DECODE_ASSERT((bitsRead > 0) && (bitsRead <= 32));
 
-    uint32_t* cache = Bitstream.pu32Cache;
-    int32_t shiftOffset = Bitstream.iBitOffset - (bitsRead);
-
-    if (shiftOffset >= 0)
-    {
-        value = (*cache) >> (shiftOffset);
-    }
-    else
-    {
-        shiftOffset += 32;
-        value = (cache[0] << (32 - shiftOffset)) + (cache[1] >> shiftOffset);
-        Bitstream.pu32Cache++;
-    }
-
-    value &= ((0x1 << bitsRead) - 1);
-    Bitstream.iBitOffset = shiftOffset;
-    Bitstream.u32ProcessedBitNum += bitsRead;
-
-    if ((cache == Bitstream.pu32CacheDataEnd) &&
-        (Bitstream.iBitOffset < Bitstream.iBitOffsetEnd))
-    {
-        return CODECHAL_DECODE_VC1_EOS;
-    }
-
-    if (cache == Bitstream.pu32CacheEnd)
+    if (Bitstream.iCachedBits < (int32_t)bitsRead)
     {
-        if (UpdateBitstreamBuffer() == CODECHAL_DECODE_VC1_EOS)
+        if (UpdateBitstreamBuffer() == CODECHAL_DECODE_VC1_EOS ||
+            Bitstream.iCachedBits < (int32_t)bitsRead)
         {
             return CODECHAL_DECODE_VC1_EOS;
         }
     }
 
+    uint32_t value = (uint32_t)(Bitstream.u64Cache >> (64 - bitsRead));
+    Bitstream.u64Cache <<= bitsRead;
+    Bitstream.iCachedBits -= bitsRead;
+    Bitstream.u32ProcessedBitNum += bitsRead;
+
     return value;
 }
 
@@ -1622,79 +1653,52 @@ uint32_t CodechalDecodeVc1::SkipBits(uint32_t bitsRead)
 {
     CODECHAL_DECODE_ASSERT((bitsRead > 0) && (bitsRead <= 32));
 
-    uint32_t* cache = Bitstream.pu32Cache;
-    int32_t shiftOffset = Bitstream.iBitOffset - (bitsRead);
-
-    if (shiftOffset < 0)
-    {
-        shiftOffset += 32;
-        Bitstream.pu32Cache++;
-    }
-
-    Bitstream.iBitOffset = shiftOffset;
-    Bitstream.u32ProcessedBitNum += bitsRead;
-
-    if ((cache == Bitstream.pu32CacheDataEnd) &&
-        (Bitstream.iBitOffset < Bitstream.iBitOffsetEnd))
+    if (Bitstream.iCachedBits < (int32_t)bitsRead)
     {
-        return CODECHAL_DECODE_VC1_EOS;
-    }
-
-    if (cache == Bitstream.pu32CacheEnd)
-    {
-        if (UpdateBitstreamBuffer() == CODECHAL_DECODE_VC1_EOS)
+        if (UpdateBitstreamBuffer() == CODECHAL_DECODE_VC1_EOS ||
+            Bitstream.iCachedBits < (int32_t)bitsRead)
         {
             return CODECHAL_DECODE_VC1_EOS;
         }
     }
 
+    Bitstream.u64Cache <<= bitsRead;
+    Bitstream.iCachedBits -= bitsRead;
+    Bitstream.u32ProcessedBitNum += bitsRead;
+
     return 0;
 }
 
-uint32_t CodechalDecodeVc1::GetVLC(const uint32_t *table)
+uint32_t CodechalDecodeVc1::GetVLC(const CODECHAL_DECODE_VC1_VLC_LUT &lut)
 {
-    if (table == nullptr)
-        return CODECHAL_DECODE_VC1_EOS;
-
-    CODECHAL_DECODE_ASSERT(table[0] > 0);    // max bits
-
-    uint32_t maxCodeLength = table[0];
-    uint32_t tableSize = table[0];
-    uint32_t index = 1;
-    uint32_t codeLength = 1;
+    CODECHAL_DECODE_ASSERT(lut.u32MaxBits > 0);    // max bits
 
-    uint32_t value = PeekBits(maxCodeLength);
+    uint32_t value = PeekBits(lut.u32MaxBits);
     if (CODECHAL_DECODE_VC1_EOS == value)
     {
         CODECHAL_DECODE_ASSERTMESSAGE("Bitstream exhausted.");
         return(value);
     }
 
-    for (uint32_t entryIndex = 0; entryIndex < tableSize; entryIndex++)
+    uint32_t secondaryBits = lut.u32MaxBits - lut.u32PrimaryBits;
+    const CODECHAL_DECODE_VC1_VLC_ENTRY *entry = &lut.Entries[value >> secondaryBits];
+    if (entry->u8Length == CODECHAL_DECODE_VC1_VLC_ESCAPE)
     {
-        uint32_t subtableSize = table[index++];
-
-        if (subtableSize > 0)
-        {
-            while (subtableSize--)
-            {
-                if (table[index++] == (value >> (maxCodeLength - codeLength)))
-                {
-                    value = GetBits((uint8_t)codeLength);
-
-                    return(table[index]);
-                }
-
-                index++;
-            }
-        }
+        entry = &lut.Entries[entry->u16Value + (value & ((1 << secondaryBits) - 1))];
+    }
 
-        codeLength++;
+    if (entry->u8Length == 0)
+    {
+        CODECHAL_DECODE_ASSERTMESSAGE("Code is not in VLC table.");
+        return(CODECHAL_DECODE_VC1_EOS);
     }
 
-    CODECHAL_DECODE_ASSERTMESSAGE("Code is not in VLC table.");
+    if (SkipBits(entry->u8Length) == CODECHAL_DECODE_VC1_EOS)
+    {
+        return(CODECHAL_DECODE_VC1_EOS);
+    }
 
-    return(CODECHAL_DECODE_VC1_EOS);
+    return(entry->u16Value);
 }
 
 MOS_STATUS CodechalDecodeVc1::InitialiseBitstream(
@@ -1712,11 +1716,8 @@ MOS_STATUS CodechalDecodeVc1::InitialiseBitstream(
     Bitstream.pOriginalBufferEnd = buffer + length;
     Bitstream.u32ZeroNum = 0;
     Bitstream.u32ProcessedBitNum = 0;
-    Bitstream.pu32Cache = (uint32_t*)Bitstream.CacheBuffer;
-    Bitstream.pu32CacheEnd = (uint32_t*)(Bitstream.CacheBuffer + CODECHAL_DECODE_VC1_BITSTRM_BUF_LEN);
-    Bitstream.pu32CacheDataEnd = (uint32_t*)Bitstream.CacheBuffer;
-    Bitstream.iBitOffset = 32;
-    Bitstream.iBitOffsetEnd = 32;
+    Bitstream.u64Cache = 0;
+    Bitstream.iCachedBits = 0;
     Bitstream.bIsEBDU = isEBDU;
 
     if (UpdateBitstreamBuffer() == CODECHAL_DECODE_VC1_EOS)
@@ -1748,17 +1749,25 @@ MOS_STATUS CodechalDecodeVc1::BitplaneNorm2Mode()
         count--;
     }
 
-    for (uint32_t i = 0; i < count / 2; i++)
+    // the pair codes are only skipped, so walk as many of them as fit in one
+    // 31-bit peek (which can't collide with EOS) and skip them together
+    uint32_t pairs = count / 2;
+    while (pairs)
     {
-        CODECHAL_DECODE_CHK_STATUS_RETURN(GetBits(1, value));
-        if (value)
+        uint32_t bits = PeekBits(31);
+        if (CODECHAL_DECODE_VC1_EOS == bits)
         {
-            CODECHAL_DECODE_CHK_STATUS_RETURN(GetBits(1, value));
-            if (value == 0)
-            {
-                CODECHAL_DECODE_CHK_STATUS_RETURN(GetBits(1, value));
-            }
+            return MOS_STATUS_UNKNOWN;
         }
+
+        uint32_t codeBits = 0;
+        while (pairs && codeBits <= 28)
+        {
+            codeBits += CODECHAL_DECODE_VC1_Norm2CodeLength[(bits >> (28 - codeBits)) & 7];
+            pairs--;
+        }
+
+        CODECHAL_DECODE_CHK_STATUS_RETURN(SkipBits(codeBits, value));
     }
 
     return eStatus;
@@ -1789,7 +1798,7 @@ MOS_STATUS CodechalDecodeVc1::BitplaneNorm6Mode()
         {
             for (uint32_t i = 0; i < widthInTiles; i++)
             {
-                CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldCode3x2Or2x3TilesTable, value));
+                CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldCode3x2Or2x3TilesLut, value));
             }
         }
 
@@ -1805,7 +1814,7 @@ MOS_STATUS CodechalDecodeVc1::BitplaneNorm6Mode()
         {
             for (uint32_t i = 0; i < widthInTiles; i++)
             {
-                CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldCode3x2Or2x3TilesTable, value));
+                CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldCode3x2Or2x3TilesLut, value));
             }
         }
 
@@ -2150,7 +2159,7 @@ MOS_STATUS CodechalDecodeVc1::ParseBitplane()
     uint32_t value;
     CODECHAL_DECODE_CHK_STATUS_RETURN(GetBits(CODECHAL_DECODE_VC1_BITS_BITPLANE_INVERT, value));
 
-    CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldBitplaneModeTable, value));
+    CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldBitplaneModeLut, value));
 
     switch (value) // Bitplane mode
     {
@@ -2457,7 +2466,7 @@ MOS_STATUS CodechalDecodeVc1::ParseFieldPictureLayerBAdvanced()
     uint32_t value;
     if (CodecHal_PictureIsInterlacedFrame(pVc1PicParams->CurrPic))
     {
-        CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldBFractionTable, value));
+        CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldBFractionLut, value));
         pVc1PicParams->b_picture_fraction = (uint8_t)value;
     }
 
@@ -2603,7 +2612,7 @@ MOS_STATUS CodechalDecodeVc1::ParsePictureHeaderAdvanced()
     }
     else
     {
-        CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldPictureTypeTable, value));
+        CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldPictureTypeLut, value));
     }
 
     if (pVc1PicParams->sequence_fields.tfcntrflag)
@@ -2696,7 +2705,7 @@ MOS_STATUS CodechalDecodeVc1::ParsePictureHeaderAdvanced()
         if (isBPicture ||
             (CodecHal_PictureIsField(pVc1PicParams->CurrPic) && isBIPicture))
         {
-            CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldBFractionTable, value));
+            CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldBFractionLut, value));
             pVc1PicParams->b_picture_fraction = (uint8_t)value;
         }
     }
@@ -2710,7 +2719,7 @@ MOS_STATUS CodechalDecodeVc1::ParsePictureHeaderAdvanced()
 
         if (value == 3)
         {
-            CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldRefDistTable, value));
+            CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldRefDistLut, value));
         }
 
         pVc1PicParams->reference_fields.reference_distance = value;
@@ -2794,7 +2803,7 @@ MOS_STATUS CodechalDecodeVc1::ParsePictureHeaderMainSimple()
         if (0 == value)
         {
             // it's B or BI picture, get B fraction
-            CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldBFractionTable, value));
+            CODECHAL_DECODE_CHK_STATUS_RETURN(GetVLC(CODECHAL_DECODE_VC1_VldBFractionLut, value));
             pVc1PicParams->b_picture_fraction = (uint8_t)value;
         }
     }
@@ -63,10 +63,22 @@
 #define CODECHAL_DECODE_VC1_CHROMA_MV(lmv)              (((lmv) + CODECHAL_DECODE_VC1_RndTb[(lmv) & 3]) >> 1)
 
 //!
-//! \def CODECHAL_DECODE_VC1_BITSTRM_BUF_LEN
-//! Bitstream Buffer Length
+//! \def CODECHAL_DECODE_VC1_VLC_PRIMARY_BITS
+//! Number of bitstream bits indexing the primary VLC lookup table
 //!
-#define CODECHAL_DECODE_VC1_BITSTRM_BUF_LEN             8
+#define CODECHAL_DECODE_VC1_VLC_PRIMARY_BITS            9
+
+//!
+//! \def CODECHAL_DECODE_VC1_VLC_LUT_SIZE
+//! Entries of a VLC lookup table, the primary table followed by the secondary tables
+//!
+#define CODECHAL_DECODE_VC1_VLC_LUT_SIZE                ((1 << CODECHAL_DECODE_VC1_VLC_PRIMARY_BITS) + 256)
+
+//!
+//! \def CODECHAL_DECODE_VC1_VLC_ESCAPE
+//! Code length marking a primary entry that escapes to a secondary table
+//!
+#define CODECHAL_DECODE_VC1_VLC_ESCAPE                  0xFF
 
 //!
 //! \def CODECHAL_DECODE_VC1_STUFFING_BYTES
@@ -142,15 +154,33 @@ typedef struct _CODECHAL_DECODE_VC1_BITSTREAM
     uint8_t*    pOriginalBufferEnd;                                   // pointer to the end of the original uncapsuted bitstream
     uint32_t    u32ZeroNum;                                           // number of continuous zeros before the current bype.
     uint32_t    u32ProcessedBitNum;                                   // number of bits being processed from initiation
-    uint8_t     CacheBuffer[CODECHAL_DECODE_VC1_BITSTRM_BUF_LEN + 4]; // cache buffer of uncapsuted raw bitstream
-    uint32_t*   pu32Cache;                                            // pointer to the cache buffer
-    uint32_t*   pu32CacheEnd;                                         // pointer to the updating end of the cache buffer
-    uint32_t*   pu32CacheDataEnd;                                     // pointer to the last valid uint32_t of the cache buffer
-    int32_t     iBitOffset;                                           // offset = 32 is the MSB, offset = 1 is the LSB.
-    int32_t     iBitOffsetEnd;                                        // bit offset of the last valid uint32_t
+    uint64_t    u64Cache;                                             // uncapsuted bits not consumed yet, MSB first, zero padded
+    int32_t     iCachedBits;                                          // number of valid bits in u64Cache
     bool        bIsEBDU;                                              // 1 if it is EBDU and emulation prevention bytes are present.
 } CODECHAL_DECODE_VC1_BITSTREAM, *PCODECHAL_DECODE_VC1_BITSTREAM;
 
+//!
+//! \struct CODECHAL_DECODE_VC1_VLC_ENTRY
+//! \brief Define VLC lookup table entry, indexed by the next bits of the bitstream
+//!
+typedef struct _CODECHAL_DECODE_VC1_VLC_ENTRY
+{
+    uint16_t    u16Value;                                             // decoded value, or offset of the secondary table for an escape entry
+    uint8_t     u8Length;                                             // code length, 0 if no code matches, CODECHAL_DECODE_VC1_VLC_ESCAPE for an escape entry
+    uint8_t     u8Reserved;
+} CODECHAL_DECODE_VC1_VLC_ENTRY, *PCODECHAL_DECODE_VC1_VLC_ENTRY;
+
+//!
+//! \struct CODECHAL_DECODE_VC1_VLC_LUT
+//! \brief Define two-level VLC lookup table built from a VLC code table
+//!
+typedef struct _CODECHAL_DECODE_VC1_VLC_LUT
+{
+    uint32_t                        u32MaxBits;                       // length of the longest code
+    uint32_t                        u32PrimaryBits;                   // number of bits indexing the primary table
+    CODECHAL_DECODE_VC1_VLC_ENTRY   Entries[CODECHAL_DECODE_VC1_VLC_LUT_SIZE];
+} CODECHAL_DECODE_VC1_VLC_LUT, *PCODECHAL_DECODE_VC1_VLC_LUT;
+
 //!
 //! \struct CODECHAL_DECODE_VC1_OLP_PARAMS
 //! \brief Define variables of VC1 Olp params for hw cmd
@@ -770,15 +800,15 @@ private:
     MOS_STATUS GetBits(uint32_t bitsRead, uint32_t &value);
 
     //!
-    //! \brief    Wrapper function to get VLC from VC1 bitstream according to VLC Table
-    //! \param    [in] table
-    //!           Pointer to VLC Table
+    //! \brief    Wrapper function to get VLC from VC1 bitstream according to VLC lookup table
+    //! \param    [in] lut
+    //!           VLC lookup table
     //! \param    [out] value
     //!           VC1 bitstream status, EOS if reaching end of stream, else bitstream value
     //! \return   MOS_STATUS
     //!           MOS_STATUS_SUCCESS if success, else fail reason
     //!
-    MOS_STATUS GetVLC(const uint32_t* table, uint32_t & value);
+    MOS_STATUS GetVLC(const CODECHAL_DECODE_VC1_VLC_LUT &lut, uint32_t & value);
 
     //!
     //! \brief    Wrapper function to skip words from VC1 bitstream
@@ -812,20 +842,22 @@ private:
     uint32_t GetBits(uint32_t bitsRead);
 
     //!
-    //! \brief    Update VC1 bitstream memeber value
+    //! \brief    Refill the VC1 bitstream cache, removing emulation prevention bytes
+    //! \details  Loads whole bytes until the cache holds more than 56 bits or the
+    //!           bitstream ends. Runs of bytes without zeros are loaded in one step.
     //! \return   uint32_t
-    //!           EOS if reaching end of stream, else bitstream value
+    //!           EOS if the bitstream is corrupted, else 0
     //!
     uint32_t UpdateBitstreamBuffer();
 
     //!
-    //! \brief    Get VLC from VC1 bitstream according to VLC Table
-    //! \param    [in] table
-    //!           Pointer to VLC Table
+    //! \brief    Get VLC from VC1 bitstream according to VLC lookup table
+    //! \param    [in] lut
+    //!           VLC lookup table
     //! \return   uint32_t
     //!           EOS if reaching end of stream, else bitstream value
     //!
-    uint32_t GetVLC(const uint32_t *table);
+    uint32_t GetVLC(const CODECHAL_DECODE_VC1_VLC_LUT &lut);
 
     //!
     //! \brief    Read bits from VC1 bitstream and don't update bitstream pointer
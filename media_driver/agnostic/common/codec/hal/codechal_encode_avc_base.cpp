@@ -649,27 +649,18 @@ MOS_STATUS CodecHal_SetPictureStructs_InsertInRefPicSelectList(PCODECHAL_ENCODE_
 
 static void PutVLCCode(BSBuffer *bsbuffer, uint32_t code)
 {
-    uint8_t   leadingZeroBits, bitcount;
-    uint32_t  code1, bits;
+    // ue(v) is code + 1 written in 2 * leadingZeroBits + 1 bits
+    uint32_t codeNum         = code + 1;
+    uint32_t leadingZeroBits = 31 - __builtin_clz(codeNum);
 
-    code1 = code + 1;
-    bitcount = 0;
-    while (code1)
+    if (leadingZeroBits < 16)
     {
-        code1 >>= 1;
-        bitcount++;
-    }
-
-    if (bitcount == 1)
-    {
-        PutBit(bsbuffer, 1);
+        PutBits(bsbuffer, codeNum, 2 * leadingZeroBits + 1);
     }
     else
     {
-        leadingZeroBits = bitcount - 1;
-        bits = code + 1 - (1 << leadingZeroBits);
-        PutBits(bsbuffer, 1, leadingZeroBits + 1);
-        PutBits(bsbuffer, bits, leadingZeroBits);
+        PutBits(bsbuffer, 0, leadingZeroBits);
+        PutBits(bsbuffer, codeNum, leadingZeroBits + 1);
     }
 }
 
@@ -1318,58 +1318,34 @@ static __inline void PutBit(BSBuffer *bsbuffer, uint32_t code)
     }
 }
 
-static __inline void PutBitsSub(BSBuffer *bsbuffer, uint32_t code, uint32_t length)
+static __inline void PutBits(BSBuffer *bsbuffer, uint32_t code, uint32_t length)
 {
     uint8_t *byte = bsbuffer->pCurrent;
 
-    // make sure that the number of bits given is <= 24
-    CODECHAL_ENCODE_ASSERT(length <= 24);
-
-    code <<= (32 - length);
-
-    // shift field so that the given code begins at the current bit
-    // offset in the most significant byte of the 32-bit word
-    length += bsbuffer->BitOffset;
-    code >>= bsbuffer->BitOffset;
+    // only support up to 32 bits based on current usage
+    CODECHAL_ENCODE_ASSERT(length <= 32);
 
-    // write bytes back into memory, big-endian
-    byte[0] = (uint8_t)((code >> 24) | byte[0]);
-    byte[1] = (uint8_t)(code >> 16);
-    if (length > 16)
+    if (length == 0)
     {
-        byte[2] = (uint8_t)(code >> 8);
-        byte[3] = (uint8_t)code;
+        return;
     }
-    else
-    {
-        byte[2] = 0;
-    }
-
-    // update bitstream pointer and bit offset
-    bsbuffer->pCurrent += (length >> 3);
-    bsbuffer->BitOffset = (length & 7);
-}
 
-static __inline void PutBits(BSBuffer *bsbuffer, uint32_t code, uint32_t length)
-{
-    uint32_t code1, code2;
+    // merge the code below the pending bits of the current byte in a 64-bit
+    // accumulator, so that up to 32 bits are written in a single pass
+    uint32_t total = bsbuffer->BitOffset + length;
+    uint64_t accum = ((uint64_t)byte[0] << 56) |
+                     (((uint64_t)code << (64 - length)) >> bsbuffer->BitOffset);
 
-    // temp solution, only support up to 32 bits based on current usage
-    CODECHAL_ENCODE_ASSERT(length <= 32);
-
-    if (length >= 24)
+    // write the complete bytes and the new current byte back, big-endian,
+    // the bits of the current byte beyond the bit offset are left cleared
+    for (uint32_t i = 0; i <= (total >> 3); i++)
     {
-        code1 = code & 0xFFFF;
-        code2 = code >> 16;
-
-        // high bits go first
-        PutBitsSub(bsbuffer, code2, length-16);
-        PutBitsSub(bsbuffer, code1, 16);
-    }
-    else
-    {
-        PutBitsSub(bsbuffer, code, length);
+        byte[i] = (uint8_t)(accum >> (56 - 8 * i));
     }
+
+    // update bitstream pointer and bit offset
+    bsbuffer->pCurrent += (total >> 3);
+    bsbuffer->BitOffset = (uint8_t)(total & 7);
 }
 
 /*----------------------------------------------------------------------------
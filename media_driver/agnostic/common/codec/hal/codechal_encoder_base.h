@@ -1664,6 +1664,18 @@ public:
     //!
     MOS_STATUS GetStatusReport(void *status, uint16_t numStatus) override;
 
+    //!
+    //! \brief  Get the resource the status report is read from
+    //! \detail HW writes the status at the end of each frame, so waiting on this
+    //!         resource waits for the pending status reports to complete.
+    //! \return PMOS_RESOURCE
+    //!         Status buffer of the PAK engine if PAK is enabled, else of the render engine
+    //!
+    PMOS_RESOURCE GetStatusReportResource()
+    {
+        return m_pakEnabled ? &m_encodeStatusBuf.resStatusBuffer : &m_encodeStatusBufRcs.resStatusBuffer;
+    }
+
     //!
     //! \brief  Initialize the encoder state
     //! \param  [in] pSettings
@@ -291,6 +291,11 @@ MHW_BLOCK_MANAGER::MHW_BLOCK_MANAGER(PMHW_BLOCK_MANAGER_PARAMS pParams):
         MOS_SecureStrcpy(m_BlockList[i].szListName, 16, szListName[i]);
     }
 
+    //Init free block index
+    m_FreeIndexFL = 0;
+    MOS_ZeroMemory(m_FreeIndexSL, sizeof(m_FreeIndexSL));
+    MOS_ZeroMemory(m_FreeIndex, sizeof(m_FreeIndex));
+
     //Extend Pool
     ExtendPool(m_Params.dwPoolInitialCount);
 }
@@ -560,6 +565,12 @@ MOS_STATUS MHW_BLOCK_MANAGER::AttachBlockInternal(
     pList->dwSize += pBlock->dwBlockSize;
     pList->iCount++;
 
+    // Free blocks are also indexed by size
+    if (BlockState == MHW_BLOCK_STATE_FREE)
+    {
+        InsertFreeIndex(pBlock);
+    }
+
     return MOS_STATUS_SUCCESS;
 }
 
@@ -650,6 +661,11 @@ PMHW_STATE_HEAP_MEMORY_BLOCK MHW_BLOCK_MANAGER::DetachBlockInternal(
     // reset pointers - block is detached
     pBlock->pNext = pBlock->pPrev = nullptr;
 
+    if (pList->BlockState == MHW_BLOCK_STATE_FREE)
+    {
+        RemoveFreeIndex(pBlock);
+    }
+
     // track size and number of block in the list
     pList->dwSize -= pBlock->dwBlockSize;
     pList->iCount--;
@@ -693,6 +709,153 @@ void MHW_BLOCK_MANAGER::ReturnBlockToPool(PMHW_STATE_HEAP_MEMORY_BLOCK pBlock)
     return;
 }
 
+void MHW_BLOCK_MANAGER::GetFreeIndex(
+    uint32_t                     dwSize,
+    uint32_t                     *pdwFL,
+    uint32_t                     *pdwSL)
+{
+    uint32_t dwFL, dwSL;
+
+    dwSize = MOS_MAX(dwSize, 1);
+    dwFL   = 31 - __builtin_clz(dwSize);
+
+    // Second level is given by the bits following the most significant bit
+    if (dwFL >= MHW_BLOCK_MANAGER_FREE_INDEX_SL_BITS)
+    {
+        dwSL = dwSize >> (dwFL - MHW_BLOCK_MANAGER_FREE_INDEX_SL_BITS);
+    }
+    else
+    {
+        dwSL = dwSize << (MHW_BLOCK_MANAGER_FREE_INDEX_SL_BITS - dwFL);
+    }
+
+    *pdwFL = dwFL;
+    *pdwSL = dwSL & (MHW_BLOCK_MANAGER_FREE_INDEX_SL_COUNT - 1);
+}
+
+void MHW_BLOCK_MANAGER::InsertFreeIndex(PMHW_STATE_HEAP_MEMORY_BLOCK pBlock)
+{
+    uint32_t dwFL, dwSL;
+
+    GetFreeIndex(pBlock->dwBlockSize, &dwFL, &dwSL);
+
+    // Insert block at the head of the size class list
+    pBlock->pFreePrev = nullptr;
+    pBlock->pFreeNext = m_FreeIndex[dwFL][dwSL];
+    if (pBlock->pFreeNext)
+    {
+        pBlock->pFreeNext->pFreePrev = pBlock;
+    }
+    m_FreeIndex[dwFL][dwSL] = pBlock;
+
+    // Size class is no longer empty
+    m_FreeIndexFL      |= (1u << dwFL);
+    m_FreeIndexSL[dwFL] |= (1u << dwSL);
+}
+
+void MHW_BLOCK_MANAGER::RemoveFreeIndex(PMHW_STATE_HEAP_MEMORY_BLOCK pBlock)
+{
+    uint32_t dwFL, dwSL;
+
+    GetFreeIndex(pBlock->dwBlockSize, &dwFL, &dwSL);
+
+    if (pBlock->pFreePrev)
+    {
+        pBlock->pFreePrev->pFreeNext = pBlock->pFreeNext;
+    }
+    else
+    {
+        m_FreeIndex[dwFL][dwSL] = pBlock->pFreeNext;
+    }
+
+    if (pBlock->pFreeNext)
+    {
+        pBlock->pFreeNext->pFreePrev = pBlock->pFreePrev;
+    }
+
+    pBlock->pFreeNext = pBlock->pFreePrev = nullptr;
+
+    // Last block of the size class was removed
+    if (!m_FreeIndex[dwFL][dwSL])
+    {
+        m_FreeIndexSL[dwFL] &= ~(1u << dwSL);
+        if (!m_FreeIndexSL[dwFL])
+        {
+            m_FreeIndexFL &= ~(1u << dwFL);
+        }
+    }
+}
+
+PMHW_STATE_HEAP_MEMORY_BLOCK MHW_BLOCK_MANAGER::FindFreeBlock(
+    uint32_t                     dwSize,
+    PMHW_STATE_HEAP              pHeapAffinity)
+{
+    PMHW_STATE_HEAP_MEMORY_BLOCK pBlock;
+    uint32_t                     dwFL, dwSL;
+    uint32_t                     dwBitmap;
+    uint64_t                     ui64Size;
+
+    // Blocks in the class of the request may be smaller than the request - round the
+    // request up to the next class boundary, so that any block found is large enough
+    GetFreeIndex(dwSize, &dwFL, &dwSL);
+    ui64Size = dwSize;
+    if (dwFL >= MHW_BLOCK_MANAGER_FREE_INDEX_SL_BITS)
+    {
+        ui64Size += (1u << (dwFL - MHW_BLOCK_MANAGER_FREE_INDEX_SL_BITS)) - 1;
+    }
+
+    if (ui64Size <= 0xFFFFFFFF)
+    {
+        GetFreeIndex((uint32_t)ui64Size, &dwFL, &dwSL);
+
+        for (;;)
+        {
+            // Find the first non-empty class starting from (FL, SL)
+            dwBitmap = (dwFL < MHW_BLOCK_MANAGER_FREE_INDEX_FL_COUNT) ? (m_FreeIndexSL[dwFL] & (~0u << dwSL)) : 0;
+            if (!dwBitmap)
+            {
+                dwBitmap = (dwFL + 1 < MHW_BLOCK_MANAGER_FREE_INDEX_FL_COUNT) ? (m_FreeIndexFL & (~0u << (dwFL + 1))) : 0;
+                if (!dwBitmap)
+                {
+                    break;
+                }
+                dwFL     = __builtin_ctz(dwBitmap);
+                dwBitmap = m_FreeIndexSL[dwFL];
+            }
+            dwSL = __builtin_ctz(dwBitmap);
+
+            // Any block fits - only heap affinity may require looking further
+            for (pBlock = m_FreeIndex[dwFL][dwSL]; pBlock != nullptr; pBlock = pBlock->pFreeNext)
+            {
+                if (!pHeapAffinity || pBlock->pStateHeap == pHeapAffinity)
+                {
+                    return pBlock;
+                }
+            }
+
+            // All blocks in this class belong to other heaps - try the next class
+            if (++dwSL == MHW_BLOCK_MANAGER_FREE_INDEX_SL_COUNT)
+            {
+                dwSL = 0;
+                dwFL++;
+            }
+        }
+    }
+
+    // Last resort - search the class of the request for a block large enough
+    GetFreeIndex(dwSize, &dwFL, &dwSL);
+    for (pBlock = m_FreeIndex[dwFL][dwSL]; pBlock != nullptr; pBlock = pBlock->pFreeNext)
+    {
+        if (pBlock->dwBlockSize >= dwSize &&
+            (!pHeapAffinity || pBlock->pStateHeap == pHeapAffinity))
+        {
+            return pBlock;
+        }
+    }
+
+    return nullptr;
+}
+
 MOS_STATUS MHW_BLOCK_MANAGER::Refresh(uint32_t dwSyncTag)
 {
     PMHW_STATE_HEAP_MEMORY_BLOCK pBlock, pNext;
@@ -753,6 +916,9 @@ void MHW_BLOCK_MANAGER::ConsolidateBlock(
         return;
     }
 
+    // Block size changes - reindex block after consolidation
+    RemoveFreeIndex(pBlock);
+
     // Consolidate pBlock with previous blocks
     PMHW_BLOCK_LIST pFree = &m_BlockList[MHW_BLOCK_STATE_FREE];
     for (pAux = pBlock->pHeapPrev; (pAux != nullptr) && (pAux->BlockState == MHW_BLOCK_STATE_FREE); pAux = pBlock->pHeapPrev)
@@ -804,6 +970,8 @@ void MHW_BLOCK_MANAGER::ConsolidateBlock(
         // Memory block object no longer needed - return to pool after consolidation
         ReturnBlockToPool(pAux);
     }
+
+    InsertFreeIndex(pBlock);
 }
 
 
@@ -954,11 +1122,23 @@ MOS_STATUS MHW_BLOCK_MANAGER::SplitBlockInternal(
     pBlockL->pNext = pBlockH;
     pBlockH->pPrev = pBlockL;
 
+    // Free block is split in 2 - remove the original block from the free index (the new block is a copy, not indexed)
+    if (pBlock->BlockState == MHW_BLOCK_STATE_FREE)
+    {
+        RemoveFreeIndex(pBlock);
+    }
+
     // Adjust Block sizes
     pBlockL->dwBlockSize         = dwSplitOffset - pBlockL->dwOffsetInStateHeap;   // Updates L block size based on split offset
     pBlockH->dwOffsetInStateHeap = dwSplitOffset;                                  // Sets 2nd block offset
     pBlockH->dwBlockSize        -= pBlockL->dwBlockSize;                           // Updates H block size by subtracting L block size
 
+    if (pBlock->BlockState == MHW_BLOCK_STATE_FREE)
+    {
+        InsertFreeIndex(pBlockL);
+        InsertFreeIndex(pBlockH);
+    }
+
     // Adjust Block data related pointers/sizes only if block is not free
     if (pBlockL->BlockState != MHW_BLOCK_STATE_FREE)
     {
@@ -1006,6 +1186,11 @@ MOS_STATUS MHW_BLOCK_MANAGER::MergeBlocksInternal(
         pBlockL = DetachBlock(MHW_BLOCK_STATE_FREE, pBlockL);
         BLOCK_MANAGER_CHK_NULL(pBlockL);
 
+        if (pBlockH->BlockState == MHW_BLOCK_STATE_FREE)
+        {
+            RemoveFreeIndex(pBlockH);
+        }
+
         pBlockH->dwOffsetInStateHeap  = pBlockL->dwOffsetInStateHeap;
         pBlockH->dwBlockSize         += pBlockL->dwBlockSize;
 
@@ -1025,6 +1210,10 @@ MOS_STATUS MHW_BLOCK_MANAGER::MergeBlocksInternal(
             pBlockH->pStateHeap->dwFree -= pBlockL->dwBlockSize;
             pBlockH->pStateHeap->dwUsed += pBlockL->dwBlockSize;
         }
+        else
+        {
+            InsertFreeIndex(pBlockH);
+        }
 
         // Return block object to the pool
         ReturnBlockToPool(pBlockL);
@@ -1043,6 +1232,11 @@ MOS_STATUS MHW_BLOCK_MANAGER::MergeBlocksInternal(
         pBlockH = DetachBlock(MHW_BLOCK_STATE_FREE, pBlockH);
 		BLOCK_MANAGER_CHK_NULL(pBlockH);
 
+        if (pBlockL->BlockState == MHW_BLOCK_STATE_FREE)
+        {
+            RemoveFreeIndex(pBlockL);
+        }
+
         pBlockL->dwBlockSize += pBlockH->dwBlockSize;
         if (pBlockL->BlockState != MHW_BLOCK_STATE_FREE)
         {
@@ -1050,6 +1244,10 @@ MOS_STATUS MHW_BLOCK_MANAGER::MergeBlocksInternal(
             pBlockL->pStateHeap->dwFree -= pBlockL->dwBlockSize;
             pBlockL->pStateHeap->dwUsed += pBlockL->dwBlockSize;
         }
+        else
+        {
+            InsertFreeIndex(pBlockL);
+        }
 
         // Add size to the target block list
         pList = &(m_BlockList[pBlockL->BlockState]);
@@ -1330,7 +1528,6 @@ PMHW_STATE_HEAP_MEMORY_BLOCK MHW_BLOCK_MANAGER::AllocateBlock(
     PMHW_STATE_HEAP     pHeapAffinity)
 {
     PMHW_STATE_HEAP_MEMORY_BLOCK pBlock = nullptr;
-    PMHW_BLOCK_LIST              pFree  = &m_BlockList[MHW_BLOCK_STATE_FREE];
     uint32_t                     dwAdjust;     // Offset adjustment for alignment purposes
     uint32_t                     dwAllocSize;  // Actual allocation size accounting for alignment and other restrictions
     MOS_STATUS                   eStatus = MOS_STATUS_SUCCESS;
@@ -1360,21 +1557,8 @@ PMHW_STATE_HEAP_MEMORY_BLOCK MHW_BLOCK_MANAGER::AllocateBlock(
     // Enforce min block size
     dwAllocSize = MOS_MAX(m_Params.dwHeapBlockMinSize, dwAllocSize);
 
-    // Search list of free blocks for the first match
-    for (pBlock = pFree->pHead; pBlock != nullptr; pBlock = pBlock->pNext)
-    {
-        // Skip this heap if we are looking for allocation in a specific heap
-        if (pHeapAffinity  && pBlock->pStateHeap != pHeapAffinity)
-        {
-            continue;
-        }
-
-        // Check if aligned block fits the request -> break with a successful block
-        if (pBlock->dwBlockSize >= dwAllocSize)
-        {
-            break;
-        }
-    }
+    // Search free block index for the best size class that fits the request
+    pBlock = FindFreeBlock(dwAllocSize, pHeapAffinity);
 
     // No block was found - fail search
     if (!pBlock)
@@ -44,6 +44,13 @@
 // Maximum allocation array size
 #define MHW_BLOCK_MANAGER_MAX_BLOCK_ARRAY  64
 
+// Free block index - free blocks are segregated by size in 2 levels: the first level
+// is the power of 2 of the block size, the second level splits each power of 2 range
+// into MHW_BLOCK_MANAGER_FREE_INDEX_SL_COUNT linear classes.
+#define MHW_BLOCK_MANAGER_FREE_INDEX_FL_COUNT   32
+#define MHW_BLOCK_MANAGER_FREE_INDEX_SL_BITS    3
+#define MHW_BLOCK_MANAGER_FREE_INDEX_SL_COUNT   (1 << MHW_BLOCK_MANAGER_FREE_INDEX_SL_BITS)
+
 typedef struct _MHW_BLOCK_MANAGER_PARAMS
 {
     uint32_t                     dwPoolInitialCount;     //!< Initial number of memory blocks in pool
@@ -79,6 +86,11 @@ private:
     MHW_MEMORY_POOL          m_MemoryPool;                          //!< Memory pool of PMHW_STATE_HEAP_MEMORY_BLOCK objects
     MHW_BLOCK_LIST           m_BlockList[MHW_BLOCK_STATE_COUNT];    //!< Block lists associated with each block state
     PMHW_STATE_HEAP          m_pStateHeap;                          //!< Points to state heap
+
+    uint32_t                     m_FreeIndexFL;                                             //!< Bitmap of first level classes holding free blocks
+    uint32_t                     m_FreeIndexSL[MHW_BLOCK_MANAGER_FREE_INDEX_FL_COUNT];      //!< Bitmaps of second level classes holding free blocks
+    PMHW_STATE_HEAP_MEMORY_BLOCK m_FreeIndex[MHW_BLOCK_MANAGER_FREE_INDEX_FL_COUNT]
+                                            [MHW_BLOCK_MANAGER_FREE_INDEX_SL_COUNT];       //!< Free blocks, one list per size class
     
 public:
 
@@ -429,6 +441,55 @@ private:
     //!
     void ReturnBlockToPool(PMHW_STATE_HEAP_MEMORY_BLOCK pBlock);
 
+    //!
+    //! \brief    Gets the size class of a free block
+    //! \details  Maps a block size into the first and second level indices of the free block index.
+    //! \param    [in] dwSize
+    //!           Block size
+    //! \param    [out] pdwFL
+    //!           First level index (power of 2 of the size)
+    //! \param    [out] pdwSL
+    //!           Second level index (linear subdivision of the power of 2 range)
+    //! \return   N/A
+    //!
+    void GetFreeIndex(
+        uint32_t                     dwSize,
+        uint32_t                     *pdwFL,
+        uint32_t                     *pdwSL);
+
+    //!
+    //! \brief    Inserts a free block into the free block index
+    //! \details  Called whenever a block enters the free list or a free block changes size.
+    //! \param    [in] pBlock
+    //!           Pointer to free memory block
+    //! \return   N/A
+    //!
+    void InsertFreeIndex(PMHW_STATE_HEAP_MEMORY_BLOCK pBlock);
+
+    //!
+    //! \brief    Removes a free block from the free block index
+    //! \details  Called whenever a block leaves the free list, or before a free block changes size.
+    //! \param    [in] pBlock
+    //!           Pointer to free memory block
+    //! \return   N/A
+    //!
+    void RemoveFreeIndex(PMHW_STATE_HEAP_MEMORY_BLOCK pBlock);
+
+    //!
+    //! \brief    Finds a free block large enough for the request
+    //! \details  Searches the free block index for the smallest size class in which all blocks
+    //!           fit the request, so the search does not depend on the number of free blocks.
+    //! \param    [in] dwSize
+    //!           Size required, accounting for alignment and minimum block size
+    //! \param    [in] pHeapAffinity
+    //!           Only consider blocks in this state heap, nullptr for any heap
+    //! \return   PMHW_STATE_HEAP_MEMORY_BLOCK
+    //!           Free block, nullptr if no block is large enough
+    //!
+    PMHW_STATE_HEAP_MEMORY_BLOCK FindFreeBlock(
+        uint32_t                     dwSize,
+        PMHW_STATE_HEAP              pHeapAffinity);
+
     //!
     //! \brief    Consolidate free memory
     //! \details  Consolidate free memory blocks adjacent to a given free block (within the same state heap).
@@ -217,6 +217,8 @@ struct _MHW_STATE_HEAP_MEMORY_BLOCK
 
     PMHW_STATE_HEAP_MEMORY_BLOCK    pHeapNext;        //!< Next block in same state heap (adjacent), null if last
     PMHW_STATE_HEAP_MEMORY_BLOCK    pHeapPrev;        //!< Previous block in same state heap (adjacent), null if first
+    PMHW_STATE_HEAP_MEMORY_BLOCK    pFreeNext;        //!< Next free block in the same size class (block manager free index)
+    PMHW_STATE_HEAP_MEMORY_BLOCK    pFreePrev;        //!< Previous free block in the same size class (block manager free index)
 
     uint8_t                         *pDataPtr;         //!< Pointer to aligned data
     uint32_t                        dwDataOffset;     //!< Offset of pDataPtr (from State Heap Base - used in state programming)
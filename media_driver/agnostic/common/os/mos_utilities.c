@@ -1537,6 +1537,24 @@ MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_ENCODE_BRC_SOFTWARE_ID,
      MOS_USER_FEATURE_VALUE_TYPE_STRING,
      "",
      "Directory where all CodecHal debug interface can locate cfg file and dump."),
+    MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_CODECHAL_DEBUG_ASYNC_DUMP_ID,
+     "CodecHal Debug Async Dump",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Codec",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_UINT32,
+     "0",
+     "CodecHal dumps are written by: the calling thread (0), a worker thread waiting when the staging memory is full (1), a worker thread dropping dumps when the staging memory is full (2)."),
+    MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_CODECHAL_DEBUG_ASYNC_DUMP_STAGING_SIZE_ID,
+     "CodecHal Debug Async Dump Staging Size",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Codec",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_UINT32,
+     "256",
+     "Size in MB of the memory holding CodecHal dumps not yet written by the async dump worker thread."),
      MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_HUC_DEMO_KERNEL_ID, // Used to indicate which huc kernel to load for the Huc Demo feature
      "Media Huc Demo kernel Id",
      __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
@@ -1574,6 +1592,33 @@ MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_ENCODE_BRC_SOFTWARE_ID,
      MOS_USER_FEATURE_VALUE_TYPE_UINT32,
      "0",
      "Specify which VP features on/off for Demo mode"),
+    MOS_DECLARE_UF_KEY(__MOS_USER_FEATURE_KEY_TRACE_EVENT_OUTPUT_FILE_ID,
+     "Trace Event Output File",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "MOS",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_STRING,
+     "",
+     "If set, trace events are buffered per thread and written in binary to this file with the process id appended, instead of trace_marker."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_BO_CACHE_MAX_SIZE_ID,
+     "BO Cache Max Size",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "MOS",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_UINT32,
+     "256",
+     "Size in MB of the largest buffer object kept in the reuse cache."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_BO_CACHE_BUDGET_ID,
+     "BO Cache Budget",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "MOS",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_UINT32,
+     "512",
+     "Total size in MB of the buffer objects kept in the reuse cache."),
 #if MOS_MESSAGES_ENABLED
     MOS_DECLARE_UF_KEY(__MOS_USER_FEATURE_KEY_MESSAGE_HLT_ENABLED_ID,
      __MOS_USER_FEATURE_KEY_MESSAGE_HLT_ENABLED,
@@ -1918,6 +1963,15 @@ MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_ENCODE_BRC_SOFTWARE_ID,
      MOS_USER_FEATURE_VALUE_TYPE_UINT32,
      "0",
      "Enable MDF Surface Dump"),
+     MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_MDF_COMPLETION_THREAD_ENABLE_ID,
+     __MEDIA_USER_FEATURE_VALUE_MDF_COMPLETION_THREAD_ENABLE,
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "MDF",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_UINT32,
+     "0",
+     "Retire flushed MDF tasks on a background thread"),
      MOS_DECLARE_UF_KEY_DBGONLY(__VPHAL_RNDR_SSD_CONTROL_ID,
      "SSD Control",
      __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
@@ -1945,6 +1999,15 @@ MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_ENCODE_BRC_SOFTWARE_ID,
      MOS_USER_FEATURE_VALUE_TYPE_BOOL,
      "0",
      "CM based FC enable Control"),
+     MOS_DECLARE_UF_KEY(__VPHAL_RNDR_KERNEL_CACHE_ENABLE_ID,
+     "VP Kernel Cache Enable",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "VP",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_UINT32,
+     "0",
+     "Persist linked composite kernels across processes"),
 #if (_DEBUG || _RELEASE_INTERNAL)
     MOS_DECLARE_UF_KEY(__VPHAL_DBG_SURF_DUMP_OUTFILE_KEY_NAME_ID,
      "outfileLocation",
@@ -5352,8 +5415,10 @@ static __inline int32_t Mos_SwizzleOffset(
 }
 
 //!
-//! \brief    Wrapper function for SwizzleOffset
-//! \details  Wrapper function for SwizzleOffset in Mos 
+//! \brief    Converts a surface between linear and X/Y tiled layout
+//! \details  Converts a surface between linear and X/Y tiled layout in Mos.
+//!           Data is moved one tile line span at a time (16B for Y-major,
+//!           512B for X-major) rather than swizzling each byte.
 //! \param    [in] pSrc
 //!           Pointer to source data.
 //! \param    [out] pDst
@@ -5381,43 +5446,94 @@ void Mos_SwizzleData(
 #define IS_TILED_TO_LINEAR(_a, _b)  (IS_TILED(_a) && !IS_TILED(_b))
 #define IS_LINEAR_TO_TILED(_a, _b)  (!IS_TILED(_a) && IS_TILED(_b))
 
-    int32_t LinearOffset;
-    int32_t TileOffset;
-    int32_t x;
-    int32_t y;
+    MOS_TILE_TYPE   TileFormat;
+    bool            bDetile;
+    int32_t         LBits, LPos;        // Size and swizzled position of the Line component.
+    int32_t         SpanSize;           // Bytes of one line within one tile (OWord for Y, 512B for X)
+    int32_t         TileCols;           // Number of complete tile columns per pitch
+    int32_t         SpanPitch;          // Bytes covered by the complete tile columns
+    int32_t         Row, Line, Col, x;
+    int32_t         LinearOffset;
+    int32_t         TileOffset;
+    uint8_t        *pLinear;
+    uint8_t        *pTiled;
+
+    if (IS_TILED_TO_LINEAR(SrcTiling, DstTiling))
+    {
+        TileFormat = SrcTiling;
+        bDetile    = true;
+    }
+    else if (IS_LINEAR_TO_TILED(SrcTiling, DstTiling))
+    {
+        TileFormat = DstTiling;
+        bDetile    = false;
+    }
+    else
+    {
+        MOS_OS_ASSERT(0);
+        return;
+    }
+
+    if (TileFormat == MOS_TILE_Y)
+    {
+        LBits = 5; // Log2(TileY.Height = 32)
+        LPos  = 4; // Log2(TileY.PseudoWidth = 16)
+    }
+    else //if (TileFormat == MOS_TILE_X)
+    {
+        LBits = 3; // Log2(TileX.Height = 8)
+        LPos  = 9; // Log2(TileX.Width = 512)
+    }
+
+    SpanSize  = 1 << LPos;
+    TileCols  = iPitch >> LPos;
+    SpanPitch = TileCols << LPos;
 
-    // Translate from one format to another
-    for (y = 0, LinearOffset = 0, TileOffset = 0; y < iHeight; y++)
+    // Within one line of a tile the swizzled offset is contiguous, so instead of
+    // swizzling every byte, move one whole span (a 16B OWord column for Y-major,
+    // a 512B line for X-major) per copy. Walk each tile row column by column so
+    // that the tiled side is accessed sequentially.
+    for (Row = 0; (Row << LBits) < iHeight; Row++)
     {
-        for (x = 0; x < iPitch; x++, LinearOffset++)
+        int32_t Lines = MOS_MIN(1 << LBits, iHeight - (Row << LBits));
+
+        for (Col = 0; Col < TileCols; Col++)
         {
-            // x or y --> linear
-            if (IS_TILED_TO_LINEAR(SrcTiling, DstTiling))
-            {
-                TileOffset = Mos_SwizzleOffset(
-                    x,
-                    y,
-                    iPitch,
-                    SrcTiling,
-                    false);
-
-                *(pDst + LinearOffset) = *(pSrc + TileOffset);
-            }
-            // linear --> x or y
-            else if (IS_LINEAR_TO_TILED(SrcTiling, DstTiling))
+            TileOffset   = ((Row * TileCols) + Col) << (LBits + LPos);
+            LinearOffset = ((Row << LBits) * iPitch) + (Col << LPos);
+
+            for (Line = 0; Line < Lines; Line++)
             {
-                TileOffset = Mos_SwizzleOffset(
-                    x,
-                    y,
-                    iPitch,
-                    DstTiling,
-                    false);
-
-                *(pDst + TileOffset) = *(pSrc + LinearOffset);
+                pLinear = (bDetile ? pDst : pSrc) + LinearOffset + Line * iPitch;
+                pTiled  = (bDetile ? pSrc : pDst) + TileOffset + (Line << LPos);
+
+                if (bDetile)
+                {
+                    memcpy(pLinear, pTiled, SpanSize);
+                }
+                else
+                {
+                    memcpy(pTiled, pLinear, SpanSize);
+                }
             }
-            else
+        }
+
+        // Trailing bytes of a pitch that is not tile aligned keep the byte-wise path.
+        for (Line = 0; Line < Lines && SpanPitch < iPitch; Line++)
+        {
+            for (x = SpanPitch; x < iPitch; x++)
             {
-                MOS_OS_ASSERT(0);
+                LinearOffset = ((Row << LBits) + Line) * iPitch + x;
+                TileOffset   = Mos_SwizzleOffset(x, (Row << LBits) + Line, iPitch, TileFormat, false);
+
+                if (bDetile)
+                {
+                    pDst[LinearOffset] = pSrc[TileOffset];
+                }
+                else
+                {
+                    pDst[TileOffset] = pSrc[LinearOffset];
+                }
             }
         }
     }
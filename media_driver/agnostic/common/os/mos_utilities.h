@@ -276,11 +276,16 @@ typedef enum _MOS_USER_FEATURE_VALUE_ID
     __MEDIA_USER_FEATURE_VALUE_MEDIASOLO_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_STREAM_OUT_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_CODECHAL_DEBUG_OUTPUT_DIRECTORY_ID,
+    __MEDIA_USER_FEATURE_VALUE_CODECHAL_DEBUG_ASYNC_DUMP_ID,
+    __MEDIA_USER_FEATURE_VALUE_CODECHAL_DEBUG_ASYNC_DUMP_STAGING_SIZE_ID,
 
 #endif // (_DEBUG || _RELEASE_INTERNAL)
     __MEDIA_USER_FEATURE_VALUE_STATUS_REPORTING_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_SPLIT_SCREEN_DEMO_POSITION_ID,
     __MEDIA_USER_FEATURE_VALUE_SPLIT_SCREEN_DEMO_PARAMETERS_ID,
+    __MOS_USER_FEATURE_KEY_TRACE_EVENT_OUTPUT_FILE_ID,
+    __MEDIA_USER_FEATURE_VALUE_BO_CACHE_MAX_SIZE_ID,
+    __MEDIA_USER_FEATURE_VALUE_BO_CACHE_BUDGET_ID,
 #if MOS_MESSAGES_ENABLED
     __MOS_USER_FEATURE_KEY_MESSAGE_HLT_ENABLED_ID,
     __MOS_USER_FEATURE_KEY_MESSAGE_HLT_OUTPUT_DIRECTORY_ID,
@@ -327,9 +332,11 @@ typedef enum _MOS_USER_FEATURE_VALUE_ID
     __MEDIA_USER_FEATURE_VALUE_MDF_UMD_ULT_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_MDF_CURBE_DUMP_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_MDF_SURFACE_DUMP_ENABLE_ID,
+    __MEDIA_USER_FEATURE_VALUE_MDF_COMPLETION_THREAD_ENABLE_ID,
     __VPHAL_RNDR_SSD_CONTROL_ID,
     __VPHAL_RNDR_SCOREBOARD_CONTROL_ID,
     __VPHAL_RNDR_CMFC_CONTROL_ID,
+    __VPHAL_RNDR_KERNEL_CACHE_ENABLE_ID,
 #if (_DEBUG || _RELEASE_INTERNAL)
     __VPHAL_DBG_SURF_DUMP_OUTFILE_KEY_NAME_ID,
     __VPHAL_DBG_SURF_DUMP_LOCATION_KEY_NAME_ID,
@@ -2253,8 +2260,10 @@ MOS_STATUS MOS_GetLocalTime(
     struct tm* tm);
 
 //!
-//! \brief    Wrapper function for SwizzleOffset
-//! \details  Wrapper function for SwizzleOffset in Mos 
+//! \brief    Converts a surface between linear and X/Y tiled layout
+//! \details  Converts a surface between linear and X/Y tiled layout in Mos.
+//!           Data is moved one tile line span at a time (16B for Y-major,
+//!           512B for X-major) rather than swizzling each byte.
 //! \param    [in] pSrc
 //!           Pointer to source data.
 //! \param    [out] pDst
@@ -2691,41 +2691,52 @@ MOS_STATUS VpHal_RndrUpdateStatusTableAfterSubmit(
 bool VpHal_RndrCommonIsMiBBEndNeeded(
     PMOS_INTERFACE           pOsInterface);
 
+//!
+//! \brief    Key of one direction of AVS polyphase coefficients
+//! \details  Only what the table calculation depends on is part of the key,
+//!           so formats of the same class and all upscaling factors share
+//!           entries.
+//!
 struct AvsCoeffsCacheTag
 {
     bool operator==(const AvsCoeffsCacheTag &rhs) const
     {
-        return (this->m_format              == rhs.m_format              &&
+        return (this->m_formatClass         == rhs.m_formatClass         &&
                 this->m_8TapAdaptiveEnable  == rhs.m_8TapAdaptiveEnable  &&
                 this->m_balancedFilter      == rhs.m_balancedFilter      &&
-                this->m_forcePolyPhaseCoefs == rhs.m_forcePolyPhaseCoefs &&
+                this->m_nearest             == rhs.m_nearest             &&
+                this->m_vertical            == rhs.m_vertical            &&
                 this->m_chromaSiting        == rhs.m_chromaSiting        &&
-                fabsf(this->m_scaleX - rhs.m_scaleX) < 1e-6              &&
-                fabsf(this->m_scaleY - rhs.m_scaleY) < 1e-6);
+                fabsf(this->m_scale - rhs.m_scale) < 1e-6);
     }
 
-    MOS_FORMAT  m_format;
+    uint32_t    m_formatClass;          //!< Format properties used by the table calculation
     bool        m_8TapAdaptiveEnable;
     bool        m_balancedFilter;
-    bool        m_forcePolyPhaseCoefs;
-    uint32_t    m_chromaSiting;
-    float       m_scaleX;
-    float       m_scaleY;
+    bool        m_nearest;              //!< 1x scaling with nearest mode tables
+    bool        m_vertical;
+    uint32_t    m_chromaSiting;         //!< Chroma siting bits of this direction, 0 if unused
+    float       m_scale;                //!< Scale factor clamped to 1.0
 };
 
 struct AvsCoeffsCacheEntry
 {
     AvsCoeffsCacheTag m_tag;
-    MHW_AVS_PARAMS    m_AvsParams;
+    int32_t           *m_piYCoefs;
+    int32_t           *m_piUVCoefs;
+    uint32_t          m_lastUsed;       //!< LRU stamp
     bool              m_valid;
 };
 
+//!
+//! \brief    LRU cache of AVS polyphase coefficient tables, one direction per entry
+//!
 template <int N>
 class AvsCoeffsCache
 {
 public:
     AvsCoeffsCache():
-        m_evictIndex(0),
+        m_useCount(0),
         m_YCoeffTableSize(0),
         m_UVCoeffTableSize(0)
     {
@@ -2736,59 +2747,74 @@ public:
     {
         for (int i = 0; i < N; ++i)
         {
-            VpHal_RndrCommonDestroyAVSParams(&m_entries[i].m_AvsParams);
+            MOS_SafeFreeMemory(m_entries[i].m_piYCoefs);
+            m_entries[i].m_piYCoefs = nullptr;
         }
     }
 
     void Init(int YCoeffTableSize, int UVCoeffTableSize)
     {
+        char *ptr;
+
         m_YCoeffTableSize  = YCoeffTableSize;
         m_UVCoeffTableSize = UVCoeffTableSize;
 
         for (int i = 0; i < N; i++)
         {
-            VpHal_RndrCommonInitAVSParams(&m_entries[i].m_AvsParams,
-                YCoeffTableSize,
-                UVCoeffTableSize);
+            ptr = (char*)MOS_AllocAndZeroMemory(YCoeffTableSize + UVCoeffTableSize);
+            m_entries[i].m_piYCoefs  = (int32_t*)ptr;
+            m_entries[i].m_piUVCoefs = ptr ? (int32_t*)(ptr + YCoeffTableSize) : nullptr;
+            m_entries[i].m_valid     = false;
         }
     }
 
-    const MHW_AVS_PARAMS* Find(const AvsCoeffsCacheTag &tag) const
+    const AvsCoeffsCacheEntry* Find(const AvsCoeffsCacheTag &tag)
     {
         for (int i = 0; i < N; i++)
         {
             if (m_entries[i].m_valid && m_entries[i].m_tag == tag)
             {
-                return &m_entries[i].m_AvsParams;
+                m_entries[i].m_lastUsed = ++m_useCount;
+                return &m_entries[i];
             }
         }
         return nullptr;
     }
 
-    void Insert(const AvsCoeffsCacheTag &tag, const MHW_AVS_PARAMS &params)
+    void Insert(const AvsCoeffsCacheTag &tag, const int32_t *piYCoefs, const int32_t *piUVCoefs)
     {
-        m_entries[m_evictIndex].m_tag = tag;
-        Clone(params, m_entries[m_evictIndex].m_AvsParams);
-        m_entries[m_evictIndex].m_valid = true;
-        m_evictIndex = (m_evictIndex + 1) % N;
+        AvsCoeffsCacheEntry *entry = &m_entries[0];
+
+        // Take a free entry, otherwise evict the least recently used one
+        for (int i = 0; i < N && entry->m_valid; i++)
+        {
+            if (!m_entries[i].m_valid || m_entries[i].m_lastUsed < entry->m_lastUsed)
+            {
+                entry = &m_entries[i];
+            }
+        }
+
+        if (entry->m_piYCoefs == nullptr)
+        {
+            return;
+        }
+
+        entry->m_tag      = tag;
+        entry->m_lastUsed = ++m_useCount;
+        entry->m_valid    = true;
+        MOS_SecureMemcpy(entry->m_piYCoefs, m_YCoeffTableSize, piYCoefs, m_YCoeffTableSize);
+        MOS_SecureMemcpy(entry->m_piUVCoefs, m_UVCoeffTableSize, piUVCoefs, m_UVCoeffTableSize);
     }
 
-    void Clone(const MHW_AVS_PARAMS &from, MHW_AVS_PARAMS &to)
+    void Copy(const AvsCoeffsCacheEntry &from, int32_t *piYCoefs, int32_t *piUVCoefs)
     {
-        to.Format               = from.Format;
-        to.fScaleX              = from.fScaleX;
-        to.fScaleY              = from.fScaleY;
-        to.bForcePolyPhaseCoefs = from.bForcePolyPhaseCoefs;
-
-        MOS_SecureMemcpy(to.piYCoefsX, m_YCoeffTableSize, from.piYCoefsX, m_YCoeffTableSize);
-        MOS_SecureMemcpy(to.piYCoefsY, m_YCoeffTableSize, from.piYCoefsY, m_YCoeffTableSize);
-        MOS_SecureMemcpy(to.piUVCoefsX, m_UVCoeffTableSize, from.piUVCoefsX, m_UVCoeffTableSize);
-        MOS_SecureMemcpy(to.piUVCoefsY, m_UVCoeffTableSize, from.piUVCoefsY, m_UVCoeffTableSize);
+        MOS_SecureMemcpy(piYCoefs, m_YCoeffTableSize, from.m_piYCoefs, m_YCoeffTableSize);
+        MOS_SecureMemcpy(piUVCoefs, m_UVCoeffTableSize, from.m_piUVCoefs, m_UVCoeffTableSize);
     }
 
 private:
     AvsCoeffsCacheEntry  m_entries[N];
-    int                  m_evictIndex;
+    uint32_t             m_useCount;
     int                  m_YCoeffTableSize;
     int                  m_UVCoeffTableSize;
 };
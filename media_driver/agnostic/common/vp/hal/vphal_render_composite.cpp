@@ -1108,6 +1108,100 @@ finish:
     return eStatus;
 }
 
+//!
+//! \brief    Set Horizontal or Vertical AVS scaling table
+//! \details  Takes the table from the coefficient cache, calculating and
+//!           caching it on a miss
+//! \param    [in] SrcFormat
+//!           Source Format
+//! \param    [in] fScale
+//!           Horizontal or Vertical Scale Factor
+//! \param    [in] bVertical
+//!           true if Vertical Scaling, else Horizontal Scaling
+//! \param    [in] dwChromaSiting
+//!           Chroma Siting
+//! \param    [in] bBalancedFilter
+//!           true if Gen9+, balanced filter
+//! \param    [in] b8TapAdaptiveEnable
+//!           true if 8Tap Adaptive Enable
+//! \param    [in,out] pAvsParams
+//!           Pointer to AVS Params
+//! \return   MOS_STATUS
+//!
+MOS_STATUS CompositeState::SetSamplerAvsScalingTable(
+    MOS_FORMAT                      SrcFormat,
+    float                           fScale,
+    bool                            bVertical,
+    uint32_t                        dwChromaSiting,
+    bool                            bBalancedFilter,
+    bool                            b8TapAdaptiveEnable,
+    PMHW_AVS_PARAMS                 pAvsParams)
+{
+    MOS_STATUS                      eStatus = MOS_STATUS_SUCCESS;
+    AvsCoeffsCacheTag               tag;
+    const AvsCoeffsCacheEntry       *pEntry;
+    int32_t                         *piYCoefsParam;
+    int32_t                         *piUVCoefsParam;
+
+    piYCoefsParam  = bVertical ? pAvsParams->piYCoefsY : pAvsParams->piYCoefsX;
+    piUVCoefsParam = bVertical ? pAvsParams->piUVCoefsY : pAvsParams->piUVCoefsX;
+
+    // Table is still valid
+    if (SrcFormat == pAvsParams->Format &&
+        fScale == (bVertical ? pAvsParams->fScaleY : pAvsParams->fScaleX))
+    {
+        goto finish;
+    }
+
+    // Key by what SamplerAvsCalcScalingTable depends on: the format class,
+    // the clamped scale and the chroma siting bits it actually reads
+    MOS_ZeroMemory(&tag, sizeof(tag));
+    tag.m_formatClass         = (IS_YUV_FORMAT(SrcFormat) ? 1 : 0) |
+                                ((IS_RGB32_FORMAT(SrcFormat) || SrcFormat == Format_Y410) ? 2 : 0) |
+                                ((SrcFormat == Format_AYUV) ? 4 : 0);
+    tag.m_8TapAdaptiveEnable  = b8TapAdaptiveEnable;
+    tag.m_balancedFilter      = bBalancedFilter;
+    tag.m_nearest             = (fScale == 1.0F && !pAvsParams->bForcePolyPhaseCoefs);
+    tag.m_vertical            = bVertical;
+    tag.m_scale               = tag.m_nearest ? 1.0F : MOS_MIN(1.0F, fScale);
+    if (bBalancedFilter && !b8TapAdaptiveEnable && !tag.m_nearest)
+    {
+        tag.m_chromaSiting    = dwChromaSiting & (bVertical ?
+                                (MHW_CHROMA_SITING_VERT_TOP | MHW_CHROMA_SITING_VERT_CENTER | MHW_CHROMA_SITING_VERT_BOTTOM) :
+                                (MHW_CHROMA_SITING_HORZ_LEFT | MHW_CHROMA_SITING_HORZ_CENTER | MHW_CHROMA_SITING_HORZ_RIGHT));
+    }
+
+    pEntry = m_AvsCoeffsCache.Find(tag);
+    if (pEntry)
+    {
+        m_AvsCoeffsCache.Copy(*pEntry, piYCoefsParam, piUVCoefsParam);
+        if (bVertical)
+        {
+            pAvsParams->fScaleY = fScale;
+        }
+        else
+        {
+            pAvsParams->fScaleX = fScale;
+        }
+    }
+    else
+    {
+        VPHAL_RENDER_CHK_STATUS(SamplerAvsCalcScalingTable(
+            SrcFormat,
+            fScale,
+            bVertical,
+            dwChromaSiting,
+            bBalancedFilter,
+            b8TapAdaptiveEnable,
+            pAvsParams));
+
+        m_AvsCoeffsCache.Insert(tag, piYCoefsParam, piUVCoefsParam);
+    }
+
+finish:
+    return eStatus;
+}
+
 //!
 //! \brief    Set Sampler Avs 8x8 Table
 //! \param    [in] pRenderHal
@@ -1205,49 +1299,27 @@ MOS_STATUS CompositeState::SetSamplerAvsTableParam(
         pAvsParams->fScaleY = fScaleY;
     }
 
-    AvsCoeffsCacheTag tag;
-    tag.m_format              = SrcFormat;
-    tag.m_8TapAdaptiveEnable  = pMhwSamplerAvsTableParam->b8TapAdaptiveEnable ? true : false;
-    tag.m_balancedFilter      = bBalancedFilter;
-    tag.m_forcePolyPhaseCoefs = pAvsParams->bForcePolyPhaseCoefs ? true : false;
-    tag.m_chromaSiting        = dwChromaSiting;
-    tag.m_scaleX              = fScaleX;
-    tag.m_scaleY              = fScaleY;
-
-    const MHW_AVS_PARAMS *cachedAvsParams;
-    cachedAvsParams = m_AvsCoeffsCache.Find(tag);
-
-    if (cachedAvsParams)
-    {
-        m_AvsCoeffsCache.Clone(*cachedAvsParams, *pAvsParams);
-    }
-    else
-    {
-        // Recalculate Horizontal scaling table
-        VPHAL_RENDER_CHK_STATUS(SamplerAvsCalcScalingTable(
-            SrcFormat,
-            fScaleX,
-            false,
-            dwChromaSiting,
-            bBalancedFilter,
-            pMhwSamplerAvsTableParam->b8TapAdaptiveEnable ? true : false,
-            pAvsParams));
-
-        // Recalculate Vertical scaling table
-        VPHAL_RENDER_CHK_STATUS(SamplerAvsCalcScalingTable(
-            SrcFormat,
-            fScaleY,
-            true,
-            dwChromaSiting,
-            bBalancedFilter,
-            pMhwSamplerAvsTableParam->b8TapAdaptiveEnable ? true : false,
-            pAvsParams));
-
-        // Save format used to calculate AVS parameters
-        pAvsParams->Format = SrcFormat;
+    // Recalculate Horizontal and Vertical scaling tables, taking each from the cache if possible
+    VPHAL_RENDER_CHK_STATUS(SetSamplerAvsScalingTable(
+        SrcFormat,
+        fScaleX,
+        false,
+        dwChromaSiting,
+        bBalancedFilter,
+        pMhwSamplerAvsTableParam->b8TapAdaptiveEnable ? true : false,
+        pAvsParams));
+
+    VPHAL_RENDER_CHK_STATUS(SetSamplerAvsScalingTable(
+        SrcFormat,
+        fScaleY,
+        true,
+        dwChromaSiting,
+        bBalancedFilter,
+        pMhwSamplerAvsTableParam->b8TapAdaptiveEnable ? true : false,
+        pAvsParams));
 
-        m_AvsCoeffsCache.Insert(tag, *pAvsParams);
-    }
+    // Save format used to calculate AVS parameters
+    pAvsParams->Format = SrcFormat;
 
     pMhwSamplerAvsTableParam->b4TapGY   = ((IS_RGB32_FORMAT(SrcFormat) || SrcFormat == Format_Y410 || SrcFormat == Format_AYUV) && !pMhwSamplerAvsTableParam->b8TapAdaptiveEnable);
     pMhwSamplerAvsTableParam->b4TapRBUV = (!pMhwSamplerAvsTableParam->b8TapAdaptiveEnable);
@@ -5737,20 +5809,26 @@ MOS_STATUS CompositeState::RenderPhase(
             iFilterSize,
             1);
 
-        // Search kernel
-        if (!pKernelDllState->pfnSearchKernel(pKernelDllState, pSearchState))
+        // Reuse kernel linked by an earlier process if available
+        if (!KernelDll_FindPersistentKernel(pKernelDllState, pSearchState, pFilter, iFilterSize, dwKernelHash))
         {
-            VPHAL_RENDER_ASSERTMESSAGE("Failed to find a kernel.");
-            eStatus = MOS_STATUS_UNKNOWN;
-            goto finish;
-        }
+            // Search kernel
+            if (!pKernelDllState->pfnSearchKernel(pKernelDllState, pSearchState))
+            {
+                VPHAL_RENDER_ASSERTMESSAGE("Failed to find a kernel.");
+                eStatus = MOS_STATUS_UNKNOWN;
+                goto finish;
+            }
 
-        // Build kernel
-        if (!pKernelDllState->pfnBuildKernel(pKernelDllState, pSearchState))
-        {
-            VPHAL_RENDER_ASSERTMESSAGE("Failed to build kernel.");
-            eStatus = MOS_STATUS_UNKNOWN;
-            goto finish;
+            // Build kernel
+            if (!pKernelDllState->pfnBuildKernel(pKernelDllState, pSearchState))
+            {
+                VPHAL_RENDER_ASSERTMESSAGE("Failed to build kernel.");
+                eStatus = MOS_STATUS_UNKNOWN;
+                goto finish;
+            }
+
+            KernelDll_StorePersistentKernel(pKernelDllState, pSearchState, pFilter, iFilterSize, dwKernelHash);
         }
 
         // Load resulting kernel into kernel cache
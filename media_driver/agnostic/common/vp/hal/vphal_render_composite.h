@@ -375,6 +375,35 @@ public:
         PMHW_BATCH_BUFFER             *ppBatchBuffer);
 
 protected:
+    //!
+    //! \brief    Set Horizontal or Vertical AVS scaling table
+    //! \details  Takes the table from the coefficient cache, calculating and
+    //!           caching it on a miss
+    //! \param    [in] SrcFormat
+    //!           Source Format
+    //! \param    [in] fScale
+    //!           Horizontal or Vertical Scale Factor
+    //! \param    [in] bVertical
+    //!           true if Vertical Scaling, else Horizontal Scaling
+    //! \param    [in] dwChromaSiting
+    //!           Chroma Siting
+    //! \param    [in] bBalancedFilter
+    //!           true if Gen9+, balanced filter
+    //! \param    [in] b8TapAdaptiveEnable
+    //!           true if 8Tap Adaptive Enable
+    //! \param    [in,out] pAvsParams
+    //!           Pointer to AVS Params
+    //! \return   MOS_STATUS
+    //!
+    MOS_STATUS SetSamplerAvsScalingTable(
+        MOS_FORMAT                      SrcFormat,
+        float                           fScale,
+        bool                            bVertical,
+        uint32_t                        dwChromaSiting,
+        bool                            bBalancedFilter,
+        bool                            b8TapAdaptiveEnable,
+        PMHW_AVS_PARAMS                 pAvsParams);
+
     //!
     //! \brief    Set Sampler Avs 8x8 Table
     //! \param    [in] pRenderHal
@@ -981,7 +1010,7 @@ protected:
     bool                            m_bAvsTableCoeffExtraEnabled; //!< Sampler AVS table param, bIsCoeffExtraEnabled
     bool                            m_bAvsTableBalancedFilter;    //!< Sampler AVS table param, bBalancedFilter
 
-    static const int                AVS_CACHE_SIZE = 4;           //!< AVS coefficients cache size
+    static const int                AVS_CACHE_SIZE = 16;          //!< AVS coefficients cache size (tables of one direction per entry)
     AvsCoeffsCache<AVS_CACHE_SIZE>  m_AvsCoeffsCache;             //!< AVS coefficients calculation is expensive, add cache to mitigate
 
     bool                            m_bForceNoneCpCompCall;       //!< Force None CP Comp call on demand
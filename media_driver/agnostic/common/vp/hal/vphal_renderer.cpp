@@ -1095,6 +1095,7 @@ MOS_STATUS VphalRenderer::Initialize(
     MHW_KERNEL_PARAM                    MhwKernelParam;
     Kdll_KernelCache                    *pKernelCache;
     Kdll_CacheEntry                     *pCacheEntryTable;
+    MOS_USER_FEATURE_VALUE_DATA         UserFeatureData;
 
     //---------------------------------------
     VPHAL_RENDER_CHK_NULL(pSettings);
@@ -1144,6 +1145,14 @@ MOS_STATUS VphalRenderer::Initialize(
         goto finish;
     }
 
+    // Share linked composite kernels with later processes if enabled
+    MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __VPHAL_RNDR_KERNEL_CACHE_ENABLE_ID,
+        &UserFeatureData);
+    pKernelDllState->bPersistentCache = UserFeatureData.u32Data ? true : false;
+
     // Set up SIP debug kernel if enabled
     if (m_pRenderHal->bIsaAsmDebugEnable)
     {
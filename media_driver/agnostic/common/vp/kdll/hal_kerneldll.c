@@ -3482,6 +3482,10 @@ void KernelDll_ReleaseStates(Kdll_State *pState)
     VPHAL_RENDER_FUNCTION_ENTER;
 
     if (!pState) return;
+    if (pState->pPersistentCache)
+    {
+        KernelDll_UnmapPersistentCache(pState->pPersistentCache, pState->dwPersistentCacheSize);
+    }
     KernelDll_ReleaseAdditionalCacheEntries(&pState->KernelCache);
     MOS_FreeMemory(pState->ComponentKernelCache.pCache);
     MOS_FreeMemory(pState->pSortedRules);
@@ -4322,6 +4326,346 @@ KernelDll_AddKernel(Kdll_State       *pState,           // Kernel Dll state
 }
 
 
+//--------------------------------------------------------------
+// KernelDll_GetPersistentRecordSize - Size of a persistent cache record
+//--------------------------------------------------------------
+static uint32_t KernelDll_GetPersistentRecordSize(
+    int32_t iFilterSize,
+    int32_t iSearchFilterSize,
+    int32_t iKernelSize)
+{
+    uint32_t dwSize;
+
+    dwSize  = sizeof(Kdll_PersistentCacheEntry);
+    dwSize += (iFilterSize + iSearchFilterSize) * sizeof(Kdll_FilterEntry);
+    dwSize += sizeof(Kdll_CSC_Params);
+    dwSize += iKernelSize;
+
+    return MOS_ALIGN_CEIL(dwSize, sizeof(uint32_t));
+}
+
+//--------------------------------------------------------------
+// KernelDll_ValidatePersistentCache - Check header and record bounds
+//                                     of a persistent cache file
+//--------------------------------------------------------------
+static bool KernelDll_ValidatePersistentCache(
+    Kdll_State    *pState,
+    const uint8_t *pData,
+    uint32_t       dwSize)
+{
+    const Kdll_PersistentCacheHeader *pHeader;
+    const Kdll_PersistentCacheEntry  *pEntry;
+    uint32_t dwOffset;
+    uint32_t i;
+
+    if (!pData || dwSize < sizeof(Kdll_PersistentCacheHeader))
+    {
+        return false;
+    }
+
+    pHeader = (const Kdll_PersistentCacheHeader *)pData;
+    if (pHeader->dwMagic           != DL_PERSISTENT_CACHE_MAGIC   ||
+        pHeader->dwVersion         != DL_PERSISTENT_CACHE_VERSION ||
+        pHeader->dwComponentHash   != pState->dwComponentHash     ||
+        pHeader->dwFilterEntrySize != sizeof(Kdll_FilterEntry)    ||
+        pHeader->dwCscParamsSize   != sizeof(Kdll_CSC_Params))
+    {
+        return false;
+    }
+
+    // Records are trusted by lookups only after every one has been bounds checked
+    dwOffset = sizeof(Kdll_PersistentCacheHeader);
+    for (i = 0; i < pHeader->dwEntryCount; i++)
+    {
+        if (dwSize - dwOffset < sizeof(Kdll_PersistentCacheEntry))
+        {
+            return false;
+        }
+
+        pEntry = (const Kdll_PersistentCacheEntry *)(pData + dwOffset);
+        if (pEntry->iFilterSize       <= 0 || pEntry->iFilterSize       > DL_MAX_SEARCH_FILTER_SIZE ||
+            pEntry->iSearchFilterSize <= 0 || pEntry->iSearchFilterSize > DL_MAX_SEARCH_FILTER_SIZE ||
+            pEntry->iKernelSize       <= 0 || pEntry->iKernelSize       > DL_MAX_KERNEL_SIZE        ||
+            pEntry->dwSize != KernelDll_GetPersistentRecordSize(pEntry->iFilterSize, pEntry->iSearchFilterSize, pEntry->iKernelSize) ||
+            pEntry->dwSize > dwSize - dwOffset)
+        {
+            return false;
+        }
+
+        dwOffset += pEntry->dwSize;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------
+// KernelDll_OpenPersistentCache - Map the persistent cache file on
+//                                 first use
+//--------------------------------------------------------------
+static void KernelDll_OpenPersistentCache(Kdll_State *pState)
+{
+    char                  szPath[MOS_MAX_PATH_LENGTH];
+    const Kdll_RuleEntry *pRule;
+    uint32_t              dwHash;
+    int32_t               iCount;
+
+    if (pState->bPersistentCacheOpened)
+    {
+        return;
+    }
+    pState->bPersistentCacheOpened = true;
+
+    // Linked kernels depend on the component kernels, the CMFC patches and the rules
+    dwHash = KernelDll_SimpleHash(pState->ComponentKernelCache.pCache, pState->ComponentKernelCache.iCacheSize);
+    if (pState->bEnableCMFC)
+    {
+        dwHash = (dwHash * 0x1000193) ^ KernelDll_SimpleHash(pState->CmFcPatchCache.pCache, pState->CmFcPatchCache.iCacheSize);
+    }
+    for (pRule = pState->pRuleTableDefault, iCount = 1; pRule && pRule->id != RID_Op_EOF; pRule++)
+    {
+        iCount++;
+    }
+    if (pState->pRuleTableDefault)
+    {
+        dwHash = (dwHash * 0x1000193) ^ KernelDll_SimpleHash((void *)pState->pRuleTableDefault, iCount * sizeof(Kdll_RuleEntry));
+    }
+    pState->dwComponentHash = dwHash;
+
+    if (!KernelDll_GetPersistentCachePath(szPath, sizeof(szPath)))
+    {
+        return;
+    }
+
+    pState->pPersistentCache = KernelDll_MapPersistentCache(szPath, &pState->dwPersistentCacheSize);
+    if (pState->pPersistentCache &&
+        !KernelDll_ValidatePersistentCache(pState, pState->pPersistentCache, pState->dwPersistentCacheSize))
+    {
+        VPHAL_RENDER_NORMALMESSAGE("Ignoring stale or invalid persistent kernel cache.");
+        KernelDll_UnmapPersistentCache(pState->pPersistentCache, pState->dwPersistentCacheSize);
+        pState->pPersistentCache      = nullptr;
+        pState->dwPersistentCacheSize = 0;
+    }
+}
+
+//--------------------------------------------------------------
+// KernelDll_FindPersistentRecord - Find record matching the
+//                                  original filter in a validated file
+//--------------------------------------------------------------
+static const Kdll_PersistentCacheEntry *KernelDll_FindPersistentRecord(
+    const uint8_t    *pData,
+    Kdll_FilterEntry *pFilter,
+    int32_t           iFilterSize,
+    uint32_t          dwHash)
+{
+    const Kdll_PersistentCacheHeader *pHeader = (const Kdll_PersistentCacheHeader *)pData;
+    const Kdll_PersistentCacheEntry  *pEntry;
+    uint32_t dwOffset = sizeof(Kdll_PersistentCacheHeader);
+    uint32_t i;
+
+    for (i = 0; i < pHeader->dwEntryCount; i++, dwOffset += pEntry->dwSize)
+    {
+        pEntry = (const Kdll_PersistentCacheEntry *)(pData + dwOffset);
+        if (pEntry->dwHash      == dwHash      &&
+            pEntry->iFilterSize == iFilterSize &&
+            memcmp(pEntry + 1, pFilter, iFilterSize * sizeof(Kdll_FilterEntry)) == 0)
+        {
+            return pEntry;
+        }
+    }
+
+    return nullptr;
+}
+
+//--------------------------------------------------------------
+// KernelDll_FindPersistentKernel - Load kernel linked by an earlier
+//                                  process from the persistent cache
+//--------------------------------------------------------------
+bool KernelDll_FindPersistentKernel(
+    Kdll_State       *pState,
+    Kdll_SearchState *pSearchState,
+    Kdll_FilterEntry *pFilter,
+    int32_t           iFilterSize,
+    uint32_t          dwHash)
+{
+    const Kdll_PersistentCacheEntry *pEntry;
+    const uint8_t                   *ptr;
+
+    VPHAL_RENDER_FUNCTION_ENTER;
+
+    if (!pState->bPersistentCache)
+    {
+        return false;
+    }
+
+    KernelDll_OpenPersistentCache(pState);
+    if (!pState->pPersistentCache)
+    {
+        return false;
+    }
+
+    pEntry = KernelDll_FindPersistentRecord(pState->pPersistentCache, pFilter, iFilterSize, dwHash);
+    if (!pEntry)
+    {
+        return false;
+    }
+
+    // Restore what search and build would have produced
+    ptr = (const uint8_t *)(pEntry + 1) + pEntry->iFilterSize * sizeof(Kdll_FilterEntry);
+
+    pSearchState->iFilterSize = pEntry->iSearchFilterSize;
+    MOS_SecureMemcpy(pSearchState->Filter, sizeof(pSearchState->Filter), (void *)ptr, pEntry->iSearchFilterSize * sizeof(Kdll_FilterEntry));
+    ptr += pEntry->iSearchFilterSize * sizeof(Kdll_FilterEntry);
+
+    MOS_SecureMemcpy(&pSearchState->CscParams, sizeof(Kdll_CSC_Params), (void *)ptr, sizeof(Kdll_CSC_Params));
+    ptr += sizeof(Kdll_CSC_Params);
+
+    pSearchState->KernelSize = pEntry->iKernelSize;
+    MOS_SecureMemcpy(pSearchState->Kernel, sizeof(pSearchState->Kernel), (void *)ptr, pEntry->iKernelSize);
+
+    return true;
+}
+
+//--------------------------------------------------------------
+// KernelDll_StorePersistentKernel - Save kernel built in the search
+//                                   state to the persistent cache
+//--------------------------------------------------------------
+void KernelDll_StorePersistentKernel(
+    Kdll_State       *pState,
+    Kdll_SearchState *pSearchState,
+    Kdll_FilterEntry *pFilter,
+    int32_t           iFilterSize,
+    uint32_t          dwHash)
+{
+    char                        szPath[MOS_MAX_PATH_LENGTH];
+    Kdll_PersistentCacheHeader *pHeader;
+    Kdll_PersistentCacheEntry  *pEntry;
+    const uint8_t              *pOld      = nullptr;
+    uint32_t                    dwOldSize = 0;
+    uint32_t                    dwOldOffset;
+    uint32_t                    dwOldCount;
+    uint32_t                    dwRecordSize;
+    uint8_t                    *pData     = nullptr;
+    uint8_t                    *ptr;
+    int32_t                     i;
+
+    VPHAL_RENDER_FUNCTION_ENTER;
+
+    if (!pState->bPersistentCache ||
+        pSearchState->KernelSize <= 0 ||
+        iFilterSize <= 0 || iFilterSize > DL_MAX_SEARCH_FILTER_SIZE)
+    {
+        return;
+    }
+
+    // Procamp coefficients and versions are per process, keep those kernels local
+    for (i = 0; i < DL_CSC_MAX; i++)
+    {
+        if (pSearchState->CscParams.Matrix[i].bInUse &&
+            pSearchState->CscParams.Matrix[i].iProcampID != DL_PROCAMP_DISABLED)
+        {
+            return;
+        }
+    }
+
+    KernelDll_OpenPersistentCache(pState);
+    if (!KernelDll_GetPersistentCachePath(szPath, sizeof(szPath)))
+    {
+        return;
+    }
+
+    // Merge with the current file, other processes may have added kernels since it was mapped
+    pOld = KernelDll_MapPersistentCache(szPath, &dwOldSize);
+    if (pOld && !KernelDll_ValidatePersistentCache(pState, pOld, dwOldSize))
+    {
+        KernelDll_UnmapPersistentCache((uint8_t *)pOld, dwOldSize);
+        pOld      = nullptr;
+        dwOldSize = 0;
+    }
+
+    if (pOld && KernelDll_FindPersistentRecord(pOld, pFilter, iFilterSize, dwHash))
+    {
+        goto finish;
+    }
+
+    // Drop the oldest records until the new one fits
+    dwRecordSize = KernelDll_GetPersistentRecordSize(iFilterSize, pSearchState->iFilterSize, pSearchState->KernelSize);
+    dwOldOffset  = sizeof(Kdll_PersistentCacheHeader);
+    dwOldCount   = pOld ? ((const Kdll_PersistentCacheHeader *)pOld)->dwEntryCount : 0;
+    dwOldSize    = pOld ? dwOldSize : dwOldOffset;
+    while (dwOldCount > 0 &&
+           dwOldSize - dwOldOffset + sizeof(Kdll_PersistentCacheHeader) + dwRecordSize > DL_PERSISTENT_CACHE_MAX_SIZE)
+    {
+        dwOldOffset += ((const Kdll_PersistentCacheEntry *)(pOld + dwOldOffset))->dwSize;
+        dwOldCount--;
+    }
+
+    pData = (uint8_t *)MOS_AllocAndZeroMemory(sizeof(Kdll_PersistentCacheHeader) + (dwOldSize - dwOldOffset) + dwRecordSize);
+    if (!pData)
+    {
+        goto finish;
+    }
+
+    pHeader = (Kdll_PersistentCacheHeader *)pData;
+    pHeader->dwMagic           = DL_PERSISTENT_CACHE_MAGIC;
+    pHeader->dwVersion         = DL_PERSISTENT_CACHE_VERSION;
+    pHeader->dwComponentHash   = pState->dwComponentHash;
+    pHeader->dwFilterEntrySize = sizeof(Kdll_FilterEntry);
+    pHeader->dwCscParamsSize   = sizeof(Kdll_CSC_Params);
+    pHeader->dwEntryCount      = dwOldCount + 1;
+    ptr = (uint8_t *)(pHeader + 1);
+
+    if (dwOldSize > dwOldOffset)
+    {
+        MOS_SecureMemcpy(ptr, dwOldSize - dwOldOffset, (void *)(pOld + dwOldOffset), dwOldSize - dwOldOffset);
+        ptr += dwOldSize - dwOldOffset;
+    }
+
+    pEntry = (Kdll_PersistentCacheEntry *)ptr;
+    pEntry->dwSize            = dwRecordSize;
+    pEntry->dwHash            = dwHash;
+    pEntry->iFilterSize       = iFilterSize;
+    pEntry->iSearchFilterSize = pSearchState->iFilterSize;
+    pEntry->iKernelSize       = pSearchState->KernelSize;
+    ptr = (uint8_t *)(pEntry + 1);
+
+    MOS_SecureMemcpy(ptr, iFilterSize * sizeof(Kdll_FilterEntry), (void *)pFilter, iFilterSize * sizeof(Kdll_FilterEntry));
+    ptr += iFilterSize * sizeof(Kdll_FilterEntry);
+    MOS_SecureMemcpy(ptr, pSearchState->iFilterSize * sizeof(Kdll_FilterEntry), (void *)pSearchState->Filter, pSearchState->iFilterSize * sizeof(Kdll_FilterEntry));
+    ptr += pSearchState->iFilterSize * sizeof(Kdll_FilterEntry);
+    MOS_SecureMemcpy(ptr, sizeof(Kdll_CSC_Params), (void *)&pSearchState->CscParams, sizeof(Kdll_CSC_Params));
+    ptr += sizeof(Kdll_CSC_Params);
+    MOS_SecureMemcpy(ptr, pSearchState->KernelSize, (void *)pSearchState->Kernel, pSearchState->KernelSize);
+
+    // The file is replaced atomically, existing mappings keep the old contents
+    if (!KernelDll_WritePersistentCache(szPath, pData, sizeof(Kdll_PersistentCacheHeader) + (dwOldSize - dwOldOffset) + dwRecordSize))
+    {
+        VPHAL_RENDER_NORMALMESSAGE("Failed to update persistent kernel cache.");
+        goto finish;
+    }
+
+    // Switch to the new file
+    if (pState->pPersistentCache)
+    {
+        KernelDll_UnmapPersistentCache(pState->pPersistentCache, pState->dwPersistentCacheSize);
+    }
+    pState->pPersistentCache = KernelDll_MapPersistentCache(szPath, &pState->dwPersistentCacheSize);
+    if (pState->pPersistentCache &&
+        !KernelDll_ValidatePersistentCache(pState, pState->pPersistentCache, pState->dwPersistentCacheSize))
+    {
+        KernelDll_UnmapPersistentCache(pState->pPersistentCache, pState->dwPersistentCacheSize);
+        pState->pPersistentCache      = nullptr;
+        pState->dwPersistentCacheSize = 0;
+    }
+
+finish:
+    if (pOld)
+    {
+        KernelDll_UnmapPersistentCache((uint8_t *)pOld, dwOldSize);
+    }
+    MOS_FreeMemory(pData);
+}
+
+
 //--------------------------------------------------------------
 // KernelDll_BuildKernel - build kernel
 //--------------------------------------------------------------
@@ -69,6 +69,10 @@
 #define DL_CACHE_BLOCK_SIZE             98304    // Kernel allocation block size
 #define DL_MAX_KERNEL_SIZE              98304    // max output kernel size
 
+#define DL_PERSISTENT_CACHE_MAGIC       0x434c444b          // 'KDLC'
+#define DL_PERSISTENT_CACHE_VERSION     1                   // Bump on any change to the file layout
+#define DL_PERSISTENT_CACHE_MAX_SIZE    (8 * 1024 * 1024)   // Max size of the persistent kernel cache file
+
 #define DL_PROCAMP_DISABLED             -1       // procamp is disabled
 #define DL_PROCAMP_MAX                   1       // 1 Procamp entry
 
@@ -589,6 +593,31 @@ typedef struct tagKdll_KernelHashTable
     Kdll_KernelHashEntry HashEntry[DL_MAX_COMBINED_KERNELS]; // Hash table entries
 } Kdll_KernelHashTable;
 
+//--------------------------------------------------------------
+// Persistent kernel cache file
+//--------------------------------------------------------------
+// File layout: header followed by dwEntryCount variable size records. Each
+// record holds the original filter (search key), the modified filter, the CSC
+// parameters and the linked kernel, padded to 4 bytes.
+typedef struct tagKdll_PersistentCacheHeader
+{
+    uint32_t            dwMagic;            // DL_PERSISTENT_CACHE_MAGIC
+    uint32_t            dwVersion;          // DL_PERSISTENT_CACHE_VERSION
+    uint32_t            dwComponentHash;    // Hash of component kernels, patches and rules
+    uint32_t            dwFilterEntrySize;  // sizeof(Kdll_FilterEntry)
+    uint32_t            dwCscParamsSize;    // sizeof(Kdll_CSC_Params)
+    uint32_t            dwEntryCount;       // Number of records
+} Kdll_PersistentCacheHeader;
+
+typedef struct tagKdll_PersistentCacheEntry
+{
+    uint32_t            dwSize;             // Record size including this header
+    uint32_t            dwHash;             // Hash of the original filter
+    int32_t             iFilterSize;        // Original filter size
+    int32_t             iSearchFilterSize;  // Modified filter size
+    int32_t             iKernelSize;        // Linked kernel size
+} Kdll_PersistentCacheEntry;
+
 //--------------------------------------------------------------
 // Dynamic linking state
 //--------------------------------------------------------------
@@ -627,6 +656,13 @@ typedef struct tagKdll_State
     Kdll_Procamp            *pProcamp;              // Array of Procamp parameters
     int32_t                 iProcampSize;           // Size of the array of Procamp parameters
 
+    // Persistent kernel cache, shared read-only across processes
+    bool                    bPersistentCache;       // Persistent kernel cache enabled
+    bool                    bPersistentCacheOpened; // Lazy open of the cache file attempted
+    uint32_t                dwComponentHash;        // Hash of component kernels, patches and rules
+    uint8_t                 *pPersistentCache;      // Read-only mapping of the cache file
+    uint32_t                dwPersistentCacheSize;  // Size of the mapping
+
     // Start kernel search
     void                 (* pfnStartKernelSearch)(PKdll_State       pState,
                                                   PKdll_SearchState pSearchState,
@@ -867,6 +903,27 @@ bool KernelDll_SetupCSC(
     Kdll_SearchState *pSearchState);
 
 bool KernelDll_IsSameFormatType(MOS_FORMAT   format1, MOS_FORMAT   format2);
+
+// Load a kernel linked by an earlier process from the persistent cache into pSearchState
+bool KernelDll_FindPersistentKernel(Kdll_State       *pState,
+                                    Kdll_SearchState *pSearchState,
+                                    Kdll_FilterEntry *pFilter,
+                                    int               iFilterSize,
+                                    uint32_t          dwHash);
+
+// Save the kernel built in pSearchState to the persistent cache
+void KernelDll_StorePersistentKernel(Kdll_State       *pState,
+                                     Kdll_SearchState *pSearchState,
+                                     Kdll_FilterEntry *pFilter,
+                                     int               iFilterSize,
+                                     uint32_t          dwHash);
+
+// Persistent cache file access, implemented per OS
+bool KernelDll_GetPersistentCachePath(char *pcPath, uint32_t dwSize);
+uint8_t *KernelDll_MapPersistentCache(const char *pcPath, uint32_t *pdwSize);
+void KernelDll_UnmapPersistentCache(uint8_t *pData, uint32_t dwSize);
+bool KernelDll_WritePersistentCache(const char *pcPath, const uint8_t *pData, uint32_t dwSize);
+
 void KernelDll_ReleaseHashEntry(Kdll_KernelHashTable *pHashTable, uint16_t entry);
 void KernelDll_ReleaseCacheEntry(Kdll_KernelCache *pCache, Kdll_CacheEntry  *pEntry);
 
@@ -79,6 +79,32 @@ finish:
     return result;
 }
 
+//*-----------------------------------------------------------------------------
+//! Take a reference on the bo of a task still running on GPU, so that it can be
+//! waited on without holding any CM lock.
+//! INPUT:
+//!     Reference to the bo in a void * format
+//! OUTPUT:
+//!     CM_SUCCESS: if data refers to a referenced bo, caller must unreference it
+//!     CM_FAILURE: if the task is already done or has no bo, data is set to nullptr
+//*-----------------------------------------------------------------------------
+int32_t CmEventRT::ReferenceTaskOsData(void  *&data)
+{
+    CLock Lock(m_CriticalSection_Query);
+
+    data = nullptr;
+    if ((m_Status != CM_STATUS_FLUSHED && m_Status != CM_STATUS_STARTED) ||
+        m_OsData == nullptr)
+    {
+        return CM_FAILURE;
+    }
+
+    mos_bo_reference((MOS_LINUX_BO*)m_OsData);
+    data = m_OsData;
+
+    return CM_SUCCESS;
+}
+
 //*-----------------------------------------------------------------------------
 //! Unreference the bo in linux.
 //! INPUT:
@@ -28,11 +28,17 @@
 #include <iostream>
 #include "cpuid.h"
 #include <smmintrin.h>
+#include <immintrin.h>
 
 typedef uintptr_t           UINT_PTR;
 #define __fastcall
 #define __noop
 
+// Compile individual functions for instruction sets above the build baseline,
+// callers dispatch on GetCpuInstructionLevel()
+#define CM_TARGET_AVX2      __attribute__((target("avx2")))
+#define CM_TARGET_AVX512    __attribute__((target("avx512f")))
+
 #ifdef __try
     #undef __try
 #endif
@@ -138,6 +144,301 @@ inline void GetCPUID(int CPUInfo[4], int InfoType)
 }
 
 
+/*****************************************************************************\
+Inline Function:
+    GetCPUIDEx
+
+Description:
+    Retrieves cpu information and capabilities for leaves with sub-leaves
+Input:
+    int InfoType - type of information requested
+    int SubLeaf - sub-leaf of the requested information
+Output:
+    int CPUInfo[4] - requested info, left untouched if the leaf is not supported
+\*****************************************************************************/
+inline void GetCPUIDEx(int CPUInfo[4], int InfoType, int SubLeaf)
+{
+    if (__get_cpuid_max(0, nullptr) < (unsigned int)InfoType)
+    {
+        return;
+    }
+
+    __cpuid_count(InfoType, SubLeaf, CPUInfo[0], CPUInfo[1], CPUInfo[2], CPUInfo[3]);
+}
+
+/*****************************************************************************\
+Inline Function:
+    GetXCR0
+
+Description:
+    Reads the XFEATURE_ENABLED_MASK register. Only valid if CPUID reports OSXSAVE.
+Output:
+    uint64_t - register states saved by the OS
+\*****************************************************************************/
+inline uint64_t GetXCR0( void )
+{
+    uint32_t eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+}
+
+/*****************************************************************************\
+Inline Function:
+    FastMemCopy_AVX2
+
+Description:
+    Memory Copy function using 256-bit Advanced Vector Extensions 2
+Input:
+    dst - pointer to destination buffer
+    src - pointer to source buffer
+    bytes - number of bytes to copy, at least 64
+    streaming - bypass the cache when writing the destination
+\*****************************************************************************/
+inline CM_TARGET_AVX2 void FastMemCopy_AVX2( void* dst, const void* src, const size_t bytes, const bool streaming )
+{
+    uint8_t *p_dst = (uint8_t*)dst;
+    uint8_t *p_src = (uint8_t*)src;
+    size_t  count  = bytes;
+
+    CM_ASSERT( bytes >= sizeof(DHWORD) );
+
+    if( streaming )
+    {
+        // Streaming stores must be 32-byte aligned, the head is covered by one unaligned store
+        const size_t alignBytes = GetAlignmentOffset( p_dst, sizeof(__m256i) );
+        if( alignBytes )
+        {
+            _mm256_storeu_si256( (__m256i*)p_dst, _mm256_loadu_si256( (const __m256i*)p_src ) );
+            p_dst += alignBytes;
+            p_src += alignBytes;
+            count -= alignBytes;
+        }
+
+        // Copies a cacheline per loop iteration
+        while( count >= sizeof(DHWORD) )
+        {
+            Prefetch( p_src + 4 * sizeof(DHWORD) );
+
+            __m256i ymm0 = _mm256_loadu_si256( (const __m256i*)p_src );
+            __m256i ymm1 = _mm256_loadu_si256( (const __m256i*)p_src + 1 );
+            _mm256_stream_si256( (__m256i*)p_dst, ymm0 );
+            _mm256_stream_si256( (__m256i*)p_dst + 1, ymm1 );
+
+            p_dst += sizeof(DHWORD);
+            p_src += sizeof(DHWORD);
+            count -= sizeof(DHWORD);
+        }
+
+        // Make the streaming stores globally visible before returning
+        _mm_sfence();
+    }
+    else
+    {
+        while( count >= sizeof(DHWORD) )
+        {
+            __m256i ymm0 = _mm256_loadu_si256( (const __m256i*)p_src );
+            __m256i ymm1 = _mm256_loadu_si256( (const __m256i*)p_src + 1 );
+            _mm256_storeu_si256( (__m256i*)p_dst, ymm0 );
+            _mm256_storeu_si256( (__m256i*)p_dst + 1, ymm1 );
+
+            p_dst += sizeof(DHWORD);
+            p_src += sizeof(DHWORD);
+            count -= sizeof(DHWORD);
+        }
+    }
+
+    // Copy remaining uint8_t(s)
+    if( count )
+    {
+        CmSafeMemCopy( p_dst, p_src, count );
+    }
+}
+
+/*****************************************************************************\
+Inline Function:
+    FastMemCopy_AVX512
+
+Description:
+    Memory Copy function using 512-bit Advanced Vector Extensions
+Input:
+    dst - pointer to destination buffer
+    src - pointer to source buffer
+    bytes - number of bytes to copy, at least 64
+    streaming - bypass the cache when writing the destination
+\*****************************************************************************/
+inline CM_TARGET_AVX512 void FastMemCopy_AVX512( void* dst, const void* src, const size_t bytes, const bool streaming )
+{
+    uint8_t *p_dst = (uint8_t*)dst;
+    uint8_t *p_src = (uint8_t*)src;
+    size_t  count  = bytes;
+
+    CM_ASSERT( bytes >= sizeof(DHWORD) );
+
+    if( streaming )
+    {
+        // Streaming stores must be 64-byte aligned, the head is covered by one unaligned store
+        const size_t alignBytes = GetAlignmentOffset( p_dst, sizeof(__m512i) );
+        if( alignBytes )
+        {
+            _mm512_storeu_si512( p_dst, _mm512_loadu_si512( p_src ) );
+            p_dst += alignBytes;
+            p_src += alignBytes;
+            count -= alignBytes;
+        }
+
+        // Copies two cachelines per loop iteration
+        while( count >= 2 * sizeof(DHWORD) )
+        {
+            Prefetch( p_src + 4 * sizeof(DHWORD) );
+            Prefetch( p_src + 5 * sizeof(DHWORD) );
+
+            __m512i zmm0 = _mm512_loadu_si512( p_src );
+            __m512i zmm1 = _mm512_loadu_si512( p_src + sizeof(DHWORD) );
+            _mm512_stream_si512( (__m512i*)p_dst, zmm0 );
+            _mm512_stream_si512( (__m512i*)(p_dst + sizeof(DHWORD)), zmm1 );
+
+            p_dst += 2 * sizeof(DHWORD);
+            p_src += 2 * sizeof(DHWORD);
+            count -= 2 * sizeof(DHWORD);
+        }
+
+        if( count >= sizeof(DHWORD) )
+        {
+            _mm512_stream_si512( (__m512i*)p_dst, _mm512_loadu_si512( p_src ) );
+
+            p_dst += sizeof(DHWORD);
+            p_src += sizeof(DHWORD);
+            count -= sizeof(DHWORD);
+        }
+
+        // Make the streaming stores globally visible before returning
+        _mm_sfence();
+    }
+    else
+    {
+        while( count >= sizeof(DHWORD) )
+        {
+            _mm512_storeu_si512( p_dst, _mm512_loadu_si512( p_src ) );
+
+            p_dst += sizeof(DHWORD);
+            p_src += sizeof(DHWORD);
+            count -= sizeof(DHWORD);
+        }
+    }
+
+    // Copy remaining uint8_t(s)
+    if( count )
+    {
+        CmSafeMemCopy( p_dst, p_src, count );
+    }
+}
+
+/*****************************************************************************\
+Inline Function:
+    FastMemCopyFromWC_AVX2
+
+Description:
+    Copies whole cachelines out of write-combined memory with 256-bit streaming loads
+Input:
+    dst - pointer to destination buffer
+    src - 64-byte aligned pointer to write-combined source buffer
+    doubleHexWords - number of DHWORDs to copy
+\*****************************************************************************/
+inline CM_TARGET_AVX2 void FastMemCopyFromWC_AVX2( void* dst, const void* src, const size_t doubleHexWords )
+{
+    __m256i *pMMSrc  = (__m256i*)src;
+    __m256i *pMMDest = (__m256i*)dst;
+    size_t  count    = doubleHexWords;
+
+    CM_ASSERT( IsAligned( (void*)src, sizeof(DHWORD) ) );
+
+    // Sync the WC memory data before issuing the streaming loads
+    _mm_mfence();
+
+    // Keep four cachelines in flight to use all streaming load buffers
+    while( count >= 4 )
+    {
+        __m256i ymm0 = _mm256_stream_load_si256( pMMSrc );
+        __m256i ymm1 = _mm256_stream_load_si256( pMMSrc + 1 );
+        __m256i ymm2 = _mm256_stream_load_si256( pMMSrc + 2 );
+        __m256i ymm3 = _mm256_stream_load_si256( pMMSrc + 3 );
+        __m256i ymm4 = _mm256_stream_load_si256( pMMSrc + 4 );
+        __m256i ymm5 = _mm256_stream_load_si256( pMMSrc + 5 );
+        __m256i ymm6 = _mm256_stream_load_si256( pMMSrc + 6 );
+        __m256i ymm7 = _mm256_stream_load_si256( pMMSrc + 7 );
+        pMMSrc += 8;
+
+        _mm256_storeu_si256( pMMDest, ymm0 );
+        _mm256_storeu_si256( pMMDest + 1, ymm1 );
+        _mm256_storeu_si256( pMMDest + 2, ymm2 );
+        _mm256_storeu_si256( pMMDest + 3, ymm3 );
+        _mm256_storeu_si256( pMMDest + 4, ymm4 );
+        _mm256_storeu_si256( pMMDest + 5, ymm5 );
+        _mm256_storeu_si256( pMMDest + 6, ymm6 );
+        _mm256_storeu_si256( pMMDest + 7, ymm7 );
+        pMMDest += 8;
+
+        count -= 4;
+    }
+
+    while( count-- )
+    {
+        __m256i ymm0 = _mm256_stream_load_si256( pMMSrc );
+        __m256i ymm1 = _mm256_stream_load_si256( pMMSrc + 1 );
+        pMMSrc += 2;
+
+        _mm256_storeu_si256( pMMDest, ymm0 );
+        _mm256_storeu_si256( pMMDest + 1, ymm1 );
+        pMMDest += 2;
+    }
+}
+
+/*****************************************************************************\
+Inline Function:
+    FastMemCopyFromWC_AVX512
+
+Description:
+    Copies whole cachelines out of write-combined memory with 512-bit streaming loads
+Input:
+    dst - pointer to destination buffer
+    src - 64-byte aligned pointer to write-combined source buffer
+    doubleHexWords - number of DHWORDs to copy
+\*****************************************************************************/
+inline CM_TARGET_AVX512 void FastMemCopyFromWC_AVX512( void* dst, const void* src, const size_t doubleHexWords )
+{
+    __m512i *pMMSrc  = (__m512i*)src;
+    __m512i *pMMDest = (__m512i*)dst;
+    size_t  count    = doubleHexWords;
+
+    CM_ASSERT( IsAligned( (void*)src, sizeof(DHWORD) ) );
+
+    // Sync the WC memory data before issuing the streaming loads
+    _mm_mfence();
+
+    // Keep four cachelines in flight to use all streaming load buffers
+    while( count >= 4 )
+    {
+        __m512i zmm0 = _mm512_stream_load_si512( pMMSrc );
+        __m512i zmm1 = _mm512_stream_load_si512( pMMSrc + 1 );
+        __m512i zmm2 = _mm512_stream_load_si512( pMMSrc + 2 );
+        __m512i zmm3 = _mm512_stream_load_si512( pMMSrc + 3 );
+        pMMSrc += 4;
+
+        _mm512_storeu_si512( pMMDest, zmm0 );
+        _mm512_storeu_si512( pMMDest + 1, zmm1 );
+        _mm512_storeu_si512( pMMDest + 2, zmm2 );
+        _mm512_storeu_si512( pMMDest + 3, zmm3 );
+        pMMDest += 4;
+
+        count -= 4;
+    }
+
+    while( count-- )
+    {
+        _mm512_storeu_si512( pMMDest++, _mm512_stream_load_si512( pMMSrc++ ) );
+    }
+}
+
 /*****************************************************************************\
 Inline Function:
     CmFastMemCopyFromWC
@@ -180,7 +481,22 @@ inline void CmFastMemCopyFromWC( void* dst, const void* src, const size_t bytes,
             // Get the number of bytes to be copied (rounded down to nearets DHWORD)
             const size_t DoubleHexWordsToCopy = count / sizeof(DHWORD);
 
-            if( DoubleHexWordsToCopy )
+            if( DoubleHexWordsToCopy && cpuInstructionLevel >= CPU_INSTRUCTION_LEVEL_AVX2 )
+            {
+                if( cpuInstructionLevel >= CPU_INSTRUCTION_LEVEL_AVX512 )
+                {
+                    FastMemCopyFromWC_AVX512( p_dst, p_src, DoubleHexWordsToCopy );
+                }
+                else
+                {
+                    FastMemCopyFromWC_AVX2( p_dst, p_src, DoubleHexWordsToCopy );
+                }
+
+                p_dst += DoubleHexWordsToCopy * sizeof(DHWORD);
+                p_src += DoubleHexWordsToCopy * sizeof(DHWORD);
+                count -= DoubleHexWordsToCopy * sizeof(DHWORD);
+            }
+            else if( DoubleHexWordsToCopy )
             {
                 // Determine if the destination address is aligned
                 const bool isDstDoubleQuadWordAligned =
@@ -0,0 +1,75 @@
+/*
+* Copyright (c) 2017, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      cm_queue_rt_os.cpp
+//! \brief     Contains Linux-dependent CmQueueRT member functions.
+//!
+
+#include "cm_queue_rt.h"
+#include "cm_event_rt.h"
+#include "cm_task_internal.h"
+
+//*-----------------------------------------------------------------------------
+//! Block until the oldest task in the flushed queue finishes on GPU, or the
+//! timeout expires. The wait sleeps in KMD on the task's command buffer bo,
+//! the flushed queue itself is not modified.
+//! INPUT:
+//!     Timeout in Milliseconds
+//! OUTPUT:
+//!     CM_SUCCESS:  if the bo is idle
+//!     CM_EXCEED_MAX_TIMEOUT:  if the bo is still busy when the timeout expires
+//!     CM_FAILURE:  if there is no running task with a bo to wait on
+//*-----------------------------------------------------------------------------
+int32_t CmQueueRT::WaitForOldestFlushedTask(uint32_t dwTimeOutMs)
+{
+    CmTaskInternal *pTask  = nullptr;
+    CmEventRT      *pEvent = nullptr;
+    void           *pData  = nullptr;
+    int32_t        result  = CM_FAILURE;
+
+    // Tasks are popped and destroyed under this lock, reference the bo
+    // before leaving it so the wait does not block queries from other threads
+    m_CriticalSection_FlushedTask.Acquire();
+    if (!m_FlushedTasks.IsEmpty())
+    {
+        pTask = m_FlushedTasks.Top();
+        pTask->GetTaskEvent(pEvent);
+        if (pEvent != nullptr)
+        {
+            result = pEvent->ReferenceTaskOsData(pData);
+        }
+    }
+    m_CriticalSection_FlushedTask.Release();
+
+    if (result != CM_SUCCESS)
+    {
+        return CM_FAILURE;
+    }
+
+    if (mos_gem_bo_wait((MOS_LINUX_BO*)pData, 1000000LL*dwTimeOutMs))
+    {
+        result = CM_EXCEED_MAX_TIMEOUT;
+    }
+    mos_bo_unreference((MOS_LINUX_BO*)pData);
+
+    return result;
+}
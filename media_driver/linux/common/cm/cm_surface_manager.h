@@ -25,6 +25,7 @@
 //!
 
 #include "cm_def.h"
+#include <set>
 
 
 typedef enum _MOS_FORMAT MOS_FORMAT;
@@ -44,6 +45,38 @@ class CmSurface3DRT;
 class CmStateBuffer;
 class CmKernelRT;
 
+// Entry of a cached surface in the surface reuse index. Entries are ordered by
+// type, format and size, so the first fitting entry at or above the requested
+// size is the smallest surface that can be reused.
+struct CM_SURFACE_REUSE_KEY
+{
+    CM_ENUM_CLASS_TYPE type;
+    CM_SURFACE_FORMAT format;
+    uint32_t size;
+    uint32_t index;         // 0 if the surface is not in the reuse index
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t sizePerPixel;
+
+    bool operator<(const CM_SURFACE_REUSE_KEY &other) const
+    {
+        if (type != other.type)
+        {
+            return type < other.type;
+        }
+        if (format != other.format)
+        {
+            return format < other.format;
+        }
+        if (size != other.size)
+        {
+            return size < other.size;
+        }
+        return index < other.index;
+    }
+};
+
 class CmSurfaceManager
 {
 public:
@@ -113,6 +146,8 @@ public:
     int32_t UpdateStateForDelayedDestroy(SURFACE_DESTROY_KIND destroyKind, uint32_t index);
     int32_t UpdateStateForSurfaceReuse(uint32_t index);
     int32_t UpdateStateForRealDestroy(uint32_t index, CM_ENUM_CLASS_TYPE surfaceType);
+    void AddSurfaceToReuseIndex(uint32_t index);
+    void RemoveSurfaceFromReuseIndex(uint32_t index);
     int32_t UpdateProfileFor2DSurface(uint32_t index, uint32_t width, uint32_t height, CM_SURFACE_FORMAT format, bool reuse);
     int32_t UpdateProfileFor1DSurface(uint32_t index, uint32_t size, bool reuse);
     int32_t UpdateProfileFor3DSurface(uint32_t index, uint32_t width, uint32_t height, uint32_t depth, CM_SURFACE_FORMAT format, bool reuse);
@@ -180,6 +215,10 @@ protected:
     bool* m_surfaceReleased; //Surface has been released by API
     int32_t *m_surfaceDestroyId; //The destroy tag ID which is used to trace the liveness of surface in current surface array element.
     int32_t *m_surfaceSizes;         // Size of each surface in surface array
+    CM_SURFACE_REUSE_KEY *m_surfaceReuseKeys; // Reuse index entry of each cached surface
+    std::set<CM_SURFACE_REUSE_KEY> m_surfaceReuseIndex; // Cached surfaces ordered for best-fit lookup
+    uint32_t *m_freeSurfaceIndices;  // Stack of free surface array elements
+    uint32_t m_freeSurfaceIndexCount;
 
     uint32_t m_maxBufferCount;
     uint32_t m_bufferCount;
@@ -286,7 +286,7 @@ int32_t CmFillMosResource( VASurfaceID        iVASurfaceID,
     CM_DDI_CHK_NULL(pMediaCtx, "Null pMediaCtx", CM_INVALID_UMD_CONTEXT);
 
     CM_DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap", CM_INVALID_UMD_CONTEXT);
-    CM_CHK_LESS((uint32_t)iVASurfaceID, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", CM_INVALID_LIBVA_SURFACE);
+    CM_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)iVASurfaceID), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", CM_INVALID_LIBVA_SURFACE);
 
     pSurface = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, iVASurfaceID);
     CM_DDI_CHK_NULL(pSurface, "Null pSurface", CM_INVALID_LIBVA_SURFACE);
@@ -237,7 +237,10 @@ VAStatus DdiMediaDecode::DecodeCombineBitstream(DDI_MEDIA_CONTEXT *mediaCtx)
         return VA_STATUS_ERROR_DECODING_ERROR;
     }
 
-    newBitstreamBuffer->iSize     = m_ddiDecodeCtx->DecodeParams.m_dataSize;
+    // Slices normally land directly in the bitstream arena, this copy only happens
+    // when growing the arena failed at buffer creation time. The combined buffer
+    // replaces the arena, so size it for the largest frame seen to keep it reusable.
+    newBitstreamBuffer->iSize     = MOS_ALIGN_CEIL(MOS_MAX(m_ddiDecodeCtx->DecodeParams.m_dataSize, bufMgr->dwMaxFrameBsSize), MOS_PAGE_SIZE);
     newBitstreamBuffer->uiType    = VASliceDataBufferType;
     newBitstreamBuffer->format    = Media_Format_Buffer;
     newBitstreamBuffer->uiOffset  = 0;
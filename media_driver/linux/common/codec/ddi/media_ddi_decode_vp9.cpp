@@ -121,9 +121,13 @@ VAStatus DdiDecodeVP9::ParsePicParams(
     int32_t i;
     for (i = 0; i < 8; i++)
     {
-        if (picParam->reference_frames[i] < mediaCtx->uiNumSurfaces)
+        PDDI_MEDIA_SURFACE refSurface = nullptr;
+        if (picParam->reference_frames[i] != VA_INVALID_SURFACE)
+        {
+            refSurface = DdiMedia_GetSurfaceFromVASurfaceID(mediaCtx, picParam->reference_frames[i]);
+        }
+        if (refSurface != nullptr)
         {
-            PDDI_MEDIA_SURFACE refSurface          = DdiMedia_GetSurfaceFromVASurfaceID(mediaCtx, picParam->reference_frames[i]);
             frameIdx                               = GetRenderTargetID(&m_ddiDecodeCtx->RTtbl, refSurface);
             picVp9Params->RefFrameList[i].FrameIdx = ((uint32_t)frameIdx >= CODECHAL_NUM_UNCOMPRESSED_SURFACE_VP9) ? (CODECHAL_NUM_UNCOMPRESSED_SURFACE_VP9 - 1) : frameIdx;
         }
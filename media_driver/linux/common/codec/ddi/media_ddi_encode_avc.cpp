@@ -836,7 +836,7 @@ VAStatus DdiEncodeAvc::RenderPicture(
             DDI_CHK_STATUS(ParsePicParams(mediaCtx, data), VA_STATUS_ERROR_INVALID_BUFFER);
 
             DDI_CHK_STATUS(
-                    AddToStatusReportQueue((void *)m_encodeCtx->resBitstreamBuffer.bo),
+                    AddToStatusReportQueue(m_encodeCtx->pCodedBuffer),
                     VA_STATUS_ERROR_INVALID_BUFFER);
             break;
 
@@ -1364,6 +1364,7 @@ VAStatus DdiEncodeAvc::ParsePicParams(
     // MSDK will re-use the buffer so need to remove before adding to status report again
     RemoveFromStatusReportQueue(buf);
     DdiMedia_MediaBufferToMosResource(buf, &(m_encodeCtx->resBitstreamBuffer));
+    m_encodeCtx->pCodedBuffer = buf;
 
     return VA_STATUS_SUCCESS;
 }
@@ -89,15 +89,17 @@ VAStatus DdiEncodeBase::EndPicture(
     return VA_STATUS_SUCCESS;
 }
 
-VAStatus DdiEncodeBase::AddToStatusReportQueue(void *codedBuf)
+VAStatus DdiEncodeBase::AddToStatusReportQueue(DDI_MEDIA_BUFFER *codedBuf)
 {
     DDI_CHK_NULL(m_encodeCtx->pCpDdiInterface, "Null m_encodeCtx->pCpDdiInterface", VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(codedBuf, "Null codedBuf", VA_STATUS_ERROR_INVALID_BUFFER);
+    DDI_CHK_NULL(codedBuf->bo, "Null codedBuf->bo", VA_STATUS_ERROR_INVALID_BUFFER);
 
-    int32_t idx                                       = m_encodeCtx->statusReportBuf.ulHeadPosition;
-    m_encodeCtx->statusReportBuf.infos[idx].pCodedBuf = codedBuf;
-    m_encodeCtx->statusReportBuf.infos[idx].uiSize    = 0;
-    m_encodeCtx->statusReportBuf.infos[idx].uiStatus  = 0;
+    int32_t idx                                        = m_encodeCtx->statusReportBuf.ulHeadPosition;
+    m_encodeCtx->statusReportBuf.infos[idx].pCodedBuf  = (void *)codedBuf->bo;
+    m_encodeCtx->statusReportBuf.infos[idx].uiSize     = 0;
+    m_encodeCtx->statusReportBuf.infos[idx].uiStatus   = 0;
+    m_encodeCtx->statusReportBuf.infos[idx].uiSequence = SetStatusReportSlot(codedBuf, idx);
     MOS_STATUS status = m_encodeCtx->pCpDdiInterface->StoreCounterToStatusReport(&m_encodeCtx->statusReportBuf.infos[idx]);
     if (status != MOS_STATUS_SUCCESS)
     {
@@ -109,6 +111,32 @@ VAStatus DdiEncodeBase::AddToStatusReportQueue(void *codedBuf)
 
 }
 
+uint32_t DdiEncodeBase::SetStatusReportSlot(DDI_MEDIA_BUFFER *buf, int32_t index)
+{
+    // 0 is never given out, it marks buffers which were never added
+    uint32_t sequence = ++m_encodeCtx->statusReportBuf.uiSequence;
+    if (sequence == 0)
+    {
+        sequence = ++m_encodeCtx->statusReportBuf.uiSequence;
+    }
+
+    buf->iStatusReportIdx  = index;
+    buf->uiStatusReportSeq = sequence;
+
+    return sequence;
+}
+
+int32_t DdiEncodeBase::GetStatusReportSlot(DDI_MEDIA_BUFFER *buf)
+{
+    if ((buf->uiStatusReportSeq == 0) ||
+        (buf->iStatusReportIdx < 0) ||
+        (buf->iStatusReportIdx >= DDI_ENCODE_MAX_STATUS_REPORT_BUFFER))
+    {
+        return DDI_CODEC_INVALID_BUFFER_INDEX;
+    }
+    return buf->iStatusReportIdx;
+}
+
 VAStatus DdiEncodeBase::InitCompBuffer()
 {
     DDI_CHK_NULL(m_encodeCtx, "Null m_encodeCtx.", VA_STATUS_ERROR_INVALID_CONTEXT);
@@ -165,7 +193,7 @@ VAStatus DdiEncodeBase::StatusReport(
     uint32_t size         = 0;
     int32_t  index        = 0;
     uint32_t status       = 0;
-    uint32_t timeOutCount = 0;
+    bool     statusWaited = false;
     VAStatus eStatus      = VA_STATUS_SUCCESS;
 
     // Get encoded frame information from status buffer queue.
@@ -225,13 +253,16 @@ VAStatus DdiEncodeBase::StatusReport(
                 break;
             }
             // Wait until encode PAK complete, sometimes we application detect encoded buffer object is Idle, may Enc done, but Pak not.
-            uint32_t maxTimeOut                               = 100000;  //set max sleep times to 100000 = 1s, other wise return error.
-            if (timeOutCount < maxTimeOut)
+            // Block on the status buffer HW writes at the end of the frame, then query the status once more.
+            if (!statusWaited)
             {
-                //sleep 10 us to wait encode complete, it won't impact the performance.
-                uint32_t sleepTime                            = 10;      //sleep 10 us when encode is not complete.
-                usleep(sleepTime);
-                timeOutCount++;
+                // The status buffer is shared by all frames in flight and may still be busy with later
+                // ones when this frame is done, so a timeout is only an error if the frame is still incomplete.
+                if (WaitStatusReportResource(encoder, DDI_ENCODE_STATUS_REPORT_TIMEOUT_NS) != VA_STATUS_SUCCESS)
+                {
+                    DDI_NORMALMESSAGE("Status report wait timed out, query the frame status once more");
+                }
+                statusWaited = true;
                 continue;
             }
             else
@@ -278,9 +309,7 @@ VAStatus DdiEncodeBase::EncStatusReport(
 
     PCODECHAL_ENCODE_STATUS_REPORT pEncodeStatusReport = (PCODECHAL_ENCODE_STATUS_REPORT)m_encodeCtx->pEncodeStatusReport;
     uint16_t numStatus    = 1;
-    uint32_t maxTimeOut   = 500000;  //set max sleep times to 500000 = 5s, other wise return error.
-    uint32_t sleepTime    = 10;  //sleep 10 us when encode is not complete.
-    uint32_t timeOutCount = 0;
+    bool     statusWaited = false;
 
     //when this function is called, there must be a frame is ready, will wait until get the right information.
     while (1)
@@ -302,11 +331,17 @@ VAStatus DdiEncodeBase::EncStatusReport(
         else if (CODECHAL_STATUS_INCOMPLETE == pEncodeStatusReport[0].CodecStatus)
         {
             // Wait until encode PAK complete, sometimes we application detect encoded buffer object is Idle, may Enc done, but Pak not.
-            if (timeOutCount < maxTimeOut)
+            // Block on the status buffer HW writes at the end of the frame, then query the status once more.
+            CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(m_encodeCtx->pCodecHal);
+            DDI_CHK_NULL(encoder, "Null codechal encoder", VA_STATUS_ERROR_INVALID_CONTEXT);
+            if (!statusWaited)
             {
-                //sleep 10 us to wait encode complete, it won't impact the performance.
-                usleep(sleepTime);
-                timeOutCount++;
+                // On a timeout the status is queried once more as well, see StatusReport()
+                if (WaitStatusReportResource(encoder, DDI_ENC_STATUS_REPORT_TIMEOUT_NS) != VA_STATUS_SUCCESS)
+                {
+                    DDI_NORMALMESSAGE("Status report wait timed out, query the frame status once more");
+                }
+                statusWaited = true;
                 continue;
             }
             else
@@ -338,9 +373,7 @@ VAStatus DdiEncodeBase::PreEncStatusReport(
 
     PCODECHAL_ENCODE_STATUS_REPORT pEncodeStatusReport = (PCODECHAL_ENCODE_STATUS_REPORT)m_encodeCtx->pEncodeStatusReport;
     uint16_t numStatus    = 1;
-    uint32_t maxTimeOut   = 500000;  //set max sleep times to 500000 = 5s, other wise return error.
-    uint32_t sleepTime    = 10;  //sleep 10 us when encode is not complete.
-    uint32_t timeOutCount = 0;
+    bool     statusWaited = false;
 
     //when this function is called, there must be a frame is ready, will wait until get the right information.
     while (1)
@@ -362,11 +395,17 @@ VAStatus DdiEncodeBase::PreEncStatusReport(
         else if (CODECHAL_STATUS_INCOMPLETE == pEncodeStatusReport[0].CodecStatus)
         {
             // Wait until encode PAK complete, sometimes we application detect encoded buffer object is Idle, may Enc done, but Pak not.
-            if (timeOutCount < maxTimeOut)
+            // Block on the status buffer HW writes at the end of the frame, then query the status once more.
+            CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(m_encodeCtx->pCodecHal);
+            DDI_CHK_NULL(encoder, "Null codechal encoder", VA_STATUS_ERROR_INVALID_CONTEXT);
+            if (!statusWaited)
             {
-                //sleep 10 us to wait encode complete, it won't impact the performance.
-                usleep(sleepTime);
-                timeOutCount++;
+                // On a timeout the status is queried once more as well, see StatusReport()
+                if (WaitStatusReportResource(encoder, DDI_ENC_STATUS_REPORT_TIMEOUT_NS) != VA_STATUS_SUCCESS)
+                {
+                    DDI_NORMALMESSAGE("Status report wait timed out, query the frame status once more");
+                }
+                statusWaited = true;
                 continue;
             }
             else
@@ -389,6 +428,23 @@ VAStatus DdiEncodeBase::PreEncStatusReport(
     return VA_STATUS_SUCCESS;
 }
 
+VAStatus DdiEncodeBase::WaitStatusReportResource(
+    CodechalEncoderState *encoder,
+    int64_t              timeOutNs)
+{
+    DDI_CHK_NULL(encoder, "Null encoder", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    PMOS_RESOURCE statusBuffer = encoder->GetStatusReportResource();
+    DDI_CHK_NULL(statusBuffer, "Null statusBuffer", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_NULL(statusBuffer->bo, "Null statusBuffer->bo", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    if (mos_gem_bo_wait(statusBuffer->bo, timeOutNs) != 0)
+    {
+        return VA_STATUS_ERROR_OPERATION_FAILED;
+    }
+    return VA_STATUS_SUCCESS;
+}
+
 VAStatus DdiEncodeBase::RemoveFromStatusReportQueue(DDI_MEDIA_BUFFER *buf)
 {
     VAStatus eStatus = VA_STATUS_SUCCESS;
@@ -481,20 +537,17 @@ VAStatus DdiEncodeBase::GetSizeFromStatusReportBuffer(
     DDI_CHK_NULL(status, "Null status", VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(index, "Null index", VA_STATUS_ERROR_INVALID_CONTEXT);
 
-    int32_t i = 0;
-    for (i = 0; i < DDI_ENCODE_MAX_STATUS_REPORT_BUFFER; i++)
+    // check if the buffer has already been added to status report queue,
+    // and the slot was not reused by another buffer since
+    int32_t i = GetStatusReportSlot(buf);
+    if ((i != DDI_CODEC_INVALID_BUFFER_INDEX) &&
+        (m_encodeCtx->statusReportBuf.infos[i].pCodedBuf == (void *)buf->bo) &&
+        (m_encodeCtx->statusReportBuf.infos[i].uiSequence == buf->uiStatusReportSeq))
     {
-        // check if the buffer has already been added to status report queue
-        if (m_encodeCtx->statusReportBuf.infos[i].pCodedBuf == (void *)buf->bo)
-        {
-            *size   = m_encodeCtx->statusReportBuf.infos[i].uiSize;
-            *status = m_encodeCtx->statusReportBuf.infos[i].uiStatus;
-
-            break;
-        }
+        *size   = m_encodeCtx->statusReportBuf.infos[i].uiSize;
+        *status = m_encodeCtx->statusReportBuf.infos[i].uiStatus;
     }
-
-    if (i >= DDI_ENCODE_MAX_STATUS_REPORT_BUFFER)
+    else
     {
         // no matching buffer has been found
         *size   = 0;
@@ -526,18 +579,16 @@ VAStatus DdiEncodeBase::GetIndexFromEncStatusReportBuffer(
         return VA_STATUS_ERROR_INVALID_CONTEXT;
     }
 
-    int32_t i = 0;
-    for (i = 0; i < DDI_ENCODE_MAX_STATUS_REPORT_BUFFER; i++)
+    // check if the buffer has already been added to status report queue,
+    // and the slot was not reused by another buffer since
+    int32_t i = GetStatusReportSlot(buf);
+    if ((i != DDI_CODEC_INVALID_BUFFER_INDEX) &&
+        (m_encodeCtx->statusReportBuf.encInfos[i].pEncBuf[typeIdx] == (void *)buf->bo) &&
+        (m_encodeCtx->statusReportBuf.encInfos[i].uiSequence[typeIdx] == buf->uiStatusReportSeq))
     {
-        // check if the buffer has already been added to status report queue
-        if (m_encodeCtx->statusReportBuf.encInfos[i].pEncBuf[typeIdx] == (void *)buf->bo)
-        {
-            *status = m_encodeCtx->statusReportBuf.encInfos[i].uiStatus;
-            break;
-        }
+        *status = m_encodeCtx->statusReportBuf.encInfos[i].uiStatus;
     }
-
-    if (i >= DDI_ENCODE_MAX_STATUS_REPORT_BUFFER)
+    else
     {
         // no matching buffer has been found
         i       = DDI_CODEC_INVALID_BUFFER_INDEX;
@@ -568,18 +619,16 @@ VAStatus DdiEncodeBase::GetIndexFromPreEncStatusReportBuffer(
         return VA_STATUS_ERROR_INVALID_CONTEXT;
     }
 
-    int32_t i = 0;
-    for (i = 0; i < DDI_ENCODE_MAX_STATUS_REPORT_BUFFER; i++)
+    // check if the buffer has already been added to status report queue,
+    // and the slot was not reused by another buffer since
+    int32_t i = GetStatusReportSlot(buf);
+    if ((i != DDI_CODEC_INVALID_BUFFER_INDEX) &&
+        (m_encodeCtx->statusReportBuf.preencInfos[i].pPreEncBuf[typeIdx] == (void *)buf->bo) &&
+        (m_encodeCtx->statusReportBuf.preencInfos[i].uiSequence[typeIdx] == buf->uiStatusReportSeq))
     {
-        // check if the buffer has already been added to status report queue
-        if (m_encodeCtx->statusReportBuf.preencInfos[i].pPreEncBuf[typeIdx] == (void *)buf->bo)
-        {
-            *status = m_encodeCtx->statusReportBuf.preencInfos[i].uiStatus;
-            break;
-        }
+        *status = m_encodeCtx->statusReportBuf.preencInfos[i].uiStatus;
     }
-
-    if (i >= DDI_ENCODE_MAX_STATUS_REPORT_BUFFER)
+    else
     {
         // no matching buffer has been found
         i       = DDI_CODEC_INVALID_BUFFER_INDEX;
@@ -598,14 +647,10 @@ bool DdiEncodeBase::CodedBufferExistInStatusReport(DDI_MEDIA_BUFFER *buf)
         return false;
     }
 
-    for (int32_t i = 0; i < DDI_ENCODE_MAX_STATUS_REPORT_BUFFER; i++)
-    {
-        if (m_encodeCtx->statusReportBuf.infos[i].pCodedBuf == (void *)buf->bo)
-        {
-            return true;
-        }
-    }
-    return false;
+    int32_t i = GetStatusReportSlot(buf);
+    return (i != DDI_CODEC_INVALID_BUFFER_INDEX) &&
+           (m_encodeCtx->statusReportBuf.infos[i].pCodedBuf == (void *)buf->bo) &&
+           (m_encodeCtx->statusReportBuf.infos[i].uiSequence == buf->uiStatusReportSeq);
 }
 
 bool DdiEncodeBase::EncBufferExistInStatusReport(
@@ -623,14 +668,10 @@ bool DdiEncodeBase::EncBufferExistInStatusReport(
         return false;
     }
 
-    for (int32_t i = 0; i < DDI_ENCODE_MAX_STATUS_REPORT_BUFFER; i++)
-    {
-        if (m_encodeCtx->statusReportBuf.encInfos[i].pEncBuf[typeIdx] == (void *)buf->bo)
-        {
-            return true;
-        }
-    }
-    return false;
+    int32_t i = GetStatusReportSlot(buf);
+    return (i != DDI_CODEC_INVALID_BUFFER_INDEX) &&
+           (m_encodeCtx->statusReportBuf.encInfos[i].pEncBuf[typeIdx] == (void *)buf->bo) &&
+           (m_encodeCtx->statusReportBuf.encInfos[i].uiSequence[typeIdx] == buf->uiStatusReportSeq);
 }
 
 bool DdiEncodeBase::PreEncBufferExistInStatusReport(
@@ -648,14 +689,10 @@ bool DdiEncodeBase::PreEncBufferExistInStatusReport(
         return false;
     }
 
-    for (int32_t i = 0; i < DDI_ENCODE_MAX_STATUS_REPORT_BUFFER; i++)
-    {
-        if (m_encodeCtx->statusReportBuf.preencInfos[i].pPreEncBuf[typeIdx] == (void *)buf->bo)
-        {
-            return true;
-        }
-    }
-    return false;
+    int32_t i = GetStatusReportSlot(buf);
+    return (i != DDI_CODEC_INVALID_BUFFER_INDEX) &&
+           (m_encodeCtx->statusReportBuf.preencInfos[i].pPreEncBuf[typeIdx] == (void *)buf->bo) &&
+           (m_encodeCtx->statusReportBuf.preencInfos[i].uiSequence[typeIdx] == buf->uiStatusReportSeq);
 }
 
 uint8_t DdiEncodeBase::VARC2HalRC(uint32_t vaRC)
@@ -31,6 +31,8 @@
 #include "media_ddi_base.h"
 #include "media_libva_encoder.h"
 
+class CodechalEncoderState;
+
 class DdiEncodeBase : public DdiMediaBase
 {
 public:
@@ -325,7 +327,36 @@ protected:
     //! \return   VAStatus
     //!           VA_STATUS_SUCCESS if successful, else fail reason
     //!
-    VAStatus AddToStatusReportQueue(void *codedBuf);
+    VAStatus AddToStatusReportQueue(DDI_MEDIA_BUFFER *codedBuf);
+
+    //!
+    //! \brief    Remember the status report slot of a buffer
+    //! \details  Store the slot index and a new sequence number in the buffer, so
+    //!           that the buffer's status report is found without scanning the queue.
+    //!           The same sequence number must be stored in the slot.
+    //!
+    //! \param    [in] buf
+    //!           Pointer to the buffer added to the queue
+    //! \param    [in] index
+    //!           Index of the slot
+    //!
+    //! \return   uint32_t
+    //!           Sequence number of the slot
+    //!
+    uint32_t SetStatusReportSlot(DDI_MEDIA_BUFFER *buf, int32_t index);
+
+    //!
+    //! \brief    Get the status report slot of a buffer
+    //! \details  Get the slot the buffer was last added to. The caller checks the
+    //!           slot still holds the buffer with the same sequence number.
+    //!
+    //! \param    [in] buf
+    //!           Pointer to DDI_MEDIA_BUFFER
+    //!
+    //! \return   int32_t
+    //!           Index of the slot, DDI_CODEC_INVALID_BUFFER_INDEX if never added
+    //!
+    int32_t GetStatusReportSlot(DDI_MEDIA_BUFFER *buf);
 
     //!
     //! \brief    Convert rate control method in VAAPI to the term in HAL
@@ -382,6 +413,23 @@ protected:
     //!
     VAStatus UpdatePreEncStatusReportBuffer(uint32_t status);
 
+    //!
+    //! \brief    Wait for the status report resource
+    //! \details  Block until the HW has written the pending status reports,
+    //!           instead of polling the status report.
+    //!
+    //! \param    [in] encoder
+    //!           Pointer to CodechalEncoderState
+    //! \param    [in] timeOutNs
+    //!           Max time to wait in nanoseconds
+    //!
+    //! \return   VAStatus
+    //!           VA_STATUS_SUCCESS if the resource is idle, VA_STATUS_ERROR_OPERATION_FAILED if timed out
+    //!
+    VAStatus WaitStatusReportResource(
+        CodechalEncoderState *encoder,
+        int64_t              timeOutNs);
+
     //!
     //! \brief    Get Size From Status Report Buffer
     //! \details  Get the coded buffer size, status and the index from Status
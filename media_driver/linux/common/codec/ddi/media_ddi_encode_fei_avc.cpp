@@ -447,7 +447,7 @@ VAStatus DdiEncodeAvcFei::RenderPicture(
                 break;
 
             DDI_CHK_STATUS(
-                AddToStatusReportQueue((void *)m_encodeCtx->resBitstreamBuffer.bo),
+                AddToStatusReportQueue(m_encodeCtx->pCodedBuffer),
                 VA_STATUS_ERROR_INVALID_BUFFER);
             break;
 
@@ -575,7 +575,7 @@ VAStatus DdiEncodeAvcFei::ParseMiscParamFeiPic(void *data)
         if (m_encodeCtx->feiFunction == CODECHAL_FUNCTION_FEI_ENC)
         {
             RemoveFromEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_MVDATA);
-            if (VA_STATUS_SUCCESS != AddToEncStatusReportQueue((void *)(feiPicParams->resMVData.bo), FEI_ENC_BUFFER_TYPE_MVDATA))
+            if (VA_STATUS_SUCCESS != AddToEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_MVDATA))
             {
                 CODEC_DDI_ASSERTMESSAGE("feiPicParams->resMVData is invalid for FEI ENC only");
                 status = VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -595,7 +595,7 @@ VAStatus DdiEncodeAvcFei::ParseMiscParamFeiPic(void *data)
         if (m_encodeCtx->feiFunction == CODECHAL_FUNCTION_FEI_ENC)
         {
             RemoveFromEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_MBCODE);
-            if (MOS_STATUS_SUCCESS != AddToEncStatusReportQueue((void *)(feiPicParams->resMBCode.bo), FEI_ENC_BUFFER_TYPE_MBCODE))
+            if (MOS_STATUS_SUCCESS != AddToEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_MBCODE))
             {
                 CODEC_DDI_ASSERTMESSAGE("feiPicParams->resMBCode is invalid for FEI ENC only");
                 status = VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -611,7 +611,7 @@ VAStatus DdiEncodeAvcFei::ParseMiscParamFeiPic(void *data)
         if (m_encodeCtx->feiFunction == CODECHAL_FUNCTION_FEI_ENC)
         {
             RemoveFromEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_DISTORTION);
-            if (MOS_STATUS_SUCCESS != AddToEncStatusReportQueue((void *)(feiPicParams->resDistortion.bo), FEI_ENC_BUFFER_TYPE_DISTORTION))
+            if (MOS_STATUS_SUCCESS != AddToEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_DISTORTION))
             {
                 CODEC_DDI_ASSERTMESSAGE("feiPicParams->resDistortion is invalid for FEI ENC only");
                 status = VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -652,10 +652,11 @@ VAStatus DdiEncodeAvcFei::ParseMiscParamFeiPic(void *data)
 }
 
 VAStatus DdiEncodeAvcFei::AddToEncStatusReportQueue(
-    void                           *encBuf,
+    DDI_MEDIA_BUFFER               *encBuf,
     DDI_ENCODE_FEI_ENC_BUFFER_TYPE typeIdx)
 {
     DDI_CHK_NULL(encBuf, "nullptr encBuf", VA_STATUS_ERROR_INVALID_PARAMETER);
+    DDI_CHK_NULL(encBuf->bo, "nullptr encBuf->bo", VA_STATUS_ERROR_INVALID_PARAMETER);
 
     CodecEncodeAvcFeiPicParams *feiPicParams = (CodecEncodeAvcFeiPicParams *)(m_encodeCtx->pFeiPicParams);
     DDI_CHK_NULL(feiPicParams, "nullptr feiPicParams", VA_STATUS_ERROR_INVALID_PARAMETER);
@@ -671,9 +672,10 @@ VAStatus DdiEncodeAvcFei::AddToEncStatusReportQueue(
         return VA_STATUS_ERROR_INVALID_PARAMETER;
     }
 
-    int32_t idx                                                 = m_encodeCtx->statusReportBuf.ulHeadPosition;
-    m_encodeCtx->statusReportBuf.encInfos[idx].pEncBuf[typeIdx] = encBuf;
-    m_encodeCtx->statusReportBuf.encInfos[idx].uiStatus         = 0;
+    int32_t idx                                                    = m_encodeCtx->statusReportBuf.ulHeadPosition;
+    m_encodeCtx->statusReportBuf.encInfos[idx].pEncBuf[typeIdx]    = (void *)encBuf->bo;
+    m_encodeCtx->statusReportBuf.encInfos[idx].uiSequence[typeIdx] = SetStatusReportSlot(encBuf, idx);
+    m_encodeCtx->statusReportBuf.encInfos[idx].uiStatus            = 0;
     m_encodeCtx->statusReportBuf.encInfos[idx].uiBuffers++;
 
     return VA_STATUS_SUCCESS;
@@ -701,10 +703,11 @@ VAStatus DdiEncodeAvcFei::AddToEncStatusReportQueueUpdatePos()
 }
 
 VAStatus DdiEncodeAvcFei::AddToPreEncStatusReportQueue(
-    void                           *preEncBuf,
+    DDI_MEDIA_BUFFER               *preEncBuf,
     DDI_ENCODE_PRE_ENC_BUFFER_TYPE typeIdx)
 {
     DDI_CHK_NULL(preEncBuf, "nullptr preEncBuf", VA_STATUS_ERROR_INVALID_PARAMETER);
+    DDI_CHK_NULL(preEncBuf->bo, "nullptr preEncBuf->bo", VA_STATUS_ERROR_INVALID_PARAMETER);
 
     if (m_encodeCtx->codecFunction != CODECHAL_FUNCTION_FEI_PRE_ENC)
     {
@@ -718,7 +721,8 @@ VAStatus DdiEncodeAvcFei::AddToPreEncStatusReportQueue(
     }
 
     int32_t i                                                       = m_encodeCtx->statusReportBuf.ulHeadPosition;
-    m_encodeCtx->statusReportBuf.preencInfos[i].pPreEncBuf[typeIdx] = preEncBuf;
+    m_encodeCtx->statusReportBuf.preencInfos[i].pPreEncBuf[typeIdx] = (void *)preEncBuf->bo;
+    m_encodeCtx->statusReportBuf.preencInfos[i].uiSequence[typeIdx] = SetStatusReportSlot(preEncBuf, i);
     m_encodeCtx->statusReportBuf.preencInfos[i].uiStatus            = 0;
     m_encodeCtx->statusReportBuf.preencInfos[i].uiBuffers++;
 
@@ -1038,7 +1042,7 @@ VAStatus DdiEncodeAvcFei::ParseStatsParams(PDDI_MEDIA_CONTEXT mediaCtx, void *pt
         }
         DdiMedia_MediaBufferToMosResource(mediaBuffer, &(preEncParams->resMvBuffer));
         RemoveFromPreEncStatusReportQueue(mediaBuffer, PRE_ENC_BUFFER_TYPE_MVDATA);
-        if (VA_STATUS_SUCCESS != AddToPreEncStatusReportQueue((void *)(preEncParams->resMvBuffer.bo), PRE_ENC_BUFFER_TYPE_MVDATA))
+        if (VA_STATUS_SUCCESS != AddToPreEncStatusReportQueue(mediaBuffer, PRE_ENC_BUFFER_TYPE_MVDATA))
         {
             CODEC_DDI_ASSERTMESSAGE("preEncParams->resMvBuffer is invalid for PREENC only");
             return VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -1055,7 +1059,7 @@ VAStatus DdiEncodeAvcFei::ParseStatsParams(PDDI_MEDIA_CONTEXT mediaCtx, void *pt
         }
         DdiMedia_MediaBufferToMosResource(mediaBuffer, &(preEncParams->resStatsBuffer));
         RemoveFromPreEncStatusReportQueue(mediaBuffer, PRE_ENC_BUFFER_TYPE_STATS);
-        if (VA_STATUS_SUCCESS != AddToPreEncStatusReportQueue((void *)(preEncParams->resStatsBuffer.bo), PRE_ENC_BUFFER_TYPE_STATS))
+        if (VA_STATUS_SUCCESS != AddToPreEncStatusReportQueue(mediaBuffer, PRE_ENC_BUFFER_TYPE_STATS))
         {
             CODEC_DDI_ASSERTMESSAGE("preEncParams->resStatsBuffer is invalid for PREENC only");
             return VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -1071,7 +1075,7 @@ VAStatus DdiEncodeAvcFei::ParseStatsParams(PDDI_MEDIA_CONTEXT mediaCtx, void *pt
             }
             DdiMedia_MediaBufferToMosResource(mediaBuffer, &(preEncParams->resStatsBotFieldBuffer));
             RemoveFromPreEncStatusReportQueue(mediaBuffer, PRE_ENC_BUFFER_TYPE_STATS_BOT);
-            if (VA_STATUS_SUCCESS != AddToPreEncStatusReportQueue((void *)(preEncParams->resStatsBotFieldBuffer.bo), PRE_ENC_BUFFER_TYPE_STATS_BOT))
+            if (VA_STATUS_SUCCESS != AddToPreEncStatusReportQueue(mediaBuffer, PRE_ENC_BUFFER_TYPE_STATS_BOT))
             {
                 CODEC_DDI_ASSERTMESSAGE("preEncParams->resStatsBotFieldBuffer is invalid for PREENC only");
                 return VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -299,7 +299,7 @@ VAStatus DdiEncodeHevcFei::RenderPicture(VADriverContextP ctx, VAContextID conte
         case VAEncPictureParameterBufferType:
             DDI_CHK_STATUS(ParsePicParams(mediaCtx, data), VA_STATUS_ERROR_INVALID_BUFFER);
             DDI_CHK_STATUS(
-                    AddToStatusReportQueue((void *)m_encodeCtx->resBitstreamBuffer.bo),
+                    AddToStatusReportQueue(m_encodeCtx->pCodedBuffer),
                     VA_STATUS_ERROR_INVALID_BUFFER);
             break;
 
@@ -424,7 +424,7 @@ VAStatus DdiEncodeHevcFei::ParseMiscParamFeiPic(void *data)
         if(m_encodeCtx->feiFunction == CODECHAL_FUNCTION_FEI_ENC)
         {
             RemoveFromEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_CTB_CMD);
-            if( VA_STATUS_SUCCESS != AddToEncStatusReportQueue( (void *)(feiPicParams->resCTBCmd.bo), FEI_ENC_BUFFER_TYPE_CTB_CMD) )
+            if( VA_STATUS_SUCCESS != AddToEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_CTB_CMD) )
             {
                 CODEC_DDI_ASSERTMESSAGE("feiPicParams->resCTBCmd is invalid for FEI ENC only");
                 status = VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -444,7 +444,7 @@ VAStatus DdiEncodeHevcFei::ParseMiscParamFeiPic(void *data)
         if(m_encodeCtx->feiFunction == CODECHAL_FUNCTION_FEI_ENC)
         {
             RemoveFromEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_CU_RECORD);
-            if( VA_STATUS_SUCCESS != AddToEncStatusReportQueue((void *)(feiPicParams->resCURecord.bo), FEI_ENC_BUFFER_TYPE_CU_RECORD) )
+            if( VA_STATUS_SUCCESS != AddToEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_CU_RECORD) )
             {
                 CODEC_DDI_ASSERTMESSAGE("feiPicParams->resCURecord is invalid for FEI ENC only");
                 status = VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -461,7 +461,7 @@ VAStatus DdiEncodeHevcFei::ParseMiscParamFeiPic(void *data)
         if(m_encodeCtx->feiFunction == CODECHAL_FUNCTION_FEI_ENC)
         {
             RemoveFromEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_DISTORTION);
-            if( VA_STATUS_SUCCESS != AddToEncStatusReportQueue((void *)(feiPicParams->resDistortion.bo), FEI_ENC_BUFFER_TYPE_DISTORTION) )
+            if( VA_STATUS_SUCCESS != AddToEncStatusReportQueue(mediaBuffer, FEI_ENC_BUFFER_TYPE_DISTORTION) )
             {
                 CODEC_DDI_ASSERTMESSAGE("feiPicParams->resDistortion is invalid for FEI ENC only");
                 status = VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -503,10 +503,11 @@ finish:
 }
 
 VAStatus DdiEncodeHevcFei::AddToEncStatusReportQueue(
-    void                           *encBuf,
+    DDI_MEDIA_BUFFER               *encBuf,
     DDI_ENCODE_FEI_ENC_BUFFER_TYPE typeIdx)
 {
     DDI_CHK_NULL(encBuf, "nullptr encBuf", VA_STATUS_ERROR_INVALID_PARAMETER);
+    DDI_CHK_NULL(encBuf->bo, "nullptr encBuf->bo", VA_STATUS_ERROR_INVALID_PARAMETER);
 
     CodecEncodeHevcFeiPicParams *feiPicParams = (CodecEncodeHevcFeiPicParams *)(m_encodeCtx->pFeiPicParams);
     DDI_CHK_NULL(feiPicParams, "nullptr feiPicParams", VA_STATUS_ERROR_INVALID_PARAMETER);
@@ -522,9 +523,10 @@ VAStatus DdiEncodeHevcFei::AddToEncStatusReportQueue(
         return VA_STATUS_ERROR_INVALID_PARAMETER;
     }
 
-    int32_t idx                                                 = m_encodeCtx->statusReportBuf.ulHeadPosition;
-    m_encodeCtx->statusReportBuf.encInfos[idx].pEncBuf[typeIdx] = encBuf;
-    m_encodeCtx->statusReportBuf.encInfos[idx].uiStatus         = 0;
+    int32_t idx                                                    = m_encodeCtx->statusReportBuf.ulHeadPosition;
+    m_encodeCtx->statusReportBuf.encInfos[idx].pEncBuf[typeIdx]    = (void *)encBuf->bo;
+    m_encodeCtx->statusReportBuf.encInfos[idx].uiSequence[typeIdx] = SetStatusReportSlot(encBuf, idx);
+    m_encodeCtx->statusReportBuf.encInfos[idx].uiStatus            = 0;
     m_encodeCtx->statusReportBuf.encInfos[idx].uiBuffers++;
 
     return VA_STATUS_SUCCESS;
@@ -69,7 +69,7 @@ public:
     //!           VA_STATUS_SUCCESS if successful, else fail reason
     //!
     VAStatus AddToEncStatusReportQueue(
-        void                           *encBuf,
+        DDI_MEDIA_BUFFER               *encBuf,
         DDI_ENCODE_FEI_ENC_BUFFER_TYPE typeIdx);
 
     //!
@@ -151,7 +151,7 @@ VAStatus DdiEncodeJpeg::RenderPicture(
         case VAEncPictureParameterBufferType:
             DDI_CHK_STATUS(ParsePicParams(mediaCtx, data), VA_STATUS_ERROR_INVALID_BUFFER);
             DDI_CHK_STATUS(
-                    AddToStatusReportQueue((void *)m_encodeCtx->resBitstreamBuffer.bo),
+                    AddToStatusReportQueue(m_encodeCtx->pCodedBuffer),
                     VA_STATUS_ERROR_INVALID_BUFFER);
             break;
 
@@ -234,6 +234,7 @@ VAStatus DdiEncodeJpeg::ParsePicParams(DDI_MEDIA_CONTEXT *mediaCtx, void *ptr)
 	if(buf != NULL)
 	{
         DdiMedia_MediaBufferToMosResource(buf, &(m_encodeCtx->resBitstreamBuffer));
+        m_encodeCtx->pCodedBuffer = buf;
 	}
 
     jpegPicParams->m_profile      = picParams->pic_flags.bits.profile;
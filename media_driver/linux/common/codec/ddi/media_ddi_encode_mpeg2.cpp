@@ -187,7 +187,7 @@ VAStatus DdiEncodeMpeg2::RenderPicture(
         case VAEncPictureParameterBufferType:
             DDI_CHK_STATUS(ParsePicParams(mediaCtx, data), VA_STATUS_ERROR_INVALID_BUFFER);
             DDI_CHK_STATUS(
-                    AddToStatusReportQueue((void *)m_encodeCtx->resBitstreamBuffer.bo),
+                    AddToStatusReportQueue(m_encodeCtx->pCodedBuffer),
                     VA_STATUS_ERROR_INVALID_BUFFER);
             break;
 
@@ -613,6 +613,7 @@ VAStatus DdiEncodeMpeg2::ParsePicParams(
     DDI_CHK_NULL(buf, "nullptr buf", VA_STATUS_ERROR_INVALID_PARAMETER);
     RemoveFromStatusReportQueue(buf);
     DdiMedia_MediaBufferToMosResource(buf, &(m_encodeCtx->resBitstreamBuffer));
+    m_encodeCtx->pCodedBuffer = buf;
     mpeg2PicParams->m_numSlice = 0;
 
     //According to MPEG2 spec, GOP header time_code include 6 fields and the ranges of values are Hour (0~23), Minute(0~59), Marker bit(always 1), Second (0~59), Picuture (0~59), Drop_frame flag( 0 or 1).
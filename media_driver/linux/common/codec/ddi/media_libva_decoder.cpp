@@ -180,6 +180,112 @@ static bool DdiDecode_AllocJPEGBsBuffer(
     return true;
 }
 
+// Bitstream buffers are kept as per-context arenas: they are never shrunk and grow by
+// at least half of their current size, so a stream converges to a size that holds a
+// whole frame of slice data after a few frames and stays allocation-free afterwards.
+static uint32_t DdiDecode_GetBsArenaSize(
+    uint32_t                    dwCurrentSize,
+    uint32_t                    dwRequiredSize)
+{
+    uint32_t dwArenaSize;
+
+    dwArenaSize = dwCurrentSize + (dwCurrentSize >> 1);
+    if (dwArenaSize < dwRequiredSize)
+    {
+        dwArenaSize = dwRequiredSize;
+    }
+
+    return MOS_ALIGN_CEIL(dwArenaSize, MOS_PAGE_SIZE);
+}
+
+// Grows the bitstream arena of the current frame in place of spilling the slice to
+// a CPU buffer. The slice data already written is moved once and the slice data
+// buffers created so far for this frame are repointed to the new bo, so
+// DecodeCombineBitstream has nothing left to copy. The arena is left alone while
+// the app holds a mapping of one of those slices, the caller spills instead.
+static bool DdiDecode_GrowBsBuffer(
+    DDI_CODEC_COM_BUFFER_MGR    *pBufMgr,
+    uint32_t                    dwUsedSize,
+    uint32_t                    dwRequiredSize,
+    PDDI_MEDIA_CONTEXT          pMediaCtx)
+{
+    DDI_MEDIA_BUFFER *pBsBufObj;
+    DDI_MEDIA_BUFFER *pSliceBuf;
+    DDI_MEDIA_BUFFER  oldBsBuf;
+    uint8_t          *pOldBase;
+    uint8_t          *pNewBase;
+    uint32_t          i;
+
+    pBsBufObj = pBufMgr->pBitStreamBuffObject[pBufMgr->dwBitstreamIndex];
+    pOldBase  = pBufMgr->pBitStreamBase[pBufMgr->dwBitstreamIndex];
+    if (pBsBufObj == nullptr || pOldBase == nullptr)
+    {
+        return false;
+    }
+
+    for (i = 0; i < pBufMgr->dwNumSliceData; i++)
+    {
+        pSliceBuf = DdiMedia_GetBufferFromVABufferID(pMediaCtx, pBufMgr->pSliceData[i].vaBufferId);
+        if (pSliceBuf != nullptr && pSliceBuf->bo == pBsBufObj->bo &&
+            !pBufMgr->pSliceData[i].bIsUseExtBuf && pSliceBuf->uiMapCount > 0)
+        {
+            return false;
+        }
+    }
+
+    oldBsBuf                     = *pBsBufObj;
+    pBsBufObj->iSize             = DdiDecode_GetBsArenaSize(oldBsBuf.iSize, dwRequiredSize);
+    pBsBufObj->bo                = nullptr;
+    pBsBufObj->pData             = nullptr;
+    pBsBufObj->bMapped           = false;
+    pBsBufObj->iRefCount         = 0;
+    pBsBufObj->pGmmResourceInfo  = nullptr;
+    pBsBufObj->pMediaCtx         = pMediaCtx;
+
+    if (VA_STATUS_SUCCESS != DdiMediaUtil_CreateBuffer(pBsBufObj, pMediaCtx->pDrmBufMgr))
+    {
+        *pBsBufObj = oldBsBuf;
+        return false;
+    }
+
+    pNewBase = (uint8_t*)DdiMediaUtil_LockBuffer(pBsBufObj, MOS_LOCKFLAG_WRITEONLY);
+    if (pNewBase == nullptr)
+    {
+        DdiMediaUtil_FreeBuffer(pBsBufObj);
+        *pBsBufObj = oldBsBuf;
+        return false;
+    }
+
+    if (dwUsedSize > 0)
+    {
+        MOS_SecureMemcpy(pNewBase, pBsBufObj->iSize, pOldBase, dwUsedSize);
+    }
+
+    for (i = 0; i < pBufMgr->dwNumSliceData; i++)
+    {
+        pSliceBuf = DdiMedia_GetBufferFromVABufferID(pMediaCtx, pBufMgr->pSliceData[i].vaBufferId);
+        if (pSliceBuf == nullptr || pSliceBuf->bo != oldBsBuf.bo ||
+            (pSliceBuf->uiType != VASliceDataBufferType && pSliceBuf->uiType != VAProtectedSliceDataBufferType))
+        {
+            continue;
+        }
+
+        // slices spilled to CPU memory keep their data there, only the bo identifies the arena
+        if (!pBufMgr->pSliceData[i].bIsUseExtBuf)
+        {
+            pSliceBuf->pData = pNewBase;
+        }
+        pSliceBuf->bo = pBsBufObj->bo;
+    }
+
+    DdiMediaUtil_UnlockBuffer(&oldBsBuf);
+    DdiMediaUtil_FreeBuffer(&oldBsBuf);
+
+    pBufMgr->pBitStreamBase[pBufMgr->dwBitstreamIndex] = pNewBase;
+
+    return true;
+}
+
 static bool DdiDecode_AllocBsBuffer(
     DDI_CODEC_COM_BUFFER_MGR    *pBufMgr,
     DDI_MEDIA_BUFFER            *pBuf,
@@ -191,6 +297,7 @@ static bool DdiDecode_AllocBsBuffer(
     DDI_MEDIA_BUFFER *pBsBufObj = nullptr;
     uint8_t          *pBsBufBaseAddr = nullptr;
     bool              bCreateBsBuffer = false;
+    uint32_t          dwRequiredSize;
 
     if ( nullptr == pBufMgr || nullptr == pBuf || nullptr == pMediaCtx )
     {
@@ -227,8 +334,11 @@ static bool DdiDecode_AllocBsBuffer(
     if(index >= 1)
     {
         pBuf->uiOffset = pBufMgr->pSliceData[index-1].uiOffset + pBufMgr->pSliceData[index-1].uiLength;
-        if((pBuf->uiOffset + pBuf->iSize) > pBufMgr->pBitStreamBuffObject[pBufMgr->dwBitstreamIndex]->iSize)
+        if((pBuf->uiOffset + pBuf->iSize) > pBufMgr->pBitStreamBuffObject[pBufMgr->dwBitstreamIndex]->iSize &&
+           !DdiDecode_GrowBsBuffer(pBufMgr, pBuf->uiOffset, pBuf->uiOffset + pBuf->iSize, pMediaCtx))
         {
+            // growing the arena failed, keep the slice in CPU memory and let
+            // DecodeCombineBitstream assemble the frame at render time.
             pSliceBuf = (uint8_t*)MOS_AllocAndZeroMemory(pBuf->iSize);
             if(pSliceBuf == nullptr)
             {
@@ -237,10 +347,6 @@ static bool DdiDecode_AllocBsBuffer(
             }
             pBufMgr->bIsSliceOverSize = true;
         }
-        else
-        {
-            pBufMgr->bIsSliceOverSize = false;
-        }
     }
     else
     {
@@ -279,23 +385,28 @@ static bool DdiDecode_AllocBsBuffer(
         pBsBufObj ->pMediaCtx       = pMediaCtx;
         pBsBufBaseAddr              = pBufMgr->pBitStreamBase[pBufMgr->dwBitstreamIndex];
 
+        // size the arena for the largest frame seen so far, so multi-slice frames
+        // are written in place without growing it again.
+        dwRequiredSize = MOS_MAX(pBufMgr->dwMaxFrameBsSize, pBuf->iSize);
+
         if(pBsBufBaseAddr == nullptr)
         {
             bCreateBsBuffer = true;
-            if (pBuf->iSize > pBsBufObj->iSize)
+            if (dwRequiredSize > pBsBufObj->iSize)
             {
-                pBsBufObj->iSize = pBuf->iSize;
+                pBsBufObj->iSize = DdiDecode_GetBsArenaSize(pBsBufObj->iSize, dwRequiredSize);
             }
         }
-        else if(pBuf->iSize > pBsBufObj->iSize)
+        else if(dwRequiredSize > pBsBufObj->iSize)
         {
            //free bo
             DdiMediaUtil_UnlockBuffer(pBsBufObj);
             DdiMediaUtil_FreeBuffer(pBsBufObj);
             pBsBufBaseAddr = nullptr;
+            pBufMgr->pBitStreamBase[pBufMgr->dwBitstreamIndex] = nullptr;
 
             bCreateBsBuffer = true;
-            pBsBufObj->iSize = pBuf->iSize;
+            pBsBufObj->iSize = DdiDecode_GetBsArenaSize(pBsBufObj->iSize, dwRequiredSize);
         }
 
         if (bCreateBsBuffer)
@@ -322,24 +433,32 @@ static bool DdiDecode_AllocBsBuffer(
 
     pBufMgr->pSliceData[index].uiLength = pBuf->iSize;
     pBufMgr->pSliceData[index].uiOffset = pBuf->uiOffset;
+    pBufMgr->pSliceData[index].vaBufferId = VA_INVALID_ID;
+
+    if (pBuf->uiOffset + pBuf->iSize > pBufMgr->dwMaxFrameBsSize)
+    {
+        pBufMgr->dwMaxFrameBsSize = pBuf->uiOffset + pBuf->iSize;
+    }
 
-    if(pBufMgr->bIsSliceOverSize == true)
+    pBuf->bo                            = pBufMgr->pBitStreamBuffObject[pBufMgr->dwBitstreamIndex]->bo;
+    if(pSliceBuf != nullptr)
     {
+        // the slice lives in CPU memory, initial data must not go through the bo
         pBuf->pData                              = pSliceBuf;
         pBuf->uiOffset                           = 0;
+        pBuf->bCFlushReq                         = false;
         pBufMgr->pSliceData[index].bIsUseExtBuf  = true;
         pBufMgr->pSliceData[index].pSliceBuf     = pSliceBuf;
     }
     else
     {
         pBuf->pData                              = (uint8_t*)(pBufMgr->pBitStreamBase[pBufMgr->dwBitstreamIndex]);
+        pBuf->bCFlushReq                         = true;
         pBufMgr->pSliceData[index].bIsUseExtBuf  = false;
         pBufMgr->pSliceData[index].pSliceBuf     = nullptr;
     }
 
     pBufMgr->dwNumSliceData ++;
-    pBuf->bo                            = pBufMgr->pBitStreamBuffObject[pBufMgr->dwBitstreamIndex]->bo;
-    pBuf->bCFlushReq                    = true;
 
     return true;
 }
@@ -723,7 +842,8 @@ VAStatus DdiDecode_CreateBuffer(
 
     // Keep record the VaBufferID of JPEG slice data buffer we allocated, in order to do buffer mapping when render this buffer. otherwise we
     // can not get correct buffer address when application create them disordered.
-    if (type == VASliceDataBufferType && pDecCtx->wMode == CODECHAL_DECODE_MODE_JPEG)
+    // For the other codecs it is used to repoint the slice data buffers when the bitstream arena grows.
+    if ((type == VASliceDataBufferType || type == VAProtectedSliceDataBufferType) && pDecCtx->BufMgr.dwNumSliceData > 0)
     {
         // since the dwNumSliceData already +1 when allocate buffer, but here we need to track the VaBufferID before dwSliceData increased.
         pDecCtx->BufMgr.pSliceData[pDecCtx->BufMgr.dwNumSliceData - 1].vaBufferId = *pBufId;
@@ -768,15 +888,15 @@ VAStatus DdiDecode_UnRegisterRTSurfaces(
     //Look through all decode contexts to unregister the surface in each decode context's RTtable.
     if (mediaCtx->pDecoderCtxHeap != nullptr)
     {
-        PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT pDecVACtxHeapBase;
+        PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT pDecVACtxHeapElmt;
 
         DdiMediaUtil_LockMutex(&mediaCtx->DecoderMutex);
-        pDecVACtxHeapBase  = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)mediaCtx->pDecoderCtxHeap->pHeapBase;
-        for (int32_t j = 0; j < mediaCtx->pDecoderCtxHeap->uiAllocatedHeapElements; j++)
+        for (uint32_t j = 0; j < mediaCtx->pDecoderCtxHeap->uiAllocatedHeapElements; j++)
         {
-            if (pDecVACtxHeapBase[j].pVaContext != nullptr)
+            pDecVACtxHeapElmt = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)DdiMediaUtil_GetHeapElementByIndex(mediaCtx->pDecoderCtxHeap, j);
+            if (pDecVACtxHeapElmt != nullptr && pDecVACtxHeapElmt->pVaContext != nullptr)
             {
-                PDDI_DECODE_CONTEXT  pDecCtx = (PDDI_DECODE_CONTEXT)pDecVACtxHeapBase[j].pVaContext;
+                PDDI_DECODE_CONTEXT  pDecCtx = (PDDI_DECODE_CONTEXT)pDecVACtxHeapElmt->pVaContext;
                 if (pDecCtx && pDecCtx->m_ddiDecode)
                 {
                     //not check the return value since the surface may not be registered in the context. pay attention to LOGW.
@@ -38,6 +38,9 @@
 
 #define DDI_ENCODE_MAX_STATUS_REPORT_BUFFER    CODECHAL_ENCODE_STATUS_NUM
 
+#define DDI_ENCODE_STATUS_REPORT_TIMEOUT_NS    1000000000LL    // 1s, else the coded buffer is reported as bad bitstream
+#define DDI_ENC_STATUS_REPORT_TIMEOUT_NS       5000000000LL    // 5s, else ENC/PreENC reports an encoding error
+
 typedef enum _DDI_ENCODE_FEI_ENC_BUFFER_TYPE
 {
     FEI_ENC_BUFFER_TYPE_MVDATA     = 0,
@@ -63,6 +66,7 @@ typedef struct _DDI_ENCODE_STATUS_REPORT_INFO
     uint32_t        uiSize;                 //encoded frame size
     uint32_t        uiStatus;               // Encode frame status
     uint32_t        uiInputCtr[4];          // Counter for HDCP2 session
+    uint32_t        uiSequence;             // sequence number given when pCodedBuf was added
 } DDI_ENCODE_STATUS_REPORT_INFO;
 
 // ENC output buffer checking for FEI_ENC case only
@@ -71,6 +75,7 @@ typedef struct _DDI_ENCODE_STATUS_REPORT_ENC_INFO
     void           *pEncBuf[3];             // ENC buffers address for Mvdata, MbCode and Distortion
     uint32_t        uiBuffers;              // rendered ENC buffers
     uint32_t        uiStatus;               // ENC frame status
+    uint32_t        uiSequence[3];          // sequence numbers given when pEncBuf were added
 } DDI_ENCODE_STATUS_REPORT_ENC_INFO;
 
 // PREENC output buffer checking
@@ -79,6 +84,7 @@ typedef struct _DDI_ENCODE_STATUS_REPORT_PREENC_INFO
     void           *pPreEncBuf[3];          // PREENC buffers address for Mvdata and Statistics, Statistics of Bottom Field
     uint32_t        uiBuffers;              // rendered ENC buffers
     uint32_t        uiStatus;               // PREENC frame status
+    uint32_t        uiSequence[3];          // sequence numbers given when pPreEncBuf were added
 } DDI_ENCODE_STATUS_REPORT_PREENC_INFO;
 
 typedef struct _DDI_ENCODE_STATUS_REPORT_INFO_BUF
@@ -88,6 +94,7 @@ typedef struct _DDI_ENCODE_STATUS_REPORT_INFO_BUF
     DDI_ENCODE_STATUS_REPORT_PREENC_INFO   preencInfos[DDI_ENCODE_MAX_STATUS_REPORT_BUFFER];
     unsigned long                          ulHeadPosition;
     unsigned long                          ulUpdatePosition;
+    uint32_t                               uiSequence;      // last sequence number given to a slot
 } DDI_ENCODE_STATUS_REPORT_INFO_BUF;
 
 class DdiEncodeBase;
@@ -120,6 +127,7 @@ typedef struct _DDI_ENCODE_CONTEXT
     MOS_RESOURCE                      resFeiDistortionBuffer;
     DDI_ENCODE_STATUS_REPORT_INFO_BUF statusReportBuf;
     MOS_RESOURCE                      resBitstreamBuffer;
+    DDI_MEDIA_BUFFER                 *pCodedBuffer;
     MOS_RESOURCE                      resMbCodeBuffer;
     MOS_RESOURCE                      resProbCoeffBuffer;
     MOS_SURFACE                       sCoeffSurface;
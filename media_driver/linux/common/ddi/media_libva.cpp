@@ -321,14 +321,17 @@ static uint32_t DdiMedia_CreateRenderTarget(
     pSurfaceElement->pSurface->uiLockedBufID   = VA_INVALID_ID;
     pSurfaceElement->pSurface->uiLockedImageID = VA_INVALID_ID;
     pSurfaceElement->pSurface->surfaceUsageHint= surfaceUsageHint;
+    DdiMediaUtil_InitMutex(&pSurfaceElement->pSurface->StatusMutex);
 
     if(DdiMediaUtil_CreateSurface(pSurfaceElement->pSurface, pMediaDrvCtx)!= VA_STATUS_SUCCESS)
     {
+        DdiMediaUtil_DestroyMutex(&pSurfaceElement->pSurface->StatusMutex);
         MOS_FreeMemory(pSurfaceElement->pSurface);
         DdiMediaUtil_ReleasePMediaSurfaceFromHeap(pMediaDrvCtx->pSurfaceHeap, pSurfaceElement->uiVaSurfaceID);
         DdiMediaUtil_UnLockMutex(&pMediaDrvCtx->SurfaceMutex);
         return VA_INVALID_ID;
     }
+    DdiMediaUtil_AddSurfaceToBoIndex(pMediaDrvCtx, pSurfaceElement->pSurface);
 
     pMediaDrvCtx->uiNumSurfaces++;
     uiSurfaceID = pSurfaceElement->uiVaSurfaceID;
@@ -568,6 +571,8 @@ DDI_MEDIA_FORMAT DdiMedia_OsFormatAlphaMaskToMediaFormat(int32_t fourcc, int32_t
             return Media_Format_YV12;
         case VA_FOURCC_IYUV:
             return Media_Format_IYUV;
+        case VA_FOURCC_I420:
+            return Media_Format_I420;
         case VA_FOURCC_422H:
             return Media_Format_422H;
         case VA_FOURCC_422V:
@@ -1127,10 +1132,8 @@ err_finish:
 static void DdiMedia_FreeSurfaceHeapElements(PDDI_MEDIA_CONTEXT pMediaCtx)
 {
     PDDI_MEDIA_HEAP                 pSurfaceHeap;
-    PDDI_MEDIA_SURFACE_HEAP_ELEMENT pMediaSurfaceHeapBase;
     PDDI_MEDIA_SURFACE_HEAP_ELEMENT pMediaSurfaceHeapElmt;
-    int32_t                         uiElementId;
-    int32_t                         uiSurfaceNums;
+    uint32_t                        uiElementId;
 
     if (nullptr == pMediaCtx)
         return;
@@ -1139,18 +1142,15 @@ static void DdiMedia_FreeSurfaceHeapElements(PDDI_MEDIA_CONTEXT pMediaCtx)
     if (nullptr == pSurfaceHeap)
         return;
 
-    pMediaSurfaceHeapBase = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)pSurfaceHeap->pHeapBase;
-    if (nullptr == pMediaSurfaceHeapBase)
-        return;
-
-    uiSurfaceNums = pMediaCtx->uiNumSurfaces;
-    for (uiElementId = 0; uiElementId < uiSurfaceNums; uiElementId++)
+    for (uiElementId = 0; uiElementId < pSurfaceHeap->uiAllocatedHeapElements; uiElementId++)
     {
-        pMediaSurfaceHeapElmt = &pMediaSurfaceHeapBase[uiElementId];
-        if (nullptr == pMediaSurfaceHeapElmt->pSurface)
+        pMediaSurfaceHeapElmt = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)DdiMediaUtil_GetHeapElementByIndex(pSurfaceHeap, uiElementId);
+        if (nullptr == pMediaSurfaceHeapElmt || nullptr == pMediaSurfaceHeapElmt->pSurface)
             continue;
 
+        DdiMediaUtil_RemoveSurfaceFromBoIndex(pMediaCtx, pMediaSurfaceHeapElmt->pSurface);
         DdiMediaUtil_FreeSurface(pMediaSurfaceHeapElmt->pSurface);
+        DdiMediaUtil_DestroyMutex(&pMediaSurfaceHeapElmt->pSurface->StatusMutex);
         MOS_FreeMemory(pMediaSurfaceHeapElmt->pSurface);
         DdiMediaUtil_ReleasePMediaSurfaceFromHeap(pSurfaceHeap,pMediaSurfaceHeapElmt->uiVaSurfaceID);
         pMediaCtx->uiNumSurfaces--;
@@ -1169,9 +1169,7 @@ static void DdiMedia_FreeBufferHeapElements(VADriverContextP    ctx)
     PDDI_MEDIA_CONTEXT             pMediaCtx;
     PDDI_MEDIA_HEAP                pBufferHeap;
     PDDI_MEDIA_BUFFER_HEAP_ELEMENT pMediaBufferHeapElmt;
-    PDDI_MEDIA_BUFFER_HEAP_ELEMENT pMediaBufferHeapBase;
-    int32_t                        uiElementId;
-    int32_t                        uiBufNums;
+    uint32_t                       uiElementId;
 
     pMediaCtx = DdiMedia_GetMediaContext(ctx);
     if (nullptr == pMediaCtx)
@@ -1181,15 +1179,10 @@ static void DdiMedia_FreeBufferHeapElements(VADriverContextP    ctx)
     if (nullptr == pBufferHeap)
         return;
 
-    pMediaBufferHeapBase = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)pBufferHeap->pHeapBase;
-    if (nullptr == pMediaBufferHeapBase)
-        return;
-
-    uiBufNums = pMediaCtx->uiNumBufs;
-    for (uiElementId = 0; uiElementId < uiBufNums; ++uiElementId)
+    for (uiElementId = 0; uiElementId < pBufferHeap->uiAllocatedHeapElements; ++uiElementId)
     {
-        pMediaBufferHeapElmt = &pMediaBufferHeapBase[uiElementId];
-        if (nullptr == pMediaBufferHeapElmt->pBuffer)
+        pMediaBufferHeapElmt = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)DdiMediaUtil_GetHeapElementByIndex(pBufferHeap, uiElementId);
+        if (nullptr == pMediaBufferHeapElmt || nullptr == pMediaBufferHeapElmt->pBuffer)
             continue;
         DdiMedia_DestroyBuffer(ctx,pMediaBufferHeapElmt->uiVaBufferID);
     }
@@ -1207,9 +1200,7 @@ static void DdiMedia_FreeImageHeapElements(VADriverContextP    ctx)
     PDDI_MEDIA_CONTEXT             pMediaCtx;
     PDDI_MEDIA_HEAP                pImageHeap;
     PDDI_MEDIA_IMAGE_HEAP_ELEMENT  pMediaImageHeapElmt;
-    PDDI_MEDIA_IMAGE_HEAP_ELEMENT  pMediaImageHeapBase;
-    int32_t                        uiElementId;
-    int32_t                        uiImageNums;
+    uint32_t                       uiElementId;
 
     pMediaCtx = DdiMedia_GetMediaContext(ctx);
     if (nullptr == pMediaCtx)
@@ -1219,15 +1210,10 @@ static void DdiMedia_FreeImageHeapElements(VADriverContextP    ctx)
     if (nullptr == pImageHeap)
         return;
 
-    pMediaImageHeapBase = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)pImageHeap->pHeapBase;
-    if (nullptr == pMediaImageHeapBase)
-        return;
-
-    uiImageNums = pMediaCtx->uiNumImages;
-    for (uiElementId = 0; uiElementId < uiImageNums; ++uiElementId)
+    for (uiElementId = 0; uiElementId < pImageHeap->uiAllocatedHeapElements; ++uiElementId)
     {
-        pMediaImageHeapElmt = &pMediaImageHeapBase[uiElementId];
-        if (nullptr == pMediaImageHeapElmt->pImage)
+        pMediaImageHeapElmt = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)DdiMediaUtil_GetHeapElementByIndex(pImageHeap, uiElementId);
+        if (nullptr == pMediaImageHeapElmt || nullptr == pMediaImageHeapElmt->pImage)
             continue;
         DdiMedia_DestroyImage(ctx,pMediaImageHeapElmt->uiVaImageID);
     }
@@ -1241,21 +1227,16 @@ static void DdiMedia_FreeImageHeapElements(VADriverContextP    ctx)
 //! [out] none
 //! \returns
 /////////////////////////////////////////////////////////////////////////////
-static void DdiMedia_FreeContextHeap(VADriverContextP ctx, PDDI_MEDIA_HEAP pContextHeap,int32_t VaContextOffset, int32_t uiCtxNums)
+static void DdiMedia_FreeContextHeap(VADriverContextP ctx, PDDI_MEDIA_HEAP pContextHeap,int32_t VaContextOffset)
 {
-    PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT  pMediaContextHeapBase;
     PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT  pMediaContextHeapElmt;
-    int32_t                            uiElementId;
+    uint32_t                           uiElementId;
     VAContextID                        uiVaCtxID;
 
-    pMediaContextHeapBase = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)pContextHeap->pHeapBase;
-    if (nullptr == pMediaContextHeapBase)
-        return;
-
-    for (uiElementId = 0; uiElementId < uiCtxNums; ++uiElementId)
+    for (uiElementId = 0; uiElementId < pContextHeap->uiAllocatedHeapElements; ++uiElementId)
     {
-        pMediaContextHeapElmt = &pMediaContextHeapBase[uiElementId];
-        if (nullptr == pMediaContextHeapElmt->pVaContext)
+        pMediaContextHeapElmt = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)DdiMediaUtil_GetHeapElementByIndex(pContextHeap, uiElementId);
+        if (nullptr == pMediaContextHeapElmt || nullptr == pMediaContextHeapElmt->pVaContext)
             continue;
         uiVaCtxID = (VAContextID)(pMediaContextHeapElmt->uiVaContextID + VaContextOffset);
         DdiMedia_DestroyContext(ctx,uiVaCtxID);
@@ -1277,10 +1258,6 @@ static void DdiMedia_FreeContextHeapElements(VADriverContextP    ctx)
     PDDI_MEDIA_HEAP        pDecoderContextHeap;
     PDDI_MEDIA_HEAP        pVpContextHeap;
     PDDI_MEDIA_HEAP        pMfeContextHeap;
-    int32_t                uiEncCtxNums;
-    int32_t                uiDecCtxNums;
-    int32_t                uiVPCtxNums;
-    int32_t                uiMfeCtxNums;
 
     pMediaCtx = DdiMedia_GetMediaContext(ctx);
     if (nullptr == pMediaCtx)
@@ -1288,27 +1265,23 @@ static void DdiMedia_FreeContextHeapElements(VADriverContextP    ctx)
 
     //Free EncoderContext
     pEncoderContextHeap = pMediaCtx->pEncoderCtxHeap;
-    uiEncCtxNums        = pMediaCtx->uiNumEncoders;
     if (nullptr != pEncoderContextHeap)
-        DdiMedia_FreeContextHeap(ctx,pEncoderContextHeap,DDI_MEDIA_VACONTEXTID_OFFSET_ENCODER,uiEncCtxNums);
+        DdiMedia_FreeContextHeap(ctx,pEncoderContextHeap,DDI_MEDIA_VACONTEXTID_OFFSET_ENCODER);
 
     //Free DecoderContext
     pDecoderContextHeap = pMediaCtx->pDecoderCtxHeap;
-    uiDecCtxNums        = pMediaCtx->uiNumDecoders;
     if (nullptr != pDecoderContextHeap)
-        DdiMedia_FreeContextHeap(ctx,pDecoderContextHeap,DDI_MEDIA_VACONTEXTID_OFFSET_DECODER,uiDecCtxNums);
+        DdiMedia_FreeContextHeap(ctx,pDecoderContextHeap,DDI_MEDIA_VACONTEXTID_OFFSET_DECODER);
 
     //Free VpContext
     pVpContextHeap = pMediaCtx->pVpCtxHeap;
-    uiVPCtxNums    = pMediaCtx->uiNumVPs;
     if (nullptr != pVpContextHeap)
-        DdiMedia_FreeContextHeap(ctx,pVpContextHeap,DDI_MEDIA_VACONTEXTID_OFFSET_VP,uiVPCtxNums);
+        DdiMedia_FreeContextHeap(ctx,pVpContextHeap,DDI_MEDIA_VACONTEXTID_OFFSET_VP);
 
     //Free MfeContext
     pMfeContextHeap = pMediaCtx->pMfeCtxHeap;
-    uiMfeCtxNums    = pMediaCtx->uiNumMfes;
     if (nullptr != pMfeContextHeap)
-        DdiMedia_FreeContextHeap(ctx, pMfeContextHeap, DDI_MEDIA_VACONTEXTID_OFFSET_MFE, uiMfeCtxNums);
+        DdiMedia_FreeContextHeap(ctx, pMfeContextHeap, DDI_MEDIA_VACONTEXTID_OFFSET_MFE);
 
     // Free media memory decompression data structure
     if (pMediaCtx->pMediaMemDecompState)
@@ -1349,51 +1322,30 @@ static void DdiMedia_FreeContextCMElements(VADriverContextP ctx)
 VAImage* DdiMedia_GetVAImageFromVAImageID (PDDI_MEDIA_CONTEXT pMediaCtx, VAImageID ImageID)
 {
     PDDI_MEDIA_IMAGE_HEAP_ELEMENT pImageElement;
-    uint32_t                      i;
-    VAImage                      *pVaImage;
 
-    i               = (uint32_t)ImageID;
-    DDI_CHK_LESS(i, pMediaCtx->pImageHeap->uiAllocatedHeapElements, "invalid image id", nullptr);
-    DdiMediaUtil_LockMutex(&pMediaCtx->ImageMutex);
-    pImageElement   = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)pMediaCtx->pImageHeap->pHeapBase;
-    pImageElement  += i;
-    pVaImage        = pImageElement->pImage;
-    DdiMediaUtil_UnLockMutex(&pMediaCtx->ImageMutex);
+    pImageElement   = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pMediaCtx->pImageHeap, (uint32_t)ImageID);
+    DDI_CHK_NULL(pImageElement, "invalid image id", nullptr);
 
-    return pVaImage;
+    return pImageElement->pImage;
 }
 void* DdiMedia_GetCtxFromVABufferID (PDDI_MEDIA_CONTEXT pMediaCtx, VABufferID bufferID)
 {
-    uint32_t                       i;
     PDDI_MEDIA_BUFFER_HEAP_ELEMENT pBufHeapElement;
-    void                          *pTemp;
 
-    i                = (uint32_t)bufferID;
-    DDI_CHK_LESS(i, pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "invalid buffer id", nullptr);
-    DdiMediaUtil_LockMutex(&pMediaCtx->BufferMutex);
-    pBufHeapElement  = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)pMediaCtx->pBufferHeap->pHeapBase;
-    pBufHeapElement += i;
-    pTemp            = pBufHeapElement->pCtx;
-    DdiMediaUtil_UnLockMutex(&pMediaCtx->BufferMutex);
+    pBufHeapElement  = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pMediaCtx->pBufferHeap, (uint32_t)bufferID);
+    DDI_CHK_NULL(pBufHeapElement, "invalid buffer id", nullptr);
 
-    return pTemp;
+    return pBufHeapElement->pCtx;
 }
 
 uint32_t DdiMedia_GetCtxTypeFromVABufferID (PDDI_MEDIA_CONTEXT pMediaCtx, VABufferID bufferID)
 {
-    uint32_t                       i;
     PDDI_MEDIA_BUFFER_HEAP_ELEMENT pBufHeapElement;
-    uint32_t                       uiCtxType;
 
-    i                = (uint32_t)bufferID;
-    DDI_CHK_LESS(i, pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "invalid buffer id", DDI_MEDIA_CONTEXT_TYPE_NONE);
-    DdiMediaUtil_LockMutex(&pMediaCtx->BufferMutex);
-    pBufHeapElement  = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)pMediaCtx->pBufferHeap->pHeapBase;
-    pBufHeapElement += i;
-    uiCtxType        = pBufHeapElement->uiCtxType;
-    DdiMediaUtil_UnLockMutex(&pMediaCtx->BufferMutex);
+    pBufHeapElement  = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pMediaCtx->pBufferHeap, (uint32_t)bufferID);
+    DDI_CHK_NULL(pBufHeapElement, "invalid buffer id", DDI_MEDIA_CONTEXT_TYPE_NONE);
 
-    return uiCtxType;
+    return pBufHeapElement->uiCtxType;
 
 }
 
@@ -1566,7 +1518,14 @@ VAStatus DdiMedia__Initialize (
         vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
         goto finish;
     }
-    pMediaCtx->pSurfaceHeap->uiHeapElementSize      = sizeof(DDI_MEDIA_SURFACE_HEAP_ELEMENT);
+    DdiMediaUtil_InitHeap(pMediaCtx->pSurfaceHeap, sizeof(DDI_MEDIA_SURFACE_HEAP_ELEMENT));
+
+    pMediaCtx->pSurfaceBoIndex                      = MOS_New(DDI_MEDIA_SURFACE_BO_INDEX);
+    if (nullptr == pMediaCtx->pSurfaceBoIndex)
+    {
+        vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
+        goto finish;
+    }
 
     pMediaCtx->pBufferHeap                          = (DDI_MEDIA_HEAP *)MOS_AllocAndZeroMemory(sizeof(DDI_MEDIA_HEAP));
     if (nullptr == pMediaCtx->pBufferHeap)
@@ -1574,7 +1533,7 @@ VAStatus DdiMedia__Initialize (
         vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
         goto finish;
     }
-    pMediaCtx->pBufferHeap->uiHeapElementSize       = sizeof(DDI_MEDIA_BUFFER_HEAP_ELEMENT);
+    DdiMediaUtil_InitHeap(pMediaCtx->pBufferHeap, sizeof(DDI_MEDIA_BUFFER_HEAP_ELEMENT));
 
     pMediaCtx->pImageHeap                           = (DDI_MEDIA_HEAP *)MOS_AllocAndZeroMemory(sizeof(DDI_MEDIA_HEAP));
     if (nullptr == pMediaCtx->pImageHeap)
@@ -1582,7 +1541,7 @@ VAStatus DdiMedia__Initialize (
         vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
         goto finish;
     }
-    pMediaCtx->pImageHeap->uiHeapElementSize        = sizeof(DDI_MEDIA_IMAGE_HEAP_ELEMENT);
+    DdiMediaUtil_InitHeap(pMediaCtx->pImageHeap, sizeof(DDI_MEDIA_IMAGE_HEAP_ELEMENT));
 
     pMediaCtx->pDecoderCtxHeap                      = (DDI_MEDIA_HEAP *)MOS_AllocAndZeroMemory(sizeof(DDI_MEDIA_HEAP));
     if (nullptr == pMediaCtx->pDecoderCtxHeap)
@@ -1590,7 +1549,7 @@ VAStatus DdiMedia__Initialize (
         vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
         goto finish;
     }
-    pMediaCtx->pDecoderCtxHeap->uiHeapElementSize   = sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT);
+    DdiMediaUtil_InitHeap(pMediaCtx->pDecoderCtxHeap, sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT));
 
     pMediaCtx->pEncoderCtxHeap                      = (DDI_MEDIA_HEAP *)MOS_AllocAndZeroMemory(sizeof(DDI_MEDIA_HEAP));
     if (nullptr == pMediaCtx->pEncoderCtxHeap)
@@ -1598,7 +1557,7 @@ VAStatus DdiMedia__Initialize (
         vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
         goto finish;
     }
-    pMediaCtx->pEncoderCtxHeap->uiHeapElementSize   = sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT);
+    DdiMediaUtil_InitHeap(pMediaCtx->pEncoderCtxHeap, sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT));
 
     pMediaCtx->pVpCtxHeap                           = (DDI_MEDIA_HEAP *)MOS_AllocAndZeroMemory(sizeof(DDI_MEDIA_HEAP));
     if (nullptr == pMediaCtx->pVpCtxHeap)
@@ -1606,7 +1565,7 @@ VAStatus DdiMedia__Initialize (
         vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
         goto finish;
     }
-    pMediaCtx->pVpCtxHeap->uiHeapElementSize        = sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT);
+    DdiMediaUtil_InitHeap(pMediaCtx->pVpCtxHeap, sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT));
 
     pMediaCtx->pCmCtxHeap                          = (DDI_MEDIA_HEAP *)MOS_AllocAndZeroMemory(sizeof(DDI_MEDIA_HEAP));
     if (nullptr == pMediaCtx->pCmCtxHeap)
@@ -1614,7 +1573,7 @@ VAStatus DdiMedia__Initialize (
         vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
         goto finish;
     }
-    pMediaCtx->pCmCtxHeap->uiHeapElementSize        = sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT);
+    DdiMediaUtil_InitHeap(pMediaCtx->pCmCtxHeap, sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT));
 
     pMediaCtx->pMfeCtxHeap                           = (DDI_MEDIA_HEAP *)MOS_AllocAndZeroMemory(sizeof(DDI_MEDIA_HEAP));
     if (nullptr == pMediaCtx->pMfeCtxHeap)
@@ -1622,7 +1581,7 @@ VAStatus DdiMedia__Initialize (
         vaStatus = VA_STATUS_ERROR_ALLOCATION_FAILED;
         goto finish;
     }
-    pMediaCtx->pMfeCtxHeap->uiHeapElementSize        = sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT);
+    DdiMediaUtil_InitHeap(pMediaCtx->pMfeCtxHeap, sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT));
 
     // Allocate memory for Media System Info
     pMediaCtx->pGtSystemInfo                        = (MEDIA_SYSTEM_INFO *)MOS_AllocAndZeroMemory(sizeof(MEDIA_SYSTEM_INFO));
@@ -1687,6 +1646,7 @@ VAStatus DdiMedia__Initialize (
     DdiMediaUtil_InitMutex(&pMediaCtx->VpMutex);
     DdiMediaUtil_InitMutex(&pMediaCtx->CmMutex);
     DdiMediaUtil_InitMutex(&pMediaCtx->MfeMutex);
+    DdiMediaUtil_InitMutex(&pMediaCtx->SurfaceBoIndexMutex);
 #ifndef ANDROID
     DdiMediaUtil_InitMutex(&pMediaCtx->PutSurfaceRenderMutex);
     DdiMediaUtil_InitMutex(&pMediaCtx->PutSurfaceSwapBufferMutex);
@@ -1756,6 +1716,7 @@ finish:
         pMediaCtx->SkuTable.reset();
         pMediaCtx->WaTable.reset();
         MOS_FreeMemory(pMediaCtx->pSurfaceHeap);
+        MOS_Delete(pMediaCtx->pSurfaceBoIndex);
         MOS_FreeMemory(pMediaCtx->pBufferHeap);
         MOS_FreeMemory(pMediaCtx->pImageHeap);
         MOS_FreeMemory(pMediaCtx->pDecoderCtxHeap);
@@ -1822,28 +1783,29 @@ static VAStatus DdiMedia_Terminate (
     mos_bufmgr_destroy(pMediaCtx->pDrmBufMgr);
 
     // destroy heaps
-    MOS_FreeMemory(pMediaCtx->pSurfaceHeap->pHeapBase);
+    DdiMediaUtil_DestroyHeap(pMediaCtx->pSurfaceHeap);
     MOS_FreeMemory(pMediaCtx->pSurfaceHeap);
+    MOS_Delete(pMediaCtx->pSurfaceBoIndex);
 
-    MOS_FreeMemory(pMediaCtx->pBufferHeap->pHeapBase);
+    DdiMediaUtil_DestroyHeap(pMediaCtx->pBufferHeap);
     MOS_FreeMemory(pMediaCtx->pBufferHeap);
 
-    MOS_FreeMemory(pMediaCtx->pImageHeap->pHeapBase);
+    DdiMediaUtil_DestroyHeap(pMediaCtx->pImageHeap);
     MOS_FreeMemory(pMediaCtx->pImageHeap);
 
-    MOS_FreeMemory(pMediaCtx->pDecoderCtxHeap->pHeapBase);
+    DdiMediaUtil_DestroyHeap(pMediaCtx->pDecoderCtxHeap);
     MOS_FreeMemory(pMediaCtx->pDecoderCtxHeap);
 
-    MOS_FreeMemory(pMediaCtx->pEncoderCtxHeap->pHeapBase);
+    DdiMediaUtil_DestroyHeap(pMediaCtx->pEncoderCtxHeap);
     MOS_FreeMemory(pMediaCtx->pEncoderCtxHeap);
 
-    MOS_FreeMemory(pMediaCtx->pVpCtxHeap->pHeapBase);
+    DdiMediaUtil_DestroyHeap(pMediaCtx->pVpCtxHeap);
     MOS_FreeMemory(pMediaCtx->pVpCtxHeap);
 
-    MOS_FreeMemory(pMediaCtx->pCmCtxHeap->pHeapBase);
+    DdiMediaUtil_DestroyHeap(pMediaCtx->pCmCtxHeap);
     MOS_FreeMemory(pMediaCtx->pCmCtxHeap);
 
-    MOS_FreeMemory(pMediaCtx->pMfeCtxHeap->pHeapBase);
+    DdiMediaUtil_DestroyHeap(pMediaCtx->pMfeCtxHeap);
     MOS_FreeMemory(pMediaCtx->pMfeCtxHeap);
 
     // Destroy memory allocated to store Media System Info
@@ -1858,6 +1820,7 @@ static VAStatus DdiMedia_Terminate (
     DdiMediaUtil_DestroyMutex(&pMediaCtx->VpMutex);
     DdiMediaUtil_DestroyMutex(&pMediaCtx->CmMutex);
     DdiMediaUtil_DestroyMutex(&pMediaCtx->MfeMutex);
+    DdiMediaUtil_DestroyMutex(&pMediaCtx->SurfaceBoIndexMutex);
 
     //resource checking
     if (pMediaCtx->uiNumSurfaces != 0)
@@ -2175,7 +2138,7 @@ static VAStatus DdiMedia_DestroySurfaces (
 
     for(i = 0; i < num_surfaces; i++)
     {
-        DDI_CHK_LESS((uint32_t)surfaces[i], pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaces", VA_STATUS_ERROR_INVALID_SURFACE);
+        DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surfaces[i]), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaces", VA_STATUS_ERROR_INVALID_SURFACE);
         pSurface = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, surfaces[i]);
         DDI_CHK_NULL(pSurface, "Null pSurface", VA_STATUS_ERROR_INVALID_SURFACE);
         if(pSurface->pCurrentFrameSemaphore)
@@ -2192,7 +2155,7 @@ static VAStatus DdiMedia_DestroySurfaces (
 
     for(i = 0; i < num_surfaces; i++)
     {
-        DDI_CHK_LESS((uint32_t)surfaces[i], pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaces", VA_STATUS_ERROR_INVALID_SURFACE);
+        DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surfaces[i]), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaces", VA_STATUS_ERROR_INVALID_SURFACE);
         pSurface = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, surfaces[i]);
         DDI_CHK_NULL(pSurface, "Null pSurface", VA_STATUS_ERROR_INVALID_SURFACE);
         if(pSurface->pCurrentFrameSemaphore)
@@ -2209,7 +2172,9 @@ static VAStatus DdiMedia_DestroySurfaces (
 
         DdiDecode_UnRegisterRTSurfaces(ctx, pSurface);
 
+        DdiMediaUtil_RemoveSurfaceFromBoIndex(pMediaCtx, pSurface);
         DdiMediaUtil_FreeSurface(pSurface);
+        DdiMediaUtil_DestroyMutex(&pSurface->StatusMutex);
         MOS_FreeMemory(pSurface);
         DdiMediaUtil_LockMutex(&pMediaCtx->SurfaceMutex);
         DdiMediaUtil_ReleasePMediaSurfaceFromHeap(pMediaCtx->pSurfaceHeap, (uint32_t)surfaces[i]);
@@ -2847,7 +2812,7 @@ static VAStatus DdiMedia_CreateContext (
         for(i = 0; i < num_render_targets; i++)
         {
             surfaceId = (UINT32)render_targets[i];
-            DDI_CHK_LESS(surfaceId, pMediaDrvCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid Surface", VA_STATUS_ERROR_INVALID_SURFACE);
+            DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX(surfaceId), pMediaDrvCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid Surface", VA_STATUS_ERROR_INVALID_SURFACE);
         }
     }
 
@@ -2978,7 +2943,7 @@ static VAStatus DdiMedia_BufferSetNumElements (
     DDI_CHK_NULL(pMediaCtx,              "Null pMediaCtx",              VA_STATUS_ERROR_INVALID_CONTEXT);
 
     DDI_CHK_NULL(pMediaCtx->pBufferHeap, "Null pMediaCtx->pBufferHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)buf_id, pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid buf_id", VA_STATUS_ERROR_INVALID_BUFFER);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)buf_id), pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid buf_id", VA_STATUS_ERROR_INVALID_BUFFER);
 
     pBuf      = DdiMedia_GetBufferFromVABufferID(pMediaCtx, buf_id);
     DDI_CHK_NULL(pBuf, "Invalid buffer.", VA_STATUS_ERROR_INVALID_BUFFER);
@@ -3041,7 +3006,7 @@ VAStatus DdiMedia_MapBufferInternal (
     DDI_CHK_NULL(pMediaCtx,              "Null pMediaCtx",              VA_STATUS_ERROR_INVALID_CONTEXT);
 
     DDI_CHK_NULL(pMediaCtx->pBufferHeap, "Null pMediaCtx->pBufferHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)buf_id, pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid bufferId", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)buf_id), pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid bufferId", VA_STATUS_ERROR_INVALID_CONTEXT);
 
     pBuf      = DdiMedia_GetBufferFromVABufferID(pMediaCtx, buf_id);
     DDI_CHK_NULL(pBuf, "Null pBuf", VA_STATUS_ERROR_INVALID_BUFFER);
@@ -3081,6 +3046,10 @@ VAStatus DdiMedia_MapBufferInternal (
     {
         case VASliceDataBufferType:
         case VAProtectedSliceDataBufferType:
+            // the bitstream arena must not move while the app writes through this pointer
+            pBuf->uiMapCount++;
+            *pbuf = (void *)(pBuf->pData + pBuf->uiOffset);
+            break;
         case VABitPlaneBufferType:
             *pbuf = (void *)(pBuf->pData + pBuf->uiOffset);
             break;
@@ -3312,7 +3281,7 @@ VAStatus DdiMedia_UnmapBuffer (
     DDI_CHK_NULL(pMediaCtx,               "Null pMediaCtx",               VA_STATUS_ERROR_INVALID_CONTEXT);
 
     DDI_CHK_NULL( pMediaCtx->pBufferHeap, "Null  pMediaCtx->pBufferHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)buf_id, pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid buf_id", VA_STATUS_ERROR_INVALID_BUFFER);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)buf_id), pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid buf_id", VA_STATUS_ERROR_INVALID_BUFFER);
 
     pBuf      = DdiMedia_GetBufferFromVABufferID(pMediaCtx,  buf_id);
     DDI_CHK_NULL(pBuf, "Null pBuf", VA_STATUS_ERROR_INVALID_BUFFER);
@@ -3351,6 +3320,11 @@ VAStatus DdiMedia_UnmapBuffer (
     {
         case VASliceDataBufferType:
         case VAProtectedSliceDataBufferType:
+            if (pBuf->uiMapCount > 0)
+            {
+                pBuf->uiMapCount--;
+            }
+            break;
         case VABitPlaneBufferType:
             break;
         case VAEncCodedBufferType:
@@ -3424,7 +3398,7 @@ VAStatus DdiMedia_DestroyBuffer (
     DDI_CHK_NULL(pMediaCtx,              "Null pMediaCtx",              VA_STATUS_ERROR_INVALID_CONTEXT);
 
     DDI_CHK_NULL(pMediaCtx->pBufferHeap, "Null pMediaCtx->pBufferHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)buffer_id, pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid bufferId", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)buffer_id), pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid bufferId", VA_STATUS_ERROR_INVALID_CONTEXT);
 
     pBuf      = DdiMedia_GetBufferFromVABufferID(pMediaCtx,  buffer_id);
     DDI_CHK_NULL(pBuf, "Null pBuf", VA_STATUS_ERROR_INVALID_BUFFER);
@@ -3609,21 +3583,21 @@ static VAStatus DdiMedia_BeginPicture (
 
     DDI_CHK_NULL(pMediaCtx,               "Null pMediaCtx",               VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)render_target, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "render_target", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)render_target), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "render_target", VA_STATUS_ERROR_INVALID_SURFACE);
 
     pCtx  = DdiMedia_GetContextFromContextID(ctx, context, &uiCtxType);
 
     pSurface = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, render_target);
     DDI_CHK_NULL(pSurface, "Null pSurface", VA_STATUS_ERROR_INVALID_SURFACE);
 
-    DdiMediaUtil_LockMutex(&pMediaCtx->SurfaceMutex);
+    DdiMediaUtil_LockMutex(&pSurface->StatusMutex);
     pSurface->curCtxType = uiCtxType;
     pSurface->curStatusReportQueryState = DDI_MEDIA_STATUS_REPORT_QUREY_STATE_PENDING;
     if(uiCtxType == DDI_MEDIA_CONTEXT_TYPE_VP)
     {
         pSurface->curStatusReport.vpp.status = VPREP_NOTAVAILABLE;
     }
-    DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceMutex);
+    DdiMediaUtil_UnLockMutex(&pSurface->StatusMutex);
 
     switch (uiCtxType)
     {
@@ -3669,7 +3643,7 @@ static VAStatus DdiMedia_RenderPicture (
 
     for(i = 0; i < num_buffers; i++)
     {
-       DDI_CHK_LESS((uint32_t)buffers[i], pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid Buffer", VA_STATUS_ERROR_INVALID_BUFFER);
+       DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)buffers[i]), pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid Buffer", VA_STATUS_ERROR_INVALID_BUFFER);
     }
 
     pCtx  = DdiMedia_GetContextFromContextID(ctx, context, &uiCtxType);
@@ -3746,12 +3720,11 @@ static VAStatus DdiMedia_SyncSurface (
     CodechalDecodeStatus           *pDecStatus = nullptr;
     CodechalDecodeStatusReport     *pDecStatusReport = nullptr;
     MOS_STATUS                      eStatus = MOS_STATUS_UNKNOWN;
-    int32_t                         i, j, index;
+    int32_t                         i, index;
     uint32_t                        uNumAvailableReport = 0, uNumCompletedReport = 0;
-    uint32_t                        TIMEOUT_NS = 100000000;
     MOS_LINUX_BO                   *bo = nullptr;
     CodechalDecodeStatusReport      tempNewReport;
-    PDDI_MEDIA_SURFACE_HEAP_ELEMENT pMediaSurfaceHeapElmt = nullptr;
+    DDI_MEDIA_SURFACE              *pReportSurface = nullptr;
 
     DDI_FUNCTION_ENTER();
 
@@ -3761,7 +3734,7 @@ static VAStatus DdiMedia_SyncSurface (
     DDI_CHK_NULL(pMediaCtx,               "Null pMediaCtx",               VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
 
-    DDI_CHK_LESS((uint32_t)render_target, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid render_target", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)render_target), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid render_target", VA_STATUS_ERROR_INVALID_SURFACE);
 
     pSurface  = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, render_target);
     DDI_CHK_NULL(pSurface,    "Null pSurface",      VA_STATUS_ERROR_INVALID_CONTEXT);
@@ -3771,11 +3744,11 @@ static VAStatus DdiMedia_SyncSurface (
         DdiMediaUtil_PostSemaphore(pSurface->pCurrentFrameSemaphore);
     }
 
-    // check the bo here?
-    // zero is a expected return value
-    while (0 != mos_gem_bo_wait(pSurface->bo, TIMEOUT_NS))
+    // A negative timeout blocks until the bo is idle, zero is the expected return value
+    if (0 != mos_gem_bo_wait(pSurface->bo, -1))
     {
-        // Just loop while gem_bo_wait times-out.
+        // Kernels with a broken infinite wait time out here, fall back to waiting for rendering
+        mos_bo_wait_rendering(pSurface->bo);
     }
 
     pDecCtx = (PDDI_DECODE_CONTEXT)pSurface->pDecCtx;
@@ -3824,29 +3797,18 @@ static VAStatus DdiMedia_SyncSurface (
 
                     if ((tempNewReport.m_codecStatus == CODECHAL_STATUS_SUCCESSFUL) || (tempNewReport.m_codecStatus == CODECHAL_STATUS_ERROR) || (tempNewReport.m_codecStatus == CODECHAL_STATUS_INCOMPLETE))
                     {
-                        DdiMediaUtil_LockMutex(&pMediaCtx->SurfaceMutex);
-                        pMediaSurfaceHeapElmt = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)pMediaCtx->pSurfaceHeap->pHeapBase;
-
-                        for (j = 0; j < pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements; j++, pMediaSurfaceHeapElmt++)
+                        // Returned with its StatusMutex held
+                        pReportSurface = DdiMediaUtil_LockSurfaceStatusByBo(pMediaCtx, bo);
+                        if (pReportSurface == nullptr)
                         {
-                            if (pMediaSurfaceHeapElmt != nullptr && 
-                                    pMediaSurfaceHeapElmt->pSurface != nullptr && 
-                                    bo == pMediaSurfaceHeapElmt->pSurface->bo)
-                            {
-                                pMediaSurfaceHeapElmt->pSurface->curStatusReport.decode.status = (uint32_t)tempNewReport.m_codecStatus;
-                                pMediaSurfaceHeapElmt->pSurface->curStatusReport.decode.errMbNum = (uint32_t)tempNewReport.m_numMbsAffected;
-                                pMediaSurfaceHeapElmt->pSurface->curStatusReport.decode.crcValue = (pDecoder->GetStandard() == CODECHAL_AVC)?(uint32_t)tempNewReport.m_frameCrc:0;
-                                pMediaSurfaceHeapElmt->pSurface->curStatusReportQueryState = DDI_MEDIA_STATUS_REPORT_QUREY_STATE_COMPLETED;
-                                break;
-                            }
-                        }
-
-                        if (j == pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements)
-                        {
-                            DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceMutex);
                             return VA_STATUS_ERROR_OPERATION_FAILED;
                         }
-                        DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceMutex);
+
+                        pReportSurface->curStatusReport.decode.status   = (uint32_t)tempNewReport.m_codecStatus;
+                        pReportSurface->curStatusReport.decode.errMbNum = (uint32_t)tempNewReport.m_numMbsAffected;
+                        pReportSurface->curStatusReport.decode.crcValue = (pDecoder->GetStandard() == CODECHAL_AVC)?(uint32_t)tempNewReport.m_frameCrc:0;
+                        pReportSurface->curStatusReportQueryState       = DDI_MEDIA_STATUS_REPORT_QUREY_STATE_COMPLETED;
+                        DdiMediaUtil_UnLockMutex(&pReportSurface->StatusMutex);
                     }
                     else
                     {
@@ -3908,8 +3870,10 @@ static VAStatus DdiMedia_SyncSurface (
                 }
 
                 // Update the status of the surface which is reported.
+                DdiMediaUtil_LockMutex(&pTempSurface->StatusMutex);
                 pTempSurface->curStatusReport.vpp.status = (uint32_t)tempVpReport.dwStatus;
                 pTempSurface->curStatusReportQueryState  = DDI_MEDIA_STATUS_REPORT_QUREY_STATE_COMPLETED;
+                DdiMediaUtil_UnLockMutex(&pTempSurface->StatusMutex);
 
                 if(tempVpReport.StatusFeedBackID == render_target)
                 {
@@ -3963,7 +3927,7 @@ static VAStatus DdiMedia_QuerySurfaceStatus (
     DDI_CHK_NULL(pMediaCtx,                  "Null pMediaCtx",               VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaCtx->pSurfaceHeap,    "Null pMediaCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
 
-    DDI_CHK_LESS((uint32_t)render_target, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid render_target", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)render_target), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid render_target", VA_STATUS_ERROR_INVALID_SURFACE);
     pSurface   = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, render_target);
     DDI_CHK_NULL(pSurface,    "Null pSurface",    VA_STATUS_ERROR_INVALID_SURFACE);
 
@@ -4038,7 +4002,7 @@ VAStatus DdiMedia_QuerySurfaceError(
 
     pSurfaceErrors   = pDecCtx->vaSurfDecErrOutput;
 
-    DdiMediaUtil_LockMutex(&pMediaCtx->SurfaceMutex);
+    DdiMediaUtil_LockMutex(&pSurface->StatusMutex);
     if (pSurface->curStatusReportQueryState == DDI_MEDIA_STATUS_REPORT_QUREY_STATE_COMPLETED)
     {
         if (error_status == -1 && pSurface->curCtxType == DDI_MEDIA_CONTEXT_TYPE_DECODER)
@@ -4048,10 +4012,11 @@ VAStatus DdiMedia_QuerySurfaceError(
             DDI_CHK_NULL(decoder, "Null codechal decoder", VA_STATUS_ERROR_INVALID_CONTEXT);
             if (decoder->GetStandard() != CODECHAL_AVC)
             {
+                DdiMediaUtil_UnLockMutex(&pSurface->StatusMutex);
                 return VA_STATUS_ERROR_UNIMPLEMENTED;
             }
             *error_info = (void *)&pSurface->curStatusReport.decode.crcValue;
-            DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceMutex);
+            DdiMediaUtil_UnLockMutex(&pSurface->StatusMutex);
             return VA_STATUS_SUCCESS;
         }
 
@@ -4065,20 +4030,20 @@ VAStatus DdiMedia_QuerySurfaceError(
             pSurfaceErrors[0].num_mb            = pSurface->curStatusReport.decode.errMbNum;
             pSurfaceErrors[0].decode_error_type = VADecodeMBError;
             *error_info = pSurfaceErrors;
-            DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceMutex);
+            DdiMediaUtil_UnLockMutex(&pSurface->StatusMutex);
             return VA_STATUS_SUCCESS;
         }
 
         if (pSurface->curCtxType == DDI_MEDIA_CONTEXT_TYPE_VP &&
             pSurface->curStatusReport.vpp.status == CODECHAL_STATUS_ERROR)
         {
-            DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceMutex);
+            DdiMediaUtil_UnLockMutex(&pSurface->StatusMutex);
             return VA_STATUS_SUCCESS;
         }
     }
 
     pSurfaceErrors[0].status = -1;
-    DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceMutex);
+    DdiMediaUtil_UnLockMutex(&pSurface->StatusMutex);
     return VA_STATUS_SUCCESS;
 }
 
@@ -4127,9 +4092,10 @@ static VAStatus DdiMedia_PutSurface(
     uint32_t         flags             /* de-interlacing flags */
 )
 {
-    PDDI_MEDIA_CONTEXT              pMediaDrvCtx;
-    void                           *pVpCtx;
-    uint32_t                        uiCtxType;
+    PDDI_MEDIA_CONTEXT                pMediaDrvCtx;
+    PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT pVpCtxHeapElmt;
+    void                             *pVpCtx;
+    uint32_t                          uiCtxType;
 
     DDI_FUNCTION_ENTER();
 
@@ -4145,11 +4111,12 @@ static VAStatus DdiMedia_PutSurface(
     DDI_CHK_NULL(pMediaDrvCtx,               "Null pMediaDrvCtx",               VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaDrvCtx->pSurfaceHeap, "Null pMediaDrvCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
 
-    DDI_CHK_LESS((uint32_t)surface, pMediaDrvCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surface), pMediaDrvCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
 
-    if (nullptr != pMediaDrvCtx->pVpCtxHeap->pHeapBase)
+    pVpCtxHeapElmt = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)DdiMediaUtil_GetHeapElementByIndex(pMediaDrvCtx->pVpCtxHeap, 0);
+    if (nullptr != pVpCtxHeapElmt)
     {
-        pVpCtx = DdiMedia_GetContextFromContextID(ctx, (VAContextID)(0 + DDI_MEDIA_VACONTEXTID_OFFSET_VP), &uiCtxType);
+        pVpCtx = DdiMedia_GetContextFromContextID(ctx, (VAContextID)(pVpCtxHeapElmt->uiVaContextID + DDI_MEDIA_VACONTEXTID_OFFSET_VP), &uiCtxType);
     }
 
 #ifdef ANDROID
@@ -4255,7 +4222,7 @@ VAStatus DdiMedia_CreateImage(
         pVAImg->num_planes               = 1;
         pVAImg->pitches[0]               = iPitch;
     }
-    else if (pVAImg->format.fourcc == VA_FOURCC_YV12)
+    else if (pVAImg->format.fourcc == VA_FOURCC_YV12 || pVAImg->format.fourcc == VA_FOURCC_I420)
     {
         iPitch      = width;
         halfwidth   = (width  + 1) / 2;
@@ -4325,7 +4292,7 @@ VAStatus DdiMedia_CreateImage(
         pVAImg->offsets[1]               = MOS_ALIGN_CEIL(height,32) * iPitch;
         pVAImg->offsets[2]               = pVAImg->offsets[1] + 1;
     }
-    else if(pVAImg->format.fourcc == VA_FOURCC('P','0','1','0'))
+    else if(pVAImg->format.fourcc == VA_FOURCC('P','0','1','0') || pVAImg->format.fourcc == VA_FOURCC('P','0','1','6'))
     {
         iPitch = MOS_ALIGN_CEIL(width, 128) * 2;
 
@@ -4406,55 +4373,16 @@ VAStatus DdiMedia_CreateImage(
     return VA_STATUS_SUCCESS;
 }
 
-VAStatus DdiMedia_DeriveImage (
-    VADriverContextP  ctx,
-    VASurfaceID       surface,
-    VAImage           *image
-)
+//!
+//! \brief  Describe the memory layout of a surface as a VAImage
+//!
+//! \param  [in] pSurface
+//!         Media surface
+//! \param  [out] pVAImg
+//!         Receives fourcc, size, planes, pitches and offsets of the surface
+//!
+static void DdiMedia_GetSurfaceImageLayout(DDI_MEDIA_SURFACE *pSurface, VAImage *pVAImg)
 {
-    PDDI_MEDIA_CONTEXT             pMediaCtx;
-    DDI_MEDIA_SURFACE              *pSurface;
-    VAImage                        *pVAImg;
-    DDI_MEDIA_BUFFER               *pBuf = nullptr;
-    PDDI_MEDIA_IMAGE_HEAP_ELEMENT  pImageHeapElement;
-    PDDI_MEDIA_BUFFER_HEAP_ELEMENT pBufferHeapElement;
-    VAStatus                       vaStatus;
-
-    DDI_FUNCTION_ENTER();
-
-    DDI_CHK_NULL(ctx,   "Null ctx",   VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_NULL(image, "Null image", VA_STATUS_ERROR_INVALID_PARAMETER);
-
-    pMediaCtx        = DdiMedia_GetMediaContext(ctx);
-    DDI_CHK_NULL(pMediaCtx, "Null pMediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
-
-    DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)surface, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
-
-    pSurface         = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, surface);
-    DDI_CHK_NULL(pSurface, "Null pSurface", VA_STATUS_ERROR_INVALID_SURFACE);
-
-    pVAImg           = (VAImage*)MOS_AllocAndZeroMemory(sizeof(VAImage));
-    DDI_CHK_NULL(pVAImg, "Null pVAImg", VA_STATUS_ERROR_ALLOCATION_FAILED);
-
-    if (pSurface->pCurrentFrameSemaphore)
-    {
-        DdiMediaUtil_WaitSemaphore(pSurface->pCurrentFrameSemaphore);
-        DdiMediaUtil_PostSemaphore(pSurface->pCurrentFrameSemaphore);
-    }
-    DdiMediaUtil_LockMutex(&pMediaCtx->ImageMutex);
-    pImageHeapElement                = DdiMediaUtil_AllocPVAImageFromHeap(pMediaCtx->pImageHeap);
-    if (nullptr == pImageHeapElement)
-    {
-        DdiMediaUtil_UnLockMutex(&pMediaCtx->ImageMutex);
-        vaStatus = VA_STATUS_ERROR_MAX_NUM_EXCEEDED;
-        goto CleanUpandReturn;
-    }
-    pImageHeapElement->pImage        = pVAImg;
-    pMediaCtx->uiNumImages++;
-    pVAImg->image_id                 = pImageHeapElement->uiVaImageID;
-    DdiMediaUtil_UnLockMutex(&pMediaCtx->ImageMutex);
-
     pVAImg->format.fourcc            = DdiMedia_MediaFormatToOsFormat(pSurface->format);
     pVAImg->width                    = pSurface->iWidth;
     pVAImg->height                   = pSurface->iRealHeight;
@@ -4600,6 +4528,58 @@ VAStatus DdiMedia_DeriveImage (
         pVAImg->offsets[2]               = pVAImg->offsets[1] + 1;
         break;
     }
+}
+
+VAStatus DdiMedia_DeriveImage (
+    VADriverContextP  ctx,
+    VASurfaceID       surface,
+    VAImage           *image
+)
+{
+    PDDI_MEDIA_CONTEXT             pMediaCtx;
+    DDI_MEDIA_SURFACE              *pSurface;
+    VAImage                        *pVAImg;
+    DDI_MEDIA_BUFFER               *pBuf = nullptr;
+    PDDI_MEDIA_IMAGE_HEAP_ELEMENT  pImageHeapElement;
+    PDDI_MEDIA_BUFFER_HEAP_ELEMENT pBufferHeapElement;
+    VAStatus                       vaStatus;
+
+    DDI_FUNCTION_ENTER();
+
+    DDI_CHK_NULL(ctx,   "Null ctx",   VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_NULL(image, "Null image", VA_STATUS_ERROR_INVALID_PARAMETER);
+
+    pMediaCtx        = DdiMedia_GetMediaContext(ctx);
+    DDI_CHK_NULL(pMediaCtx, "Null pMediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surface), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
+
+    pSurface         = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, surface);
+    DDI_CHK_NULL(pSurface, "Null pSurface", VA_STATUS_ERROR_INVALID_SURFACE);
+
+    pVAImg           = (VAImage*)MOS_AllocAndZeroMemory(sizeof(VAImage));
+    DDI_CHK_NULL(pVAImg, "Null pVAImg", VA_STATUS_ERROR_ALLOCATION_FAILED);
+
+    if (pSurface->pCurrentFrameSemaphore)
+    {
+        DdiMediaUtil_WaitSemaphore(pSurface->pCurrentFrameSemaphore);
+        DdiMediaUtil_PostSemaphore(pSurface->pCurrentFrameSemaphore);
+    }
+    DdiMediaUtil_LockMutex(&pMediaCtx->ImageMutex);
+    pImageHeapElement                = DdiMediaUtil_AllocPVAImageFromHeap(pMediaCtx->pImageHeap);
+    if (nullptr == pImageHeapElement)
+    {
+        DdiMediaUtil_UnLockMutex(&pMediaCtx->ImageMutex);
+        vaStatus = VA_STATUS_ERROR_MAX_NUM_EXCEEDED;
+        goto CleanUpandReturn;
+    }
+    pImageHeapElement->pImage        = pVAImg;
+    pMediaCtx->uiNumImages++;
+    pVAImg->image_id                 = pImageHeapElement->uiVaImageID;
+    DdiMediaUtil_UnLockMutex(&pMediaCtx->ImageMutex);
+
+    DdiMedia_GetSurfaceImageLayout(pSurface, pVAImg);
 
     pBuf               = (DDI_MEDIA_BUFFER *)MOS_AllocAndZeroMemory(sizeof(DDI_MEDIA_BUFFER));
 	if (pBuf == nullptr)
@@ -4672,7 +4652,7 @@ VAStatus DdiMedia_DestroyImage (
 
     DDI_CHK_NULL(pMediaCtx,             "Null Media",                        VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaCtx->pImageHeap, "Null pMediaCtx->pImageHeap",        VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)image, pMediaCtx->pImageHeap->uiAllocatedHeapElements, "Invalid image", VA_STATUS_ERROR_INVALID_IMAGE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)image), pMediaCtx->pImageHeap->uiAllocatedHeapElements, "Invalid image", VA_STATUS_ERROR_INVALID_IMAGE);
 
     pImage    = DdiMedia_GetVAImageFromVAImageID(pMediaCtx, image);
     if (pImage == nullptr)
@@ -4701,6 +4681,399 @@ VAStatus DdiMedia_SetImagePalette(
 }
 
 
+//!
+//! \brief  Sampling of one plane of a VAImage layout
+//!
+typedef struct _DDI_MEDIA_PLANE_SAMPLING
+{
+    uint32_t    uiBytesPerUnit;     // bytes per horizontal sampling unit
+    uint32_t    uiHShift;           // log2 of the horizontal subsampling
+    uint32_t    uiVShift;           // log2 of the vertical subsampling
+} DDI_MEDIA_PLANE_SAMPLING;
+
+//!
+//! \brief  Get the sampling of one plane of an image format
+//!
+//! \param  [in] fourcc
+//!         Image fourcc
+//! \param  [in] uiPlane
+//!         Plane index
+//! \param  [out] pSampling
+//!         Sampling of the plane
+//!
+//! \return bool
+//!         true if the fourcc/plane is known, otherwise false
+//!
+static bool DdiMedia_GetPlaneSampling(uint32_t fourcc, uint32_t uiPlane, DDI_MEDIA_PLANE_SAMPLING *pSampling)
+{
+    uint32_t uiBytes  = 1;
+    uint32_t uiHShift = 0;
+    uint32_t uiVShift = 0;
+    uint32_t uiPlanes = 1;
+
+    switch (fourcc)
+    {
+        case VA_FOURCC_NV12:
+        case VA_FOURCC_NV21:
+            uiPlanes = 2;
+            uiBytes  = (uiPlane == 0) ? 1 : 2;
+            uiHShift = uiVShift = (uiPlane == 0) ? 0 : 1;
+            break;
+        case VA_FOURCC('P','0','1','0'):
+        case VA_FOURCC('P','0','1','6'):
+            uiPlanes = 2;
+            uiBytes  = (uiPlane == 0) ? 2 : 4;
+            uiHShift = uiVShift = (uiPlane == 0) ? 0 : 1;
+            break;
+        case VA_FOURCC_YV12:
+        case VA_FOURCC_I420:
+        case VA_FOURCC_IYUV:
+        case VA_FOURCC_IMC3:
+            uiPlanes = 3;
+            uiHShift = uiVShift = (uiPlane == 0) ? 0 : 1;
+            break;
+        case VA_FOURCC_422H:
+            uiPlanes = 3;
+            uiHShift = (uiPlane == 0) ? 0 : 1;
+            break;
+        case VA_FOURCC_422V:
+            uiPlanes = 3;
+            uiVShift = (uiPlane == 0) ? 0 : 1;
+            break;
+        case VA_FOURCC_411P:
+            uiPlanes = 3;
+            uiHShift = (uiPlane == 0) ? 0 : 2;
+            break;
+        case VA_FOURCC_444P:
+            uiPlanes = 3;
+            break;
+        case VA_FOURCC('4','0','0','P'):
+        case VA_FOURCC_Y800:
+            break;
+        case VA_FOURCC_YUY2:
+        case VA_FOURCC_UYVY:
+            // one unit is a two pixel macropixel
+            uiBytes  = 4;
+            uiHShift = 1;
+            break;
+        case VA_FOURCC_ARGB:
+        case VA_FOURCC_ABGR:
+        case VA_FOURCC_XRGB:
+        case VA_FOURCC_XBGR:
+        case VA_FOURCC_BGRA:
+        case VA_FOURCC_RGBA:
+        case VA_FOURCC_BGRX:
+        case VA_FOURCC_RGBX:
+            uiBytes  = 4;
+            break;
+        case VA_FOURCC_R5G6B5:
+            uiBytes  = 2;
+            break;
+        case VA_FOURCC_R8G8B8:
+            uiBytes  = 3;
+            break;
+        default:
+            return false;
+    }
+
+    if (uiPlane >= uiPlanes)
+    {
+        return false;
+    }
+
+    pSampling->uiBytesPerUnit = uiBytes;
+    pSampling->uiHShift       = uiHShift;
+    pSampling->uiVShift       = uiVShift;
+    return true;
+}
+
+//!
+//! \brief  Pixel region of one plane, in sampling units
+//!
+typedef struct _DDI_MEDIA_PLANE_REGION
+{
+    uint8_t    *pSurf;              // first byte of the region in the surface plane
+    uint8_t    *pImage;             // first byte of the region in the image plane
+    uint32_t    uiSurfPitch;
+    uint32_t    uiImagePitch;
+    uint32_t    uiUnits;            // sampling units per row
+    uint32_t    uiRows;
+} DDI_MEDIA_PLANE_REGION;
+
+static void DdiMedia_GetPlaneRegion(
+    uint8_t                    *pSurfData,
+    VAImage                    *pSurfLayout,
+    uint32_t                    uiSurfPlane,
+    uint8_t                    *pImageData,
+    VAImage                    *pVAImg,
+    uint32_t                    uiImagePlane,
+    DDI_MEDIA_PLANE_SAMPLING   *pSampling,
+    int32_t                     surfX,
+    int32_t                     surfY,
+    int32_t                     imgX,
+    int32_t                     imgY,
+    uint32_t                    width,
+    uint32_t                    height,
+    DDI_MEDIA_PLANE_REGION     *pRegion)
+{
+    uint32_t uiHUnit = 1 << pSampling->uiHShift;
+    uint32_t uiVUnit = 1 << pSampling->uiVShift;
+    uint32_t uiX     = (uint32_t)surfX >> pSampling->uiHShift;
+    uint32_t uiY     = (uint32_t)surfY >> pSampling->uiVShift;
+
+    pRegion->uiUnits      = ((surfX + width  + uiHUnit - 1) >> pSampling->uiHShift) - uiX;
+    pRegion->uiRows       = ((surfY + height + uiVUnit - 1) >> pSampling->uiVShift) - uiY;
+    pRegion->uiSurfPitch  = pSurfLayout->pitches[uiSurfPlane];
+    pRegion->uiImagePitch = pVAImg->pitches[uiImagePlane];
+    pRegion->pSurf        = pSurfData + pSurfLayout->offsets[uiSurfPlane] +
+                            uiY * pRegion->uiSurfPitch + uiX * pSampling->uiBytesPerUnit;
+    pRegion->pImage       = pImageData + pVAImg->offsets[uiImagePlane] +
+                            ((uint32_t)imgY >> pSampling->uiVShift) * pRegion->uiImagePitch +
+                            ((uint32_t)imgX >> pSampling->uiHShift) * pSampling->uiBytesPerUnit;
+}
+
+//!
+//! \brief  Copy a region between a locked surface and a mapped image
+//!
+//! \details Only the requested rows and bytes of every plane are touched.
+//!          Reads from the surface go through streaming loads since tiled
+//!          surfaces are mapped write-combined through the GTT. Besides a
+//!          plain copy between identical formats, NV12 <-> I420/YV12,
+//!          P010 <-> P016, YUY2 <-> NV12 and ARGB <-> ABGR are converted
+//!          on the CPU.
+//!
+//! \param  [in] pSurface
+//!         Media surface
+//! \param  [in] pSurfData
+//!         Locked surface data
+//! \param  [in] pVAImg
+//!         VA image
+//! \param  [in] pImageData
+//!         Mapped image data
+//! \param  [in] surfX, surfY
+//!         Top left of the region in the surface
+//! \param  [in] imgX, imgY
+//!         Top left of the region in the image
+//! \param  [in] width, height
+//!         Size of the region
+//! \param  [in] bSurfaceToImage
+//!         true to copy surface to image, false for image to surface
+//!
+//! \return VAStatus
+//!         VA_STATUS_SUCCESS if success, else fail reason
+//!
+static VAStatus DdiMedia_CopySurfaceImageRegion(
+    DDI_MEDIA_SURFACE  *pSurface,
+    uint8_t            *pSurfData,
+    VAImage            *pVAImg,
+    uint8_t            *pImageData,
+    int32_t             surfX,
+    int32_t             surfY,
+    int32_t             imgX,
+    int32_t             imgY,
+    uint32_t            width,
+    uint32_t            height,
+    bool                bSurfaceToImage)
+{
+    VAImage                     surfLayout;
+    DDI_MEDIA_FORMAT            imageFormat;
+    DDI_MEDIA_PLANE_SAMPLING    sampling;
+    DDI_MEDIA_PLANE_REGION      region;
+    uint8_t                    *pScratch = nullptr;
+    uint32_t                    uiPlane, uiRow;
+    VAStatus                    vaStatus = VA_STATUS_SUCCESS;
+
+    DDI_CHK_CONDITION((surfX < 0 || surfY < 0 || imgX < 0 || imgY < 0), "Invalid region offset", VA_STATUS_ERROR_INVALID_PARAMETER);
+    DDI_CHK_CONDITION((surfX + width  > (uint32_t)pSurface->iWidth  ||
+                       surfY + height > (uint32_t)pSurface->iHeight), "Region exceeds surface", VA_STATUS_ERROR_INVALID_PARAMETER);
+    DDI_CHK_CONDITION((imgX + width  > pVAImg->width ||
+                       imgY + height > pVAImg->height), "Region exceeds image", VA_STATUS_ERROR_INVALID_PARAMETER);
+
+    MOS_ZeroMemory(&surfLayout, sizeof(surfLayout));
+    DdiMedia_GetSurfaceImageLayout(pSurface, &surfLayout);
+
+    imageFormat = DdiMedia_OsFormatAlphaMaskToMediaFormat(pVAImg->format.fourcc, pVAImg->format.alpha_mask);
+    if (pVAImg->format.fourcc == VA_FOURCC('P','0','1','6'))
+    {
+        // P016 shares the P010 layout, P010 just leaves the low 6 bits unused
+        imageFormat = Media_Format_P010;
+    }
+
+    // YUY2 <-> NV12 converts whole chroma pairs, the region must start on one on both sides
+    DDI_CHK_CONDITION((((pSurface->format == Media_Format_YUY2 && imageFormat == Media_Format_NV12) ||
+                        (pSurface->format == Media_Format_NV12 && imageFormat == Media_Format_YUY2)) &&
+                       ((surfX | imgX) & 1)), "Odd region offset", VA_STATUS_ERROR_INVALID_PARAMETER);
+
+    if (bSurfaceToImage)
+    {
+        pScratch = (uint8_t *)MOS_AllocMemory(pSurface->iPitch * 2);
+        DDI_CHK_NULL(pScratch, "Null pScratch", VA_STATUS_ERROR_ALLOCATION_FAILED);
+    }
+
+    if (pSurface->format == imageFormat)
+    {
+        for (uiPlane = 0; uiPlane < surfLayout.num_planes && uiPlane < pVAImg->num_planes; uiPlane++)
+        {
+            if (!DdiMedia_GetPlaneSampling(surfLayout.format.fourcc, uiPlane, &sampling))
+            {
+                vaStatus = VA_STATUS_ERROR_UNIMPLEMENTED;
+                break;
+            }
+            DdiMedia_GetPlaneRegion(pSurfData, &surfLayout, uiPlane, pImageData, pVAImg, uiPlane, &sampling,
+                surfX, surfY, imgX, imgY, width, height, &region);
+
+            for (uiRow = 0; uiRow < region.uiRows; uiRow++)
+            {
+                uint8_t *pSurfRow  = region.pSurf  + uiRow * region.uiSurfPitch;
+                uint8_t *pImageRow = region.pImage + uiRow * region.uiImagePitch;
+                uint32_t uiBytes   = region.uiUnits * sampling.uiBytesPerUnit;
+
+                if (bSurfaceToImage)
+                {
+                    DdiMediaUtil_CopyRowFromWC(pImageRow, pSurfRow, uiBytes);
+                }
+                else
+                {
+                    MOS_SecureMemcpy(pSurfRow, uiBytes, pImageRow, uiBytes);
+                }
+            }
+        }
+    }
+    else if (pSurface->format == Media_Format_NV12 &&
+             (imageFormat == Media_Format_I420 || imageFormat == Media_Format_IYUV || imageFormat == Media_Format_YV12))
+    {
+        uint32_t uiUPlane = (imageFormat == Media_Format_YV12) ? 2 : 1;
+        uint32_t uiVPlane = (imageFormat == Media_Format_YV12) ? 1 : 2;
+        uint8_t *pU, *pV;
+
+        // luma
+        DdiMedia_GetPlaneSampling(VA_FOURCC_NV12, 0, &sampling);
+        DdiMedia_GetPlaneRegion(pSurfData, &surfLayout, 0, pImageData, pVAImg, 0, &sampling,
+            surfX, surfY, imgX, imgY, width, height, &region);
+        for (uiRow = 0; uiRow < region.uiRows; uiRow++)
+        {
+            uint8_t *pSurfRow  = region.pSurf  + uiRow * region.uiSurfPitch;
+            uint8_t *pImageRow = region.pImage + uiRow * region.uiImagePitch;
+
+            if (bSurfaceToImage)
+            {
+                DdiMediaUtil_CopyRowFromWC(pImageRow, pSurfRow, region.uiUnits);
+            }
+            else
+            {
+                MOS_SecureMemcpy(pSurfRow, region.uiUnits, pImageRow, region.uiUnits);
+            }
+        }
+
+        // chroma: UV pairs of the surface against the U and V planes of the image
+        DdiMedia_GetPlaneSampling(VA_FOURCC_NV12, 1, &sampling);
+        DdiMedia_GetPlaneRegion(pSurfData, &surfLayout, 1, pImageData, pVAImg, uiUPlane, &sampling,
+            surfX, surfY, imgX, imgY, width, height, &region);
+        pU = pImageData + pVAImg->offsets[uiUPlane] +
+             ((uint32_t)imgY >> 1) * pVAImg->pitches[uiUPlane] + ((uint32_t)imgX >> 1);
+        pV = pImageData + pVAImg->offsets[uiVPlane] +
+             ((uint32_t)imgY >> 1) * pVAImg->pitches[uiVPlane] + ((uint32_t)imgX >> 1);
+
+        for (uiRow = 0; uiRow < region.uiRows; uiRow++)
+        {
+            uint8_t *pSurfRow = region.pSurf  + uiRow * region.uiSurfPitch;
+            uint8_t *pURow    = pU + uiRow * pVAImg->pitches[uiUPlane];
+            uint8_t *pVRow    = pV + uiRow * pVAImg->pitches[uiVPlane];
+
+            if (bSurfaceToImage)
+            {
+                DdiMediaUtil_CopyRowFromWC(pScratch, pSurfRow, region.uiUnits * 2);
+                DdiMediaUtil_SplitBytePairs(pScratch, pURow, pVRow, region.uiUnits);
+            }
+            else
+            {
+                DdiMediaUtil_InterleaveBytePairs(pURow, pVRow, pSurfRow, region.uiUnits);
+            }
+        }
+    }
+    else if ((pSurface->format == Media_Format_YUY2 && imageFormat == Media_Format_NV12) ||
+             (pSurface->format == Media_Format_NV12 && imageFormat == Media_Format_YUY2))
+    {
+        bool      bPackedSurface = (pSurface->format == Media_Format_YUY2);
+        VAImage  *pPackedLayout  = bPackedSurface ? &surfLayout : pVAImg;
+        VAImage  *pPlanarLayout  = bPackedSurface ? pVAImg : &surfLayout;
+        uint8_t  *pPackedData    = bPackedSurface ? pSurfData : pImageData;
+        uint8_t  *pPlanarData    = bPackedSurface ? pImageData : pSurfData;
+        int32_t   packedX        = bPackedSurface ? surfX : imgX;
+        int32_t   packedY        = bPackedSurface ? surfY : imgY;
+        int32_t   planarX        = bPackedSurface ? imgX : surfX;
+        int32_t   planarY        = bPackedSurface ? imgY : surfY;
+        uint32_t  uiPixels       = ((width + 1) >> 1) * 2;
+
+        for (uiRow = 0; uiRow < height; uiRow++)
+        {
+            uint32_t uiPlanarRow = planarY + uiRow;
+            uint8_t *pPacked     = pPackedData + pPackedLayout->offsets[0] +
+                                   (packedY + uiRow) * pPackedLayout->pitches[0] + packedX * 2;
+            uint8_t *pY          = pPlanarData + pPlanarLayout->offsets[0] +
+                                   uiPlanarRow * pPlanarLayout->pitches[0] + planarX;
+            uint8_t *pUV         = pPlanarData + pPlanarLayout->offsets[1] +
+                                   (uiPlanarRow >> 1) * pPlanarLayout->pitches[1] + planarX;
+            bool     bChromaRow  = ((uiPlanarRow & 1) == 0) || (uiRow == 0);
+
+            if (bPackedSurface == bSurfaceToImage)
+            {
+                // packed -> planar, chroma taken from the first row of each pair
+                if (bSurfaceToImage)
+                {
+                    DdiMediaUtil_CopyRowFromWC(pScratch, pPacked, uiPixels * 2);
+                    pPacked = pScratch;
+                }
+                DdiMediaUtil_SplitBytePairs(pPacked, pY, bChromaRow ? pUV : nullptr, uiPixels);
+            }
+            else
+            {
+                // planar -> packed, chroma shared by both rows of each pair
+                if (bSurfaceToImage)
+                {
+                    DdiMediaUtil_CopyRowFromWC(pScratch, pY, uiPixels);
+                    DdiMediaUtil_CopyRowFromWC(pScratch + uiPixels, pUV, uiPixels);
+                    pY  = pScratch;
+                    pUV = pScratch + uiPixels;
+                }
+                DdiMediaUtil_InterleaveBytePairs(pY, pUV, pPacked, uiPixels);
+            }
+        }
+    }
+    else if (((pSurface->format == Media_Format_A8R8G8B8 || pSurface->format == Media_Format_X8R8G8B8) &&
+              (imageFormat == Media_Format_A8B8G8R8 || imageFormat == Media_Format_X8B8G8R8)) ||
+             ((pSurface->format == Media_Format_A8B8G8R8 || pSurface->format == Media_Format_X8B8G8R8) &&
+              (imageFormat == Media_Format_A8R8G8B8 || imageFormat == Media_Format_X8R8G8B8)))
+    {
+        DdiMedia_GetPlaneSampling(VA_FOURCC_ARGB, 0, &sampling);
+        DdiMedia_GetPlaneRegion(pSurfData, &surfLayout, 0, pImageData, pVAImg, 0, &sampling,
+            surfX, surfY, imgX, imgY, width, height, &region);
+
+        for (uiRow = 0; uiRow < region.uiRows; uiRow++)
+        {
+            uint8_t *pSurfRow  = region.pSurf  + uiRow * region.uiSurfPitch;
+            uint8_t *pImageRow = region.pImage + uiRow * region.uiImagePitch;
+
+            if (bSurfaceToImage)
+            {
+                DdiMediaUtil_CopyRowFromWC(pScratch, pSurfRow, region.uiUnits * 4);
+                DdiMediaUtil_SwapRBRow(pScratch, pImageRow, region.uiUnits);
+            }
+            else
+            {
+                DdiMediaUtil_SwapRBRow(pImageRow, pSurfRow, region.uiUnits);
+            }
+        }
+    }
+    else
+    {
+        vaStatus = VA_STATUS_ERROR_UNIMPLEMENTED;
+    }
+
+    MOS_FreeMemory(pScratch);
+    return vaStatus;
+}
+
 ////////////////////////////////////////////////////
 // Retrive surface data into a VAImage
 // Image must be in a format supported by the implementation
@@ -4729,11 +5102,7 @@ VAStatus DdiMedia_GetImage(
     VAStatus                      status;
     void                         *pSurfData;
     void                         *pImageData;
-    MOS_STATUS                    eStatus = MOS_STATUS_SUCCESS;
-    DDI_UNUSED(x);
-    DDI_UNUSED(y);
-    DDI_UNUSED(width);
-    DDI_UNUSED(height);
+    VAStatus                      copyStatus;
 
     DDI_FUNCTION_ENTER();
 
@@ -4742,9 +5111,9 @@ VAStatus DdiMedia_GetImage(
     pMediaCtx       = DdiMedia_GetMediaContext(ctx);
     DDI_CHK_NULL(pMediaCtx,               "Null pMediaCtx.",              VA_STATUS_ERROR_INVALID_PARAMETER);
     DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap",   VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)surface, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surface), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
     DDI_CHK_NULL(pMediaCtx->pImageHeap,   "Null pMediaCtx->pImageHeap",     VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)image,   pMediaCtx->pImageHeap->uiAllocatedHeapElements,   "Invalid image",   VA_STATUS_ERROR_INVALID_IMAGE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)image),   pMediaCtx->pImageHeap->uiAllocatedHeapElements,   "Invalid image",   VA_STATUS_ERROR_INVALID_IMAGE);
 
     pSurface        = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, surface);
     DDI_CHK_NULL(pSurface,     "Null pSurface.",      VA_STATUS_ERROR_INVALID_PARAMETER);
@@ -4762,11 +5131,6 @@ VAStatus DdiMedia_GetImage(
     pBuf            = DdiMedia_GetBufferFromVABufferID(pMediaCtx, pVAImg->buf);
     DDI_CHK_NULL(pBuf,         "Null pBuf.",          VA_STATUS_ERROR_INVALID_PARAMETER);
 
-    if (pSurface->format != DdiMedia_OsFormatAlphaMaskToMediaFormat(pVAImg->format.fourcc, pVAImg->format.alpha_mask))
-    {
-        return VA_STATUS_ERROR_UNIMPLEMENTED;
-    }
-
     //Lock Surface
     pSurfData = DdiMediaUtil_LockSurface(pSurface, (MOS_LOCKFLAG_READONLY | MOS_LOCKFLAG_WRITEONLY));
     if (nullptr == pSurfData)
@@ -4781,10 +5145,9 @@ VAStatus DdiMedia_GetImage(
         return VA_STATUS_ERROR_UNKNOWN;
     }
 
-    //copy data from surface to image
-    //this is temp solution, will copy by difference size and difference format in further
-    eStatus = MOS_SecureMemcpy(pImageData, pVAImg->data_size, pSurfData, pVAImg->data_size);
-    DDI_CHK_CONDITION((eStatus != MOS_STATUS_SUCCESS), "DDI:Failed to copy surface to image buffer data!", VA_STATUS_ERROR_OPERATION_FAILED);
+    //copy the requested region from surface to image
+    copyStatus = DdiMedia_CopySurfaceImageRegion(pSurface, (uint8_t *)pSurfData, pVAImg, (uint8_t *)pImageData,
+                                                 x, y, 0, 0, width, height, true);
 
     status = DdiMedia_UnmapBuffer(ctx, pVAImg->buf);
     if (status != VA_STATUS_SUCCESS)
@@ -4795,6 +5158,8 @@ VAStatus DdiMedia_GetImage(
 
     DdiMediaUtil_UnlockSurface(pSurface);
 
+    DDI_CHK_RET(copyStatus, "DDI:Failed to copy surface to image buffer data!");
+
     return VA_STATUS_SUCCESS;
 
 }
@@ -4836,15 +5201,7 @@ VAStatus DdiMedia_PutImage(
     VAStatus                      status;
     void                         *pSurfData;
     void                         *pImageData;
-    MOS_STATUS                    eStatus = MOS_STATUS_SUCCESS;
-    DDI_UNUSED(src_x);
-    DDI_UNUSED(src_y);
-    DDI_UNUSED(src_width);
-    DDI_UNUSED(src_height);
-    DDI_UNUSED(dest_x);
-    DDI_UNUSED(dest_y);
-    DDI_UNUSED(dest_width);
-    DDI_UNUSED(dest_height);
+    VAStatus                      copyStatus;
 
     DDI_FUNCTION_ENTER();
 
@@ -4853,9 +5210,9 @@ VAStatus DdiMedia_PutImage(
     pMediaCtx        = DdiMedia_GetMediaContext(ctx);
     DDI_CHK_NULL(pMediaCtx,               "Null pMediaCtx.",              VA_STATUS_ERROR_INVALID_PARAMETER);
     DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap",   VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)surface, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surface), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
     DDI_CHK_NULL(pMediaCtx->pImageHeap,   "Null pMediaCtx->pImageHeap",     VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)image, pMediaCtx->pImageHeap->uiAllocatedHeapElements,     "Invalid image",   VA_STATUS_ERROR_INVALID_IMAGE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)image), pMediaCtx->pImageHeap->uiAllocatedHeapElements,     "Invalid image",   VA_STATUS_ERROR_INVALID_IMAGE);
 
     pSurface     = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, surface);
     DDI_CHK_NULL(pSurface, "Null pSurface.", VA_STATUS_ERROR_INVALID_PARAMETER);
@@ -4872,7 +5229,8 @@ VAStatus DdiMedia_PutImage(
     pBuf = DdiMedia_GetBufferFromVABufferID(pMediaCtx, pVAImg->buf);
     DDI_CHK_NULL(pBuf,       "Invalid buffer.",      VA_STATUS_ERROR_INVALID_PARAMETER);
 
-    if (pSurface->format != DdiMedia_OsFormatAlphaMaskToMediaFormat(pVAImg->format.fourcc,pVAImg->format.alpha_mask))
+    // CPU copy path does not scale
+    if (src_width != dest_width || src_height != dest_height)
     {
         return VA_STATUS_ERROR_UNIMPLEMENTED;
     }
@@ -4893,10 +5251,9 @@ VAStatus DdiMedia_PutImage(
         return VA_STATUS_ERROR_UNKNOWN;
     }
 
-    //copy data from image to surferce
-    //this is temp solution, will copy by difference size and difference format in further
-    eStatus = MOS_SecureMemcpy(pSurfData, pVAImg->data_size, pImageData, pVAImg->data_size);
-    DDI_CHK_CONDITION((eStatus != MOS_STATUS_SUCCESS), "DDI:Failed to copy image to surface buffer data!", VA_STATUS_ERROR_OPERATION_FAILED);
+    //copy the requested region from image to surface
+    copyStatus = DdiMedia_CopySurfaceImageRegion(pSurface, (uint8_t *)pSurfData, pVAImg, (uint8_t *)pImageData,
+                                                 dest_x, dest_y, src_x, src_y, dest_width, dest_height, false);
 
     status = DdiMedia_UnmapBuffer(ctx, pVAImg->buf);
     if (status != VA_STATUS_SUCCESS)
@@ -4907,6 +5264,8 @@ VAStatus DdiMedia_PutImage(
 
     DdiMediaUtil_UnlockSurface(pSurface);
 
+    DDI_CHK_RET(copyStatus, "DDI:Failed to copy image to surface buffer data!");
+
     return VA_STATUS_SUCCESS;
 
 }
@@ -5175,7 +5534,7 @@ VAStatus DdiMedia_BufferInfo (
         return VA_STATUS_ERROR_INVALID_CONTEXT;
 
     DDI_CHK_NULL(pMediaCtx->pBufferHeap, "Null pMediaCtx->pBufferHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)buf_id, pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid buf_id", VA_STATUS_ERROR_INVALID_BUFFER);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)buf_id), pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "Invalid buf_id", VA_STATUS_ERROR_INVALID_BUFFER);
 
     pBuf  = DdiMedia_GetBufferFromVABufferID(pMediaCtx, buf_id);
     if (nullptr == pBuf)
@@ -5230,7 +5589,7 @@ VAStatus DdiMedia_LockSurface (
     pMediaCtx         = DdiMedia_GetMediaContext(ctx);
     DDI_CHK_NULL(pMediaCtx,               "Null Media",                   VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)surface, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surface), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
 
     pSurface          = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, surface);
     if (nullptr == pSurface)
@@ -5300,7 +5659,7 @@ VAStatus DdiMedia_UnlockSurface (
     pMediaCtx = DdiMedia_GetMediaContext(ctx);
     DDI_CHK_NULL(pMediaCtx,               "Null pMediaCtx",                 VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap",   VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)surface, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surface), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surface", VA_STATUS_ERROR_INVALID_SURFACE);
 
     pSurface  = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, surface);
     DDI_CHK_NULL(pSurface, "Null pSurface", VA_STATUS_ERROR_INVALID_SURFACE);
@@ -5808,7 +6167,7 @@ MEDIAAPI_EXPORT VAStatus DdiMedia_ExtGetSurfaceHandle(
     pMediaCtx = DdiMedia_GetMediaContext(ctx);
     DDI_CHK_NULL(pMediaCtx,               "Null pMediaCtx",               VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_LESS((uint32_t)(*surface), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaces", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)(*surface)), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaces", VA_STATUS_ERROR_INVALID_SURFACE);
 
     pSurface = DdiMedia_GetSurfaceFromVASurfaceID(pMediaCtx, *surface);
     if (pSurface)
@@ -247,6 +247,7 @@ typedef struct _DDI_CODEC_COM_BUFFER_MGR
     int32_t                                     *pNumOfRenderedSliceParaForOneBuffer; // how many slice headers in one slice parameter buffer.
     int32_t                                     *pRenderedOrder; // a array to keep record the sequence when slice data rendered.
     bool                                         bIsSliceOverSize;
+    uint32_t                                     dwMaxFrameBsSize; // largest slice data size of one frame so far, the bitstream arena is sized for it
     //decode parameters
     union
     {
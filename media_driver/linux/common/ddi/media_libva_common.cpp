@@ -30,20 +30,16 @@
 static void* DdiMedia_GetVaContextFromHeap(PDDI_MEDIA_HEAP  pMediaHeap, uint32_t uiIndex, PMEDIA_MUTEX_T pMutex)
 {
     PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT  pVaCtxHeapElmt;
-    void                              *pContext;
 
-    DdiMediaUtil_LockMutex(pMutex);
-    if(nullptr == pMediaHeap || uiIndex >= pMediaHeap->uiAllocatedHeapElements)
+    // Heap lookups take no lock, pMutex only guards creation and destruction
+    MOS_UNUSED(pMutex);
+    pVaCtxHeapElmt  = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pMediaHeap, uiIndex);
+    if (nullptr == pVaCtxHeapElmt)
     {
-        DdiMediaUtil_UnLockMutex(pMutex);
         return nullptr;
     }
-    pVaCtxHeapElmt  = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)pMediaHeap->pHeapBase;
-    pVaCtxHeapElmt += uiIndex;
-    pContext        = pVaCtxHeapElmt->pVaContext;
-    DdiMediaUtil_UnLockMutex(pMutex);
 
-    return pContext;
+    return pVaCtxHeapElmt->pVaContext;
 }
 
 void DdiMedia_MediaSurfaceToMosResource(DDI_MEDIA_SURFACE *pMediaSurface, MOS_RESOURCE  *pMosResource)
@@ -257,36 +253,22 @@ void* DdiMedia_GetContextFromContextID (VADriverContextP ctx, VAContextID vaCtxI
 
 DDI_MEDIA_SURFACE* DdiMedia_GetSurfaceFromVASurfaceID (PDDI_MEDIA_CONTEXT pMediaCtx, VASurfaceID surfaceID)
 {
-    uint32_t                         i;
     PDDI_MEDIA_SURFACE_HEAP_ELEMENT  pSurfaceElement;
-    PDDI_MEDIA_SURFACE               pSurface;
 
-    i                = (uint32_t)surfaceID;
-    DDI_CHK_LESS(i, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "invalid surface id", nullptr);
-    DdiMediaUtil_LockMutex(&pMediaCtx->SurfaceMutex);
-    pSurfaceElement  = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)pMediaCtx->pSurfaceHeap->pHeapBase;
-    pSurfaceElement += i;
-    pSurface         = pSurfaceElement->pSurface;
-    DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceMutex);
+    pSurfaceElement  = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pMediaCtx->pSurfaceHeap, (uint32_t)surfaceID);
+    DDI_CHK_NULL(pSurfaceElement, "invalid surface id", nullptr);
 
-    return pSurface;
+    return pSurfaceElement->pSurface;
 }
 
 DDI_MEDIA_BUFFER* DdiMedia_GetBufferFromVABufferID (PDDI_MEDIA_CONTEXT pMediaCtx, VABufferID bufferID)
 {
-    uint32_t                       i;
     PDDI_MEDIA_BUFFER_HEAP_ELEMENT pBufHeapElement;
-    PDDI_MEDIA_BUFFER              pBuf;
 
-    i                = (uint32_t)bufferID;
-    DDI_CHK_LESS(i, pMediaCtx->pBufferHeap->uiAllocatedHeapElements, "invalid buffer id", nullptr);
-    DdiMediaUtil_LockMutex(&pMediaCtx->BufferMutex);
-    pBufHeapElement  = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)pMediaCtx->pBufferHeap->pHeapBase;
-    pBufHeapElement += i;
-    pBuf             = pBufHeapElement->pBuffer;
-    DdiMediaUtil_UnLockMutex(&pMediaCtx->BufferMutex);
+    pBufHeapElement  = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pMediaCtx->pBufferHeap, (uint32_t)bufferID);
+    DDI_CHK_NULL(pBufHeapElement, "invalid buffer id", nullptr);
 
-    return pBuf;
+    return pBufHeapElement->pBuffer;
 }
 
 bool DdiMedia_DestroyBufFromVABufferID (PDDI_MEDIA_CONTEXT pMediaCtx, VABufferID bufferID)
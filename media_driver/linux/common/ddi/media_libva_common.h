@@ -29,6 +29,7 @@
 #define __MEDIA_LIBVA_COMMON_H__
 
 #include <pthread.h>
+#include <unordered_map>
 
 #include "xf86drm.h"
 #include "drm.h"
@@ -81,7 +82,14 @@ static int32_t atrace_switch            = 0;
 #define DDI_MEDIA_MAX_INSTANCE_NUMBER          0x0FFFFFFF
 
 // heap
+// Heaps are segmented: segment k holds DDI_MEDIA_HEAP_INCREMENTAL_SIZE << k elements and is never reallocated.
+// A VA ID is (generation << DDI_MEDIA_HEAP_INDEX_BITS) | index, it must fit into DDI_MEDIA_MASK_VACONTEXTID.
 #define DDI_MEDIA_HEAP_INCREMENTAL_SIZE      8
+#define DDI_MEDIA_HEAP_MAX_SEGMENTS          17
+#define DDI_MEDIA_HEAP_INDEX_BITS            20
+#define DDI_MEDIA_HEAP_INDEX_MASK            ((1 << DDI_MEDIA_HEAP_INDEX_BITS) - 1)
+#define DDI_MEDIA_HEAP_GENERATION_MASK       0xFF
+#define DDI_MEDIA_HEAP_INDEX(id)             ((uint32_t)(id) & DDI_MEDIA_HEAP_INDEX_MASK)
 
 #define DDI_MEDIA_VACONTEXTID_OFFSET_DECODER       0x10000000
 #define DDI_MEDIA_VACONTEXTID_OFFSET_ENCODER       0x20000000
@@ -243,12 +251,15 @@ typedef struct _DDI_MEDIA_SURFACE
     uint32_t                            curCtxType;                // indicate current surface is using in which context type.
     DDI_MEDIA_STATUS_REPORT_QUERY_STATE curStatusReportQueryState; // indicate status report is queried or not.
     DDI_MEDIA_SURFACE_STATUS_REPORT     curStatusReport;           // union for both decode and vpp status.
+    MEDIA_MUTEX_T                       StatusMutex;               // protects curCtxType and the status report fields above.
 
     PDDI_MEDIA_CONTEXT      pMediaCtx; // Media driver Context
     PMEDIA_SEM_T            pCurrentFrameSemaphore;   // to sync render target for hybrid decoding multi-threading mode
     PMEDIA_SEM_T            pReferenceFrameSemaphore; // to sync reference frame surface. when this semaphore is posted, the surface is not used as reference frame, and safe to be destroied
 } DDI_MEDIA_SURFACE, *PDDI_MEDIA_SURFACE;
 
+typedef std::unordered_map<MOS_LINUX_BO *, PDDI_MEDIA_SURFACE> DDI_MEDIA_SURFACE_BO_INDEX;
+
 typedef struct _DDI_MEDIA_BUFFER
 {
     uint32_t               iSize;
@@ -276,13 +287,15 @@ typedef struct _DDI_MEDIA_BUFFER
     PDDI_MEDIA_SURFACE     pSurface;
     GMM_RESOURCE_INFO     *pGmmResourceInfo; // GMM resource descriptor
     PDDI_MEDIA_CONTEXT     pMediaCtx; // Media driver Context
+    int32_t                iStatusReportIdx;  // encode status report slot the buffer was last added to
+    uint32_t               uiStatusReportSeq; // sequence number the slot got when the buffer was added, 0 if never added
+    uint32_t               uiMapCount;        // outstanding vaMapBuffer calls on slice data, which may point into the bitstream arena
 } DDI_MEDIA_BUFFER, *PDDI_MEDIA_BUFFER;
 
 typedef struct _DDI_MEDIA_SURFACE_HEAP_ELEMENT
 {
     PDDI_MEDIA_SURFACE                      pSurface;
     uint32_t                                uiVaSurfaceID;
-    struct _DDI_MEDIA_SURFACE_HEAP_ELEMENT *pNextFree;
 }DDI_MEDIA_SURFACE_HEAP_ELEMENT, *PDDI_MEDIA_SURFACE_HEAP_ELEMENT;
 
 typedef struct _DDI_MEDIA_BUFFER_HEAP_ELEMENT
@@ -291,29 +304,35 @@ typedef struct _DDI_MEDIA_BUFFER_HEAP_ELEMENT
     void                                   *pCtx;
     uint32_t                                uiCtxType;
     uint32_t                                uiVaBufferID;
-    struct _DDI_MEDIA_BUFFER_HEAP_ELEMENT  *pNextFree;
 }DDI_MEDIA_BUFFER_HEAP_ELEMENT, *PDDI_MEDIA_BUFFER_HEAP_ELEMENT;
 
 typedef struct _DDI_MEDIA_IMAGE_HEAP_ELEMENT
 {
     VAImage                                *pImage;
     uint32_t                                uiVaImageID;
-    struct _DDI_MEDIA_IMAGE_HEAP_ELEMENT   *pNextFree;
 }DDI_MEDIA_IMAGE_HEAP_ELEMENT, *PDDI_MEDIA_IMAGE_HEAP_ELEMENT;
 
 typedef struct _DDI_MEDIA_VACONTEXT_HEAP_ELEMENT
 {
     void                                       *pVaContext;
     uint32_t                                    uiVaContextID;
-    struct _DDI_MEDIA_VACONTEXT_HEAP_ELEMENT   *pNextFree;
 }DDI_MEDIA_VACONTEXT_HEAP_ELEMENT, *PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT;
 
+typedef struct _DDI_MEDIA_HEAP_SLOT
+{
+    uint32_t            uiNextFree;             // index + 1 of the next free slot, 0 ends the free list
+    uint32_t            uiGeneration;           // bumped on every release so stale IDs are rejected
+    uint32_t            bInUse;
+}DDI_MEDIA_HEAP_SLOT, *PDDI_MEDIA_HEAP_SLOT;
+
 typedef struct _DDI_MEDIA_HEAP
 {
-    void               *pHeapBase;
+    void               *pHeapSegments[DDI_MEDIA_HEAP_MAX_SEGMENTS];  // elements followed by their slots, lookups take no lock
     uint32_t            uiHeapElementSize;
     uint32_t            uiAllocatedHeapElements;
-    void               *pFirstFreeHeapElement;
+    uint32_t            uiSegments;
+    uint64_t            FirstFree;              // (ABA tag << 32) | (index + 1) of the first free slot, updated by CAS
+    MEDIA_MUTEX_T       GrowMutex;              // only serializes segment allocation
 }DDI_MEDIA_HEAP, *PDDI_MEDIA_HEAP;
 
 #ifndef ANDROID
@@ -387,6 +406,10 @@ struct DDI_MEDIA_CONTEXT
     MEDIA_MUTEX_T       CmMutex;
     MEDIA_MUTEX_T       MfeMutex;
 
+    // bo -> surface index for status report lookup, protected by SurfaceBoIndexMutex
+    DDI_MEDIA_SURFACE_BO_INDEX *pSurfaceBoIndex;
+    MEDIA_MUTEX_T       SurfaceBoIndexMutex;
+
     // GT system Info
     MEDIA_SYSTEM_INFO  *pGtSystemInfo;
     
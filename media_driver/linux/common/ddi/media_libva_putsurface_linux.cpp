@@ -352,6 +352,7 @@ VAStatus DdiCodec_PutSurfaceLinuxHW(
 
     uint32_t                uiCtxType;
     PDDI_VP_CONTEXT         pVpCtx;
+    PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT pVpCtxHeapElmt;
     struct dri_drawable*    dri_drawable;
     union dri_buffer*       buffer;
 
@@ -362,7 +363,7 @@ VAStatus DdiCodec_PutSurfaceLinuxHW(
     DDI_CHK_NULL(pMediaCtx, "Null pMediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(pMediaCtx->dri_output, "Null pMediaDrvCtx->dri_output", VA_STATUS_ERROR_INVALID_PARAMETER);
 	DDI_CHK_NULL(pMediaCtx->pSurfaceHeap, "Null pMediaDrvCtx->pSurfaceHeap", VA_STATUS_ERROR_INVALID_PARAMETER);
-    DDI_CHK_LESS((uint32_t)surface, pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaceId", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_LESS(DDI_MEDIA_HEAP_INDEX((uint32_t)surface), pMediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaceId", VA_STATUS_ERROR_INVALID_SURFACE);
 
 	struct dri_vtable * const dri_vtable = &pMediaCtx->dri_output->vtable;
     dri_drawable = dri_vtable->get_drawable(ctx, (Drawable)draw);
@@ -376,9 +377,10 @@ VAStatus DdiCodec_PutSurfaceLinuxHW(
     pitch = pBufferObject->iPitch;
    
     pVpCtx         = nullptr;
-    if (nullptr != pMediaCtx->pVpCtxHeap->pHeapBase)
+    pVpCtxHeapElmt = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)DdiMediaUtil_GetHeapElementByIndex(pMediaCtx->pVpCtxHeap, 0);
+    if (nullptr != pVpCtxHeapElmt)
     {
-        pVpCtx = (PDDI_VP_CONTEXT)DdiMedia_GetContextFromContextID(ctx, (VAContextID)(0 + DDI_MEDIA_VACONTEXTID_OFFSET_VP), &uiCtxType);
+        pVpCtx = (PDDI_VP_CONTEXT)DdiMedia_GetContextFromContextID(ctx, (VAContextID)(pVpCtxHeapElmt->uiVaContextID + DDI_MEDIA_VACONTEXTID_OFFSET_VP), &uiCtxType);
         DDI_CHK_NULL(pVpCtx, "Null pVpCtx", VA_STATUS_ERROR_INVALID_PARAMETER);
         pVpHal = pVpCtx->pVpHal;
         DDI_CHK_NULL(pVpHal, "Null pVpHal", VA_STATUS_ERROR_INVALID_PARAMETER);
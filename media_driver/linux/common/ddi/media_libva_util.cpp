@@ -34,6 +34,7 @@
 #include <fcntl.h>
 #include <dlfcn.h>
 #include <errno.h>
+#include <smmintrin.h>
 
 #ifdef ANDROID
 #include <va/va_android.h>
@@ -217,122 +218,29 @@ void DdiMediaUtil_MediaPrintFps()
 
 #ifdef ANDROID
 #define GTT_SIZE_THRESHOLD  (4096*4096*3)    //use the maximum 4K resolution YUV 444 as the threshold
-// The following implemention refers to Solo_PerformManualSwizzling in mos_os_solo.c.
-static __inline int32_t SwizzleOffset(
-    // Linear Offset:
-    int32_t             OffsetX,        // Horizontal byte offset from left edge of tiled surface.
-    int32_t             OffsetY,        // Vertical offset from top of tiled surface.
-    // Swizzling Parameters:
-    int32_t             Pitch,          // Row-to-row byte stride.
-    uint32_t            TileFormat,     // Either 'x' or 'y'--for X-Major or Y-Major tiling, respectively.
-    int32_t             CsxSwizzle)     // (Boolean) Additionally perform Channel Select XOR swizzling.
+static __inline MOS_TILE_TYPE DdiTilingToMosTileType(uint32_t TileType)
 {
-    int32_t Row, Line, Col, x; // Linear Offset Components
-    int32_t LBits, LPos; // Size and swizzled position of the Line component.
-    int32_t SwizzledOffset;
-    if (TileFormat == I915_TILING_NONE)
+    switch (TileType)
     {
-        return(OffsetY * Pitch + OffsetX);
-    }
-
-    if (TileFormat == I915_TILING_Y)
-    {
-        LBits = 5; // Log2(TileY.Height = 32)
-        LPos = 4;  // Log2(TileY.PseudoWidth = 16)
-    }
-    else //if (TileFormat == I915_TILING_X)
-    {
-        LBits = 3; // Log2(TileX.Height = 8)
-        LPos = 9;  // Log2(TileX.Width = 512)
-    }
-
-    Row =   OffsetY >> LBits;               // OffsetY / LinesPerTile
-    Line =  OffsetY & ((1 << LBits) - 1);   // OffsetY % LinesPerTile
-    Col =   OffsetX >> LPos;                // OffsetX / BytesPerLine
-    x =     OffsetX & ((1 << LPos) - 1);    // OffsetX % BytesPerLine
-
-    SwizzledOffset =
-        (((((Row * (Pitch >> LPos)) + Col) << LBits) + Line) << LPos) + x;
-    //                V                V                 V
-    //                / BytesPerLine   * LinesPerTile    * BytesPerLine
-
-    /// Channel Select XOR Swizzling ///////////////////////////////////////////
-    if (CsxSwizzle)
-    {
-        if (TileFormat == I915_TILING_Y) // A6 = A6 ^ A9
-        {
-            SwizzledOffset ^= ((SwizzledOffset >> (9 - 6)) & 0x40);
-        }
-        else //if (TileFormat == I915_TILING_X) // A6 = A6 ^ A9 ^ A10
-        {
-            SwizzledOffset ^= (((SwizzledOffset >> (9 - 6)) ^ (SwizzledOffset >> (10 - 6))) & 0x40);
-        }
-    }
-
-    return(SwizzledOffset);
-}
-
-static void SwizzleData(
-    uint8_t  *pSrc,
-    uint8_t  *pDst,
-    uint32_t  SrcTiling,
-    uint32_t  DstTiling,
-    int32_t   iHeight,
-    int32_t   iPitch)
-{
-#define IS_TILED(_a)                ((_a) != I915_TILING_NONE)
-#define IS_TILED_TO_LINEAR(_a, _b)  (IS_TILED(_a) && !IS_TILED(_b))
-#define IS_LINEAR_TO_TILED(_a, _b)  (!IS_TILED(_a) && IS_TILED(_b))
-
-    int32_t LinearOffset;
-    int32_t TileOffset;
-    int32_t x;
-    int32_t y;
-
-    // Translate from one format to another
-    for (y = 0, LinearOffset = 0, TileOffset = 0; y < iHeight; y++)
-    {
-        for (x = 0; x < iPitch; x++, LinearOffset++)
-        {
-            // x or y --> linear
-            if (IS_TILED_TO_LINEAR(SrcTiling, DstTiling))
-            {
-                TileOffset = SwizzleOffset(
-                    x,
-                    y,
-                    iPitch,
-                    SrcTiling,
-                    false);
-
-                *(pDst + LinearOffset) = *(pSrc + TileOffset);
-            }
-            // linear --> x or y
-            else if (IS_LINEAR_TO_TILED(SrcTiling, DstTiling))
-            {
-                TileOffset = SwizzleOffset(
-                    x,
-                    y,
-                    iPitch,
-                    DstTiling,
-                    false);
-
-                *(pDst + TileOffset) = *(pSrc + LinearOffset);
-            }
-            else
-            {
-                MOS_OS_ASSERT(0);
-            }
-        }
+        case I915_TILING_X:
+            return MOS_TILE_X;
+        case I915_TILING_Y:
+            return MOS_TILE_Y;
+        default:
+            return MOS_TILE_LINEAR;
     }
 }
 
 static bool NeedSwizzleData(PDDI_MEDIA_SURFACE pSurface, bool bLock)
 {
-    uint32_t            iSize, iPitch;
+    uint32_t            iSize, iPitch, iHeight;
+    uint32_t            iTileRowHeight, iTileRowSize, iRow;
     uint8_t            *pResourceBase;
+    uint8_t            *pTileRow;
+    MOS_TILE_TYPE       TileType;
     GMM_RESOURCE_FLAG   GmmFlags;
-	DDI_CHK_NULL(pSurface, "nullptr pSurface", false);
-	DDI_CHK_NULL(pSurface->pGmmResourceInfo, "nullptr pGmmResourceInfo", false);
+    DDI_CHK_NULL(pSurface, "nullptr pSurface", false);
+    DDI_CHK_NULL(pSurface->pGmmResourceInfo, "nullptr pGmmResourceInfo", false);
     iPitch = (uint32_t)pSurface->pGmmResourceInfo->GetRenderPitch();
     iSize  = GmmResGetRenderSize(pSurface->pGmmResourceInfo);
     GmmFlags = pSurface->pGmmResourceInfo->GetResFlags();
@@ -344,20 +252,34 @@ static bool NeedSwizzleData(PDDI_MEDIA_SURFACE pSurface, bool bLock)
         iSize = iSize - (uint32_t)(pSurface->pGmmResourceInfo->GetSizeAuxSurface(GMM_AUX_SURF));
     }
 
-    pResourceBase = (uint8_t*)MOS_AllocAndZeroMemory(iSize);
-    if(DDI_UTIL_CHK_NULL(pResourceBase))
+    TileType       = DdiTilingToMosTileType(pSurface->TileType);
+    iTileRowHeight = (TileType == MOS_TILE_Y) ? MOS_YTILE_H_ALIGNMENT : MOS_XTILE_H_ALIGNMENT;
+    iTileRowSize   = iTileRowHeight * iPitch;
+    iHeight        = iSize / iPitch;
+    pResourceBase  = (uint8_t*) pSurface->bo->virt;
+
+    // A row of tiles occupies the same byte range in linear and tiled layout,
+    // so the surface can be converted in place with one tile row of scratch.
+    pTileRow = (uint8_t*)MOS_AllocMemory(iTileRowSize);
+    if(DDI_UTIL_CHK_NULL(pTileRow))
        return false;
 
-    if (bLock)
-    {
-        SwizzleData((uint8_t*) pSurface->bo->virt, pResourceBase, pSurface->TileType, I915_TILING_NONE, iSize / iPitch, iPitch);
-    }
-    else
+    for (iRow = 0; iRow < iHeight; iRow += iTileRowHeight)
     {
-        SwizzleData((uint8_t*) pSurface->bo->virt, pResourceBase, I915_TILING_NONE, pSurface->TileType, iSize / iPitch, iPitch);
+        uint32_t iLines = MOS_MIN(iTileRowHeight, iHeight - iRow);
+        uint8_t *pRow   = pResourceBase + iRow * iPitch;
+
+        if (bLock)
+        {
+            Mos_SwizzleData(pRow, pTileRow, TileType, MOS_TILE_LINEAR, iLines, iPitch);
+        }
+        else
+        {
+            Mos_SwizzleData(pRow, pTileRow, MOS_TILE_LINEAR, TileType, iLines, iPitch);
+        }
+        MOS_SecureMemcpy(pRow, iLines * iPitch, pTileRow, iLines * iPitch);
     }
-    MOS_SecureMemcpy((uint8_t*) pSurface->bo->virt, iSize, pResourceBase, iSize);
-    MOS_FreeMemory(pResourceBase);
+    MOS_FreeMemory(pTileRow);
 
     return true;
 }
@@ -1234,6 +1156,72 @@ void DdiMediaUtil_FreeSurface(DDI_MEDIA_SURFACE *pSurface)
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////
+// Purpose:      register a heap surface so that status reports can find it by bo
+// pMediaCtx[in]: pointer to media context
+// pSurface[in]: pointer to surface, its bo must be allocated
+/////////////////////////////////////////////////////////////////////////////////////
+void DdiMediaUtil_AddSurfaceToBoIndex(PDDI_MEDIA_CONTEXT pMediaCtx, DDI_MEDIA_SURFACE *pSurface)
+{
+    if (DDI_UTIL_CHK_NULL(pMediaCtx) || DDI_UTIL_CHK_NULL(pMediaCtx->pSurfaceBoIndex) ||
+        DDI_UTIL_CHK_NULL(pSurface) || DDI_UTIL_CHK_NULL(pSurface->bo))
+        return;
+
+    DdiMediaUtil_LockMutex(&pMediaCtx->SurfaceBoIndexMutex);
+    (*pMediaCtx->pSurfaceBoIndex)[pSurface->bo] = pSurface;
+    DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceBoIndexMutex);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Purpose:      unregister a surface before its bo is released, and wait for
+//               any status update in flight on it to finish
+// pMediaCtx[in]: pointer to media context
+// pSurface[in]: pointer to surface
+/////////////////////////////////////////////////////////////////////////////////////
+void DdiMediaUtil_RemoveSurfaceFromBoIndex(PDDI_MEDIA_CONTEXT pMediaCtx, DDI_MEDIA_SURFACE *pSurface)
+{
+    if (DDI_UTIL_CHK_NULL(pMediaCtx) || DDI_UTIL_CHK_NULL(pMediaCtx->pSurfaceBoIndex) ||
+        DDI_UTIL_CHK_NULL(pSurface))
+        return;
+
+    DdiMediaUtil_LockMutex(&pMediaCtx->SurfaceBoIndexMutex);
+    auto it = pMediaCtx->pSurfaceBoIndex->find(pSurface->bo);
+    // The bufmgr may already have handed a recycled bo to another surface
+    if (it != pMediaCtx->pSurfaceBoIndex->end() && it->second == pSurface)
+    {
+        pMediaCtx->pSurfaceBoIndex->erase(it);
+    }
+    DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceBoIndexMutex);
+
+    DdiMediaUtil_LockMutex(&pSurface->StatusMutex);
+    DdiMediaUtil_UnLockMutex(&pSurface->StatusMutex);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Purpose:      find the heap surface owning a bo and lock its status
+// pMediaCtx[in]: pointer to media context
+// bo[in]:       bo of the surface
+// Returns:      the surface with StatusMutex held, nullptr if bo is not indexed
+/////////////////////////////////////////////////////////////////////////////////////
+DDI_MEDIA_SURFACE* DdiMediaUtil_LockSurfaceStatusByBo(PDDI_MEDIA_CONTEXT pMediaCtx, MOS_LINUX_BO *bo)
+{
+    DDI_MEDIA_SURFACE *pSurface = nullptr;
+
+    if (DDI_UTIL_CHK_NULL(pMediaCtx) || DDI_UTIL_CHK_NULL(pMediaCtx->pSurfaceBoIndex) || nullptr == bo)
+        return nullptr;
+
+    DdiMediaUtil_LockMutex(&pMediaCtx->SurfaceBoIndexMutex);
+    auto it = pMediaCtx->pSurfaceBoIndex->find(bo);
+    if (it != pMediaCtx->pSurfaceBoIndex->end())
+    {
+        pSurface = it->second;
+        // Taken before the index lock is dropped so that the surface can not be released in between
+        DdiMediaUtil_LockMutex(&pSurface->StatusMutex);
+    }
+    DdiMediaUtil_UnLockMutex(&pMediaCtx->SurfaceBoIndexMutex);
+
+    return pSurface;
+}
 
 // should ref_count added for bo?
 void DdiMediaUtil_FreeBuffer(DDI_MEDIA_BUFFER  *pBuf)
@@ -1315,6 +1303,143 @@ VAStatus DdiMediaUtil_FillPositionToRect(RECT *rect, int16_t offset_x, int16_t o
     return VA_STATUS_SUCCESS;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////
+// Purpose:   copy one row out of a (possibly write-combined) GTT mapping.
+//            Uses SSE4.1 streaming loads so that WC reads are not serialized
+//            one cache line at a time; plain copy for head/tail bytes.
+// pDst[out]: destination in cacheable system memory
+// pSrc[in]:  source row in the surface mapping
+// uiBytes:   number of bytes to copy
+/////////////////////////////////////////////////////////////////////////////////////
+void DdiMediaUtil_CopyRowFromWC(uint8_t *pDst, const uint8_t *pSrc, uint32_t uiBytes)
+{
+    uint32_t uiHead = (uint32_t)((16 - ((uintptr_t)pSrc & 15)) & 15);
+
+    if (uiBytes < 64 + uiHead)
+    {
+        MOS_SecureMemcpy(pDst, uiBytes, pSrc, uiBytes);
+        return;
+    }
+
+    if (uiHead)
+    {
+        MOS_SecureMemcpy(pDst, uiHead, pSrc, uiHead);
+        pDst    += uiHead;
+        pSrc    += uiHead;
+        uiBytes -= uiHead;
+    }
+
+    // Sync the WC memory data before issuing the MOVNTDQA instruction.
+    _mm_mfence();
+    for (; uiBytes >= 64; uiBytes -= 64, pSrc += 64, pDst += 64)
+    {
+        __m128i xmm0 = _mm_stream_load_si128((__m128i *)pSrc);
+        __m128i xmm1 = _mm_stream_load_si128((__m128i *)pSrc + 1);
+        __m128i xmm2 = _mm_stream_load_si128((__m128i *)pSrc + 2);
+        __m128i xmm3 = _mm_stream_load_si128((__m128i *)pSrc + 3);
+
+        _mm_storeu_si128((__m128i *)pDst,     xmm0);
+        _mm_storeu_si128((__m128i *)pDst + 1, xmm1);
+        _mm_storeu_si128((__m128i *)pDst + 2, xmm2);
+        _mm_storeu_si128((__m128i *)pDst + 3, xmm3);
+    }
+
+    if (uiBytes)
+    {
+        MOS_SecureMemcpy(pDst, uiBytes, pSrc, uiBytes);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Purpose:    de-interleave byte pairs, e.g. NV12 UV -> U + V, or YUY2 -> Y + UV
+// pSrc[in]:   interleaved source of 2 * uiPairs bytes
+// pEven[out]: receives bytes 0, 2, 4, ...
+// pOdd[out]:  receives bytes 1, 3, 5, ...; may be nullptr to drop them
+// uiPairs:    number of byte pairs
+/////////////////////////////////////////////////////////////////////////////////////
+void DdiMediaUtil_SplitBytePairs(const uint8_t *pSrc, uint8_t *pEven, uint8_t *pOdd, uint32_t uiPairs)
+{
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    uint32_t      i    = 0;
+
+    for (; i + 16 <= uiPairs; i += 16)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i *)(pSrc + 2 * i));
+        __m128i hi = _mm_loadu_si128((const __m128i *)(pSrc + 2 * i + 16));
+
+        _mm_storeu_si128((__m128i *)(pEven + i),
+            _mm_packus_epi16(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask)));
+        if (pOdd)
+        {
+            _mm_storeu_si128((__m128i *)(pOdd + i),
+                _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+        }
+    }
+
+    for (; i < uiPairs; i++)
+    {
+        pEven[i] = pSrc[2 * i];
+        if (pOdd)
+        {
+            pOdd[i] = pSrc[2 * i + 1];
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Purpose:   interleave two byte rows, e.g. U + V -> NV12 UV, or Y + UV -> YUY2
+// pEven[in]: bytes to place at 0, 2, 4, ...
+// pOdd[in]:  bytes to place at 1, 3, 5, ...
+// pDst[out]: interleaved destination of 2 * uiPairs bytes
+// uiPairs:   number of byte pairs
+/////////////////////////////////////////////////////////////////////////////////////
+void DdiMediaUtil_InterleaveBytePairs(const uint8_t *pEven, const uint8_t *pOdd, uint8_t *pDst, uint32_t uiPairs)
+{
+    uint32_t i = 0;
+
+    for (; i + 16 <= uiPairs; i += 16)
+    {
+        __m128i even = _mm_loadu_si128((const __m128i *)(pEven + i));
+        __m128i odd  = _mm_loadu_si128((const __m128i *)(pOdd + i));
+
+        _mm_storeu_si128((__m128i *)(pDst + 2 * i),      _mm_unpacklo_epi8(even, odd));
+        _mm_storeu_si128((__m128i *)(pDst + 2 * i + 16), _mm_unpackhi_epi8(even, odd));
+    }
+
+    for (; i < uiPairs; i++)
+    {
+        pDst[2 * i]     = pEven[i];
+        pDst[2 * i + 1] = pOdd[i];
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Purpose:    swap the R and B channels of 32bpp pixels (ARGB <-> ABGR)
+// pSrc[in]:   source pixels
+// pDst[out]:  destination pixels, may alias pSrc
+// uiPixels:   number of pixels
+/////////////////////////////////////////////////////////////////////////////////////
+void DdiMediaUtil_SwapRBRow(const uint8_t *pSrc, uint8_t *pDst, uint32_t uiPixels)
+{
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    uint32_t      i       = 0;
+
+    for (; i + 4 <= uiPixels; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(pSrc + 4 * i));
+        _mm_storeu_si128((__m128i *)(pDst + 4 * i), _mm_shuffle_epi8(pixels, shuffle));
+    }
+
+    for (; i < uiPixels; i++)
+    {
+        uint8_t r = pSrc[4 * i];
+        pDst[4 * i]     = pSrc[4 * i + 2];
+        pDst[4 * i + 1] = pSrc[4 * i + 1];
+        pDst[4 * i + 2] = r;
+        pDst[4 * i + 3] = pSrc[4 * i + 3];
+    }
+}
+
 void DdiMediaUtil_InitMutex(PMEDIA_MUTEX_T  pMutex)
 {
     pthread_mutex_init(pMutex, nullptr);
@@ -1392,36 +1517,242 @@ void DdiMediaUtil_PostSemaphore(PMEDIA_SEM_T  pSem)
 }
 
 // heap related
-PDDI_MEDIA_SURFACE_HEAP_ELEMENT DdiMediaUtil_AllocPMediaSurfaceFromHeap(PDDI_MEDIA_HEAP pSurfaceHeap)
+static bool DdiMediaUtil_GetHeapSlot(
+    PDDI_MEDIA_HEAP       pHeap,
+    uint32_t              uiIndex,
+    void                **ppElement,
+    PDDI_MEDIA_HEAP_SLOT *ppSlot)
 {
-    PDDI_MEDIA_SURFACE_HEAP_ELEMENT  pSurfaceHeapBase;
-    PDDI_MEDIA_SURFACE_HEAP_ELEMENT  pMediaSurfaceHeapElmt;
-    void                            *pNewHeapBase;
-    int32_t                          i;
+    uint32_t  uiSegment;
+    uint32_t  uiOffset;
+    uint8_t  *pSegment;
+
+    // The element count is published after the segment pointer, so a segment below it is always visible
+    if (uiIndex >= __atomic_load_n(&pHeap->uiAllocatedHeapElements, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    uiSegment = 31 - __builtin_clz(uiIndex / DDI_MEDIA_HEAP_INCREMENTAL_SIZE + 1);
+    uiOffset  = uiIndex - DDI_MEDIA_HEAP_INCREMENTAL_SIZE * ((1 << uiSegment) - 1);
+    pSegment  = (uint8_t *)__atomic_load_n(&pHeap->pHeapSegments[uiSegment], __ATOMIC_ACQUIRE);
+    if (nullptr == pSegment)
+    {
+        return false;
+    }
+
+    *ppElement = pSegment + uiOffset * pHeap->uiHeapElementSize;
+    *ppSlot    = (PDDI_MEDIA_HEAP_SLOT)(pSegment + (DDI_MEDIA_HEAP_INCREMENTAL_SIZE << uiSegment) * pHeap->uiHeapElementSize) + uiOffset;
+    return true;
+}
 
-    if (nullptr == pSurfaceHeap->pFirstFreeHeapElement)
+static bool DdiMediaUtil_GrowHeap(PDDI_MEDIA_HEAP pHeap)
+{
+    PDDI_MEDIA_HEAP_SLOT  pSlots;
+    uint8_t              *pSegment;
+    uint32_t              uiSegment;
+    uint32_t              uiCount;
+    uint32_t              uiFirst;
+    uint64_t              head;
+    uint64_t              newHead;
+    uint32_t              i;
+
+    DdiMediaUtil_LockMutex(&pHeap->GrowMutex);
+
+    // Another thread grew the heap or released an element meanwhile
+    if ((uint32_t)__atomic_load_n(&pHeap->FirstFree, __ATOMIC_ACQUIRE) != 0)
+    {
+        DdiMediaUtil_UnLockMutex(&pHeap->GrowMutex);
+        return true;
+    }
+
+    uiSegment = pHeap->uiSegments;
+    if (uiSegment >= DDI_MEDIA_HEAP_MAX_SEGMENTS)
+    {
+        DDI_ASSERTMESSAGE("DDI: heap is full.");
+        DdiMediaUtil_UnLockMutex(&pHeap->GrowMutex);
+        return false;
+    }
+
+    uiCount  = DDI_MEDIA_HEAP_INCREMENTAL_SIZE << uiSegment;
+    uiFirst  = DDI_MEDIA_HEAP_INCREMENTAL_SIZE * ((1 << uiSegment) - 1);
+    pSegment = (uint8_t *)MOS_AllocAndZeroMemory(uiCount * (pHeap->uiHeapElementSize + sizeof(DDI_MEDIA_HEAP_SLOT)));
+    if (nullptr == pSegment)
+    {
+        DDI_ASSERTMESSAGE("DDI: heap segment allocation failed.");
+        DdiMediaUtil_UnLockMutex(&pHeap->GrowMutex);
+        return false;
+    }
+
+    pSlots = (PDDI_MEDIA_HEAP_SLOT)(pSegment + uiCount * pHeap->uiHeapElementSize);
+    for (i = 0; i < uiCount - 1; i++)
     {
-        pNewHeapBase = realloc(pSurfaceHeap->pHeapBase, (pSurfaceHeap->uiAllocatedHeapElements + DDI_MEDIA_HEAP_INCREMENTAL_SIZE) * sizeof(DDI_MEDIA_SURFACE_HEAP_ELEMENT));
+        pSlots[i].uiNextFree = uiFirst + i + 2;
+    }
+
+    __atomic_store_n(&pHeap->pHeapSegments[uiSegment], (void *)pSegment, __ATOMIC_RELEASE);
+    __atomic_store_n(&pHeap->uiAllocatedHeapElements, uiFirst + uiCount, __ATOMIC_RELEASE);
+    pHeap->uiSegments++;
 
-        if (nullptr == pNewHeapBase)
+    // Push the new chain in front of whatever was released meanwhile
+    head = __atomic_load_n(&pHeap->FirstFree, __ATOMIC_ACQUIRE);
+    do
+    {
+        pSlots[uiCount - 1].uiNextFree = (uint32_t)head;
+        newHead = (((head >> 32) + 1) << 32) | (uiFirst + 1);
+    } while (!__atomic_compare_exchange_n(&pHeap->FirstFree, &head, newHead, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    DdiMediaUtil_UnLockMutex(&pHeap->GrowMutex);
+    return true;
+}
+
+void DdiMediaUtil_InitHeap(PDDI_MEDIA_HEAP pHeap, uint32_t uiHeapElementSize)
+{
+    DDI_CHK_NULL(pHeap, "nullptr heap", );
+
+    pHeap->uiHeapElementSize        = uiHeapElementSize;
+    pHeap->uiAllocatedHeapElements  = 0;
+    pHeap->uiSegments               = 0;
+    pHeap->FirstFree                = 0;
+    DdiMediaUtil_InitMutex(&pHeap->GrowMutex);
+}
+
+void DdiMediaUtil_DestroyHeap(PDDI_MEDIA_HEAP pHeap)
+{
+    uint32_t i;
+
+    if (nullptr == pHeap)
+        return;
+
+    for (i = 0; i < pHeap->uiSegments; i++)
+    {
+        MOS_FreeMemory(pHeap->pHeapSegments[i]);
+        pHeap->pHeapSegments[i] = nullptr;
+    }
+    pHeap->uiSegments               = 0;
+    pHeap->uiAllocatedHeapElements  = 0;
+    pHeap->FirstFree                = 0;
+    DdiMediaUtil_DestroyMutex(&pHeap->GrowMutex);
+}
+
+void* DdiMediaUtil_AllocHeapElement(PDDI_MEDIA_HEAP pHeap, uint32_t *puiId)
+{
+    PDDI_MEDIA_HEAP_SLOT  pSlot;
+    void                 *pElement;
+    uint64_t              head;
+    uint64_t              newHead;
+    uint32_t              uiIndex;
+
+    DDI_CHK_NULL(pHeap, "nullptr heap", nullptr);
+    DDI_CHK_NULL(puiId, "nullptr id", nullptr);
+
+    head = __atomic_load_n(&pHeap->FirstFree, __ATOMIC_ACQUIRE);
+    while (true)
+    {
+        if ((uint32_t)head == 0)
+        {
+            if (!DdiMediaUtil_GrowHeap(pHeap))
+            {
+                return nullptr;
+            }
+            head = __atomic_load_n(&pHeap->FirstFree, __ATOMIC_ACQUIRE);
+            continue;
+        }
+
+        uiIndex = (uint32_t)head - 1;
+        if (!DdiMediaUtil_GetHeapSlot(pHeap, uiIndex, &pElement, &pSlot))
         {
-            DDI_ASSERTMESSAGE("DDI: realloc failed.");
             return nullptr;
         }
-        pSurfaceHeap->pHeapBase                    = pNewHeapBase;
-        pSurfaceHeapBase                           = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)pSurfaceHeap->pHeapBase;
-        pSurfaceHeap->pFirstFreeHeapElement        = (void*)(&pSurfaceHeapBase[pSurfaceHeap->uiAllocatedHeapElements]);
-        for (i = 0; i < (DDI_MEDIA_HEAP_INCREMENTAL_SIZE); i++)
+
+        // The tag makes the CAS fail if the slot was popped and pushed again in between
+        newHead = (((head >> 32) + 1) << 32) | __atomic_load_n(&pSlot->uiNextFree, __ATOMIC_ACQUIRE);
+        if (__atomic_compare_exchange_n(&pHeap->FirstFree, &head, newHead, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
         {
-            pMediaSurfaceHeapElmt                  = &pSurfaceHeapBase[pSurfaceHeap->uiAllocatedHeapElements + i];
-            pMediaSurfaceHeapElmt->pNextFree       = (i == (DDI_MEDIA_HEAP_INCREMENTAL_SIZE - 1))? nullptr : &pSurfaceHeapBase[pSurfaceHeap->uiAllocatedHeapElements + i + 1];
-            pMediaSurfaceHeapElmt->uiVaSurfaceID   = pSurfaceHeap->uiAllocatedHeapElements + i;
+            break;
         }
-        pSurfaceHeap->uiAllocatedHeapElements     += DDI_MEDIA_HEAP_INCREMENTAL_SIZE;
     }
 
-    pMediaSurfaceHeapElmt                          = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)pSurfaceHeap->pFirstFreeHeapElement;
-    pSurfaceHeap->pFirstFreeHeapElement            = pMediaSurfaceHeapElmt->pNextFree;
+    __atomic_store_n(&pSlot->bInUse, 1, __ATOMIC_RELEASE);
+    *puiId = (pSlot->uiGeneration << DDI_MEDIA_HEAP_INDEX_BITS) | uiIndex;
+    return pElement;
+}
+
+void* DdiMediaUtil_GetHeapElement(PDDI_MEDIA_HEAP pHeap, uint32_t uiId)
+{
+    PDDI_MEDIA_HEAP_SLOT  pSlot;
+    void                 *pElement;
+
+    if (nullptr == pHeap ||
+        (uiId >> DDI_MEDIA_HEAP_INDEX_BITS) > DDI_MEDIA_HEAP_GENERATION_MASK ||
+        !DdiMediaUtil_GetHeapSlot(pHeap, DDI_MEDIA_HEAP_INDEX(uiId), &pElement, &pSlot))
+    {
+        return nullptr;
+    }
+
+    // A stale ID has the generation of a released element
+    if (!__atomic_load_n(&pSlot->bInUse, __ATOMIC_ACQUIRE) ||
+        __atomic_load_n(&pSlot->uiGeneration, __ATOMIC_ACQUIRE) != (uiId >> DDI_MEDIA_HEAP_INDEX_BITS))
+    {
+        return nullptr;
+    }
+
+    return pElement;
+}
+
+void* DdiMediaUtil_GetHeapElementByIndex(PDDI_MEDIA_HEAP pHeap, uint32_t uiIndex)
+{
+    PDDI_MEDIA_HEAP_SLOT  pSlot;
+    void                 *pElement;
+
+    if (nullptr == pHeap ||
+        !DdiMediaUtil_GetHeapSlot(pHeap, uiIndex, &pElement, &pSlot) ||
+        !__atomic_load_n(&pSlot->bInUse, __ATOMIC_ACQUIRE))
+    {
+        return nullptr;
+    }
+
+    return pElement;
+}
+
+bool DdiMediaUtil_ReleaseHeapElement(PDDI_MEDIA_HEAP pHeap, uint32_t uiId)
+{
+    PDDI_MEDIA_HEAP_SLOT  pSlot;
+    void                 *pElement;
+    uint64_t              head;
+    uint64_t              newHead;
+    uint32_t              uiIndex;
+
+    pElement = DdiMediaUtil_GetHeapElement(pHeap, uiId);
+    DDI_CHK_NULL(pElement, "invalid heap id", false);
+
+    uiIndex = DDI_MEDIA_HEAP_INDEX(uiId);
+    DdiMediaUtil_GetHeapSlot(pHeap, uiIndex, &pElement, &pSlot);
+
+    __atomic_store_n(&pSlot->uiGeneration, (pSlot->uiGeneration + 1) & DDI_MEDIA_HEAP_GENERATION_MASK, __ATOMIC_RELEASE);
+    __atomic_store_n(&pSlot->bInUse, 0, __ATOMIC_RELEASE);
+
+    head = __atomic_load_n(&pHeap->FirstFree, __ATOMIC_ACQUIRE);
+    do
+    {
+        __atomic_store_n(&pSlot->uiNextFree, (uint32_t)head, __ATOMIC_RELEASE);
+        newHead = (((head >> 32) + 1) << 32) | (uiIndex + 1);
+    } while (!__atomic_compare_exchange_n(&pHeap->FirstFree, &head, newHead, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    return true;
+}
+
+PDDI_MEDIA_SURFACE_HEAP_ELEMENT DdiMediaUtil_AllocPMediaSurfaceFromHeap(PDDI_MEDIA_HEAP pSurfaceHeap)
+{
+    PDDI_MEDIA_SURFACE_HEAP_ELEMENT  pMediaSurfaceHeapElmt;
+    uint32_t                         uiVaSurfaceID;
+
+    pMediaSurfaceHeapElmt = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)DdiMediaUtil_AllocHeapElement(pSurfaceHeap, &uiVaSurfaceID);
+    if (nullptr == pMediaSurfaceHeapElmt)
+    {
+        return nullptr;
+    }
+    pMediaSurfaceHeapElmt->uiVaSurfaceID   = uiVaSurfaceID;
 
     return pMediaSurfaceHeapElmt;
 }
@@ -1430,151 +1761,82 @@ PDDI_MEDIA_SURFACE_HEAP_ELEMENT DdiMediaUtil_AllocPMediaSurfaceFromHeap(PDDI_MED
 void DdiMediaUtil_ReleasePMediaSurfaceFromHeap(PDDI_MEDIA_HEAP pSurfaceHeap, uint32_t uiVaSurfaceID)
 {
     PDDI_MEDIA_SURFACE_HEAP_ELEMENT  pMediaSurfaceHeapElmt;
-    PDDI_MEDIA_SURFACE_HEAP_ELEMENT  pMediaSurfaceHeapBase;
-    void                            *pFirstFree;
 
-    DDI_CHK_LESS(uiVaSurfaceID, pSurfaceHeap->uiAllocatedHeapElements, "invalid surface id", );
-    pMediaSurfaceHeapBase                   = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)pSurfaceHeap->pHeapBase;
-    pMediaSurfaceHeapElmt                   = &pMediaSurfaceHeapBase[uiVaSurfaceID];
+    pMediaSurfaceHeapElmt                   = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pSurfaceHeap, uiVaSurfaceID);
+    DDI_CHK_NULL(pMediaSurfaceHeapElmt, "invalid surface id", );
     DDI_CHK_NULL(pMediaSurfaceHeapElmt->pSurface, "surface is already released", );
-    pFirstFree                              = pSurfaceHeap->pFirstFreeHeapElement;
-    pSurfaceHeap->pFirstFreeHeapElement     = (void*)pMediaSurfaceHeapElmt;
-    pMediaSurfaceHeapElmt->pNextFree        = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)pFirstFree;
     pMediaSurfaceHeapElmt->pSurface         = nullptr;
+    DdiMediaUtil_ReleaseHeapElement(pSurfaceHeap, uiVaSurfaceID);
 }
 
 
 PDDI_MEDIA_BUFFER_HEAP_ELEMENT DdiMediaUtil_AllocPMediaBufferFromHeap(PDDI_MEDIA_HEAP pBufferHeap)
 {
-    PDDI_MEDIA_BUFFER_HEAP_ELEMENT  pMediaBufferHeapBase;
     PDDI_MEDIA_BUFFER_HEAP_ELEMENT  pMediaBufferHeapElmt;
-    void                           *pNewHeapBase;
-    int32_t                         i;
+    uint32_t                        uiVaBufferID;
 
-    if (nullptr == pBufferHeap->pFirstFreeHeapElement)
+    pMediaBufferHeapElmt = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)DdiMediaUtil_AllocHeapElement(pBufferHeap, &uiVaBufferID);
+    if (nullptr == pMediaBufferHeapElmt)
     {
-        pNewHeapBase = realloc(pBufferHeap->pHeapBase, (pBufferHeap->uiAllocatedHeapElements + DDI_MEDIA_HEAP_INCREMENTAL_SIZE) * sizeof(DDI_MEDIA_BUFFER_HEAP_ELEMENT));
-        if (nullptr == pNewHeapBase)
-        {
-            DDI_ASSERTMESSAGE("DDI: realloc failed.");
-            return nullptr;
-        }
-        pBufferHeap->pHeapBase                 = pNewHeapBase;
-        pMediaBufferHeapBase                   = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)pBufferHeap->pHeapBase;
-        pBufferHeap->pFirstFreeHeapElement     = (void*)(&pMediaBufferHeapBase[pBufferHeap->uiAllocatedHeapElements]);
-        for (i = 0; i < (DDI_MEDIA_HEAP_INCREMENTAL_SIZE); i++)
-        {
-            pMediaBufferHeapElmt               = &pMediaBufferHeapBase[pBufferHeap->uiAllocatedHeapElements + i];
-            pMediaBufferHeapElmt->pNextFree    = (i == (DDI_MEDIA_HEAP_INCREMENTAL_SIZE - 1))? nullptr : &pMediaBufferHeapBase[pBufferHeap->uiAllocatedHeapElements + i + 1];
-            pMediaBufferHeapElmt->uiVaBufferID = pBufferHeap->uiAllocatedHeapElements + i;
-        }
-        pBufferHeap->uiAllocatedHeapElements  += DDI_MEDIA_HEAP_INCREMENTAL_SIZE;
+        return nullptr;
     }
+    pMediaBufferHeapElmt->uiVaBufferID     = uiVaBufferID;
 
-    pMediaBufferHeapElmt                       = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)pBufferHeap->pFirstFreeHeapElement;
-    pBufferHeap->pFirstFreeHeapElement         = pMediaBufferHeapElmt->pNextFree;
     return pMediaBufferHeapElmt;
 }
 
 
 void DdiMediaUtil_ReleasePMediaBufferFromHeap(PDDI_MEDIA_HEAP pBufferHeap, uint32_t uiVaBufferID)
 {
-    PDDI_MEDIA_BUFFER_HEAP_ELEMENT   pMediaBufferHeapBase;
     PDDI_MEDIA_BUFFER_HEAP_ELEMENT   pMediaBufferHeapElmt;
-    void                            *pFirstFree;
 
-    DDI_CHK_LESS(uiVaBufferID, pBufferHeap->uiAllocatedHeapElements, "invalid buffer id", );
-    pMediaBufferHeapBase                    = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)pBufferHeap->pHeapBase;
-    pMediaBufferHeapElmt                    = &pMediaBufferHeapBase[uiVaBufferID];
+    pMediaBufferHeapElmt                    = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pBufferHeap, uiVaBufferID);
+    DDI_CHK_NULL(pMediaBufferHeapElmt, "invalid buffer id", );
     DDI_CHK_NULL(pMediaBufferHeapElmt->pBuffer, "buffer is already released", );
-    pFirstFree                              = pBufferHeap->pFirstFreeHeapElement;
-    pBufferHeap->pFirstFreeHeapElement      = (void*)pMediaBufferHeapElmt;
-    pMediaBufferHeapElmt->pNextFree         = (PDDI_MEDIA_BUFFER_HEAP_ELEMENT)pFirstFree;
     pMediaBufferHeapElmt->pBuffer           = nullptr;
+    DdiMediaUtil_ReleaseHeapElement(pBufferHeap, uiVaBufferID);
 }
 
 PDDI_MEDIA_IMAGE_HEAP_ELEMENT DdiMediaUtil_AllocPVAImageFromHeap(PDDI_MEDIA_HEAP pImageHeap)
 {
-    PDDI_MEDIA_IMAGE_HEAP_ELEMENT   pVAImageHeapBase;
     PDDI_MEDIA_IMAGE_HEAP_ELEMENT   pVAImageHeapElmt;
-    void                           *pNewHeapBase;
-    int32_t                         i;
+    uint32_t                        uiVaImageID;
 
-    if (nullptr == pImageHeap->pFirstFreeHeapElement)
+    pVAImageHeapElmt = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)DdiMediaUtil_AllocHeapElement(pImageHeap, &uiVaImageID);
+    if (nullptr == pVAImageHeapElmt)
     {
-        pNewHeapBase = realloc(pImageHeap->pHeapBase, (pImageHeap->uiAllocatedHeapElements + DDI_MEDIA_HEAP_INCREMENTAL_SIZE) * sizeof(DDI_MEDIA_IMAGE_HEAP_ELEMENT));
-
-        if (nullptr == pNewHeapBase)
-        {
-            DDI_ASSERTMESSAGE("DDI: realloc failed.");
-            return nullptr;
-        }
-        pImageHeap->pHeapBase                  = pNewHeapBase;
-        pVAImageHeapBase                       = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)pImageHeap->pHeapBase;
-        pImageHeap->pFirstFreeHeapElement      = (void*)(&pVAImageHeapBase[pImageHeap->uiAllocatedHeapElements]);
-        for (i = 0; i < (DDI_MEDIA_HEAP_INCREMENTAL_SIZE); i++)
-        {
-            pVAImageHeapElmt                   = &pVAImageHeapBase[pImageHeap->uiAllocatedHeapElements + i];
-            pVAImageHeapElmt->pNextFree        = (i == (DDI_MEDIA_HEAP_INCREMENTAL_SIZE - 1))? nullptr : &pVAImageHeapBase[pImageHeap->uiAllocatedHeapElements + i + 1];
-            pVAImageHeapElmt->uiVaImageID      = pImageHeap->uiAllocatedHeapElements + i;
-        }
-        pImageHeap->uiAllocatedHeapElements   += DDI_MEDIA_HEAP_INCREMENTAL_SIZE;
-
+        return nullptr;
     }
+    pVAImageHeapElmt->uiVaImageID          = uiVaImageID;
 
-    pVAImageHeapElmt                           = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)pImageHeap->pFirstFreeHeapElement;
-    pImageHeap->pFirstFreeHeapElement          = pVAImageHeapElmt->pNextFree;
     return pVAImageHeapElmt;
 }
 
 
 void DdiMediaUtil_ReleasePVAImageFromHeap(PDDI_MEDIA_HEAP pImageHeap, uint32_t uiVAImageID)
 {
-    PDDI_MEDIA_IMAGE_HEAP_ELEMENT    pVAImageHeapBase;
     PDDI_MEDIA_IMAGE_HEAP_ELEMENT    pVAImageHeapElmt;
-    void                            *pFirstFree;
 
-    DDI_CHK_LESS(uiVAImageID, pImageHeap->uiAllocatedHeapElements, "invalid image id", );
-    pVAImageHeapBase                    = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)pImageHeap->pHeapBase;
-    pVAImageHeapElmt                    = &pVAImageHeapBase[uiVAImageID];
+    pVAImageHeapElmt                    = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pImageHeap, uiVAImageID);
+    DDI_CHK_NULL(pVAImageHeapElmt, "invalid image id", );
     DDI_CHK_NULL(pVAImageHeapElmt->pImage, "image is already released", );
-    pFirstFree                          = pImageHeap->pFirstFreeHeapElement;
-    pImageHeap->pFirstFreeHeapElement   = (void*)pVAImageHeapElmt;
-    pVAImageHeapElmt->pNextFree         = (PDDI_MEDIA_IMAGE_HEAP_ELEMENT)pFirstFree;
     pVAImageHeapElmt->pImage            = nullptr;
+    DdiMediaUtil_ReleaseHeapElement(pImageHeap, uiVAImageID);
 }
 
 PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT DdiMediaUtil_AllocPVAContextFromHeap(PDDI_MEDIA_HEAP pVaContextHeap)
 {
-    PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT   pVAContextHeapBase;
     PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT   pVAContextHeapElmt;
-    void                               *pNewHeapBase;
-    int32_t                                 i;
+    uint32_t                            uiVaContextID;
 
-    if (nullptr == pVaContextHeap->pFirstFreeHeapElement)
+    pVAContextHeapElmt = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)DdiMediaUtil_AllocHeapElement(pVaContextHeap, &uiVaContextID);
+    if (nullptr == pVAContextHeapElmt)
     {
-        pNewHeapBase = realloc(pVaContextHeap->pHeapBase, (pVaContextHeap->uiAllocatedHeapElements + DDI_MEDIA_HEAP_INCREMENTAL_SIZE) * sizeof(DDI_MEDIA_VACONTEXT_HEAP_ELEMENT));
-
-        if (nullptr == pNewHeapBase)
-        {
-            DDI_ASSERTMESSAGE("DDI: realloc failed.");
-            return nullptr;
-        }
-        pVaContextHeap->pHeapBase                    = pNewHeapBase;
-        pVAContextHeapBase                           = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)pVaContextHeap->pHeapBase;
-        pVaContextHeap->pFirstFreeHeapElement        = (void*)(&(pVAContextHeapBase[pVaContextHeap->uiAllocatedHeapElements]));
-        for (i = 0; i < (DDI_MEDIA_HEAP_INCREMENTAL_SIZE); i++)
-        {
-            pVAContextHeapElmt                       = &pVAContextHeapBase[pVaContextHeap->uiAllocatedHeapElements + i];
-            pVAContextHeapElmt->pNextFree            = (i == (DDI_MEDIA_HEAP_INCREMENTAL_SIZE - 1))? nullptr : &pVAContextHeapBase[pVaContextHeap->uiAllocatedHeapElements + i + 1];
-            pVAContextHeapElmt->uiVaContextID        = pVaContextHeap->uiAllocatedHeapElements + i;
-            pVAContextHeapElmt->pVaContext           = nullptr;
-        }
-        pVaContextHeap->uiAllocatedHeapElements     += DDI_MEDIA_HEAP_INCREMENTAL_SIZE;
+        return nullptr;
     }
+    pVAContextHeapElmt->uiVaContextID      = uiVaContextID;
+    pVAContextHeapElmt->pVaContext         = nullptr;
 
-    pVAContextHeapElmt                               = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)pVaContextHeap->pFirstFreeHeapElement;
-    pVaContextHeap->pFirstFreeHeapElement            = pVAContextHeapElmt->pNextFree;
     return pVAContextHeapElmt;
 }
 
@@ -1582,17 +1844,12 @@ PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT DdiMediaUtil_AllocPVAContextFromHeap(PDDI_MEDI
 void DdiMediaUtil_ReleasePVAContextFromHeap(PDDI_MEDIA_HEAP pVaContextHeap, uint32_t uiVAContextID)
 {
     PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT    pVAContextHeapElmt;
-    PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT    pVAContextHeapBase;
-    void                                *pFirstFree;
 
-    DDI_CHK_LESS(uiVAContextID, pVaContextHeap->uiAllocatedHeapElements, "invalid context id", );
-    pVAContextHeapBase                      = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)pVaContextHeap->pHeapBase;
-    pVAContextHeapElmt                      = &pVAContextHeapBase[uiVAContextID];
+    pVAContextHeapElmt                      = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)DdiMediaUtil_GetHeapElement(pVaContextHeap, uiVAContextID);
+    DDI_CHK_NULL(pVAContextHeapElmt, "invalid context id", );
     DDI_CHK_NULL(pVAContextHeapElmt->pVaContext, "context is already released", );
-    pFirstFree                              = pVaContextHeap->pFirstFreeHeapElement;
-    pVaContextHeap->pFirstFreeHeapElement   = (void*)pVAContextHeapElmt;
-    pVAContextHeapElmt->pNextFree           = (PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT)pFirstFree;
     pVAContextHeapElmt->pVaContext          = nullptr;
+    DdiMediaUtil_ReleaseHeapElement(pVaContextHeap, uiVAContextID);
 }
 
 void DdiMediaUtil_UnRefBufObjInMediaBuffer(PDDI_MEDIA_BUFFER pBuf)
@@ -1623,6 +1880,27 @@ void DdiMediaUtil_GetEnabledFeature(PDDI_MEDIA_CONTEXT pMediaCtx)
 #ifdef ANDROID
     pMediaCtx->bVC1Enabled = false;
 #endif
+
+    // Size limits of the buffer object reuse cache, in MB
+    MOS_USER_FEATURE_VALUE_DATA UserFeatureData;
+    uint32_t                    uiBoCacheMaxSize;
+    MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_BO_CACHE_MAX_SIZE_ID,
+        &UserFeatureData);
+    uiBoCacheMaxSize = UserFeatureData.u32Data;
+
+    MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_BO_CACHE_BUDGET_ID,
+        &UserFeatureData);
+
+    mos_bufmgr_gem_set_bo_cache_limits(
+        pMediaCtx->pDrmBufMgr,
+        (unsigned long)uiBoCacheMaxSize << 20,
+        (uint64_t)UserFeatureData.u32Data << 20);
 }
 
 // Open Intel's Graphics Device to get the file descriptor
@@ -44,6 +44,9 @@ void*    DdiMediaUtil_LockBuffer(DDI_MEDIA_BUFFER *pBuf, uint32_t flag);
 void     DdiMediaUtil_UnlockBuffer(DDI_MEDIA_BUFFER *pBuf);
 
 void     DdiMediaUtil_FreeSurface(DDI_MEDIA_SURFACE *pSurface);
+void     DdiMediaUtil_AddSurfaceToBoIndex(PDDI_MEDIA_CONTEXT pMediaCtx, DDI_MEDIA_SURFACE *pSurface);
+void     DdiMediaUtil_RemoveSurfaceFromBoIndex(PDDI_MEDIA_CONTEXT pMediaCtx, DDI_MEDIA_SURFACE *pSurface);
+DDI_MEDIA_SURFACE* DdiMediaUtil_LockSurfaceStatusByBo(PDDI_MEDIA_CONTEXT pMediaCtx, MOS_LINUX_BO *bo);
 void     DdiMediaUtil_FreeBuffer(DDI_MEDIA_BUFFER  *pBuf);
 
 void     DdiMediaUtil_InitMutex(PMEDIA_MUTEX_T  pMutex);
@@ -60,6 +63,18 @@ VAStatus DdiMediaUtil_ConvertBufImageToSurface(DDI_MEDIA_BUFFER *pBuf, VAImage *
 VAStatus DdiMediaUtil_FillPositionToRect(RECT *rect, int16_t offset_x, int16_t offset_y, int16_t width, int16_t height);
 bool     DdiMediaUtil_IsExternalSurface(PDDI_MEDIA_SURFACE pSurface);
 
+void     DdiMediaUtil_CopyRowFromWC(uint8_t *pDst, const uint8_t *pSrc, uint32_t uiBytes);
+void     DdiMediaUtil_SplitBytePairs(const uint8_t *pSrc, uint8_t *pEven, uint8_t *pOdd, uint32_t uiPairs);
+void     DdiMediaUtil_InterleaveBytePairs(const uint8_t *pEven, const uint8_t *pOdd, uint8_t *pDst, uint32_t uiPairs);
+void     DdiMediaUtil_SwapRBRow(const uint8_t *pSrc, uint8_t *pDst, uint32_t uiPixels);
+
+void     DdiMediaUtil_InitHeap(PDDI_MEDIA_HEAP pHeap, uint32_t uiHeapElementSize);
+void     DdiMediaUtil_DestroyHeap(PDDI_MEDIA_HEAP pHeap);
+void*    DdiMediaUtil_AllocHeapElement(PDDI_MEDIA_HEAP pHeap, uint32_t *puiId);
+void*    DdiMediaUtil_GetHeapElement(PDDI_MEDIA_HEAP pHeap, uint32_t uiId);
+void*    DdiMediaUtil_GetHeapElementByIndex(PDDI_MEDIA_HEAP pHeap, uint32_t uiIndex);
+bool     DdiMediaUtil_ReleaseHeapElement(PDDI_MEDIA_HEAP pHeap, uint32_t uiId);
+
 PDDI_MEDIA_SURFACE_HEAP_ELEMENT DdiMediaUtil_AllocPMediaSurfaceFromHeap(PDDI_MEDIA_HEAP pSurfaceHeap);
 void     DdiMediaUtil_ReleasePMediaSurfaceFromHeap(PDDI_MEDIA_HEAP pSurfaceHeap, uint32_t uiVaSurfaceID);
 
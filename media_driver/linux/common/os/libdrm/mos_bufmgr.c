@@ -90,6 +90,17 @@
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 #define MAX2(A, B) ((A) > (B) ? (A) : (B))
+#define MIN2(A, B) ((A) < (B) ? (A) : (B))
+
+/* The BO cache has 4K, 8K and 12K buckets and then four buckets per power
+ * of two from 16K up to (and including) 1 << MOS_BO_CACHE_MAX_LOG2.
+ */
+#define MOS_BO_CACHE_MAX_LOG2                   30
+#define MOS_BO_CACHE_NUM_BUCKETS                (3 + 4 * (MOS_BO_CACHE_MAX_LOG2 - 13))
+#define MOS_BO_CACHE_DEFAULT_MAX_BO_SIZE        (256UL * 1024 * 1024)
+#define MOS_BO_CACHE_DEFAULT_BUDGET             (512ULL * 1024 * 1024)
+/* Longest time in seconds an idle BO stays cached in a frequently reused bucket */
+#define MOS_BO_CACHE_MAX_IDLE_TIME              16
 
 /**
  * upper_32_bits - return bits 32-63 of a number
@@ -110,6 +121,8 @@
 struct mos_gem_bo_bucket {
 	drmMMListHead head;
 	unsigned long size;
+	/** Cache hits in this bucket, halved every second by the cleanup */
+	unsigned int reuse_count;
 };
 
 struct mos_bufmgr_gem {
@@ -121,7 +134,12 @@ struct mos_bufmgr_gem {
 
 	int max_relocs;
 
+	/** Protects the BO cache, the named list and final unreferences */
 	pthread_mutex_t lock;
+	/** Protects the validation list built by exec */
+	pthread_mutex_t exec_lock;
+	/** Protects the vma cache and the map state of the BOs */
+	pthread_mutex_t vma_lock;
 
 	struct drm_i915_gem_exec_object *exec_objects;
 	struct drm_i915_gem_exec_object2 *exec2_objects;
@@ -129,9 +147,14 @@ struct mos_bufmgr_gem {
 	int exec_size;
 	int exec_count;
 
-	/** Array of lists of cached gem objects of power-of-two sizes */
-	struct mos_gem_bo_bucket cache_bucket[14 * 4];
+	/** Array of lists of cached gem objects, four sizes per power of two */
+	struct mos_gem_bo_bucket cache_bucket[MOS_BO_CACHE_NUM_BUCKETS];
+	/** Number of buckets in use, limited by the largest cacheable size */
 	int num_buckets;
+	/** Total size of the BOs sitting in the cache */
+	uint64_t cached_bytes;
+	/** Upper limit of cached_bytes */
+	uint64_t cache_budget;
 	time_t time;
 
 	drmMMListHead managers;
@@ -425,21 +448,45 @@ mos_gem_bo_tile_pitch(struct mos_bufmgr_gem *bufmgr_gem,
 	return i;
 }
 
+static int
+mos_gem_bo_bucket_index(unsigned long size)
+{
+	unsigned long s;
+	int lg;
+
+	if (size <= 3 * 4096)
+		return size ? (size - 1) / 4096 : 0;
+	if (size <= 4 * 4096)
+		return 3;
+
+	/* Above 16K the buckets are p, p * 5/4, p * 6/4 and p * 7/4 for each
+	 * power of two p, so the position of the top bit of (size - 1) picks
+	 * the power of two and the two bits below it pick the quarter.
+	 */
+	s = size - 1;
+	lg = 8 * sizeof(s) - 1 - __builtin_clzl(s);
+	return 4 + (lg - 14) * 4 + (int)((s >> (lg - 2)) & 3);
+}
+
 static struct mos_gem_bo_bucket *
 mos_gem_bo_bucket_for_size(struct mos_bufmgr_gem *bufmgr_gem,
 				 unsigned long size)
 {
-	int i;
+	int i = mos_gem_bo_bucket_index(size);
 
-	for (i = 0; i < bufmgr_gem->num_buckets; i++) {
-		struct mos_gem_bo_bucket *bucket =
-		    &bufmgr_gem->cache_bucket[i];
-		if (bucket->size >= size) {
-			return bucket;
-		}
-	}
+	if (i >= bufmgr_gem->num_buckets)
+		return nullptr;
 
-	return nullptr;
+	assert(bufmgr_gem->cache_bucket[i].size >= size);
+	return &bufmgr_gem->cache_bucket[i];
+}
+
+static void
+mos_gem_bo_cache_remove(struct mos_bufmgr_gem *bufmgr_gem,
+			      struct mos_bo_gem *bo_gem)
+{
+	DRMLISTDEL(&bo_gem->head);
+	bufmgr_gem->cached_bytes -= bo_gem->bo.size;
 }
 
 static void
@@ -780,7 +827,7 @@ mos_gem_bo_cache_purge_bucket(struct mos_bufmgr_gem *bufmgr_gem,
 		    (bufmgr_gem, bo_gem, I915_MADV_DONTNEED))
 			break;
 
-		DRMLISTDEL(&bo_gem->head);
+		mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
 		mos_gem_bo_free(&bo_gem->bo);
 	}
 }
@@ -803,7 +850,7 @@ mos_gem_empty_bo_cache(struct mos_bufmgr_gem *bufmgr_gem)
 			bo_gem = DRMLISTENTRY(struct mos_bo_gem,
 					      bucket->head.next, head);
 
-			DRMLISTDEL(&bo_gem->head);
+			mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
 			mos_gem_bo_free(&bo_gem->bo);
 		}
 	}
@@ -848,22 +895,25 @@ mos_gem_bo_alloc_internal(struct mos_bufmgr *bufmgr,
 		bo_size = bucket->size;
 	}
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
-	/* Get a buffer out of the cache if available */
+	/* Get a buffer out of the cache if available. Only the list
+	 * operations are done under the lock, the ioctls to revive the
+	 * buffer are not.
+	 */
 retry:
 	alloc_from_cache = false;
-	if (bucket != nullptr && !DRMLISTEMPTY(&bucket->head)) {
-		if (for_render) {
+	if (bucket != nullptr) {
+		pthread_mutex_lock(&bufmgr_gem->lock);
+		if (!DRMLISTEMPTY(&bucket->head) && for_render) {
 			/* Allocate new render-target BOs from the tail (MRU)
 			 * of the list, as it will likely be hot in the GPU
 			 * cache and in the aperture for us.
 			 */
 			bo_gem = DRMLISTENTRY(struct mos_bo_gem,
 					      bucket->head.prev, head);
-			DRMLISTDEL(&bo_gem->head);
+			mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
 			alloc_from_cache = true;
 			bo_gem->bo.align = alignment;
-		} else {
+		} else if (!DRMLISTEMPTY(&bucket->head)) {
 			assert(alignment == 0);
 			/* For non-render-target BOs (where we're probably
 			 * going to map it first thing in order to fill it
@@ -876,28 +926,31 @@ retry:
 					      bucket->head.next, head);
 			if (!mos_gem_bo_busy(&bo_gem->bo)) {
 				alloc_from_cache = true;
-				DRMLISTDEL(&bo_gem->head);
+				mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
 			}
 		}
+		if (alloc_from_cache)
+			bucket->reuse_count++;
+		pthread_mutex_unlock(&bufmgr_gem->lock);
+	}
 
-		if (alloc_from_cache) {
-			if (!mos_gem_bo_madvise_internal
-			    (bufmgr_gem, bo_gem, I915_MADV_WILLNEED)) {
-				mos_gem_bo_free(&bo_gem->bo);
-				mos_gem_bo_cache_purge_bucket(bufmgr_gem,
-								    bucket);
-				goto retry;
-			}
+	if (alloc_from_cache) {
+		if (!mos_gem_bo_madvise_internal
+		    (bufmgr_gem, bo_gem, I915_MADV_WILLNEED)) {
+			mos_gem_bo_free(&bo_gem->bo);
+			pthread_mutex_lock(&bufmgr_gem->lock);
+			mos_gem_bo_cache_purge_bucket(bufmgr_gem, bucket);
+			pthread_mutex_unlock(&bufmgr_gem->lock);
+			goto retry;
+		}
 
-			if (mos_gem_bo_set_tiling_internal(&bo_gem->bo,
-								 tiling_mode,
-								 stride)) {
-				mos_gem_bo_free(&bo_gem->bo);
-				goto retry;
-			}
+		if (mos_gem_bo_set_tiling_internal(&bo_gem->bo,
+							 tiling_mode,
+							 stride)) {
+			mos_gem_bo_free(&bo_gem->bo);
+			goto retry;
 		}
 	}
-	pthread_mutex_unlock(&bufmgr_gem->lock);
 
 	if (!alloc_from_cache) {
 		struct drm_i915_gem_create create;
@@ -1007,7 +1060,7 @@ retry:
 					entry, head);
 
 			    if (bo_gem->bo.size >= size) {
-					DRMLISTDEL(&bo_gem->head);
+					mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
 					alloc_from_cache = true;
 					break;
 			    }
@@ -1027,7 +1080,7 @@ retry:
 
 			    if ((bo_gem->bo.size >= size) &&
 				!mos_gem_bo_busy(&bo_gem->bo)) {
-					DRMLISTDEL(&bo_gem->head);
+					mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
 					alloc_from_cache = true;
 					break;
 			    }
@@ -1035,6 +1088,7 @@ retry:
 		}
 
 		if (alloc_from_cache) {
+			bucket->reuse_count++;
 			if (!mos_gem_bo_madvise_internal
 			    (bufmgr_gem, bo_gem, I915_MADV_WILLNEED)) {
 				mos_gem_bo_free(&bo_gem->bo);
@@ -1604,6 +1658,7 @@ mos_gem_bo_free(struct mos_linux_bo *bo)
 	struct drm_gem_close close;
 	int ret;
 
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
 	DRMLISTDEL(&bo_gem->vma_list);
 	if (bo_gem->mem_virtual) {
 		VG(VALGRIND_FREELIKE_BLOCK(bo_gem->mem_virtual, 0));
@@ -1623,6 +1678,7 @@ mos_gem_bo_free(struct mos_linux_bo *bo)
 #endif
 		bufmgr_gem->vma_count--;
 	}
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
 
 	/* Close this object */
 	memclear(close);
@@ -1655,7 +1711,14 @@ mos_gem_bo_mark_mmaps_incoherent(struct mos_linux_bo *bo)
 #endif
 }
 
-/** Frees all cached buffers significantly older than @time. */
+/**
+ * Frees the cached buffers that have been idle for too long at @time.
+ *
+ * A buffer in a bucket that is not being reused expires after a second as
+ * before; the more often a bucket is hit, the longer its buffers are kept,
+ * up to MOS_BO_CACHE_MAX_IDLE_TIME.  The hit counts are halved on every
+ * pass so that the idle time follows the recent reuse rate.
+ */
 static void
 mos_gem_cleanup_bo_cache(struct mos_bufmgr_gem *bufmgr_gem, time_t time)
 {
@@ -1667,24 +1730,60 @@ mos_gem_cleanup_bo_cache(struct mos_bufmgr_gem *bufmgr_gem, time_t time)
 	for (i = 0; i < bufmgr_gem->num_buckets; i++) {
 		struct mos_gem_bo_bucket *bucket =
 		    &bufmgr_gem->cache_bucket[i];
+		time_t max_idle = 1 + MIN2(bucket->reuse_count,
+					   MOS_BO_CACHE_MAX_IDLE_TIME);
 
 		while (!DRMLISTEMPTY(&bucket->head)) {
 			struct mos_bo_gem *bo_gem;
 
 			bo_gem = DRMLISTENTRY(struct mos_bo_gem,
 					      bucket->head.next, head);
-			if (time - bo_gem->free_time <= 1)
+			if (time - bo_gem->free_time <= max_idle)
 				break;
 
-			DRMLISTDEL(&bo_gem->head);
+			mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
 
 			mos_gem_bo_free(&bo_gem->bo);
 		}
+
+		bucket->reuse_count >>= 1;
 	}
 
 	bufmgr_gem->time = time;
 }
 
+/**
+ * Frees cached buffers until the cache fits in its budget again, starting
+ * with the oldest buffer of the least reused bucket (the larger one on a tie).
+ */
+static void
+mos_gem_bo_cache_trim(struct mos_bufmgr_gem *bufmgr_gem)
+{
+	while (bufmgr_gem->cached_bytes > bufmgr_gem->cache_budget) {
+		struct mos_gem_bo_bucket *victim = nullptr;
+		struct mos_bo_gem *bo_gem;
+		int i;
+
+		for (i = 0; i < bufmgr_gem->num_buckets; i++) {
+			struct mos_gem_bo_bucket *bucket =
+			    &bufmgr_gem->cache_bucket[i];
+
+			if (DRMLISTEMPTY(&bucket->head))
+				continue;
+			if (victim == nullptr ||
+			    bucket->reuse_count <= victim->reuse_count)
+				victim = bucket;
+		}
+		if (victim == nullptr)
+			break;
+
+		bo_gem = DRMLISTENTRY(struct mos_bo_gem,
+				      victim->head.next, head);
+		mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
+		mos_gem_bo_free(&bo_gem->bo);
+	}
+}
+
 static void mos_gem_bo_purge_vma_cache(struct mos_bufmgr_gem *bufmgr_gem)
 {
 	int limit;
@@ -1806,18 +1905,21 @@ mos_gem_bo_unreference_final(struct mos_linux_bo *bo, time_t time)
 	}
 
 	/* Clear any left-over mappings */
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
 	if (bo_gem->map_count) {
 		MOS_DBG("bo freed with non-zero map-count %d\n", bo_gem->map_count);
 		bo_gem->map_count = 0;
 		mos_gem_bo_close_vma(bufmgr_gem, bo_gem);
 		mos_gem_bo_mark_mmaps_incoherent(bo);
 	}
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
 
 	DRMLISTDEL(&bo_gem->name_list);
 
 	bucket = mos_gem_bo_bucket_for_size(bufmgr_gem, bo->size);
 	/* Put the buffer into our internal cache for reuse if we can. */
 	if (bufmgr_gem->bo_reuse && bo_gem->reusable && bucket != nullptr &&
+	    bo->size <= bufmgr_gem->cache_budget &&
 	    mos_gem_bo_madvise_internal(bufmgr_gem, bo_gem,
 					      I915_MADV_DONTNEED)) {
 		bo_gem->free_time = time;
@@ -1826,6 +1928,8 @@ mos_gem_bo_unreference_final(struct mos_linux_bo *bo, time_t time)
 		bo_gem->validate_index = -1;
 
 		DRMLISTADDTAIL(&bo_gem->head, &bucket->head);
+		bufmgr_gem->cached_bytes += bo->size;
+		mos_gem_bo_cache_trim(bufmgr_gem);
 	} else {
 		mos_gem_bo_free(bo);
 	}
@@ -1931,13 +2035,11 @@ mos_gem_bo_map_wc(struct mos_linux_bo *bo) {
 	struct drm_i915_gem_set_domain set_domain;
 	int ret;
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
-
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
 	ret = map_wc(bo);
-	if (ret) {
-		pthread_mutex_unlock(&bufmgr_gem->lock);
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
+	if (ret)
 		return ret;
-	}
 
 	/* Now move it to the GTT domain so that the GPU and CPU
 	 * caches are flushed and the GPU isn't actively using the
@@ -1945,7 +2047,8 @@ mos_gem_bo_map_wc(struct mos_linux_bo *bo) {
 	 *
 	 * The domain change is done even for the objects which
 	 * are not bounded. For them first the pages are acquired,
-	 * before the domain change.
+	 * before the domain change.  It may wait for the GPU, so
+	 * it is done without holding any bufmgr lock.
 	 */
 	memclear(set_domain);
 	set_domain.handle = bo_gem->gem_handle;
@@ -1961,7 +2064,6 @@ mos_gem_bo_map_wc(struct mos_linux_bo *bo) {
 	}
 	mos_gem_bo_mark_mmaps_incoherent(bo);
 	VG(VALGRIND_MAKE_MEM_DEFINED(bo_gem->mem_wc_virtual, bo->size));
-	pthread_mutex_unlock(&bufmgr_gem->lock);
 
 	return 0;
 }
@@ -1974,7 +2076,7 @@ mos_gem_bo_map_wc_unsynchronized(struct mos_linux_bo *bo) {
 #endif
 	int ret;
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
 
 	ret = map_wc(bo);
 	if (ret == 0) {
@@ -1982,7 +2084,7 @@ mos_gem_bo_map_wc_unsynchronized(struct mos_linux_bo *bo) {
 		VG(VALGRIND_MAKE_MEM_DEFINED(bo_gem->mem_wc_virtual, bo->size));
 	}
 
-	pthread_mutex_unlock(&bufmgr_gem->lock);
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
 
 	return ret;
 }
@@ -2004,7 +2106,7 @@ drm_export int mos_gem_bo_map(struct mos_linux_bo *bo, int write_enable)
 		return 0;
 	}
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
 
 	if (bo_gem->map_count++ == 0)
 		mos_gem_bo_open_vma(bufmgr_gem, bo_gem);
@@ -2028,7 +2130,7 @@ drm_export int mos_gem_bo_map(struct mos_linux_bo *bo, int write_enable)
 			    bo_gem->name, strerror(errno));
 			if (--bo_gem->map_count == 0)
 				mos_gem_bo_close_vma(bufmgr_gem, bo_gem);
-			pthread_mutex_unlock(&bufmgr_gem->lock);
+			pthread_mutex_unlock(&bufmgr_gem->vma_lock);
 			return ret;
 		}
 		VG(VALGRIND_MALLOCLIKE_BLOCK(mmap_arg.addr_ptr, mmap_arg.size, 0, 1));
@@ -2042,6 +2144,12 @@ drm_export int mos_gem_bo_map(struct mos_linux_bo *bo, int write_enable)
 	bo->virtual = bo_gem->mem_virtual;
 #endif
 
+	if (write_enable)
+		bo_gem->mapped_cpu_write = true;
+
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
+
+	/* The domain change may wait for the GPU, keep it out of the lock */
 	memclear(set_domain);
 	set_domain.handle = bo_gem->gem_handle;
 	set_domain.read_domains = I915_GEM_DOMAIN_CPU;
@@ -2058,12 +2166,8 @@ drm_export int mos_gem_bo_map(struct mos_linux_bo *bo, int write_enable)
 		    strerror(errno));
 	}
 
-	if (write_enable)
-		bo_gem->mapped_cpu_write = true;
-
 	mos_gem_bo_mark_mmaps_incoherent(bo);
 	VG(VALGRIND_MAKE_MEM_DEFINED(bo_gem->mem_virtual, bo->size));
-	pthread_mutex_unlock(&bufmgr_gem->lock);
 
 	return 0;
 }
@@ -2142,13 +2246,11 @@ mos_gem_bo_map_gtt(struct mos_linux_bo *bo)
 	struct drm_i915_gem_set_domain set_domain;
 	int ret;
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
-
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
 	ret = map_gtt(bo);
-	if (ret) {
-		pthread_mutex_unlock(&bufmgr_gem->lock);
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
+	if (ret)
 		return ret;
-	}
 
 	/* Now move it to the GTT domain so that the GPU and CPU
 	 * caches are flushed and the GPU isn't actively using the
@@ -2158,6 +2260,7 @@ mos_gem_bo_map_gtt(struct mos_linux_bo *bo)
 	 * it has unbound the BO from the GTT, but it's up to us to
 	 * tell it when we're about to use things if we had done
 	 * rendering and it still happens to be bound to the GTT.
+	 * It may wait for the GPU, so no bufmgr lock is held.
 	 */
 	memclear(set_domain);
 	set_domain.handle = bo_gem->gem_handle;
@@ -2174,7 +2277,6 @@ mos_gem_bo_map_gtt(struct mos_linux_bo *bo)
 
 	mos_gem_bo_mark_mmaps_incoherent(bo);
 	VG(VALGRIND_MAKE_MEM_DEFINED(bo_gem->gtt_virtual, bo->size));
-	pthread_mutex_unlock(&bufmgr_gem->lock);
 
 	return 0;
 }
@@ -2212,7 +2314,7 @@ mos_gem_bo_map_unsynchronized(struct mos_linux_bo *bo)
 	if (!bufmgr_gem->has_llc)
 		return mos_gem_bo_map_gtt(bo);
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
 
 	ret = map_gtt(bo);
 	if (ret == 0) {
@@ -2220,7 +2322,7 @@ mos_gem_bo_map_unsynchronized(struct mos_linux_bo *bo)
 		VG(VALGRIND_MAKE_MEM_DEFINED(bo_gem->gtt_virtual, bo->size));
 	}
 
-	pthread_mutex_unlock(&bufmgr_gem->lock);
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
 
 	return ret;
 }
@@ -2239,11 +2341,11 @@ drm_export int mos_gem_bo_unmap(struct mos_linux_bo *bo)
 
 	bufmgr_gem = (struct mos_bufmgr_gem *) bo->bufmgr;
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
 
 	if (bo_gem->map_count <= 0) {
 		MOS_DBG("attempted to unmap an unmapped bo\n");
-		pthread_mutex_unlock(&bufmgr_gem->lock);
+		pthread_mutex_unlock(&bufmgr_gem->vma_lock);
 		/* Preserve the old behaviour of just treating this as a
 		 * no-op rather than reporting the error.
 		 */
@@ -2281,7 +2383,7 @@ drm_export int mos_gem_bo_unmap(struct mos_linux_bo *bo)
 		bo->virtual = nullptr;
 #endif
 	}
-	pthread_mutex_unlock(&bufmgr_gem->lock);
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
 
 	return ret;
 }
@@ -2495,6 +2597,7 @@ mos_bufmgr_gem_destroy(struct mos_bufmgr *bufmgr)
 #endif
 
 	pthread_mutex_destroy(&bufmgr_gem->lock);
+	pthread_mutex_destroy(&bufmgr_gem->exec_lock);
 
 #ifndef ANDROID
 	/* Free any cached buffer objects we were going to reuse */
@@ -2524,6 +2627,8 @@ mos_bufmgr_gem_destroy(struct mos_bufmgr *bufmgr)
 				"i915 kernel driver may not be sane!\n", errno);
 	}
 #endif
+	/* mos_gem_bo_free() above still takes the vma lock */
+	pthread_mutex_destroy(&bufmgr_gem->vma_lock);
 	free(bufmgr);
 }
 
@@ -2971,19 +3076,20 @@ mos_update_buffer_offsets2 (struct mos_bufmgr_gem *bufmgr_gem, mos_linux_context
 		}
 
 #ifndef ANDROID
-		if (cmd_bo != bo) {
-			auto item_ctx = ctx->pOsContext->contextOffsetList.begin();
-			for (; item_ctx != ctx->pOsContext->contextOffsetList.end(); item_ctx++) {
-				if (item_ctx->intel_context == ctx && item_ctx->target_bo == bo) {
-					item_ctx->offset64 = bo->offset64;
+		if (cmd_bo != bo && ctx->pOsContext->pContextOffsetList != nullptr) {
+			auto range = ctx->pOsContext->pContextOffsetList->equal_range(bo);
+			auto item_ctx = range.first;
+			for (; item_ctx != range.second; item_ctx++) {
+				if (item_ctx->second.intel_context == ctx) {
+					item_ctx->second.offset64 = bo->offset64;
 					break;
 				}
 			}
-			if ( item_ctx == ctx->pOsContext->contextOffsetList.end()) {
+			if (item_ctx == range.second) {
 				struct MOS_CONTEXT_OFFSET newContext = {ctx,
 									bo,
 									bo->offset64};
-				ctx->pOsContext->contextOffsetList.push_back(newContext);
+				ctx->pOsContext->pContextOffsetList->emplace(bo, newContext);
 			}
 		}
 #endif
@@ -3310,7 +3416,7 @@ mos_gem_bo_exec(struct mos_linux_bo *bo, int used,
 	if (to_bo_gem(bo)->has_error)
 		return -ENOMEM;
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
+	pthread_mutex_lock(&bufmgr_gem->exec_lock);
 	/* Update indices and set up the validate list. */
 	mos_gem_bo_process_reloc(bo);
 
@@ -3366,7 +3472,7 @@ mos_gem_bo_exec(struct mos_linux_bo *bo, int used,
 		bufmgr_gem->exec_bos[i] = nullptr;
 	}
 	bufmgr_gem->exec_count = 0;
-	pthread_mutex_unlock(&bufmgr_gem->lock);
+	pthread_mutex_unlock(&bufmgr_gem->exec_lock);
 
 	return ret;
 }
@@ -3472,7 +3578,7 @@ do_exec2(struct mos_linux_bo *bo, int used, struct mos_linux_context *ctx,
 		break;
 	}
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
+	pthread_mutex_lock(&bufmgr_gem->exec_lock);
 	/* Update indices and set up the validate list. */
 	mos_gem_bo_process_reloc2(bo);
 
@@ -3535,7 +3641,7 @@ skip_execution:
 		bufmgr_gem->exec_bos[i] = nullptr;
 	}
 	bufmgr_gem->exec_count = 0;
-	pthread_mutex_unlock(&bufmgr_gem->lock);
+	pthread_mutex_unlock(&bufmgr_gem->exec_lock);
 
 	return ret;
 }
@@ -3596,7 +3702,7 @@ do_exec2(struct mos_linux_bo *bo, int used, struct mos_linux_context *ctx,
 	}
 #endif
 
-	pthread_mutex_lock(&bufmgr_gem->lock);
+	pthread_mutex_lock(&bufmgr_gem->exec_lock);
 	/* Update indices and set up the validate list. */
 	mos_gem_bo_process_reloc2(bo);
 
@@ -3683,7 +3789,7 @@ skip_execution:
 		bufmgr_gem->exec_bos[i] = nullptr;
 	}
 	bufmgr_gem->exec_count = 0;
-	pthread_mutex_unlock(&bufmgr_gem->lock);
+	pthread_mutex_unlock(&bufmgr_gem->exec_lock);
 
 	return ret;
 }
@@ -4222,11 +4328,11 @@ mos_gem_bo_prime(struct mos_linux_bo *bo, uint32_t * prime_fd)
 #endif
 
 /**
- * Enables unlimited caching of buffer objects for reuse.
+ * Enables caching of buffer objects for reuse.
  *
- * This is potentially very memory expensive, as the cache at each bucket
- * size is only bounded by how many buffers of that size we've managed to have
- * in flight at once.
+ * The cache is bounded by the limits set with
+ * mos_bufmgr_gem_set_bo_cache_limits(), by default buffers up to 256MB and
+ * 512MB in total.
  */
 void
 mos_bufmgr_gem_enable_reuse(struct mos_bufmgr *bufmgr)
@@ -4236,6 +4342,60 @@ mos_bufmgr_gem_enable_reuse(struct mos_bufmgr *bufmgr)
 	bufmgr_gem->bo_reuse = true;
 }
 
+/* Limits the buckets in use to the ones not larger than @max_bo_size */
+static void
+mos_gem_bo_cache_set_max_bo_size(struct mos_bufmgr_gem *bufmgr_gem,
+				       unsigned long max_bo_size)
+{
+	int num_buckets = 0;
+
+	while (num_buckets < (int)ARRAY_SIZE(bufmgr_gem->cache_bucket) &&
+	       bufmgr_gem->cache_bucket[num_buckets].size <= max_bo_size)
+		num_buckets++;
+
+	/* Buckets that are dropped give their buffers back to the kernel */
+	for (; bufmgr_gem->num_buckets > num_buckets; bufmgr_gem->num_buckets--) {
+		struct mos_gem_bo_bucket *bucket =
+		    &bufmgr_gem->cache_bucket[bufmgr_gem->num_buckets - 1];
+
+		while (!DRMLISTEMPTY(&bucket->head)) {
+			struct mos_bo_gem *bo_gem;
+
+			bo_gem = DRMLISTENTRY(struct mos_bo_gem,
+					      bucket->head.next, head);
+			mos_gem_bo_cache_remove(bufmgr_gem, bo_gem);
+			mos_gem_bo_free(&bo_gem->bo);
+		}
+	}
+
+	bufmgr_gem->num_buckets = num_buckets;
+}
+
+/**
+ * Sets the largest BO size kept in the reuse cache and the total number of
+ * bytes the cache may hold.  Zero leaves the respective limit unchanged.
+ *
+ * Cached buffers that no longer fit are freed right away.
+ */
+void
+mos_bufmgr_gem_set_bo_cache_limits(struct mos_bufmgr *bufmgr,
+				   unsigned long max_bo_size,
+				   uint64_t budget)
+{
+	struct mos_bufmgr_gem *bufmgr_gem = (struct mos_bufmgr_gem *) bufmgr;
+
+	pthread_mutex_lock(&bufmgr_gem->lock);
+
+	if (max_bo_size)
+		mos_gem_bo_cache_set_max_bo_size(bufmgr_gem, max_bo_size);
+	if (budget) {
+		bufmgr_gem->cache_budget = budget;
+		mos_gem_bo_cache_trim(bufmgr_gem);
+	}
+
+	pthread_mutex_unlock(&bufmgr_gem->lock);
+}
+
 /**
  * Enable use of fenced reloc type.
  *
@@ -4498,7 +4658,7 @@ add_bucket(struct mos_bufmgr_gem *bufmgr_gem, int size)
 static void
 init_cache_buckets(struct mos_bufmgr_gem *bufmgr_gem)
 {
-	unsigned long size, cache_max_size = 64 * 1024 * 1024;
+	unsigned long size;
 
 	/* OK, so power of two buckets was too wasteful of memory.
 	 * Give 3 other sizes between each power of two, to hopefully
@@ -4512,14 +4672,20 @@ init_cache_buckets(struct mos_bufmgr_gem *bufmgr_gem)
 	add_bucket(bufmgr_gem, 4096 * 2);
 	add_bucket(bufmgr_gem, 4096 * 3);
 
-	/* Initialize the linked lists for BO reuse cache. */
-	for (size = 4 * 4096; size <= cache_max_size; size *= 2) {
+	/* Initialize the linked lists for BO reuse cache. The layout has to
+	 * match mos_gem_bo_bucket_index().
+	 */
+	for (size = 4 * 4096; size <= (1UL << MOS_BO_CACHE_MAX_LOG2); size *= 2) {
 		add_bucket(bufmgr_gem, size);
 
 		add_bucket(bufmgr_gem, size + size * 1 / 4);
 		add_bucket(bufmgr_gem, size + size * 2 / 4);
 		add_bucket(bufmgr_gem, size + size * 3 / 4);
 	}
+
+	bufmgr_gem->cache_budget = MOS_BO_CACHE_DEFAULT_BUDGET;
+	mos_gem_bo_cache_set_max_bo_size(bufmgr_gem,
+					       MOS_BO_CACHE_DEFAULT_MAX_BO_SIZE);
 }
 
 void
@@ -4527,9 +4693,13 @@ mos_bufmgr_gem_set_vma_cache_size(struct mos_bufmgr *bufmgr, int limit)
 {
 	struct mos_bufmgr_gem *bufmgr_gem = (struct mos_bufmgr_gem *)bufmgr;
 
+	pthread_mutex_lock(&bufmgr_gem->vma_lock);
+
 	bufmgr_gem->vma_max = limit;
 
 	mos_gem_bo_purge_vma_cache(bufmgr_gem);
+
+	pthread_mutex_unlock(&bufmgr_gem->vma_lock);
 }
 
 /**
@@ -5017,6 +5187,8 @@ mos_bufmgr_gem_init(int fd, int batch_size)
 		bufmgr_gem = nullptr;
 		goto exit;
 	}
+	pthread_mutex_init(&bufmgr_gem->exec_lock, nullptr);
+	pthread_mutex_init(&bufmgr_gem->vma_lock, nullptr);
 
 	memclear(aperture);
 	ret = drmIoctl(bufmgr_gem->fd,
@@ -119,11 +119,233 @@ void Mos_Specific_ClearGpuContext(MOS_CONTEXT *pContext)
             pContext->OsGpuContext[iLoop].pbWriteMode = nullptr;
         }
 
+        if (pContext->OsGpuContext[iLoop].pResHash != nullptr)
+        {
+            MOS_FreeMemory(pContext->OsGpuContext[iLoop].pResHash);
+            pContext->OsGpuContext[iLoop].pResHash = nullptr;
+        }
+
         pContext->OsGpuContext[iLoop].uiMaxNumAllocations    = 0;
         pContext->OsGpuContext[iLoop].uiMaxPatchLocationsize = 0;
     }
 }
 
+//!
+//! \brief    Reset resource registration hash
+//! \details  Empties the bo -> allocation index hash of a GPU context by moving
+//!           to a new generation; the table only has to be cleared on wrap around
+//! \param    PMOS_OS_GPU_CONTEXT pOsGpuContext
+//!           [in] Pointer to OS GPU context
+//! \return   void
+//!
+static void Mos_Specific_ResetResourceHash(PMOS_OS_GPU_CONTEXT pOsGpuContext)
+{
+    if (pOsGpuContext->pResHash == nullptr)
+    {
+        return;
+    }
+
+    if (++pOsGpuContext->uiResHashGeneration == 0)
+    {
+        MOS_ZeroMemory(pOsGpuContext->pResHash, sizeof(MOS_RES_HASH_ENTRY) * MOS_RES_HASH_SIZE);
+        pOsGpuContext->uiResHashGeneration = 1;
+    }
+}
+
+//!
+//! \brief    Find resource registration hash entry
+//! \details  Returns the entry holding bo, or the empty entry where bo is to be inserted
+//! \param    PMOS_OS_GPU_CONTEXT pOsGpuContext
+//!           [in] Pointer to OS GPU context
+//! \param    MOS_LINUX_BO *bo
+//!           [in] Buffer object to look up
+//! \return   PMOS_RES_HASH_ENTRY
+//!           Matching or empty hash entry
+//!
+static PMOS_RES_HASH_ENTRY Mos_Specific_FindResourceHashEntry(
+    PMOS_OS_GPU_CONTEXT pOsGpuContext,
+    MOS_LINUX_BO        *bo)
+{
+    PMOS_RES_HASH_ENTRY pEntry;
+    uint64_t            uiHash;
+    uint32_t            uiSlot;
+
+    // 64 bit finalizer mix, bo pointers only differ in the middle bits
+    uiHash  = (uint64_t)(uintptr_t)bo;
+    uiHash ^= uiHash >> 33;
+    uiHash *= 0xff51afd7ed558ccdULL;
+    uiHash ^= uiHash >> 33;
+    uiSlot  = (uint32_t)uiHash & (MOS_RES_HASH_SIZE - 1);
+
+    // Never full: at most ALLOCATIONLIST_SIZE entries are live in a generation
+    for (;;)
+    {
+        pEntry = &pOsGpuContext->pResHash[uiSlot];
+        if (pEntry->uiGeneration != pOsGpuContext->uiResHashGeneration ||
+            pEntry->bo == bo)
+        {
+            return pEntry;
+        }
+        uiSlot = (uiSlot + 1) & (MOS_RES_HASH_SIZE - 1);
+    }
+}
+
+//!
+//! \brief    Retire command buffer
+//! \details  Move the command buffer in a pool slot to the idle list so that it can
+//!           be handed out again without a new allocation and mapping.
+//!           Caller must make sure the GPU is done with it.
+//! \param    PMOS_CONTEXT pOsContext
+//!           [in] Pointer to OS context structure
+//! \param    int32_t index
+//!           [in] Command buffer's index in Command buffer pool
+//! \return   void
+//!
+static void Linux_RetireCmdBuffer(
+    PMOS_CONTEXT   pOsContext,
+    int32_t        index)
+{
+    CMD_BUFFER_BO_POOL *pPool;
+    MOS_LINUX_BO       *cmd_bo;
+    uint32_t           uiDirty;
+
+    pPool  = &pOsContext->CmdBufferPool;
+    cmd_bo = pPool->pCmd_bo[index];
+    if (cmd_bo == nullptr)
+    {
+        return;
+    }
+
+    // A buffer that was never submitted may have been written anywhere
+    uiDirty = pPool->uiCmdUsed[index] ? pPool->uiCmdUsed[index] : (uint32_t)cmd_bo->size;
+
+    if (pPool->iIdleCount < MAX_CMD_BUF_NUM)
+    {
+        pPool->pIdle_bo[pPool->iIdleCount]    = cmd_bo;
+        pPool->uiIdleDirty[pPool->iIdleCount] = uiDirty;
+        pPool->iIdleCount++;
+    }
+    else
+    {
+        mos_bo_unreference(cmd_bo);
+    }
+
+    pPool->pCmd_bo[index]     = nullptr;
+    pPool->uiCmdUsed[index]   = 0;
+    pPool->uiSubmitSeq[index] = 0;
+    pPool->iInUse--;
+}
+
+//!
+//! \brief    Recycle idle command buffers
+//! \details  Retire every submitted command buffer the GPU has finished with
+//! \param    PMOS_CONTEXT pOsContext
+//!           [in] Pointer to OS context structure
+//! \return   void
+//!
+static void Linux_RecycleIdleCmdBuffers(
+    PMOS_CONTEXT   pOsContext)
+{
+    CMD_BUFFER_BO_POOL *pPool;
+    int32_t            i;
+
+    pPool = &pOsContext->CmdBufferPool;
+    for (i = 0; i < MAX_CMD_BUF_NUM; i++)
+    {
+        if (pPool->pCmd_bo[i] != nullptr   &&
+            pPool->uiSubmitSeq[i] != 0     &&
+            !mos_bo_busy(pPool->pCmd_bo[i]))
+        {
+            Linux_RetireCmdBuffer(pOsContext, i);
+        }
+    }
+}
+
+//!
+//! \brief    Trim command buffer pool
+//! \details  Release the idle buffers exceeding the peak demand seen since the last trim
+//! \param    PMOS_CONTEXT pOsContext
+//!           [in] Pointer to OS context structure
+//! \return   void
+//!
+static void Linux_TrimCmdBufferPool(
+    PMOS_CONTEXT   pOsContext)
+{
+    CMD_BUFFER_BO_POOL *pPool;
+    int32_t            i, iSurplus;
+
+    pPool    = &pOsContext->CmdBufferPool;
+    iSurplus = pPool->iIdleCount + pPool->iInUse - pPool->iPeakInUse;
+    iSurplus = MOS_MIN(iSurplus, pPool->iIdleCount);
+
+    if (iSurplus > 0)
+    {
+        // Coldest buffers sit at the bottom of the idle stack
+        for (i = 0; i < iSurplus; i++)
+        {
+            mos_bo_unreference(pPool->pIdle_bo[i]);
+        }
+        for (i = iSurplus; i < pPool->iIdleCount; i++)
+        {
+            pPool->pIdle_bo[i - iSurplus]    = pPool->pIdle_bo[i];
+            pPool->uiIdleDirty[i - iSurplus] = pPool->uiIdleDirty[i];
+        }
+        pPool->iIdleCount -= iSurplus;
+    }
+
+    pPool->iPeakInUse = pPool->iInUse;
+}
+
+//!
+//! \brief    Acquire command buffer from pool
+//! \details  Pop the most recently retired command buffer big enough for the request
+//! \param    PMOS_CONTEXT pOsContext
+//!           [in] Pointer to OS context structure
+//! \param    int32_t iSize
+//!           [in] Required size in bytes
+//! \param    uint32_t *puiDirty
+//!           [out] Number of bytes at the start of the buffer holding stale commands
+//! \return   MOS_LINUX_BO *
+//!           Idle command buffer, nullptr if a new one has to be allocated
+//!
+static MOS_LINUX_BO *Linux_AcquireCmdBo(
+    PMOS_CONTEXT   pOsContext,
+    int32_t        iSize,
+    uint32_t       *puiDirty)
+{
+    CMD_BUFFER_BO_POOL *pPool;
+    MOS_LINUX_BO       *cmd_bo;
+
+    pPool = &pOsContext->CmdBufferPool;
+
+    if (++pPool->uiAcquireCount % CMD_BUF_POOL_TRIM_PERIOD == 0)
+    {
+        Linux_TrimCmdBufferPool(pOsContext);
+    }
+
+    if (pPool->iIdleCount == 0)
+    {
+        Linux_RecycleIdleCmdBuffers(pOsContext);
+    }
+
+    while (pPool->iIdleCount > 0)
+    {
+        pPool->iIdleCount--;
+        cmd_bo    = pPool->pIdle_bo[pPool->iIdleCount];
+        *puiDirty = pPool->uiIdleDirty[pPool->iIdleCount];
+        pPool->pIdle_bo[pPool->iIdleCount] = nullptr;
+
+        if (cmd_bo->size >= (unsigned long)iSize)
+        {
+            return cmd_bo;
+        }
+        // Requested size grew, drop the buffer
+        mos_bo_unreference(cmd_bo);
+    }
+
+    return nullptr;
+}
+
 //!
 //! \brief    Unified OS get command buffer
 //! \details  Return the pointer to the next available space in Cmd Buffer
@@ -143,6 +365,7 @@ int32_t Linux_GetCommandBuffer(
 {
     int32_t                bResult  = false;
     MOS_LINUX_BO    	   *cmd_bo = nullptr;
+    uint32_t               uiDirty  = 0;
 
     if ( pOsContext == nullptr ||
          pCmdBuffer == nullptr)
@@ -152,13 +375,19 @@ int32_t Linux_GetCommandBuffer(
         goto finish;
     }
 
-    // Allocate the command buffer from GEM
-    cmd_bo = mos_bo_alloc(pOsContext->bufmgr,"MOS CmdBuf",iSize,4096);     // Align to page boundary
+    // Reuse a retired command buffer if possible, otherwise allocate one from GEM
+    cmd_bo = Linux_AcquireCmdBo(pOsContext, iSize, &uiDirty);
     if (cmd_bo == nullptr)
     {
-        MOS_OS_ASSERTMESSAGE("Allocation of command buffer failed.");
-        bResult = false;
-        goto finish;
+        cmd_bo = mos_bo_alloc(pOsContext->bufmgr,"MOS CmdBuf",iSize,4096);     // Align to page boundary
+        if (cmd_bo == nullptr)
+        {
+            MOS_OS_ASSERTMESSAGE("Allocation of command buffer failed.");
+            bResult = false;
+            goto finish;
+        }
+        // The BO may come from the bufmgr cache with any content
+        uiDirty = cmd_bo->size;
     }
     //MOS_OS_NORMALMESSAGE("alloc CMB, bo is 0x%x.", cmd_bo);
 
@@ -193,7 +422,8 @@ int32_t Linux_GetCommandBuffer(
     pCmdBuffer->iRemaining  = cmd_bo->size;
     pCmdBuffer->iCmdIndex   = -1;
 
-    MOS_ZeroMemory(pCmdBuffer->pCmdBase, cmd_bo->size);
+    // Only the part written by the previous user needs clearing
+    MOS_ZeroMemory(pCmdBuffer->pCmdBase, MOS_MIN(uiDirty, cmd_bo->size));
     bResult = true;
 
 finish:
@@ -298,7 +528,8 @@ void Linux_InitCmdBufferPool(
 
 //!
 //! \brief    Wait and release command buffer
-//! \details  Command buffer Wait and release
+//! \details  Command buffer Wait and release. A buffer still being recorded is
+//!           left in its slot, it may belong to another GPU context.
 //! \param    PMOS_CONTEXT pOsContext
 //!           [in] Pointer to OS context structure
 //! \param    int32_t index
@@ -323,16 +554,11 @@ MOS_STATUS Linux_WaitAndReleaseCmdBuffer(
         goto finish;
     }
 
-    // According to the logic of CmdBufferPool now, the command buffer is used in a circular way.
-    // The input index always points to the next(oldest) buffer after the latest(newest) buffer.
-    // If the next buffer is not empty (!= nullptr), all the buffers in the pool will also be not empty.
-    // So it's not necessary to check all buffers to see whether there's empty buffer.
     cmd_bo = pOsContext->CmdBufferPool.pCmd_bo[index];
-    if (cmd_bo != nullptr)
+    if (cmd_bo != nullptr && pOsContext->CmdBufferPool.uiSubmitSeq[index] != 0)
     {
         mos_bo_wait_rendering(cmd_bo);
-        mos_bo_unreference(cmd_bo);
-        pOsContext->CmdBufferPool.pCmd_bo[index] = nullptr;
+        Linux_RetireCmdBuffer(pOsContext, index);
     }
 
 finish:
@@ -359,15 +585,100 @@ MOS_STATUS Linux_ReleaseCmdBufferPool(PMOS_CONTEXT   pOsContext)
     for (i = 0; i < MAX_CMD_BUF_NUM; i++)
     {
         MOS_OS_CHK_STATUS(Linux_WaitAndReleaseCmdBuffer(pOsContext, i));
+
+        // never submitted, nothing to wait for
+        if (pOsContext->CmdBufferPool.pCmd_bo[i] != nullptr)
+        {
+            mos_bo_unreference(pOsContext->CmdBufferPool.pCmd_bo[i]);
+            pOsContext->CmdBufferPool.pCmd_bo[i] = nullptr;
+            pOsContext->CmdBufferPool.iInUse--;
+        }
+    }
+
+    for (i = 0; i < pOsContext->CmdBufferPool.iIdleCount; i++)
+    {
+        mos_bo_unreference(pOsContext->CmdBufferPool.pIdle_bo[i]);
+        pOsContext->CmdBufferPool.pIdle_bo[i] = nullptr;
     }
+    pOsContext->CmdBufferPool.iIdleCount = 0;
 
 finish:
     return eStatus;
 }
 
+//!
+//! \brief    Find free command buffer slot
+//! \details  Search the pool for an empty slot, starting from iFetch
+//! \param    PMOS_CONTEXT pOsContext
+//!           [in] Pointer to OS context structure
+//! \return   int32_t
+//!           Index of the empty slot, -1 if the pool is full
+//!
+static int32_t Linux_FindFreeCmdSlot(
+    PMOS_CONTEXT   pOsContext)
+{
+    CMD_BUFFER_BO_POOL *pPool;
+    int32_t            i, index;
+
+    pPool = &pOsContext->CmdBufferPool;
+    if (pPool->iInUse >= MAX_CMD_BUF_NUM)
+    {
+        return -1;
+    }
+
+    index = pPool->iFetch;
+    for (i = 0; i < MAX_CMD_BUF_NUM; i++)
+    {
+        if (pPool->pCmd_bo[index] == nullptr)
+        {
+            return index;
+        }
+        index = (index + 1 < MAX_CMD_BUF_NUM) ? index + 1 : 0;
+    }
+
+    return -1;
+}
+
+//!
+//! \brief    Find oldest submitted command buffer slot
+//! \param    PMOS_CONTEXT pOsContext
+//!           [in] Pointer to OS context structure
+//! \return   int32_t
+//!           Index of the slot submitted first, -1 if no slot has been submitted
+//!
+static int32_t Linux_FindOldestSubmittedCmdSlot(
+    PMOS_CONTEXT   pOsContext)
+{
+    CMD_BUFFER_BO_POOL *pPool;
+    int32_t            i, index;
+    uint32_t           uiAge, uiMaxAge;
+
+    pPool    = &pOsContext->CmdBufferPool;
+    index    = -1;
+    uiMaxAge = 0;
+    for (i = 0; i < MAX_CMD_BUF_NUM; i++)
+    {
+        if (pPool->pCmd_bo[i] == nullptr || pPool->uiSubmitSeq[i] == 0)
+        {
+            continue;
+        }
+        // unsigned distance stays correct when the counter wraps
+        uiAge = pPool->uiSubmitCount - pPool->uiSubmitSeq[i];
+        if (index < 0 || uiAge > uiMaxAge)
+        {
+            index    = i;
+            uiMaxAge = uiAge;
+        }
+    }
+
+    return index;
+}
+
 //!
 //! \brief    Wait for the fetch command
-//! \details  Wait for the fetch command bo until it is available
+//! \details  Point iFetch to a free slot of the pool. Slots whose buffer the GPU
+//!           has finished with are recycled first, only a full pool of busy
+//!           buffers waits for the oldest submitted one.
 //! \param    PMOS_CONTEXT pOsContext
 //!           [in] Pointer to OS context structure
 //! \return   MOS_STATUS
@@ -383,8 +694,25 @@ MOS_STATUS Linux_WaitForAvailableCmdBo(
 
     eStatus = MOS_STATUS_SUCCESS;
 
-    index = pOsContext->CmdBufferPool.iFetch;
-    MOS_OS_CHK_STATUS(Linux_WaitAndReleaseCmdBuffer(pOsContext, index));
+    index = Linux_FindFreeCmdSlot(pOsContext);
+    if (index < 0)
+    {
+        Linux_RecycleIdleCmdBuffers(pOsContext);
+        index = Linux_FindFreeCmdSlot(pOsContext);
+    }
+
+    if (index < 0)
+    {
+        index = Linux_FindOldestSubmittedCmdSlot(pOsContext);
+        if (index < 0)
+        {
+            MOS_OS_ASSERTMESSAGE("Every command buffer of the pool is being recorded.");
+            eStatus = MOS_STATUS_NO_SPACE;
+            goto finish;
+        }
+        MOS_OS_CHK_STATUS(Linux_WaitAndReleaseCmdBuffer(pOsContext, index));
+    }
+    pOsContext->CmdBufferPool.iFetch = index;
 
 finish:
     return eStatus;
@@ -416,9 +744,17 @@ MOS_STATUS Linux_InsertCmdBufferToPool(
 
     index = pOsContext->CmdBufferPool.iFetch;
 
-    pOsContext->CmdBufferPool.pCmd_bo[index] = pCmdBuffer->OsResource.bo;
+    pOsContext->CmdBufferPool.pCmd_bo[index]     = pCmdBuffer->OsResource.bo;
+    pOsContext->CmdBufferPool.uiCmdUsed[index]   = 0;
+    pOsContext->CmdBufferPool.uiSubmitSeq[index] = 0;
     pCmdBuffer->iCmdIndex = index;
 
+    pOsContext->CmdBufferPool.iInUse++;
+    if (pOsContext->CmdBufferPool.iInUse > pOsContext->CmdBufferPool.iPeakInUse)
+    {
+        pOsContext->CmdBufferPool.iPeakInUse = pOsContext->CmdBufferPool.iInUse;
+    }
+
     pOsContext->CmdBufferPool.iFetch++;
     if (pOsContext->CmdBufferPool.iFetch >= MAX_CMD_BUF_NUM)
     {
@@ -906,11 +1242,7 @@ void Linux_Destroy(
     Linux_ReleaseGPUStatus(pOsContext);
 
 #ifndef ANDROID
-    if (pOsContext->contextOffsetList.size())
-    {
-         pOsContext->contextOffsetList.clear();
-         pOsContext->contextOffsetList.shrink_to_fit();
-    }
+    MOS_Delete(pOsContext->pContextOffsetList);
 #endif    
 
     if (!MODSEnabled && (pOsContext->intel_context))
@@ -1052,6 +1384,13 @@ MOS_STATUS Linux_InitContext(
             return MOS_STATUS_UNKNOWN;
        }
     }
+
+    pContext->pContextOffsetList = MOS_New(MOS_CONTEXT_OFFSET_MAP);
+    if (pContext->pContextOffsetList == nullptr)
+    {
+        MOS_OS_ASSERTMESSAGE("Failed to create context offset list");
+        return MOS_STATUS_NO_SPACE;
+    }
  
     pContext->intel_context->pOsContext = pContext;
 #else
@@ -1123,6 +1462,16 @@ MOS_STATUS Linux_InitContext(
             eStatus = MOS_STATUS_NO_SPACE;
             goto finish;
         }
+
+        pContext->OsGpuContext[i].pResHash    =
+            (PMOS_RES_HASH_ENTRY)MOS_AllocAndZeroMemory(sizeof(MOS_RES_HASH_ENTRY) * MOS_RES_HASH_SIZE);
+        if (nullptr == pContext->OsGpuContext[i].pResHash)
+        {
+            MOS_OS_ASSERTMESSAGE("pContext->OsGpuContext[%d].pResHash malloc failed.", i);
+            eStatus = MOS_STATUS_NO_SPACE;
+            goto finish;
+        }
+        pContext->OsGpuContext[i].uiResHashGeneration = 1;
         
         pContext->OsGpuContext[i].uiGPUStatusTag = 1;
     }
@@ -1391,6 +1740,7 @@ void Mos_Specific_ResetOsStates(
     pOsGpuContext->uiCurrentNumPatchLocations = 0;
     MOS_ZeroMemory(pOsGpuContext->pPatchLocationList, sizeof(PATCHLOCATIONLIST) * pOsGpuContext->uiMaxPatchLocationsize);
     pOsGpuContext->uiResCount = 0;
+    Mos_Specific_ResetResourceHash(pOsGpuContext);
 
     MOS_ZeroMemory(pOsGpuContext->pResources, sizeof(MOS_RESOURCE) * pOsGpuContext->uiMaxNumAllocations);
     MOS_ZeroMemory(pOsGpuContext->pbWriteMode, sizeof(int32_t) * pOsGpuContext->uiMaxNumAllocations);
@@ -1981,17 +2331,8 @@ void Mos_Specific_FreeResource(
         mos_bo_unreference((MOS_LINUX_BO *)(pOsResource->bo));
 
 #ifndef ANDROID
-        if ( pOsInterface->pOsContext != nullptr && pOsInterface->pOsContext->contextOffsetList.size()) {
-          MOS_CONTEXT *pOsCtx = pOsInterface->pOsContext;
-          auto item_ctx = pOsCtx->contextOffsetList.begin();
-
-          for (;item_ctx != pOsCtx->contextOffsetList.end();)
-          {
-             if (item_ctx->target_bo == pOsResource->bo)
-                item_ctx = pOsCtx->contextOffsetList.erase(item_ctx); 
-             else
-                item_ctx++;
-          } 
+        if ( pOsInterface->pOsContext != nullptr && pOsInterface->pOsContext->pContextOffsetList != nullptr) {
+          pOsInterface->pOsContext->pContextOffsetList->erase((MOS_LINUX_BO *)pOsResource->bo);
         }
 #endif
         pOsResource->bo = nullptr;
@@ -2404,6 +2745,7 @@ MOS_STATUS Mos_Specific_RegisterResource (
 {
     PMOS_OS_CONTEXT     pOsContext;
     PMOS_RESOURCE       pResources;
+    PMOS_RES_HASH_ENTRY pHashEntry = nullptr;
     uint32_t            uiAllocation;
     MOS_STATUS          eStatus = MOS_STATUS_SUCCESS;
     MOS_OS_GPU_CONTEXT  *pOsGpuContext;
@@ -2422,11 +2764,20 @@ MOS_STATUS Mos_Specific_RegisterResource (
         MOS_OS_ASSERTMESSAGE("pResouce is NULL.");
         return MOS_STATUS_SUCCESS;
     }
-    for (uiAllocation = 0;
-         uiAllocation < pOsGpuContext->uiResCount;
-         uiAllocation++, pResources++)
+    if (pOsGpuContext->pResHash)
+    {
+        pHashEntry = Mos_Specific_FindResourceHashEntry(pOsGpuContext, pOsResource->bo);
+        uiAllocation = (pHashEntry->uiGeneration == pOsGpuContext->uiResHashGeneration) ?
+                       pHashEntry->uiAllocation : pOsGpuContext->uiResCount;
+    }
+    else
     {
-        if (pOsResource->bo == pResources->bo) break;
+        for (uiAllocation = 0;
+             uiAllocation < pOsGpuContext->uiResCount;
+             uiAllocation++, pResources++)
+        {
+            if (pOsResource->bo == pResources->bo) break;
+        }
     }
     // Allocation list to be updated
     if (uiAllocation < pOsGpuContext->uiMaxNumAllocations)
@@ -2435,6 +2786,12 @@ MOS_STATUS Mos_Specific_RegisterResource (
         if (uiAllocation == pOsGpuContext->uiResCount)
         {
             pOsGpuContext->uiResCount++;
+            if (pHashEntry)
+            {
+                pHashEntry->bo           = pOsResource->bo;
+                pHashEntry->uiAllocation = uiAllocation;
+                pHashEntry->uiGeneration = pOsGpuContext->uiResHashGeneration;
+            }
         }
 
         // Set allocation
@@ -2951,14 +3308,14 @@ MOS_STATUS Mos_Specific_SubmitCommandBuffer(
 
 #ifndef ANDROID
         boOffset = alloc_bo->offset64;
-        if (alloc_bo != cmd_bo)
+        if (alloc_bo != cmd_bo && pOsContext->pContextOffsetList != nullptr)
         {
-          auto item_ctx = pOsContext->contextOffsetList.begin();
-          for (; item_ctx != pOsContext->contextOffsetList.end(); item_ctx++)
+          auto range = pOsContext->pContextOffsetList->equal_range(alloc_bo);
+          for (auto item_ctx = range.first; item_ctx != range.second; item_ctx++)
           {
-             if (item_ctx->intel_context == pOsContext->intel_context && item_ctx->target_bo == alloc_bo)
+             if (item_ctx->second.intel_context == pOsContext->intel_context)
              {
-               boOffset = item_ctx->offset64;
+               boOffset = item_ctx->second.offset64;
                break;
              }
           }
@@ -3196,6 +3553,21 @@ MOS_STATUS Mos_Specific_SubmitCommandBuffer(
 
     //clear command buffer relocations to fix memory leak issue
     mos_gem_bo_clear_relocs(cmd_bo, 0);
+
+    // Record how much of the buffer must be cleared when the pool hands it out again
+    if (pCmdBuffer->iCmdIndex >= 0 && pCmdBuffer->iCmdIndex < MAX_CMD_BUF_NUM &&
+        pOsContext->CmdBufferPool.pCmd_bo[pCmdBuffer->iCmdIndex] == cmd_bo)
+    {
+        pOsContext->CmdBufferPool.uiCmdUsed[pCmdBuffer->iCmdIndex] =
+            (uint32_t)((pCmdBuffer->pCmdPtr - pCmdBuffer->pCmdBase) * sizeof(uint32_t));
+
+        // 0 marks a slot still being recorded, skip it when the counter wraps
+        if (++pOsContext->CmdBufferPool.uiSubmitCount == 0)
+        {
+            pOsContext->CmdBufferPool.uiSubmitCount = 1;
+        }
+        pOsContext->CmdBufferPool.uiSubmitSeq[pCmdBuffer->iCmdIndex] = pOsContext->CmdBufferPool.uiSubmitCount;
+    }
     
     // Reset resource allocation
     pOsGpuContext->uiNumAllocations = 0;
@@ -3203,6 +3575,7 @@ MOS_STATUS Mos_Specific_SubmitCommandBuffer(
     pOsGpuContext->uiCurrentNumPatchLocations = 0;
     MOS_ZeroMemory(pOsGpuContext->pPatchLocationList, sizeof(PATCHLOCATIONLIST) * pOsGpuContext->uiMaxPatchLocationsize);
     pOsGpuContext->uiResCount = 0;
+    Mos_Specific_ResetResourceHash(pOsGpuContext);
 
     MOS_ZeroMemory(pOsGpuContext->pbWriteMode, sizeof(int32_t) * pOsGpuContext->uiMaxNumAllocations);
 finish:
@@ -42,6 +42,7 @@
 
 #ifndef ANDROID
 #include <vector>
+#include <unordered_map>
 #endif
 
 typedef unsigned int MOS_OS_FORMAT;
@@ -100,6 +101,7 @@ enum DdiSurfaceFormat
 #define COMMAND_BUFFER_SIZE                       32768
 
 #define MAX_CMD_BUF_NUM                           30
+#define CMD_BUF_POOL_TRIM_PERIOD                  64
 
 #define MOS_LOCKFLAG_WRITEONLY                    OSKM_LOCKFLAG_WRITEONLY
 #define MOS_LOCKFLAG_READONLY                     OSKM_LOCKFLAG_READONLY
@@ -374,6 +376,18 @@ typedef struct _ALLOCATION_LIST
 //#define ALLOCATIONLIST_SIZE MOS_MAX_REGS
 #define ALLOCATIONLIST_SIZE CODECHAL_MAX_REGS  //!< use the large value
 
+#define MOS_RES_HASH_SIZE   (ALLOCATIONLIST_SIZE * 2)  //!< power of 2, keeps the load factor at most 1/2
+
+//!
+//! \brief Structure to resource registration hash entry (bo -> allocation index)
+//!
+typedef struct _MOS_RES_HASH_ENTRY
+{
+    MOS_LINUX_BO    *bo;
+    uint32_t        uiAllocation;
+    uint32_t        uiGeneration;   //!< Entry is empty unless it matches the context generation
+} MOS_RES_HASH_ENTRY, *PMOS_RES_HASH_ENTRY;
+
 //!
 //! \brief Structure to command buffer
 //!
@@ -435,6 +449,8 @@ typedef struct _CODECHAL_OS_GPU_CONTEXT
     int32_t                     iResIndex[CODECHAL_MAX_REGS];  //!< Resource indices
     PMOS_RESOURCE                pResources;                   //!< Pointer to resources list
     int32_t                     *pbWriteMode;                  //!< Write mode
+    PMOS_RES_HASH_ENTRY         pResHash;                      //!< Hash index of pResources by bo
+    uint32_t                    uiResHashGeneration;           //!< Bumped to empty pResHash per command buffer
     
     // GPU Status
 	uint32_t                    uiGPUStatusTag;
@@ -446,7 +462,16 @@ typedef struct _CODECHAL_OS_GPU_CONTEXT
 typedef struct _CMD_BUFFER_BO_POOL
 {
     int32_t             iFetch;
-    MOS_LINUX_BO        *pCmd_bo[MAX_CMD_BUF_NUM];
+    MOS_LINUX_BO        *pCmd_bo[MAX_CMD_BUF_NUM];      //!< Buffers being recorded or in flight
+    uint32_t            uiCmdUsed[MAX_CMD_BUF_NUM];     //!< Bytes written at submission, 0 until submitted
+    uint32_t            uiSubmitSeq[MAX_CMD_BUF_NUM];   //!< Submission order of each slot, 0 while still being recorded
+    uint32_t            uiSubmitCount;                  //!< Last submission order handed out
+    int32_t             iIdleCount;
+    MOS_LINUX_BO        *pIdle_bo[MAX_CMD_BUF_NUM];     //!< Retired buffers kept for reuse, hottest last
+    uint32_t            uiIdleDirty[MAX_CMD_BUF_NUM];   //!< Prefix of each retired buffer to clear on reuse
+    int32_t             iInUse;                         //!< Occupied slots in pCmd_bo
+    int32_t             iPeakInUse;                     //!< Peak of iInUse during the current trim period
+    uint32_t            uiAcquireCount;
 }CMD_BUFFER_BO_POOL;
 
 #ifndef ANDROID
@@ -456,6 +481,11 @@ struct MOS_CONTEXT_OFFSET
     MOS_LINUX_BO      *target_bo;
     uint64_t          offset64;	
 };
+
+//!
+//! \brief Softpin offsets keyed by target bo; a bo normally has one entry per context
+//!
+typedef std::unordered_multimap<MOS_LINUX_BO *, struct MOS_CONTEXT_OFFSET> MOS_CONTEXT_OFFSET_MAP;
 #endif
 
 typedef struct _MOS_OS_CONTEXT MOS_CONTEXT, *PMOS_CONTEXT, MOS_OS_CONTEXT, *PMOS_OS_CONTEXT, MOS_DRIVER_CONTEXT,*PMOS_DRIVER_CONTEXT;
@@ -522,7 +552,7 @@ struct _MOS_OS_CONTEXT
     PMOS_RESOURCE   pGPUStatusBuffer;
 
 #ifndef ANDROID
-    std::vector< struct MOS_CONTEXT_OFFSET> contextOffsetList;   
+    MOS_CONTEXT_OFFSET_MAP *pContextOffsetList;    //!< Created by Linux_InitContext, the context itself is zero-allocated
 #endif
  
     // Media memory decompression function
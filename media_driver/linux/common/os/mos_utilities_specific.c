@@ -33,9 +33,12 @@
 #include <errno.h>     // strerror(errno)
 #include <time.h>      // get_clocktime
 #include <sys/stat.h>  // fstat
+#include <sys/file.h>  // flock
 #include <dlfcn.h>     // dlopen, dlsym, dlclose
 #include <sys/types.h>
+#include <sys/syscall.h> // SYS_gettid
 #include <unistd.h>
+#include <pthread.h>
 #if _MEDIA_RESERVED
 #include "codechal_util_user_interface_ext.h"
 #endif // _MEDIA_RESERVED
@@ -64,6 +67,38 @@ PUFKEYOPS      pUFKeyOps = nullptr;
 const char * const MosTracePath = "/sys/kernel/debug/tracing/trace_marker";
 static int32_t MosTraceFd = -1;
 
+//!
+//! \brief Linux specific binary trace backend.
+//!        Each thread owns a pre-allocated ring it fills without locks, a
+//!        drain thread copies the rings to MosTraceFile. Rings are kept for
+//!        the process lifetime and reused by new threads once their owner exits.
+//!
+#define TRACE_EVENT_MAX_SIZE            4096        // max event size, for both backends
+#define TRACE_RING_SIZE                 (1 << 20)   // bytes per thread, power of 2
+#define TRACE_RING_DRAIN_INTERVAL_MS    10
+
+typedef struct _MOS_TRACE_RING
+{
+    uint8_t                     *pData;
+    uint64_t                    ullHead;        // only advanced by the owner thread
+    uint64_t                    ullTail;        // only advanced by the drain thread
+    uint64_t                    ullOwner;       // token of the owner thread, 0 when free
+    struct _MOS_TRACE_RING      *pNext;
+} MOS_TRACE_RING;
+
+static MOS_TRACE_RING           *MosTraceRings          = nullptr;
+static FILE                     *MosTraceFile           = nullptr;
+static int32_t                  MosTraceRingEnabled     = 0;
+static int32_t                  MosTraceRingStop        = 0;
+static uint64_t                 MosTraceRingToken       = 0;
+static uint64_t                 MosTraceDroppedEvents   = 0;
+static MOS_THREADHANDLE         MosTraceRingThread;
+static pthread_key_t            MosTraceRingKey;
+static bool                     MosTraceRingKeyCreated  = false;
+static thread_local MOS_TRACE_RING  *MosTraceThreadRing = nullptr;
+static thread_local uint64_t        MosTraceThreadToken = 0;
+static thread_local uint32_t        MosTraceThreadId    = 0;
+
 //!
 //! \brief for int64_t/uint64_t format print warning
 //!
@@ -87,6 +122,56 @@ MOS_MUTEX gMosUtilMutex = PTHREAD_MUTEX_INITIALIZER;
 
 static uint32_t uiMOSUtilInitCount = 0; // number count of mos utilities init
 
+//!
+//! \brief Hash index entry of the in-memory user feature store.
+//!        An entry refers to a key (iValue == NOT_FOUND) or to one value of a key.
+//!
+typedef struct _MOS_UF_HASH_ENTRY
+{
+    MOS_UF_KEY                  *pKey;
+    int32_t                     iValue;     // index in pKey->pValueArray, NOT_FOUND for the key itself
+    uint32_t                    uiHash;
+    bool                        bChanged;   // value set by this process since the last write-back
+    struct _MOS_UF_HASH_ENTRY   *pNext;
+} MOS_UF_HASH_ENTRY;
+
+//!
+//! \brief In-memory copy of USER_FEATURE_FILE.
+//!        The file is parsed once, reads and writes are served from memory and
+//!        changed values are written back by a flush thread UF_FLUSH_INTERVAL_MS
+//!        after the first change, and at MOS_OS_Utilities_Close(). Edits made by
+//!        other processes are picked up on the next access, local changes are
+//!        merged on top of them.
+//!
+typedef struct _MOS_UF_STORE
+{
+    MOS_PUF_KEYLIST             pKeyList;
+    MOS_UF_HASH_ENTRY           *pBuckets[UF_HASH_BUCKETS];
+    MOS_STATUS                  eLoadStatus;    // result of parsing the file, returned to every access
+    bool                        bLoaded;
+    bool                        bDirty;         // values changed since the last write-back
+    uint64_t                    uiDirtyMs;      // time of the first change since the last write-back
+    bool                        bFileStatValid;
+    struct stat                 FileStat;       // file identity when it was parsed or written
+} MOS_UF_STORE;
+
+static MOS_UF_STORE gMosUfStore;
+
+//!
+//! \brief mutex protecting gMosUfStore
+//!
+static MOS_MUTEX gMosUfStoreMutex = PTHREAD_MUTEX_INITIALIZER;
+
+//!
+//! \brief thread writing back gMosUfStore, runs while the store is dirty
+//!        the state below is protected by gMosUfStoreMutex
+//!
+static MOS_THREADHANDLE gMosUfFlushThread;
+static bool             gMosUfFlushThreadActive   = false;  // running until the store is written back
+static bool             gMosUfFlushThreadJoinable = false;  // created and not joined yet
+static bool             gMosUfFlushStop           = false;
+static pthread_cond_t   gMosUfFlushCond           = PTHREAD_COND_INITIALIZER;
+
 MOS_STATUS MOS_SecureStrcat(char  *strDestination, size_t numberOfElements, const char * const strSource)
 {
     if ( (strDestination == nullptr) || (strSource == nullptr) )
@@ -495,58 +580,113 @@ void MOS_Sleep(uint32_t mSec)
 
 //User Feature
 /*----------------------------------------------------------------------------
-| Name      : _UserFeature_FindKey
-| Purpose   : This function finds a key in keys linked list according to key
-|             name.
-| Arguments : pKeyList   [in] Key Linked list.
-|             pcKeyName  [in] Name to the key to find.
-| Returns   : Matched uf_key data. otherwise return NULL.
+| Name      : _UserFeature_Hash
+| Purpose   : Hash a key name, or a key name and value name pair, for the
+|             user feature index.
+| Arguments : pcKeyName    [in] Key name.
+|             pcValueName  [in] Value name, nullptr to hash the key itself.
+| Returns   : FNV-1a hash of the names.
 | Comments  :
 \---------------------------------------------------------------------------*/
-static MOS_UF_KEY* _UserFeature_FindKey(MOS_PUF_KEYLIST pKeyList, char * const pcKeyName)
+static uint32_t _UserFeature_Hash(const char *pcKeyName, const char *pcValueName)
 {
-    int32_t           iResult;
-    MOS_PUF_KEYLIST   pTempNode;
+    uint32_t    uiHash;
+    const char  *pcChar;
 
-    iResult = -1;
+    uiHash = 2166136261u;
+    for (pcChar = pcKeyName; *pcChar; pcChar++)
+    {
+        uiHash = (uiHash ^ (uint8_t)*pcChar) * 16777619u;
+    }
 
-    for(pTempNode = pKeyList; pTempNode; pTempNode = pTempNode->pNext)
+    if (pcValueName != nullptr)
     {
-        iResult = strcmp(pTempNode->pElem->pcKeyName, pcKeyName);
-        if ( iResult == 0 )
+        // separator that can't appear in a name read from the file
+        uiHash = (uiHash ^ 0xff) * 16777619u;
+        for (pcChar = pcValueName; *pcChar; pcChar++)
         {
-            return pTempNode->pElem;
+            uiHash = (uiHash ^ (uint8_t)*pcChar) * 16777619u;
         }
     }
-    return nullptr; //not found
+
+    return uiHash;
 }
 
 /*----------------------------------------------------------------------------
-| Name      : _UserFeature_FindValue
-| Purpose   : Find a value in values array of a key. Return position in values
-|             array
-| Arguments : UFKey        [in] Searched Key node.
-|             pcValueName  [in] Value name.
-| Returns   : Matched value No. if it can be found, otherwise, return
-|             NOT_FOUND(-1);
+| Name      : _UserFeature_IndexFind
+| Purpose   : Find a key, or a value of a key, in the user feature index.
+| Arguments : pStore       [in] User feature store.
+|             pcKeyName    [in] Name of the key to find.
+|             pcValueName  [in] Name of the value to find, nullptr to find the
+|                               key itself.
+| Returns   : Matched index entry, otherwise return nullptr.
 | Comments  :
 \---------------------------------------------------------------------------*/
-static int32_t _UserFeature_FindValue(MOS_UF_KEY UFKey, char * const pcValueName)
+static MOS_UF_HASH_ENTRY* _UserFeature_IndexFind(
+    MOS_UF_STORE        *pStore,
+    const char * const  pcKeyName,
+    const char * const  pcValueName)
 {
-    int32_t iResult;
-    int32_t i;
+    MOS_UF_HASH_ENTRY   *pEntry;
+    uint32_t            uiHash;
 
-    iResult = -1;
+    uiHash = _UserFeature_Hash(pcKeyName, pcValueName);
 
-    for ( i = 0; i < (int32_t)UFKey.ulValueNum; i++ )
+    for (pEntry = pStore->pBuckets[uiHash & (UF_HASH_BUCKETS - 1)]; pEntry; pEntry = pEntry->pNext)
     {
-        iResult = strcmp(UFKey.pValueArray[i].pcValueName, pcValueName);
-        if ( iResult == 0 )
+        if (pEntry->uiHash != uiHash ||
+            (pcValueName == nullptr) != (pEntry->iValue == NOT_FOUND) ||
+            strcmp(pEntry->pKey->pcKeyName, pcKeyName) != 0)
         {
-            return i;
+            continue;
         }
+        if (pcValueName == nullptr ||
+            strcmp(pEntry->pKey->pValueArray[pEntry->iValue].pcValueName, pcValueName) == 0)
+        {
+            return pEntry;
+        }
+    }
+    return nullptr; //not found
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_IndexAdd
+| Purpose   : Add a key, or a value of a key, to the user feature index. If the
+|             name is already indexed the first one is kept, as the linked
+|             list lookups used to do.
+| Arguments : pStore     [in] User feature store.
+|             pKey       [in] Key to index.
+|             iValue     [in] Value position in pKey's values, NOT_FOUND to
+|                             index the key itself.
+| Returns   : MOS_STATUS_SUCCESS            success
+|             MOS_STATUS_NO_SPACE           no space left for allocate
+| Comments  :
+\---------------------------------------------------------------------------*/
+static MOS_STATUS _UserFeature_IndexAdd(MOS_UF_STORE *pStore, MOS_UF_KEY *pKey, int32_t iValue)
+{
+    MOS_UF_HASH_ENTRY   *pEntry;
+    const char          *pcValueName;
+
+    pcValueName = (iValue == NOT_FOUND) ? nullptr : pKey->pValueArray[iValue].pcValueName;
+    if (_UserFeature_IndexFind(pStore, pKey->pcKeyName, pcValueName) != nullptr)
+    {
+        return MOS_STATUS_SUCCESS;
+    }
+
+    pEntry = (MOS_UF_HASH_ENTRY*)MOS_AllocMemory(sizeof(MOS_UF_HASH_ENTRY));
+    if (pEntry == nullptr)
+    {
+        return MOS_STATUS_NO_SPACE;
     }
-    return NOT_FOUND;
+
+    pEntry->pKey    = pKey;
+    pEntry->iValue  = iValue;
+    pEntry->uiHash  = _UserFeature_Hash(pKey->pcKeyName, pcValueName);
+    pEntry->bChanged = false;
+    pEntry->pNext   = pStore->pBuckets[pEntry->uiHash & (UF_HASH_BUCKETS - 1)];
+    pStore->pBuckets[pEntry->uiHash & (UF_HASH_BUCKETS - 1)] = pEntry;
+
+    return MOS_STATUS_SUCCESS;
 }
 
 /*----------------------------------------------------------------------------
@@ -597,30 +737,34 @@ static MOS_STATUS _UserFeature_Add(MOS_PUF_KEYLIST *pKeyList, MOS_UF_KEY *NewKey
 
 /*----------------------------------------------------------------------------
 | Name      : _UserFeature_Set
-| Purpose   : This function set a key to the key list.
-| Arguments : pKeyList          [in] Key linked list.
+| Purpose   : This function set a key to the user feature store.
+| Arguments : pStore            [in] User feature store.
 |             NewKey            [in] Set key content.
 | Returns   : MOS_STATUS_SUCCESS      Operation success.
 |             MOS_STATUS_UNKNOWN      Can't find key in User Feature File.
 |             MOS_STATUS_NO_SPACE     no space left for allocate
-| Comments  :
+| Comments  : The value is marked as changed, to be merged into the file on
+|             the next write-back.
 \---------------------------------------------------------------------------*/
-static MOS_STATUS _UserFeature_Set(MOS_PUF_KEYLIST *pKeyList, MOS_UF_KEY NewKey)
+static MOS_STATUS _UserFeature_Set(MOS_UF_STORE *pStore, MOS_UF_KEY NewKey)
 {
-    int32_t       iPos;
-    MOS_UF_VALUE  *pValueArray;
-    MOS_UF_KEY    *Key;
+    int32_t             iPos;
+    MOS_UF_VALUE        *pValueArray;
+    MOS_UF_KEY          *Key;
+    MOS_UF_HASH_ENTRY   *pEntry;
+    void                *pValueBuf;
 
     iPos         = -1;
     pValueArray  = nullptr;
 
-    if ( (Key = _UserFeature_FindKey(*pKeyList, NewKey.pcKeyName)) == nullptr )
+    if ( (pEntry = _UserFeature_IndexFind(pStore, NewKey.pcKeyName, nullptr)) == nullptr )
     {
         // can't find key in File
         return MOS_STATUS_UNKNOWN;
     }
+    Key = pEntry->pKey;
 
-    if ( (iPos = _UserFeature_FindValue(*Key, NewKey.pValueArray[0].pcValueName)) == NOT_FOUND)
+    if ( (pEntry = _UserFeature_IndexFind(pStore, NewKey.pcKeyName, NewKey.pValueArray[0].pcValueName)) == nullptr)
     {
         //not found, add a new value to key struct.
         //reallocate memory for appending this value.
@@ -640,27 +784,44 @@ static MOS_STATUS _UserFeature_Set(MOS_PUF_KEYLIST *pKeyList, MOS_UF_KEY NewKey)
         Key->pValueArray = pValueArray;
 
         iPos = Key->ulValueNum;
-        MOS_SecureStrcpy(Key->pValueArray[Key->ulValueNum].pcValueName,
+        MOS_SecureStrcpy(Key->pValueArray[iPos].pcValueName,
             MAX_USERFEATURE_LINE_LENGTH,
             NewKey.pValueArray[0].pcValueName);
+        Key->pValueArray[iPos].ulValueBuf = nullptr;
+        Key->pValueArray[iPos].ulValueLen = 0;
         Key->ulValueNum ++;
+
+        if (_UserFeature_IndexAdd(pStore, Key, iPos) != MOS_STATUS_SUCCESS)
+        {
+            Key->ulValueNum --;
+            return MOS_STATUS_NO_SPACE;
+        }
+        pEntry = _UserFeature_IndexFind(pStore, NewKey.pcKeyName, NewKey.pValueArray[0].pcValueName);
+    }
+    else
+    {
+        iPos = pEntry->iValue;
     }
 
-    Key->pValueArray[iPos].ulValueLen  = NewKey.pValueArray[0].ulValueLen;
-    Key->pValueArray[iPos].ulValueType = NewKey.pValueArray[0].ulValueType;
-    Key->pValueArray[iPos].ulValueBuf  = MOS_AllocMemory(NewKey.pValueArray[0].ulValueLen);
-    if(Key->pValueArray[iPos].ulValueBuf == nullptr)
+    pValueBuf = MOS_AllocMemory(NewKey.pValueArray[0].ulValueLen);
+    if(pValueBuf == nullptr)
     {
         return MOS_STATUS_NO_SPACE;
     }
 
-    MOS_ZeroMemory(Key->pValueArray[iPos].ulValueBuf, NewKey.pValueArray[0].ulValueLen);
+    MOS_ZeroMemory(pValueBuf, NewKey.pValueArray[0].ulValueLen);
 
-    MOS_SecureMemcpy(Key->pValueArray[iPos].ulValueBuf,
+    MOS_SecureMemcpy(pValueBuf,
                      NewKey.pValueArray[0].ulValueLen,
                      NewKey.pValueArray[0].ulValueBuf,
                      NewKey.pValueArray[0].ulValueLen);
 
+    MOS_FreeMemory(Key->pValueArray[iPos].ulValueBuf);
+    Key->pValueArray[iPos].ulValueBuf  = pValueBuf;
+    Key->pValueArray[iPos].ulValueLen  = NewKey.pValueArray[0].ulValueLen;
+    Key->pValueArray[iPos].ulValueType = NewKey.pValueArray[0].ulValueType;
+    pEntry->bChanged                   = true;
+
     return MOS_STATUS_SUCCESS;
 }
 
@@ -668,41 +829,32 @@ static MOS_STATUS _UserFeature_Set(MOS_PUF_KEYLIST *pKeyList, MOS_UF_KEY NewKey)
 | Name      : _UserFeature_Query
 | Purpose   : This function query a key's value and return matched key node
 |             content just with matched value content.
-| Arguments : pKeyList      [in] Key linked list.
+| Arguments : pStore        [in] User feature store.
 |             NewKey        [in] New key content with matched value.
 | Returns   : MOS_STATUS_SUCCESS         Operation success.
 |             MOS_STATUS_UNKNOWN         Can't find key or value in User Feature File.
 | Comments  :
 \---------------------------------------------------------------------------*/
-static MOS_STATUS _UserFeature_Query(MOS_PUF_KEYLIST pKeyList, MOS_UF_KEY *NewKey)
+static MOS_STATUS _UserFeature_Query(MOS_UF_STORE *pStore, MOS_UF_KEY *NewKey)
 {
-    int32_t       iPos;
-    MOS_UF_VALUE  *pValueArray;
-    MOS_UF_KEY    *Key;
-
-    iPos         = -1;
-    pValueArray  = nullptr;
+    MOS_UF_HASH_ENTRY   *pEntry;
+    MOS_UF_VALUE        *pValue;
 
-    // can't find key in user feature
-    if ( (Key = _UserFeature_FindKey(pKeyList, NewKey->pcKeyName)) == nullptr )
-    {
-        return MOS_STATUS_UNKNOWN;
-    }
-
-    // can't find Value in the key
-    if ( (iPos = _UserFeature_FindValue(*Key, NewKey->pValueArray[0].pcValueName)) == NOT_FOUND)
+    // can't find key or Value in user feature
+    if ( (pEntry = _UserFeature_IndexFind(pStore, NewKey->pcKeyName, NewKey->pValueArray[0].pcValueName)) == nullptr )
     {
         return MOS_STATUS_UNKNOWN;
     }
+    pValue = &pEntry->pKey->pValueArray[pEntry->iValue];
 
     //get key content from user feature
     MOS_SecureMemcpy(NewKey->pValueArray[0].ulValueBuf,
-                     Key->pValueArray[iPos].ulValueLen,
-                     Key->pValueArray[iPos].ulValueBuf,
-                     Key->pValueArray[iPos].ulValueLen);
+                     pValue->ulValueLen,
+                     pValue->ulValueBuf,
+                     pValue->ulValueLen);
 
-    NewKey->pValueArray[0].ulValueLen    =  Key->pValueArray[iPos].ulValueLen;
-    NewKey->pValueArray[0].ulValueType   =  Key->pValueArray[iPos].ulValueType;
+    NewKey->pValueArray[0].ulValueLen    =  pValue->ulValueLen;
+    NewKey->pValueArray[0].ulValueType   =  pValue->ulValueType;
 
     return MOS_STATUS_SUCCESS;
 }
@@ -969,6 +1121,41 @@ static MOS_STATUS _UserFeature_DumpFile(const char * const szFileName, MOS_PUF_K
     return eStatus;
 }
 
+#ifndef ANDROID
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_GetEventKey
+| Purpose   : Get the IPC key of the semaphore signalled on user feature changes.
+| Arguments : None
+| Returns   : IPC key, or -1 if it can't be generated.
+| Comments  : Keyed on the directory, not USER_FEATURE_FILE: the file gets a new
+|             inode each time it is replaced and ftok() would change with it.
+\---------------------------------------------------------------------------*/
+static key_t _UserFeature_GetEventKey()
+{
+    return ftok(USER_FEATURE_DIR, USER_FEATURE_EVENT_PROJ_ID);
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_SignalChange
+| Purpose   : Signal the semaphore processes wait on for user feature changes.
+| Arguments : None
+| Returns   : None
+| Comments  :
+\---------------------------------------------------------------------------*/
+static void _UserFeature_SignalChange()
+{
+    int32_t        semid;
+    struct sembuf  operation[1] ;
+
+    semid = semget(_UserFeature_GetEventKey(),1,0);
+    //change semaphore
+    operation[0].sem_op  = 1;
+    operation[0].sem_num = 0;
+    operation[0].sem_flg = SEM_UNDO;
+    semop(semid, operation, 1);
+}
+#endif // ANDROID
+
 /*----------------------------------------------------------------------------
 | Name      : _UserFeature_DumpDataToFile
 | Purpose   : This function dump key linked list data to File.
@@ -976,7 +1163,9 @@ static MOS_STATUS _UserFeature_DumpFile(const char * const szFileName, MOS_PUF_K
 |             pKeyList               [in] Reserved, any LPDWORD type value.
 | Returns   : MOS_STATUS_SUCCESS                        Operation success.
 |             MOS_STATUS_USER_FEATURE_KEY_WRITE_FAILED  File can't be written.
-| Comments  :
+| Comments  : The data is written to a temporary file renamed over szFileName,
+|             so readers never see a partially written file. If the directory
+|             is not writable the file is rewritten in place.
 \---------------------------------------------------------------------------*/
 static MOS_STATUS _UserFeature_DumpDataToFile(char  *szFileName, MOS_PUF_KEYLIST pKeyList)
 {
@@ -984,8 +1173,34 @@ static MOS_STATUS _UserFeature_DumpDataToFile(char  *szFileName, MOS_PUF_KEYLIST
     PFILE             File;
     MOS_PUF_KEYLIST   pKeyTmp;
     int32_t           j;
+    char              szTmpFileName[MAX_UF_PATH];
+    int32_t           iTmpFd;
+    struct stat       FileStat;
 
-    File = fopen(szFileName, "w+");
+    File   = nullptr;
+    iTmpFd = -1;
+    if (MOS_SecureStringPrint(szTmpFileName, MAX_UF_PATH, MAX_UF_PATH, "%s.XXXXXX", szFileName) > 0)
+    {
+        iTmpFd = mkstemp(szTmpFileName);
+    }
+    if (iTmpFd >= 0)
+    {
+        if (stat(szFileName, &FileStat) == 0)
+        {
+            fchmod(iTmpFd, FileStat.st_mode & 07777);
+        }
+        File = fdopen(iTmpFd, "w");
+        if ( !File )
+        {
+            close(iTmpFd);
+            unlink(szTmpFileName);
+            iTmpFd = -1;
+        }
+    }
+    if ( !File )
+    {
+        File = fopen(szFileName, "w+");
+    }
     if ( !File )
     {
         return MOS_STATUS_USER_FEATURE_KEY_WRITE_FAILED;
@@ -1026,8 +1241,31 @@ static MOS_STATUS _UserFeature_DumpDataToFile(char  *szFileName, MOS_PUF_KEYLIST
             }
         } // for ( j = 0; j < (int32_t)pKeyTmp->pElem->ulValueNum; j ++ )
     } //for (pKeyTmp = pKeyList; pKeyTmp; pKeyTmp = pKeyTmp->pNext)
-    fclose(File);
+
+    if (iTmpFd >= 0)
+    {
+        iResult = fflush(File);
+        if (iResult == 0)
+        {
+            iResult = fsync(iTmpFd);
+        }
+        fclose(File);
+        if (iResult != 0 || rename(szTmpFileName, szFileName) != 0)
+        {
+            unlink(szTmpFileName);
+            return MOS_STATUS_USER_FEATURE_KEY_WRITE_FAILED;
+        }
+    }
+    else
+    {
+        fclose(File);
+    }
+
+#ifndef ANDROID
+    _UserFeature_SignalChange();
+#else
     MOS_UserFeatureNotifyChangeKeyValue(nullptr, false, nullptr, true);
+#endif // ANDROID
 
     return MOS_STATUS_SUCCESS;
 }
@@ -1061,6 +1299,389 @@ static void _UserFeature_FreeKeyList(MOS_PUF_KEYLIST pKeyList)
     return;
 }
 
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_FreeStore
+| Purpose   : Free the keys and the index of the user feature store.
+| Arguments : pStore             [in] user feature store to be free.
+| Returns   : None
+| Comments  : Pending changes are dropped, flush the store first to keep them.
+\---------------------------------------------------------------------------*/
+static void _UserFeature_FreeStore(MOS_UF_STORE *pStore)
+{
+    MOS_UF_HASH_ENTRY   *pEntry;
+    MOS_UF_HASH_ENTRY   *pEntryNext;
+    uint32_t            i;
+
+    for (i = 0; i < UF_HASH_BUCKETS; i++)
+    {
+        for (pEntry = pStore->pBuckets[i]; pEntry; pEntry = pEntryNext)
+        {
+            pEntryNext = pEntry->pNext;
+            MOS_FreeMemory(pEntry);
+        }
+        pStore->pBuckets[i] = nullptr;
+    }
+
+    _UserFeature_FreeKeyList(pStore->pKeyList);
+    pStore->pKeyList = nullptr;
+    pStore->bLoaded  = false;
+    pStore->bDirty   = false;
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_GetTimeMs
+| Purpose   : Get a monotonic time stamp for the user feature write-back timer.
+| Returns   : Current time in milliseconds.
+| Comments  :
+\---------------------------------------------------------------------------*/
+static uint64_t _UserFeature_GetTimeMs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_FileChanged
+| Purpose   : Check whether USER_FEATURE_FILE was replaced or modified since
+|             the store last parsed or wrote it.
+| Arguments : pStore       [in] User feature store.
+|             bStatValid   [in] Whether pFileStat holds the current file state.
+|             pFileStat    [in] Current file state.
+| Returns   : true if the file changed, otherwise false.
+| Comments  :
+\---------------------------------------------------------------------------*/
+static bool _UserFeature_FileChanged(MOS_UF_STORE *pStore, bool bStatValid, struct stat *pFileStat)
+{
+    if (bStatValid != pStore->bFileStatValid)
+    {
+        return true;
+    }
+    if (!bStatValid)
+    {
+        return false;
+    }
+
+    return pFileStat->st_dev            != pStore->FileStat.st_dev          ||
+           pFileStat->st_ino            != pStore->FileStat.st_ino          ||
+           pFileStat->st_size           != pStore->FileStat.st_size         ||
+           pFileStat->st_mtim.tv_sec    != pStore->FileStat.st_mtim.tv_sec  ||
+           pFileStat->st_mtim.tv_nsec   != pStore->FileStat.st_mtim.tv_nsec;
+}
+
+static MOS_STATUS _UserFeature_MergeStore(MOS_UF_STORE *pStore);
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_LoadStore
+| Purpose   : Parse USER_FEATURE_FILE into the store and index it, unless it is
+|             already loaded and the file did not change since.
+| Arguments : pStore       [in] User feature store, gMosUfStoreMutex held.
+| Returns   : MOS_STATUS_SUCCESS           Operation success.
+|             Otherwise the error returned when parsing the file.
+| Comments  : A store with pending changes is reloaded with the changes
+|             merged on top of the new file contents.
+\---------------------------------------------------------------------------*/
+static MOS_STATUS _UserFeature_LoadStore(MOS_UF_STORE *pStore)
+{
+    MOS_PUF_KEYLIST     pKeyTmp;
+    struct stat         FileStat;
+    bool                bStatValid;
+    uint32_t            i;
+    MOS_STATUS          eStatus;
+
+    bStatValid = (stat(USER_FEATURE_FILE, &FileStat) == 0);
+
+    if (pStore->bLoaded)
+    {
+        if (!_UserFeature_FileChanged(pStore, bStatValid, &FileStat))
+        {
+            return pStore->eLoadStatus;
+        }
+        if (pStore->bDirty)
+        {
+            eStatus = _UserFeature_MergeStore(pStore);
+            pStore->bFileStatValid = bStatValid;
+            if (bStatValid)
+            {
+                pStore->FileStat   = FileStat;
+            }
+            return eStatus;
+        }
+        _UserFeature_FreeStore(pStore);
+    }
+
+    pStore->eLoadStatus = _UserFeature_DumpFile(USER_FEATURE_FILE, &pStore->pKeyList);
+
+    for (pKeyTmp = pStore->pKeyList; pKeyTmp && pStore->eLoadStatus == MOS_STATUS_SUCCESS; pKeyTmp = pKeyTmp->pNext)
+    {
+        pStore->eLoadStatus = _UserFeature_IndexAdd(pStore, pKeyTmp->pElem, NOT_FOUND);
+        for (i = 0; i < pKeyTmp->pElem->ulValueNum && pStore->eLoadStatus == MOS_STATUS_SUCCESS; i++)
+        {
+            pStore->eLoadStatus = _UserFeature_IndexAdd(pStore, pKeyTmp->pElem, i);
+        }
+    }
+
+    if (pStore->eLoadStatus != MOS_STATUS_SUCCESS)
+    {
+        _UserFeature_FreeStore(pStore);
+    }
+
+    pStore->bLoaded        = true;
+    pStore->bFileStatValid = bStatValid;
+    if (bStatValid)
+    {
+        pStore->FileStat   = FileStat;
+    }
+
+    return pStore->eLoadStatus;
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_MergeStore
+| Purpose   : Parse USER_FEATURE_FILE again and set the values changed in the
+|             store on top of it, the result replaces the store contents.
+| Arguments : pStore       [in] User feature store, gMosUfStoreMutex held.
+| Returns   : MOS_STATUS_SUCCESS           Operation success.
+|             MOS_STATUS_NO_SPACE          no space left for allocate
+| Comments  : If the file can't be parsed the store is kept as it is. Changes
+|             to keys another process removed from the file are dropped.
+\---------------------------------------------------------------------------*/
+static MOS_STATUS _UserFeature_MergeStore(MOS_UF_STORE *pStore)
+{
+    MOS_UF_STORE        *pFileStore;
+    MOS_UF_HASH_ENTRY   *pEntry;
+    MOS_UF_KEY          NewKey;
+    MOS_STATUS          eStatus;
+    bool                bDirty;
+    uint64_t            uiDirtyMs;
+    uint32_t            i;
+
+    pFileStore = (MOS_UF_STORE*)MOS_AllocAndZeroMemory(sizeof(MOS_UF_STORE));
+    if (pFileStore == nullptr)
+    {
+        return MOS_STATUS_NO_SPACE;
+    }
+
+    if (_UserFeature_LoadStore(pFileStore) != MOS_STATUS_SUCCESS)
+    {
+        MOS_OS_NORMALMESSAGE("User feature file can't be parsed, keep the values in memory.");
+        MOS_FreeMemory(pFileStore);
+        return MOS_STATUS_SUCCESS;
+    }
+
+    eStatus = MOS_STATUS_SUCCESS;
+    for (i = 0; i < UF_HASH_BUCKETS && eStatus == MOS_STATUS_SUCCESS; i++)
+    {
+        for (pEntry = pStore->pBuckets[i]; pEntry && eStatus == MOS_STATUS_SUCCESS; pEntry = pEntry->pNext)
+        {
+            if (!pEntry->bChanged)
+            {
+                continue;
+            }
+
+            MOS_SecureStrcpy(NewKey.pcKeyName, MAX_USERFEATURE_LINE_LENGTH, pEntry->pKey->pcKeyName);
+            NewKey.pValueArray = &pEntry->pKey->pValueArray[pEntry->iValue];
+            NewKey.ulValueNum  = 1;
+
+            eStatus = _UserFeature_Set(pFileStore, NewKey);
+            if (eStatus == MOS_STATUS_UNKNOWN)
+            {
+                eStatus = MOS_STATUS_SUCCESS;
+            }
+        }
+    }
+
+    if (eStatus != MOS_STATUS_SUCCESS)
+    {
+        _UserFeature_FreeStore(pFileStore);
+        MOS_FreeMemory(pFileStore);
+        return eStatus;
+    }
+
+    bDirty    = pStore->bDirty;
+    uiDirtyMs = pStore->uiDirtyMs;
+    _UserFeature_FreeStore(pStore);
+    *pStore           = *pFileStore;
+    pStore->bDirty    = bDirty;
+    pStore->uiDirtyMs = uiDirtyMs;
+    MOS_FreeMemory(pFileStore);
+
+    return MOS_STATUS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_FlushStore
+| Purpose   : Write the pending changes of the store back to USER_FEATURE_FILE.
+| Arguments : pStore       [in] User feature store, gMosUfStoreMutex held.
+| Returns   : MOS_STATUS_SUCCESS                        Operation success.
+|             MOS_STATUS_NO_SPACE                       no space left for allocate
+|             MOS_STATUS_USER_FEATURE_KEY_WRITE_FAILED  File can't be written.
+| Comments  : The file is parsed again and only the values changed by this
+|             process are written over it, holding a lock on USER_FEATURE_DIR
+|             so that processes flushing at the same time don't lose changes.
+\---------------------------------------------------------------------------*/
+static MOS_STATUS _UserFeature_FlushStore(MOS_UF_STORE *pStore)
+{
+    MOS_UF_HASH_ENTRY   *pEntry;
+    MOS_STATUS          eStatus;
+    int32_t             iLockFd;
+    uint32_t            i;
+
+    if (!pStore->bDirty)
+    {
+        return MOS_STATUS_SUCCESS;
+    }
+
+    // the file is replaced on write-back, lock the directory that holds it
+    iLockFd = open(USER_FEATURE_DIR, O_RDONLY | O_CLOEXEC);
+    if (iLockFd >= 0 && flock(iLockFd, LOCK_EX) != 0)
+    {
+        close(iLockFd);
+        iLockFd = -1;
+    }
+
+    eStatus = _UserFeature_MergeStore(pStore);
+    if (eStatus == MOS_STATUS_SUCCESS)
+    {
+        eStatus = _UserFeature_DumpDataToFile((char *)USER_FEATURE_FILE, pStore->pKeyList);
+    }
+    if (eStatus == MOS_STATUS_SUCCESS)
+    {
+        for (i = 0; i < UF_HASH_BUCKETS; i++)
+        {
+            for (pEntry = pStore->pBuckets[i]; pEntry; pEntry = pEntry->pNext)
+            {
+                pEntry->bChanged = false;
+            }
+        }
+        pStore->bDirty         = false;
+        // don't reload what was just written
+        pStore->bFileStatValid = (stat(USER_FEATURE_FILE, &pStore->FileStat) == 0);
+    }
+
+    if (iLockFd >= 0)
+    {
+        close(iLockFd);
+    }
+
+    return eStatus;
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_FlushThread
+| Purpose   : Write back the user feature store UF_FLUSH_INTERVAL_MS after it
+|             was first changed, then exit.
+| Arguments : pData        [in] Unused.
+| Returns   : nullptr
+| Comments  : Started by _UserFeature_StartFlushThread(). A failed write-back
+|             is retried by the thread started on the next change.
+\---------------------------------------------------------------------------*/
+static void *_UserFeature_FlushThread(void *pData)
+{
+    struct timespec     Deadline;
+    uint64_t            uiWaitMs;
+    uint64_t            uiElapsedMs;
+
+    MOS_UNUSED(pData);
+
+    MOS_LockMutex(&gMosUfStoreMutex);
+    while (!gMosUfFlushStop && gMosUfStore.bDirty)
+    {
+        uiElapsedMs = _UserFeature_GetTimeMs() - gMosUfStore.uiDirtyMs;
+        if (uiElapsedMs >= UF_FLUSH_INTERVAL_MS)
+        {
+            if (_UserFeature_FlushStore(&gMosUfStore) != MOS_STATUS_SUCCESS)
+            {
+                MOS_OS_ASSERTMESSAGE("Failed to write back the user feature file.");
+                break;
+            }
+            continue;
+        }
+
+        // woken up early by _UserFeature_CloseStore()
+        uiWaitMs = UF_FLUSH_INTERVAL_MS - uiElapsedMs;
+        clock_gettime(CLOCK_REALTIME, &Deadline);
+        Deadline.tv_sec  += uiWaitMs / 1000;
+        Deadline.tv_nsec += (uiWaitMs % 1000) * 1000000;
+        if (Deadline.tv_nsec >= 1000000000)
+        {
+            Deadline.tv_sec++;
+            Deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&gMosUfFlushCond, &gMosUfStoreMutex, &Deadline);
+    }
+    gMosUfFlushThreadActive = false;
+    MOS_UnlockMutex(&gMosUfStoreMutex);
+
+    return nullptr;
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_StartFlushThread
+| Purpose   : Make sure a flush thread will write back the dirty store.
+| Arguments : None, gMosUfStoreMutex held.
+| Returns   : MOS_STATUS_SUCCESS                        Operation success.
+|             MOS_STATUS_USER_FEATURE_KEY_WRITE_FAILED  File can't be written.
+| Comments  : If no thread can be created the store is written back at once.
+\---------------------------------------------------------------------------*/
+static MOS_STATUS _UserFeature_StartFlushThread()
+{
+    if (gMosUfFlushThreadActive || gMosUfFlushStop)
+    {
+        return MOS_STATUS_SUCCESS;
+    }
+
+    // a previous thread is done with the store, it cleared the active flag under the mutex
+    if (gMosUfFlushThreadJoinable)
+    {
+        MOS_WaitThread(gMosUfFlushThread);
+        gMosUfFlushThreadJoinable = false;
+    }
+
+    gMosUfFlushThread = MOS_CreateThread((void *)_UserFeature_FlushThread, nullptr);
+    if (gMosUfFlushThread == 0)
+    {
+        return _UserFeature_FlushStore(&gMosUfStore);
+    }
+    gMosUfFlushThreadActive   = true;
+    gMosUfFlushThreadJoinable = true;
+
+    return MOS_STATUS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+| Name      : _UserFeature_CloseStore
+| Purpose   : Write back pending changes and release the user feature store.
+| Returns   : MOS_STATUS_SUCCESS                        Operation success.
+|             MOS_STATUS_USER_FEATURE_KEY_WRITE_FAILED  File can't be written.
+| Comments  :
+\---------------------------------------------------------------------------*/
+static MOS_STATUS _UserFeature_CloseStore()
+{
+    MOS_STATUS          eStatus;
+
+    MOS_LockMutex(&gMosUfStoreMutex);
+    gMosUfFlushStop = true;
+    pthread_cond_signal(&gMosUfFlushCond);
+    MOS_UnlockMutex(&gMosUfStoreMutex);
+
+    // no thread is started while gMosUfFlushStop is set
+    if (gMosUfFlushThreadJoinable)
+    {
+        MOS_WaitThread(gMosUfFlushThread);
+        gMosUfFlushThreadJoinable = false;
+    }
+
+    MOS_LockMutex(&gMosUfStoreMutex);
+    eStatus = _UserFeature_FlushStore(&gMosUfStore);
+    _UserFeature_FreeStore(&gMosUfStore);
+    gMosUfFlushStop = false;
+    MOS_UnlockMutex(&gMosUfStoreMutex);
+
+    return eStatus;
+}
+
 /*----------------------------------------------------------------------------
 | Name      : _UserFeature_SetValue
 | Purpose   : Modify or add a value of the specified user feature key.
@@ -1095,10 +1716,8 @@ static MOS_STATUS _UserFeature_SetValue(
     MOS_UF_KEY          NewKey;
     MOS_UF_VALUE        NewValue;
     MOS_STATUS          eStatus;
-    MOS_PUF_KEYLIST     pKeyList;
 
     eStatus   = MOS_STATUS_UNKNOWN;
-    pKeyList   = nullptr;
 
     if ( (strKey== nullptr) || (pcValueName == nullptr) )
     {
@@ -1123,17 +1742,20 @@ static MOS_STATUS _UserFeature_SetValue(
     NewKey.pValueArray = &NewValue;
     NewKey.ulValueNum = 1;
 
-    if ( (eStatus = _UserFeature_DumpFile(USER_FEATURE_FILE, &pKeyList)) != MOS_STATUS_SUCCESS )
+    MOS_LockMutex(&gMosUfStoreMutex);
+    if ( (eStatus = _UserFeature_LoadStore(&gMosUfStore)) == MOS_STATUS_SUCCESS &&
+         (eStatus = _UserFeature_Set(&gMosUfStore, NewKey)) == MOS_STATUS_SUCCESS )
     {
-        return eStatus;
-    }
-
-    if ( ( eStatus = _UserFeature_Set(&pKeyList, NewKey)) == MOS_STATUS_SUCCESS )
-    {
-        eStatus = _UserFeature_DumpDataToFile((char *)USER_FEATURE_FILE, pKeyList);
+        // batch the write-back of values set in a row, e.g. at context creation
+        if (!gMosUfStore.bDirty)
+        {
+            gMosUfStore.bDirty    = true;
+            gMosUfStore.uiDirtyMs = _UserFeature_GetTimeMs();
+        }
+        eStatus = _UserFeature_StartFlushThread();
     }
+    MOS_UnlockMutex(&gMosUfStoreMutex);
 
-    _UserFeature_FreeKeyList(pKeyList);
     return eStatus;
 }
 
@@ -1165,12 +1787,10 @@ static MOS_STATUS _UserFeature_QueryValue(
     MOS_UF_VALUE        NewValue;
     size_t              nKeyLen, nValueLen;
     MOS_STATUS          eStatus;
-    MOS_PUF_KEYLIST     pKeyList;
     char                strTempKey[MAX_USERFEATURE_LINE_LENGTH];
     char                strTempValueName[MAX_USERFEATURE_LINE_LENGTH];
 
     eStatus   = MOS_STATUS_UNKNOWN;
-    pKeyList   = nullptr;
 
     if ( (strKey == nullptr) || (pcValueName == nullptr))
     {
@@ -1185,9 +1805,10 @@ static MOS_STATUS _UserFeature_QueryValue(
     NewKey.pValueArray = &NewValue;
     NewKey.ulValueNum = 1;
 
-    if ( (eStatus = _UserFeature_DumpFile(USER_FEATURE_FILE, &pKeyList)) == MOS_STATUS_SUCCESS)
+    MOS_LockMutex(&gMosUfStoreMutex);
+    if ( (eStatus = _UserFeature_LoadStore(&gMosUfStore)) == MOS_STATUS_SUCCESS)
     {
-        if ( (eStatus = _UserFeature_Query(pKeyList, &NewKey)) == MOS_STATUS_SUCCESS )
+        if ( (eStatus = _UserFeature_Query(&gMosUfStore, &NewKey)) == MOS_STATUS_SUCCESS )
         {
             if(uiValueType != nullptr)
             {
@@ -1199,7 +1820,7 @@ static MOS_STATUS _UserFeature_QueryValue(
             }
         }
     }
-    _UserFeature_FreeKeyList(pKeyList);
+    MOS_UnlockMutex(&gMosUfStoreMutex);
 
     return eStatus;
 }
@@ -1216,33 +1837,21 @@ static MOS_STATUS _UserFeature_QueryValue(
 \---------------------------------------------------------------------------*/
 static MOS_STATUS _UserFeature_GetKeyIdbyName(const char  *pcKeyName, void **pUFKey)
 {
-    MOS_PUF_KEYLIST     pKeyList;
-    int32_t             iResult;
     MOS_STATUS          eStatus;
-    MOS_PUF_KEYLIST     pTempNode;
-
-    pKeyList   = nullptr;
-    iResult    = -1;
+    MOS_UF_HASH_ENTRY   *pEntry;
 
-    if ( (eStatus = _UserFeature_DumpFile(USER_FEATURE_FILE, &pKeyList)) !=
-        MOS_STATUS_SUCCESS )
+    MOS_LockMutex(&gMosUfStoreMutex);
+    if ( (eStatus = _UserFeature_LoadStore(&gMosUfStore)) == MOS_STATUS_SUCCESS )
     {
-        return eStatus;
-    }
+        eStatus   = MOS_STATUS_INVALID_PARAMETER;
 
-    eStatus   = MOS_STATUS_INVALID_PARAMETER;
-
-    for(pTempNode=pKeyList; pTempNode; pTempNode=pTempNode->pNext)
-    {
-        iResult = strcmp(pTempNode->pElem->pcKeyName, pcKeyName);
-        if ( iResult == 0 )
+        if ( (pEntry = _UserFeature_IndexFind(&gMosUfStore, pcKeyName, nullptr)) != nullptr )
         {
-            *pUFKey = pTempNode->pElem->UFKey;
+            *pUFKey = pEntry->pKey->UFKey;
             eStatus = MOS_STATUS_SUCCESS;
-            break;
         }
     }
-    _UserFeature_FreeKeyList(pKeyList);
+    MOS_UnlockMutex(&gMosUfStoreMutex);
 
     return eStatus;
 }
@@ -1259,12 +1868,9 @@ static MOS_STATUS _UserFeature_GetKeyIdbyName(const char  *pcKeyName, void **pUF
 \---------------------------------------------------------------------------*/
 static MOS_STATUS _UserFeature_GetKeyNamebyId(void  *UFKey, char  *pcKeyName)
 {
-    MOS_PUF_KEYLIST     pKeyList;
     MOS_PUF_KEYLIST     pTempNode;
     MOS_STATUS          eStatus;
 
-    pKeyList   = nullptr;
-
     switch((uintptr_t)UFKey)
     {
     case UFKEY_INTERNAL:
@@ -1276,15 +1882,17 @@ static MOS_STATUS _UserFeature_GetKeyNamebyId(void  *UFKey, char  *pcKeyName)
         eStatus = MOS_STATUS_SUCCESS;
         break;
     default:
-        if ( (eStatus = _UserFeature_DumpFile(USER_FEATURE_FILE, &pKeyList)) !=
+        MOS_LockMutex(&gMosUfStoreMutex);
+        if ( (eStatus = _UserFeature_LoadStore(&gMosUfStore)) !=
             MOS_STATUS_SUCCESS )
         {
+            MOS_UnlockMutex(&gMosUfStoreMutex);
             return eStatus;
         }
 
         eStatus   = MOS_STATUS_UNKNOWN;
 
-        for(pTempNode=pKeyList;pTempNode;pTempNode=pTempNode->pNext)
+        for(pTempNode=gMosUfStore.pKeyList;pTempNode;pTempNode=pTempNode->pNext)
         {
             if(pTempNode->pElem->UFKey == UFKey)
             {
@@ -1293,7 +1901,7 @@ static MOS_STATUS _UserFeature_GetKeyNamebyId(void  *UFKey, char  *pcKeyName)
                 break;
             }
         }
-        _UserFeature_FreeKeyList(pKeyList);
+        MOS_UnlockMutex(&gMosUfStoreMutex);
         break;
     }
 
@@ -2132,6 +2740,8 @@ MOS_STATUS MOS_OS_Utilities_Close()
     {
         MOS_TraceEventClose();
         eStatus = MOS_DestroyUserFeatureKeysForAllDescFields();
+        // write back the user feature values still pending
+        _UserFeature_CloseStore();
 #if _MEDIA_RESERVED
         if (utilUserInterface) delete utilUserInterface;
 #endif // _MEDIA_RESERVED
@@ -2253,17 +2863,7 @@ MOS_STATUS MOS_UserFeatureNotifyChangeKeyValue(
     HANDLE              hEvent,
     int32_t             fAsynchronous)
 {
-    key_t          key;
-    int32_t        semid;
-    struct sembuf  operation[1] ;
-
-    key = ftok(USER_FEATURE_FILE,1);
-    semid = semget(key,1,0);
-    //change semaphore
-    operation[0].sem_op  = 1;
-    operation[0].sem_num = 0;
-    operation[0].sem_flg = SEM_UNDO;
-    semop(semid, operation, 1);
+    _UserFeature_SignalChange();
 
     return MOS_STATUS_SUCCESS;
 }
@@ -2284,8 +2884,7 @@ HANDLE MOS_CreateEventEx(
 
     semid = 0;
 
-    //Generate a unique key, U can also supply a value instead
-    key = ftok(USER_FEATURE_FILE, 1);
+    key = _UserFeature_GetEventKey();
     semid = semget(key,  1, 0666 | IPC_CREAT );
     semctl_arg.val = 0; //Setting semval to 0
     semctl(semid, 0, SETVAL, semctl_arg);
@@ -2753,20 +3352,329 @@ MOS_STATUS MOS_GetLocalTime(
     return eStatus;    
 }
 
+//!
+//! \brief    Release the trace ring of an exiting thread
+//! \details  pthread key destructor, the ring can then be reused by another thread.
+//!           Data still in the ring is drained as usual.
+//!
+static void MOS_TraceRingRelease(void *pRing)
+{
+    uint64_t token = MosTraceThreadToken;
+
+    __atomic_compare_exchange_n(&((MOS_TRACE_RING *)pRing)->ullOwner, &token, 0,
+        false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+
+//!
+//! \brief    Get the trace ring of the calling thread
+//! \details  Claims a free ring or allocates one on the first event of a thread.
+//!           This is the only place the binary trace backend allocates memory.
+//! \return   MOS_TRACE_RING*
+//!           Ring owned by the calling thread, nullptr if out of memory
+//!
+static MOS_TRACE_RING *MOS_TraceRingAcquire()
+{
+    MOS_TRACE_RING *pRing;
+    uint64_t        token;
+    uint64_t        expected;
+
+    token = __atomic_add_fetch(&MosTraceRingToken, 1, __ATOMIC_RELAXED);
+
+    for (pRing = __atomic_load_n(&MosTraceRings, __ATOMIC_ACQUIRE); pRing; pRing = pRing->pNext)
+    {
+        expected = 0;
+        if (__atomic_compare_exchange_n(&pRing->ullOwner, &expected, token,
+                false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+
+    if (pRing == nullptr)
+    {
+        pRing = (MOS_TRACE_RING *)MOS_AllocAndZeroMemory(sizeof(MOS_TRACE_RING));
+        if (pRing == nullptr)
+        {
+            return nullptr;
+        }
+        pRing->pData = (uint8_t *)MOS_AllocMemory(TRACE_RING_SIZE);
+        if (pRing->pData == nullptr)
+        {
+            MOS_FreeMemory(pRing);
+            return nullptr;
+        }
+        pRing->ullOwner = token;
+
+        pRing->pNext = __atomic_load_n(&MosTraceRings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&MosTraceRings, &pRing->pNext, pRing,
+                   true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    MosTraceThreadRing  = pRing;
+    MosTraceThreadToken = token;
+    MosTraceThreadId    = (uint32_t)syscall(SYS_gettid);
+    if (MosTraceRingKeyCreated)
+    {
+        pthread_setspecific(MosTraceRingKey, pRing);
+    }
+
+    return pRing;
+}
+
+//!
+//! \brief    Copy data to a trace ring at a given position, wrapping around its end
+//!
+static void MOS_TraceRingCopy(MOS_TRACE_RING *pRing, uint64_t ullPos, const void *pSrc, uint32_t dwSize)
+{
+    uint32_t dwOffset = (uint32_t)(ullPos & (TRACE_RING_SIZE - 1));
+    uint32_t dwFirst  = MOS_MIN(dwSize, TRACE_RING_SIZE - dwOffset);
+
+    if (dwSize == 0)
+    {
+        return;
+    }
+
+    memcpy(pRing->pData + dwOffset, pSrc, dwFirst);
+    memcpy(pRing->pData, (const uint8_t *)pSrc + dwFirst, dwSize - dwFirst);
+}
+
+//!
+//! \brief    Append one event to the calling thread's trace ring
+//! \details  Lock-free and allocation-free, except for the first event of a thread.
+//!           The event is dropped and counted if the ring is full.
+//!
+static void MOS_TraceRingWrite(
+    uint16_t         usId,
+    uint8_t          ucType,
+    const void      *pArg1,
+    uint32_t         dwSize1,
+    const void      *pArg2,
+    uint32_t         dwSize2)
+{
+    static const uint8_t    padding[8] = {0};
+    MOS_TRACE_RING          *pRing;
+    MOS_TRACE_RECORD        record;
+    struct timespec         ts;
+    uint64_t                ullHead;
+    uint32_t                dwRecordSize;
+
+    pRing = MosTraceThreadRing;
+    if (pRing == nullptr || __atomic_load_n(&pRing->ullOwner, __ATOMIC_RELAXED) != MosTraceThreadToken)
+    {
+        pRing = MOS_TraceRingAcquire();
+        if (pRing == nullptr)
+        {
+            return;
+        }
+    }
+
+    dwSize1 = pArg1 ? MOS_MIN(dwSize1, TRACE_EVENT_MAX_SIZE) : 0;
+    dwSize2 = pArg2 ? MOS_MIN(dwSize2, TRACE_EVENT_MAX_SIZE - dwSize1) : 0;
+    dwRecordSize = sizeof(record) + MOS_ALIGN_CEIL(dwSize1 + dwSize2, 8);
+
+    ullHead = pRing->ullHead;
+    if (TRACE_RING_SIZE - (ullHead - __atomic_load_n(&pRing->ullTail, __ATOMIC_ACQUIRE)) < dwRecordSize)
+    {
+        __atomic_add_fetch(&MosTraceDroppedEvents, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    record.usId         = usId;
+    record.ucType       = ucType;
+    record.ucReserved   = 0;
+    record.dwSize       = dwSize1 + dwSize2;
+    record.dwThreadId   = MosTraceThreadId;
+    record.dwReserved   = 0;
+    record.ullTimestamp = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+
+    MOS_TraceRingCopy(pRing, ullHead, &record, sizeof(record));
+    MOS_TraceRingCopy(pRing, ullHead + sizeof(record), pArg1, dwSize1);
+    MOS_TraceRingCopy(pRing, ullHead + sizeof(record) + dwSize1, pArg2, dwSize2);
+    MOS_TraceRingCopy(pRing, ullHead + sizeof(record) + dwSize1 + dwSize2, padding,
+        dwRecordSize - sizeof(record) - dwSize1 - dwSize2);
+
+    // publish the record to the drain thread
+    __atomic_store_n(&pRing->ullHead, ullHead + dwRecordSize, __ATOMIC_RELEASE);
+}
+
+//!
+//! \brief    Copy the content of all trace rings to the trace file
+//! \return   uint64_t
+//!           Number of bytes written
+//!
+static uint64_t MOS_TraceRingDrain()
+{
+    MOS_TRACE_RING *pRing;
+    uint64_t        ullHead;
+    uint64_t        ullTail;
+    uint64_t        ullDrained;
+    uint32_t        dwOffset;
+    uint32_t        dwSize;
+
+    ullDrained = 0;
+
+    for (pRing = __atomic_load_n(&MosTraceRings, __ATOMIC_ACQUIRE); pRing; pRing = pRing->pNext)
+    {
+        ullTail = pRing->ullTail;
+        ullHead = __atomic_load_n(&pRing->ullHead, __ATOMIC_ACQUIRE);
+        while (ullTail != ullHead)
+        {
+            dwOffset = (uint32_t)(ullTail & (TRACE_RING_SIZE - 1));
+            dwSize   = (uint32_t)MOS_MIN(ullHead - ullTail, (uint64_t)(TRACE_RING_SIZE - dwOffset));
+            fwrite(pRing->pData + dwOffset, 1, dwSize, MosTraceFile);
+            ullTail    += dwSize;
+            ullDrained += dwSize;
+        }
+        __atomic_store_n(&pRing->ullTail, ullTail, __ATOMIC_RELEASE);
+    }
+    fflush(MosTraceFile);
+
+    return ullDrained;
+}
+
+static void *MOS_TraceRingDrainThread(void *pData)
+{
+    MOS_UNUSED(pData);
+
+    while (!__atomic_load_n(&MosTraceRingStop, __ATOMIC_ACQUIRE))
+    {
+        // keep draining without sleeping while events keep coming
+        if (MOS_TraceRingDrain() == 0)
+        {
+            MOS_Sleep(TRACE_RING_DRAIN_INTERVAL_MS);
+        }
+    }
+    return nullptr;
+}
+
+//!
+//! \brief    Start the binary trace backend
+//! \param    [in] pcFileName
+//!           Trace file name, the process id is appended to it
+//! \return   MOS_STATUS
+//!           MOS_STATUS_SUCCESS if the trace file and the drain thread are ready
+//!
+static MOS_STATUS MOS_TraceRingOpen(const char *pcFileName)
+{
+    char                    szFileName[MAX_USERFEATURE_LINE_LENGTH + 16];
+    MOS_TRACE_FILE_HEADER   header;
+    MOS_TRACE_RING          *pRing;
+
+    MOS_SecureStringPrint(szFileName, sizeof(szFileName), sizeof(szFileName) - 1,
+        "%s.%d", pcFileName, MOS_GetPid());
+    MosTraceFile = fopen(szFileName, "wb");
+    if (MosTraceFile == nullptr)
+    {
+        return MOS_STATUS_FILE_OPEN_FAILED;
+    }
+
+    MOS_ZeroMemory(&header, sizeof(header));
+    header.dwMagic      = MOS_TRACE_FILE_MAGIC;
+    header.dwVersion    = MOS_TRACE_FILE_VERSION;
+    header.dwProcessId  = MOS_GetPid();
+    fwrite(&header, sizeof(header), 1, MosTraceFile);
+
+    // deleted again on close, the destructor must not outlive the driver
+    if (!MosTraceRingKeyCreated &&
+        pthread_key_create(&MosTraceRingKey, MOS_TraceRingRelease) == 0)
+    {
+        MosTraceRingKeyCreated = true;
+    }
+
+    // rings left by a previous session start over
+    for (pRing = MosTraceRings; pRing; pRing = pRing->pNext)
+    {
+        pRing->ullHead  = 0;
+        pRing->ullTail  = 0;
+        pRing->ullOwner = 0;
+    }
+    MosTraceDroppedEvents = 0;
+    MosTraceRingStop      = 0;
+
+    MosTraceRingThread = MOS_CreateThread((void *)MOS_TraceRingDrainThread, nullptr);
+    if (MosTraceRingThread == 0)
+    {
+        fclose(MosTraceFile);
+        MosTraceFile = nullptr;
+        return MOS_STATUS_UNKNOWN;
+    }
+
+    __atomic_store_n(&MosTraceRingEnabled, 1, __ATOMIC_RELEASE);
+    return MOS_STATUS_SUCCESS;
+}
+
+//!
+//! \brief    Stop the binary trace backend, flushing all pending events
+//!
+static void MOS_TraceRingClose()
+{
+    MOS_TRACE_FILE_HEADER   header;
+
+    if (MosTraceFile == nullptr)
+    {
+        return;
+    }
+
+    __atomic_store_n(&MosTraceRingEnabled, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&MosTraceRingStop, 1, __ATOMIC_RELEASE);
+    MOS_WaitThread(MosTraceRingThread);
+    MOS_TraceRingDrain();
+
+    MOS_ZeroMemory(&header, sizeof(header));
+    header.dwMagic          = MOS_TRACE_FILE_MAGIC;
+    header.dwVersion        = MOS_TRACE_FILE_VERSION;
+    header.dwProcessId      = MOS_GetPid();
+    header.ullDroppedEvents = __atomic_load_n(&MosTraceDroppedEvents, __ATOMIC_RELAXED);
+    fseek(MosTraceFile, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, MosTraceFile);
+
+    fclose(MosTraceFile);
+    MosTraceFile = nullptr;
+
+    // threads exiting after the driver is unloaded must not run MOS_TraceRingRelease,
+    // the calling thread gives its ring back here as no destructor will do it
+    if (MosTraceRingKeyCreated)
+    {
+        pthread_key_delete(MosTraceRingKey);
+        MosTraceRingKeyCreated = false;
+    }
+    if (MosTraceThreadRing)
+    {
+        MOS_TraceRingRelease(MosTraceThreadRing);
+        MosTraceThreadRing = nullptr;
+    }
+}
+
 void MOS_TraceEventInit()
 {
+    MOS_USER_FEATURE_VALUE_DATA UserFeatureData;
+    char                        szTraceFile[MAX_USERFEATURE_LINE_LENGTH];
+
     // close first, if already opened.
-    if (MosTraceFd >= 0)
+    MOS_TraceEventClose();
+
+    MOS_ZeroMemory(szTraceFile, sizeof(szTraceFile));
+    MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+    UserFeatureData.StringData.pStringData = szTraceFile;
+    UserFeatureData.StringData.uSize       = sizeof(szTraceFile);
+    if (MOS_UserFeature_ReadValue_ID(
+            nullptr,
+            __MOS_USER_FEATURE_KEY_TRACE_EVENT_OUTPUT_FILE_ID,
+            &UserFeatureData) == MOS_STATUS_SUCCESS &&
+        szTraceFile[0] != '\0' &&
+        MOS_TraceRingOpen(szTraceFile) == MOS_STATUS_SUCCESS)
     {
-        close(MosTraceFd);
-        MosTraceFd = -1;
+        return;
     }
+
     MosTraceFd = open(MosTracePath, O_WRONLY);
     return; 
 }
 
 void MOS_TraceEventClose()
 {
+    MOS_TraceRingClose();
     if (MosTraceFd >= 0)
     {
         close(MosTraceFd);
@@ -2775,7 +3683,6 @@ void MOS_TraceEventClose()
     return;
 }
 
-#define TRACE_EVENT_MAX_SIZE    4096
 void MOS_TraceEvent(
     uint16_t         usId,
     uint8_t          ucType,
@@ -2784,46 +3691,47 @@ void MOS_TraceEvent(
     void * const     pArg2,
     uint32_t         dwSize2)
 {
-    if (MosTraceFd >= 0)
+    if (__atomic_load_n(&MosTraceRingEnabled, __ATOMIC_RELAXED))
     {
-        char  *pTraceBuf = (char *)MOS_AllocAndZeroMemory(TRACE_EVENT_MAX_SIZE);
-        uint32_t   nLen = 0;
+        MOS_TraceRingWrite(usId, ucType, pArg1, dwSize1, pArg2, dwSize2);
+    }
+    else if (MosTraceFd >= 0)
+    {
+        char      traceBuf[TRACE_EVENT_MAX_SIZE];
+        uint32_t  nLen = 0;
 
-        if (pTraceBuf)
+        MOS_SecureStringPrint(traceBuf,
+                    TRACE_EVENT_MAX_SIZE,
+                    (TRACE_EVENT_MAX_SIZE-1),
+                    "IMTE|%d|%d", // magic number IMTE (IntelMediaTraceEvent)
+                    usId,
+                    ucType);
+        nLen = strlen(traceBuf);
+        if (pArg1)
         {
-            MOS_SecureStringPrint(pTraceBuf,
-                        TRACE_EVENT_MAX_SIZE, 
-                        (TRACE_EVENT_MAX_SIZE-1), 
-                        "IMTE|%d|%d", // magic number IMTE (IntelMediaTraceEvent)
-                        usId, 
-                        ucType);
-            nLen = strlen(pTraceBuf);
-            if (pArg1)
-            {
-                // convert raw event data to string. native raw data will be supported 
-                // from linux kernel 4.10, hopefully we can skip this convert in the future. 
-                const static char n2c[] = "0123456789ABCDEF";
-                char  *pData = (char *)pArg1;
+            // convert raw event data to string. native raw data will be supported
+            // from linux kernel 4.10, hopefully we can skip this convert in the future.
+            static const char n2c[] = "0123456789ABCDEF";
+            const uint8_t    *pData = (const uint8_t *)pArg1;
 
-                pTraceBuf[nLen++] = '|'; // prefix splite marker.
-                while(dwSize1-- > 0 && nLen < TRACE_EVENT_MAX_SIZE-2)
-                {
-                    pTraceBuf[nLen++] = n2c[(*pData) >> 4];
-                    pTraceBuf[nLen++] = n2c[(*pData++) & 0xf];
-                }
-                if (pArg2)
+            traceBuf[nLen++] = '|'; // prefix splite marker.
+            while(dwSize1-- > 0 && nLen < TRACE_EVENT_MAX_SIZE-2)
+            {
+                traceBuf[nLen++] = n2c[(*pData) >> 4];
+                traceBuf[nLen++] = n2c[(*pData++) & 0xf];
+            }
+            if (pArg2)
+            {
+                pData = (const uint8_t *)pArg2;
+                while(dwSize2-- > 0 && nLen < TRACE_EVENT_MAX_SIZE-2)
                 {
-                    pData = (char *)pArg2; 
-                    while(dwSize2-- > 0 && nLen < TRACE_EVENT_MAX_SIZE-2)
-                    {
-                        pTraceBuf[nLen++] = n2c[(*pData) >> 4];
-                        pTraceBuf[nLen++] = n2c[(*pData++) & 0xf];
-                    }
+                    traceBuf[nLen++] = n2c[(*pData) >> 4];
+                    traceBuf[nLen++] = n2c[(*pData++) & 0xf];
                 }
             }
-            size_t writeSize = write(MosTraceFd, pTraceBuf, nLen);
-            MOS_FreeMemory(pTraceBuf);
         }
+        size_t writeSize = write(MosTraceFd, traceBuf, nLen);
+        MOS_UNUSED(writeSize);
     }
     return;
 }
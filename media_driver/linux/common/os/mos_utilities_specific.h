@@ -36,15 +36,19 @@
 
 //user feature
 #if ANDROID_VERSION >= 800
-#define USER_FEATURE_FILE                   "/data/igfx_user_feature.txt"
+#define USER_FEATURE_DIR                    "/data"
 #else
-#define USER_FEATURE_FILE                   "/etc/igfx_user_feature.txt"
+#define USER_FEATURE_DIR                    "/etc"
 #endif
+#define USER_FEATURE_FILE                   USER_FEATURE_DIR "/igfx_user_feature.txt"
+#define USER_FEATURE_EVENT_PROJ_ID          'U'
 #define UF_KEY_ID                           "[KEY]"
 #define UF_VALUE_ID                         "[VALUE]"
 #define UF_CAPABILITY                       64
 #define MAX_USERFEATURE_LINE_LENGTH         256
 #define MAX_UF_LINE_STRING_FORMAT           "%255[^\n]\n"
+#define UF_HASH_BUCKETS                     1024    // buckets of the in-memory user feature index, power of 2
+#define UF_FLUSH_INTERVAL_MS                1000    // maximum delay before changed user feature values are written back
 
 #define UF_NONE                             ( 0 )   // No value type
 #define UF_SZ                               ( 1 )   // Unicode nul terminated string
@@ -153,4 +157,33 @@ typedef struct UFKEYOPS
         uint8_t    *lpData,
         uint32_t   cbData);
 } UFKEYOPS,*PUFKEYOPS;
+
+//!
+//! \brief Binary trace file written when "Trace Event Output File" is set.
+//!        The file starts with MOS_TRACE_FILE_HEADER, followed by records made
+//!        of a MOS_TRACE_RECORD and its payload padded to 8 bytes. Records of
+//!        one thread are in order, records of different threads are not.
+//!
+#define MOS_TRACE_FILE_MAGIC                0x42544D49  // "IMTB" (IntelMediaTraceBinary)
+#define MOS_TRACE_FILE_VERSION              1
+
+typedef struct _MOS_TRACE_FILE_HEADER
+{
+    uint32_t          dwMagic;
+    uint32_t          dwVersion;
+    uint32_t          dwProcessId;
+    uint32_t          dwReserved;
+    uint64_t          ullDroppedEvents;     // events lost because a thread's ring was full
+} MOS_TRACE_FILE_HEADER;
+
+typedef struct _MOS_TRACE_RECORD
+{
+    uint16_t          usId;                 // MEDIA_EVENT
+    uint8_t           ucType;               // MEDIA_EVENT_TYPE
+    uint8_t           ucReserved;
+    uint32_t          dwSize;               // payload size, without padding
+    uint32_t          dwThreadId;
+    uint32_t          dwReserved;
+    uint64_t          ullTimestamp;         // CLOCK_MONOTONIC, in ns
+} MOS_TRACE_RECORD;
 #endif // __MOS_UTILITIES_SPECIFIC_H__
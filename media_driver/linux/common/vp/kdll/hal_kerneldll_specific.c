@@ -0,0 +1,226 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file     hal_kerneldll_specific.c
+//! \brief    Linux file access for the persistent kernel dll cache
+//! \details  Maps the cache file read-only so it is shared between processes
+//!           and replaces it atomically on update.
+//!
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hal_kerneldll.h"
+#include "vphal.h"
+
+#define KDLL_PERSISTENT_CACHE_DIR   "intel-media-driver"
+#define KDLL_PERSISTENT_CACHE_FILE  "vp_kernel_cache.bin"
+
+//!
+//! \brief    Get persistent kernel cache file path
+//! \details  Uses $XDG_CACHE_HOME, falling back to $HOME/.cache
+//! \param    [out] pcPath
+//!           Buffer for the path
+//! \param    [in] dwSize
+//!           Size of the buffer
+//! \return   bool
+//!           true if the path fits in the buffer, false otherwise
+//!
+bool KernelDll_GetPersistentCachePath(char *pcPath, uint32_t dwSize)
+{
+    const char *pcBase;
+    int         iLength;
+
+    pcBase = getenv("XDG_CACHE_HOME");
+    if (pcBase && pcBase[0] == '/')
+    {
+        iLength = snprintf(pcPath, dwSize, "%s/" KDLL_PERSISTENT_CACHE_DIR "/" KDLL_PERSISTENT_CACHE_FILE, pcBase);
+    }
+    else
+    {
+        pcBase = getenv("HOME");
+        if (!pcBase || pcBase[0] != '/')
+        {
+            return false;
+        }
+        iLength = snprintf(pcPath, dwSize, "%s/.cache/" KDLL_PERSISTENT_CACHE_DIR "/" KDLL_PERSISTENT_CACHE_FILE, pcBase);
+    }
+
+    return (iLength > 0 && (uint32_t)iLength < dwSize);
+}
+
+//!
+//! \brief    Map persistent kernel cache file
+//! \param    [in] pcPath
+//!           Cache file path
+//! \param    [out] pdwSize
+//!           Size of the mapping
+//! \return   uint8_t *
+//!           Read-only mapping of the file, nullptr if missing or unusable
+//!
+uint8_t *KernelDll_MapPersistentCache(const char *pcPath, uint32_t *pdwSize)
+{
+    struct stat st;
+    void       *pData;
+    int         fd;
+
+    *pdwSize = 0;
+
+    fd = open(pcPath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    if (fstat(fd, &st) != 0 ||
+        st.st_size <= 0    ||
+        st.st_size > DL_PERSISTENT_CACHE_MAX_SIZE)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    pData = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pData == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    *pdwSize = (uint32_t)st.st_size;
+    return (uint8_t *)pData;
+}
+
+//!
+//! \brief    Unmap persistent kernel cache file
+//! \param    [in] pData
+//!           Mapping returned by KernelDll_MapPersistentCache
+//! \param    [in] dwSize
+//!           Size of the mapping
+//!
+void KernelDll_UnmapPersistentCache(uint8_t *pData, uint32_t dwSize)
+{
+    if (pData)
+    {
+        munmap(pData, dwSize);
+    }
+}
+
+//!
+//! \brief    Create a directory if it does not exist yet
+//!
+static bool KernelDll_CreateCacheDirectory(const char *pcPath)
+{
+    return (mkdir(pcPath, 0700) == 0 || errno == EEXIST);
+}
+
+//!
+//! \brief    Replace persistent kernel cache file
+//! \details  Writes a private temporary file and renames it over the cache,
+//!           so readers never see a partially written file and existing
+//!           mappings keep the previous contents.
+//! \param    [in] pcPath
+//!           Cache file path
+//! \param    [in] pData
+//!           New file contents
+//! \param    [in] dwSize
+//!           Size of the new contents
+//! \return   bool
+//!           true if the cache file was replaced, false otherwise
+//!
+bool KernelDll_WritePersistentCache(const char *pcPath, const uint8_t *pData, uint32_t dwSize)
+{
+    char        szDir[MOS_MAX_PATH_LENGTH];
+    char        szTemp[MOS_MAX_PATH_LENGTH];
+    char       *pcSlash;
+    ssize_t     iWritten;
+    uint32_t    dwOffset;
+    int         fd;
+
+    // Create $HOME/.cache and the driver directory as needed
+    if (snprintf(szDir, sizeof(szDir), "%s", pcPath) >= (int)sizeof(szDir))
+    {
+        return false;
+    }
+    pcSlash = strrchr(szDir, '/');
+    if (!pcSlash)
+    {
+        return false;
+    }
+    *pcSlash = '\0';
+    pcSlash = strrchr(szDir, '/');
+    if (pcSlash && pcSlash != szDir)
+    {
+        *pcSlash = '\0';
+        KernelDll_CreateCacheDirectory(szDir);
+        *pcSlash = '/';
+    }
+    if (!KernelDll_CreateCacheDirectory(szDir))
+    {
+        return false;
+    }
+
+    // Unique per writer, concurrent stores from threads of one process must not share it
+    if (snprintf(szTemp, sizeof(szTemp), "%s.XXXXXX", pcPath) >= (int)sizeof(szTemp))
+    {
+        return false;
+    }
+
+    fd = mkostemp(szTemp, O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    for (dwOffset = 0; dwOffset < dwSize; dwOffset += (uint32_t)iWritten)
+    {
+        iWritten = write(fd, pData + dwOffset, dwSize - dwOffset);
+        if (iWritten < 0 && errno == EINTR)
+        {
+            iWritten = 0;
+        }
+        else if (iWritten <= 0)
+        {
+            break;
+        }
+    }
+
+    // Contents must be on disk before the rename makes them visible
+    if (dwOffset != dwSize || fsync(fd) != 0)
+    {
+        close(fd);
+        unlink(szTemp);
+        return false;
+    }
+
+    if (close(fd) != 0 || rename(szTemp, pcPath) != 0)
+    {
+        unlink(szTemp);
+        return false;
+    }
+
+    return true;
+}
@@ -20,3 +20,4 @@
 
 media_include_subdirectory(ddi)
 media_include_subdirectory(hal)
+media_include_subdirectory(kdll)